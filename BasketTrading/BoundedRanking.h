@@ -0,0 +1,78 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+
+#pragma once
+
+// keeps the best N of whatever is pushed in, worst kept item at the top of the heap:
+//   a candidate no better than that is rejected in O(1), otherwise replaces it in O(log N)
+// rankings built independently, say one per worker thread, combine with Merge
+// C orders keys, a key is better than another when C( other, key ), so std::less keeps the largest
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+template<typename K, typename V, typename C = std::less<K> >
+class BoundedRanking {
+public:
+
+  typedef std::pair<K,V> value_type;
+  typedef std::vector<value_type> vector_t;
+
+  explicit BoundedRanking( size_t nMax ): m_nMax( nMax ) { m_heap.reserve( nMax ); };
+
+  void Push( const K& key, const V& value ) {
+    if ( m_nMax > m_heap.size() ) {
+      m_heap.push_back( value_type( key, value ) );
+      std::push_heap( m_heap.begin(), m_heap.end(), m_compare );
+    }
+    else {
+      if ( ( 0 < m_nMax ) && m_compare.m_cmp( m_heap.front().first, key ) ) {
+        std::pop_heap( m_heap.begin(), m_heap.end(), m_compare );
+        m_heap.back() = value_type( key, value );
+        std::push_heap( m_heap.begin(), m_heap.end(), m_compare );
+      }
+    }
+  }
+
+  void Merge( const BoundedRanking<K,V,C>& rhs ) {
+    for ( typename vector_t::const_iterator iter = rhs.m_heap.begin(); rhs.m_heap.end() != iter; ++iter ) {
+      Push( iter->first, iter->second );
+    }
+  }
+
+  vector_t Sorted( void ) const {  // best first
+    vector_t v( m_heap );
+    std::sort_heap( v.begin(), v.end(), m_compare );
+    return v;
+  }
+
+  size_t Size( void ) const { return m_heap.size(); };
+  void Clear( void ) { m_heap.clear(); };
+
+protected:
+private:
+
+  struct Compare {  // heap ordering, puts the worst key at the front
+    C m_cmp;
+    bool operator()( const value_type& lhs, const value_type& rhs ) const { return m_cmp( rhs.first, lhs.first ); };
+  };
+
+  size_t m_nMax;
+  Compare m_compare;
+  vector_t m_heap;
+
+};
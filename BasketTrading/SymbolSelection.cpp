@@ -14,29 +14,139 @@
 
 #include "stdafx.h"
 
+#include <atomic>
+#include <memory>
+#include <sstream>
 #include <iostream>
+#include <fstream>
 #include <set>
 #include <vector>
 #include <math.h>
 
+#include <boost/thread/thread.hpp>
+
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/serialization/split_free.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/deque.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/date_time/posix_time/time_serialize.hpp>
+
 #include <TFHDF5TimeSeries/HDF5IterateGroups.h>
 #include <TFHDF5TimeSeries/HDF5TimeSeriesContainer.h>
 
-#include <TFIndicators/Darvas.h>
 #include <TFIndicators/Pivots.h>
 
 #include "SymbolSelection.h"
 
-SymbolSelection::SymbolSelection( ptime dtLast )
-  : m_dtLast( dtLast ), m_dm( ou::tf::HDF5DataManager::RO ), m_nMinPivotBars( 20 )
+namespace boost {
+namespace serialization {
+
+template<class Archive>
+void save( Archive& ar, const ou::tf::Bar& bar, const unsigned int ) {
+  const ptime dt( bar.DateTime() );
+  const double dblOpen( bar.Open() ), dblHigh( bar.High() ), dblLow( bar.Low() ), dblClose( bar.Close() );
+  const ou::tf::Bar::volume_t nVolume( bar.Volume() );
+  ar << dt << dblOpen << dblHigh << dblLow << dblClose << nVolume;
+}
+
+template<class Archive>
+void load( Archive& ar, ou::tf::Bar& bar, const unsigned int ) {
+  ptime dt;
+  double dblOpen, dblHigh, dblLow, dblClose;
+  ou::tf::Bar::volume_t nVolume;
+  ar >> dt >> dblOpen >> dblHigh >> dblLow >> dblClose >> nVolume;
+  bar = ou::tf::Bar( dt, dblOpen, dblHigh, dblLow, dblClose, nVolume );
+}
+
+} // namespace serialization
+} // namespace boost
+
+BOOST_SERIALIZATION_SPLIT_FREE( ou::tf::Bar )
+
+namespace {
+
+#ifdef H5_HAVE_THREADSAFE
+  struct hdf5_lock_t {  // library serializes its own calls
+    explicit hdf5_lock_t( boost::mutex& ) {};
+  };
+#else
+  typedef boost::mutex::scoped_lock hdf5_lock_t;  // calls into the library must not overlap
+#endif
+
+  typedef SymbolSelection::filter_t filter_t;
+  typedef SymbolSelection::citerBars citerBars;
+
+  // needs to be first in a composition, the others assume the bars they look at are present
+  filter_t MinimumBars( size_t nBars ) {
+    return [nBars]( citerBars begin, citerBars end ) -> bool {
+      return nBars <= (size_t)( end - begin );
+    };
+  }
+
+  filter_t AverageVolumeAbove( size_t nBars, ou::tf::Bar::volume_t nVolume ) {
+    return [nBars,nVolume]( citerBars begin, citerBars end ) -> bool {
+      ou::tf::Bar::volume_t nTotal( 0 );
+      for ( citerBars iter = end - nBars; end != iter; ++iter ) nTotal += iter->Volume();
+      return nVolume < ( nTotal / nBars );
+    };
+  }
+
+  filter_t CloseBetween( double dblLow, double dblHigh ) {
+    return [dblLow,dblHigh]( citerBars begin, citerBars end ) -> bool {
+      const double dblClose( ( end - 1 )->Close() );
+      return ( dblLow <= dblClose ) && ( dblHigh >= dblClose );
+    };
+  }
+
+  filter_t LastBarOn( date d ) {
+    return [d]( citerBars begin, citerBars end ) -> bool {
+      return d == ( end - 1 )->DateTime().date();
+    };
+  }
+
+  double Milliseconds( const time_duration& td ) { return td.total_microseconds() / 1000.0; }
+
+}
+
+const std::string SymbolSelection::c_sStateFile( "SymbolSelection.state" );
+const unsigned int SymbolSelection::c_nStateVersion( 2 );  // 2: darvas state alongside the bars
+
+SymbolSelection::filter_t SymbolSelection::All( const std::vector<filter_t>& vFilter ) {
+  return [vFilter]( citerBars begin, citerBars end ) -> bool {
+    for ( std::vector<filter_t>::const_iterator iter = vFilter.begin(); vFilter.end() != iter; ++iter ) {
+      if ( !(*iter)( begin, end ) ) return false;
+    }
+    return true;
+  };
+}
+
+SymbolSelection::SymbolSelection( ptime dtLast, unsigned int nThreads )
+  : m_dtLast( dtLast ), m_nThreads( nThreads ), m_nMinPivotBars( 20 )
 {
 
+  if ( 0 == m_nThreads ) {
+    m_nThreads = std::max<unsigned int>( 1, boost::thread::hardware_concurrency() );
+  }
+
   m_dtEnd = m_dtLast + date_duration( 1 );
   m_dtOneYearAgo = m_dtLast - date_duration( 52 * 7 );
   m_dt26WeeksAgo = m_dtLast - date_duration( 26 * 7 );
   m_dtDateOfFirstBar = m_dt26WeeksAgo;
   m_dtDarvasTrigger = m_dtLast - date_duration( 8 );
 
+  m_filterUniverse = All( {
+    MinimumBars( m_nMinPivotBars ),
+    AverageVolumeAbove( m_nMinPivotBars, 1000000 ),
+    CloseBetween( 15.0, 90.0 ),
+    LastBarOn( m_dtLast.date() )
+  } );
+  m_filterDarvas = MinimumBars( 121 );
+
+  LoadState();
+
 }
 
 SymbolSelection::~SymbolSelection(void) {
@@ -44,30 +154,158 @@ SymbolSelection::~SymbolSelection(void) {
 
 void SymbolSelection::Process( setInstrumentInfo_t& selected ) {
 
-  m_psetSymbols = &selected;
-
   std::cout << "Running" << std::endl;
   
   std::cout << "Darvas: AT=Aggressive Trigger, CT=Conservative Trigger, BO=Break Out Alert, stop=recommended stop" << std::endl;
-  
-  ou::tf::HDF5IterateGroups groups;
 
-  groups.SetOnHandleObject( MakeDelegate( this, &SymbolSelection::ProcessGroupItem ) );
+  ptime dtStart( boost::posix_time::microsec_clock::universal_time() );
+
+  // stage 1: enumerate the universe, names only
+  m_vSymbol.clear();
+  ou::tf::HDF5IterateGroups groups;
+  groups.SetOnHandleObject( MakeDelegate( this, &SymbolSelection::HandleGroupItem ) );
   try {
     int result = groups.Start( "/bar/86400/" );
   }
   catch (...) {
     std::cout << "ouch" << std::endl;
   }
+  std::set<std::string> setName;
+  for ( vSymbol_t::const_iterator iter = m_vSymbol.begin(); m_vSymbol.end() != iter; ++iter ) {
+    setName.insert( iter->sName );
+  }
+  for ( mapSymbolState_t::iterator iter = m_mapSymbolState.begin(); m_mapSymbolState.end() != iter; ) {
+    if ( setName.end() == setName.find( iter->first ) ) {
+      m_mapSymbolState.erase( iter++ );  // no longer in the universe, don't carry it forward
+    }
+    else {
+      ++iter;
+    }
+  }
+  for ( vSymbol_t::iterator iter = m_vSymbol.begin(); m_vSymbol.end() != iter; ++iter ) {
+    iter->pState = &m_mapSymbolState[ iter->sName ];  // the map is not modified while the workers run
+  }
+
+  ptime dtEnumerated( boost::posix_time::microsec_clock::universal_time() );
+  std::cout 
+    << "Enumerated " << m_vSymbol.size() << " symbols in " 
+    << Milliseconds( dtEnumerated - dtStart ) << "ms" << std::endl;
+
+  // stage 2: scan, workers claim symbols from a shared index so a slow symbol doesn't stall a whole shard
+  std::vector<Results> vResults( m_nThreads );
+  m_ixNextSymbol = 0;
+  boost::thread_group threads;
+  for ( size_t ix = 0; ix < m_nThreads; ++ix ) {
+    threads.create_thread( boost::bind( &SymbolSelection::ScanShard, this, boost::ref( vResults[ ix ] ) ) );
+  }
+  threads.join_all();
 
-//  WrapUp10Percent(selected);
-//  WrapUpVolatility(selected);
-//  WrapUpPivots(selected);
+  ptime dtScanned( boost::posix_time::microsec_clock::universal_time() );
+
+  // stage 3: merge
+  Results results;
+  for ( std::vector<Results>::const_iterator iter = vResults.begin(); vResults.end() != iter; ++iter ) {
+    results.Merge( *iter );
+  }
+  std::cout << results.sReport;
+  selected.insert( results.setSelected.begin(), results.setSelected.end() );
+
+//  WrapUp10Percent( results, selected );
+//  WrapUpVolatility( results, selected );
+//  WrapUpPivots( results, selected );
+
+  ptime dtMerged( boost::posix_time::microsec_clock::universal_time() );
+
+  SaveState();
+
+  ptime dtSaved( boost::posix_time::microsec_clock::universal_time() );
+
+  std::cout 
+    << "Scanned " << results.cntScanned << " symbols, " << results.cntPassed << " passed, on " << m_nThreads << " threads in " 
+    << Milliseconds( dtScanned - dtEnumerated ) << "ms" << std::endl;
+  std::cout << "Merged in " << Milliseconds( dtMerged - dtScanned ) << "ms" << std::endl;
+  std::cout << "State saved in " << Milliseconds( dtSaved - dtMerged ) << "ms" << std::endl;
 
   std::cout << "History Scanned." << std::endl;
 
 }
 
+void SymbolSelection::Results::Merge( const Results& rhs ) {
+  setSelected.insert( rhs.setSelected.begin(), rhs.setSelected.end() );
+  rankingPivot.Merge( rhs.rankingPivot );
+  rankingMaxPositives.Merge( rhs.rankingMaxPositives );
+  rankingMaxNegatives.Merge( rhs.rankingMaxNegatives );
+  rankingMaxVolatility.Merge( rhs.rankingMaxVolatility );
+  sReport += rhs.sReport;
+  cntScanned += rhs.cntScanned;
+  cntPassed += rhs.cntPassed;
+}
+
+void SymbolSelection::LoadState( void ) {
+  m_mapSymbolState.clear();
+  std::ifstream ifs( c_sStateFile, std::ios::binary );
+  if ( ifs ) {
+    try {
+      boost::archive::binary_iarchive ia( ifs );
+      unsigned int nVersion( 0 );
+      ia >> nVersion;
+      if ( c_nStateVersion == nVersion ) {
+        ia >> m_mapSymbolState;
+      }
+      else {
+        std::cout << "SymbolSelection: " << c_sStateFile << " is from another version, rescanning full history" << std::endl;
+      }
+    }
+    catch (...) {
+      std::cout << "SymbolSelection: " << c_sStateFile << " unreadable, rescanning full history" << std::endl;
+      m_mapSymbolState.clear();
+    }
+  }
+}
+
+void SymbolSelection::SaveState( void ) const {
+  std::ofstream ofs( c_sStateFile, std::ios::binary );
+  boost::archive::binary_oarchive oa( ofs );
+  oa << c_nStateVersion << m_mapSymbolState;
+}
+
+// bring the cached window up to m_dtLast, reading only bars newer than those cached
+void SymbolSelection::UpdateWindow( ou::tf::HDF5DataManager& dm, const std::string& sObjectPath, SymbolState& state ) {
+
+  dequeBars_t& bars( state.bars );
+
+  if ( !bars.empty() && ( m_dtLast < bars.back().DateTime() ) ) {
+    bars.clear();  // cached past the requested eod, so start over
+    state.darvas = ProcessDarvas();
+  }
+
+  while ( !bars.empty() && ( m_dtDateOfFirstBar > bars.front().DateTime() ) ) {
+    bars.pop_front();  // expired from the window
+  }
+
+  hdf5_lock_t lock( m_mutexHDF5 );
+  ou::tf::HDF5TimeSeriesContainer<ou::tf::Bar> barRepository( dm, sObjectPath );
+  ou::tf::HDF5TimeSeriesContainer<ou::tf::Bar>::iterator begin, end;
+  if ( bars.empty() ) {
+    begin = lower_bound( barRepository.begin(), barRepository.end(), m_dtDateOfFirstBar );
+  }
+  else {
+    const ptime dtCached( bars.back().DateTime() );
+    begin = lower_bound( barRepository.begin(), barRepository.end(), dtCached );
+    if ( ( barRepository.end() != begin ) && ( dtCached == (*begin).DateTime() ) ) ++begin;
+  }
+  end = lower_bound( begin, barRepository.end(), m_dtEnd );
+  hsize_t cnt = end - begin;
+  if ( 0 < cnt ) {
+    ou::tf::Bars barsNew;
+    barsNew.Resize( cnt );
+    barRepository.Read( begin, end, &barsNew );
+    for ( ou::tf::Bars::const_iterator iter = barsNew.begin(); barsNew.end() != iter; ++iter ) {
+      bars.push_back( *iter );
+    }
+  }
+}
+
 struct AverageVolume {
 private:
   ou::tf::Bar::volume_t m_nTotalVolume;
@@ -96,39 +334,67 @@ public:
   operator double() { return m_dblSumOfPrices / m_nNumberOfValues; };
 };
 
-void SymbolSelection::ProcessGroupItem( const std::string& sObjectPath, const std::string& sObjectName ) {
-//  std::cout << sObjectName << std::endl;
-  ou::tf::HDF5TimeSeriesContainer<ou::tf::Bar> barRepository( m_dm, sObjectPath );
-  ou::tf::HDF5TimeSeriesContainer<ou::tf::Bar>::iterator begin, end;
-  begin = lower_bound( barRepository.begin(), barRepository.end(), m_dtDateOfFirstBar );
-  end = lower_bound( begin, barRepository.end(), m_dtEnd ); 
-  hsize_t cnt = end - begin;
-  if ( m_nMinPivotBars <= cnt ) {
-    ptime dttmp = (*(end-1)).DateTime();
-//    std::cout << sObjectName << m_dtLast << ", " << dttmp << std::endl;
-      ou::tf::Bars bars;
-      bars.Resize( cnt );
-      barRepository.Read( begin, end, &bars );
-      ou::tf::Bars::const_iterator iterVolume = bars.end() - m_nMinPivotBars;
-      ou::tf::Bar::volume_t volAverage = std::for_each( iterVolume, bars.end(), AverageVolume() );
-      if ( ( 1000000 < volAverage ) 
-        && ( 15.0 <= bars.Last()->Close() )
-        && ( 90.0 >= bars.Last()->Close() ) 
-        && ( m_dtLast.date() == bars.Last()->DateTime().date() )
-        ) {
-          InstrumentInfo ii( sObjectName, *bars.Last() );
-          if ( ( 120 < cnt ) && ( dttmp.date() == m_dtLast.date() ) ) {
-            CheckForDarvas( ii, bars.begin(), bars.end() );
-          }
-//          CheckFor10Percent( ii, bars.end() - 20, bars.end() );
-//          CheckForVolatility( ii, bars.end() - 20, bars.end() );
-//          CheckForPivots( ii, bars.end() - m_nMinPivotBars, bars.end() );
-//          CheckForRange( ii, bars.end() - m_nMinPivotBars, bars.end() );
-      }
+void SymbolSelection::HandleGroupItem( const std::string& sObjectPath, const std::string& sObjectName ) {
+  m_vSymbol.push_back( Symbol( sObjectPath, sObjectName ) );
+}
+
+void SymbolSelection::ScanShard( Results& results ) {
+
+  std::unique_ptr<ou::tf::HDF5DataManager> pdm;
+  {
+    hdf5_lock_t lock( m_mutexHDF5 );
+    pdm.reset( new ou::tf::HDF5DataManager( ou::tf::HDF5DataManager::RO ) );  // each worker has its own read path
+  }
+
+  for ( size_t ix = m_ixNextSymbol++; m_vSymbol.size() > ix; ix = m_ixNextSymbol++ ) {
+    const Symbol& symbol( m_vSymbol[ ix ] );
+    try {
+      ScanSymbol( results, *pdm, symbol );
+    }
+    catch (...) {
+      results.sReport += "ouch " + symbol.sName + "\n";
+    }
+  }
+
+  hdf5_lock_t lock( m_mutexHDF5 );
+  pdm.reset();
+}
+
+// feed the darvas the bars it has not yet seen, whether or not the symbol passes the filters today
+void SymbolSelection::UpdateDarvas( SymbolState& state ) {
+  const dequeBars_t& bars( state.bars );
+  citerBars iter( bars.begin() );
+  const ptime dtLastBar( state.darvas.LastBar() );
+  if ( !dtLastBar.is_not_a_date_time() ) {
+    iter = std::upper_bound( 
+      bars.begin(), bars.end(), dtLastBar, 
+      []( const ptime& dt, const ou::tf::Bar& bar ) -> bool { return dt < bar.DateTime(); } );
+  }
+  for ( ; bars.end() != iter; ++iter ) {
+    state.darvas.Calc( *iter );
   }
 }
 
-void SymbolSelection::CheckForRange( const InstrumentInfo& ii, citerBars begin, citerBars end ) {
+void SymbolSelection::ScanSymbol( Results& results, ou::tf::HDF5DataManager& dm, const Symbol& symbol ) {
+  SymbolState& state( *symbol.pState );
+  UpdateWindow( dm, symbol.sPath, state );
+  UpdateDarvas( state );
+  const dequeBars_t& bars( state.bars );
+  ++results.cntScanned;
+  if ( m_filterUniverse( bars.begin(), bars.end() ) ) {
+    ++results.cntPassed;
+    InstrumentInfo ii( symbol.sName, bars.back() );
+    if ( m_filterDarvas( bars.begin(), bars.end() ) ) {
+      CheckForDarvas( results, ii, state.darvas, bars.begin(), bars.end() );
+    }
+//    CheckFor10Percent( results, ii, bars.end() - 20, bars.end() );
+//    CheckForVolatility( results, ii, bars.end() - 20, bars.end() );
+//    CheckForPivots( results, ii, bars.end() - m_nMinPivotBars, bars.end() );
+//    CheckForRange( results, ii, bars.end() - m_nMinPivotBars, bars.end() );
+  }
+}
+
+void SymbolSelection::CheckForRange( Results& results, const InstrumentInfo& ii, citerBars begin, citerBars end ) {
   citerBars iter1( begin );
   int cnt( 0 );
   int cntAbove( 0 );
@@ -160,8 +426,8 @@ void SymbolSelection::CheckForRange( const InstrumentInfo& ii, citerBars begin,
   int diffCnt = cntAbove - cntBelow;  // minimize this
   double dblRatioAboveBelow = 0.5 - ( avgAbove / ( avgAbove + avgBelow ) ); // minimize this
 
-  //m_mapRangeRanking.insert( mapRangeRanking_t::value_type( diffCnt, ii ) );
-  std::cout 
+  std::stringstream ss;
+  ss 
     << ii.sName << ","
     << diffCnt << ","
     << dblRatioAboveBelow << ","
@@ -170,6 +436,7 @@ void SymbolSelection::CheckForRange( const InstrumentInfo& ii, citerBars begin,
 //    << avgAbove + avgBelow << ","
     << dblRange
     << std::endl;
+  results.sReport += ss.str();
 }
 
 struct CalcMaxDate: public std::unary_function<ou::tf::Bar&, void> {
@@ -193,7 +460,7 @@ private:
 
 // taken from scanner
 
-void SymbolSelection::CheckForPivots( const InstrumentInfo& ii, citerBars begin, citerBars end ) {
+void SymbolSelection::CheckForPivots( Results& results, const InstrumentInfo& ii, citerBars begin, citerBars end ) {
   ou::tf::Bar::volume_t nAverageVolume = std::for_each( begin, end, AverageVolume() );
 //  std::cout << sObject << ": " << bars.Last()->DateTime() << " - " << m_dtLast << std::endl;
 //      Info info( sObjectName, *bars.Last() );
@@ -245,166 +512,102 @@ void SymbolSelection::CheckForPivots( const InstrumentInfo& ii, citerBars begin,
   boost::uint32_t ttlOutside = ttlR1S1 + ttlR1PvS1;
   boost::uint32_t rank = ( 100 * ( ( 100 * ttlOutside ) + ttlR1S1 ) ) + ttlR1PvS1;
 
-  m_mapPivotRanking.insert( mapPivotRanking_t::value_type( rank, ii ) );
+  results.rankingPivot.Push( rank, ii );
 
 }
 
-void SymbolSelection::WrapUpPivots( setInstrumentInfo_t& selected ) {
-  int cnt( 35 );  // select 35 symbols ( => < 3% weighting by symbol )
-  for ( mapPivotRanking_t::const_reverse_iterator iter = m_mapPivotRanking.rbegin(); iter!= m_mapPivotRanking.rend(); ++iter ) {
+void SymbolSelection::WrapUpPivots( Results& results, setInstrumentInfo_t& selected ) {
+  rankingPivot_t::vector_t vRanked( results.rankingPivot.Sorted() );
+  for ( rankingPivot_t::vector_t::const_iterator iter = vRanked.begin(); vRanked.end() != iter; ++iter ) {
     selected.insert( iter->second );
-    --cnt;
-    if ( 0 == cnt ) break;
   }
-  m_mapPivotRanking.clear();
+  results.rankingPivot.Clear();
 }
 
 // 
 // ProcessDarvas
 //
 
-class ProcessDarvas: public ou::tf::Darvas<ProcessDarvas> {
-  friend ou::tf::Darvas<ProcessDarvas>;
-public:
-  ProcessDarvas( std::stringstream& ss, size_t ix );
-  ~ProcessDarvas( void ) {};
-  bool Calc( const ou::tf::Bar& );
-  double StopValue( void );  // should only be called once
-protected:
-  // CRTP from CDarvas<CProcess>
-  void ConservativeTrigger( void );
-  void AggressiveTrigger( void );
-  void SetStop( double stop ) { m_dblStop = stop; };
-//  void StopTrigger( void ) {};
-  void BreakOutAlert( size_t );
-
-private:
-
-  std::stringstream& m_ss;
-
-  size_t m_ix; // keeps track of index of trigger bar
-  bool m_bTriggered;  // set when last bar has trigger
-  double m_dblStop;
-
-};
-
-ProcessDarvas::ProcessDarvas( std::stringstream& ss, size_t ix ) 
-: ou::tf::Darvas<ProcessDarvas>(), m_ss( ss ),
-  m_bTriggered( false ), m_dblStop( 0 ), m_ix( ix )
+ProcessDarvas::ProcessDarvas( void ) 
+: ou::tf::Darvas<ProcessDarvas>(),
+  m_bTriggered( false ), m_dblStop( 0 )
 {
 }
 
 bool ProcessDarvas::Calc( const ou::tf::Bar& bar ) {
+  m_bTriggered = false;
+  m_sTriggers.clear();
   ou::tf::Darvas<ProcessDarvas>::Calc( bar );
-  --m_ix;
-  bool b = m_bTriggered; 
-  m_bTriggered = false; 
-  return b;
+  m_dtLastBar = bar.DateTime();
+  return m_bTriggered;
 }
 
 void ProcessDarvas::ConservativeTrigger( void ) {
-  m_ss << " CT(" << m_ix << ")";
+  m_sTriggers += " CT";
   m_bTriggered = true;
 }
 
 void ProcessDarvas::AggressiveTrigger( void ) {
-  m_ss << " AT(" << m_ix << ")";
+  m_sTriggers += " AT";
   m_bTriggered = true;
 }
 
 void ProcessDarvas::BreakOutAlert( size_t cnt ) {
-  m_ss << " BO(" << m_ix << ")";
+  m_sTriggers += " BO";
   m_bTriggered = true;
 }
 
-double ProcessDarvas::StopValue( void ) {
-  m_ss << " stop(" << m_dblStop << ")";
-  return m_dblStop;
+template<class Archive>
+void ProcessDarvas::serialize( Archive& ar, const unsigned int ) {
+  ar & boost::serialization::base_object<ou::tf::Darvas<ProcessDarvas> >( *this );
+  ar & m_bTriggered & m_sTriggers & m_dblStop & m_dtLastBar;
 }
 
-void SymbolSelection::CheckForDarvas( InstrumentInfo& ii, citerBars begin, citerBars end ) {
-  size_t nTriggerWindow( 10 );
+void SymbolSelection::CheckForDarvas( Results& results, InstrumentInfo& ii, const ProcessDarvas& darvas, citerBars begin, citerBars end ) {
   ptime dtDayOfMax = std::for_each( begin, end, CalcMaxDate() );
   citerBars iterLast( end - 1 );
-  if ( dtDayOfMax >= m_dtDarvasTrigger ) {
+  if ( ( dtDayOfMax >= m_dtDarvasTrigger ) && darvas.Triggered() ) {  // trigger on final day
+    ii.dblStop = darvas.StopValue();
+    results.setSelected.insert( ii );
     std::stringstream ss;
     ss << "Darvas max for " << ii.sName 
       << " on " << dtDayOfMax 
       << ", close=" << iterLast->Close()
-      << ", volume=" << iterLast->Volume();
-
-    ProcessDarvas darvas( ss, nTriggerWindow );
-    //size_t ix = end - nTriggerWindow;
-    citerBars iterTriggerBegin = end - nTriggerWindow;
-    bool bTrigger;  // wait for trigger on final day
-    for ( citerBars iter = iterTriggerBegin; iter != end; ++iter ) {
-      bTrigger = darvas.Calc( *iter );  // final day only is needed
-    }
-
-    if ( bTrigger ) {
-      ii.dblStop = darvas.StopValue();
-      m_psetSymbols->insert( ii );
-      std::cout << ss.str() << std::endl;
-    }
-
+      << ", volume=" << iterLast->Volume()
+      << darvas.Triggers()
+      << " stop(" << ii.dblStop << ")"
+      << std::endl;
+    results.sReport += ss.str();
   }
 }
 
-void SymbolSelection::CheckFor10Percent( const InstrumentInfo& ii, citerBars begin, citerBars end ) {
+void SymbolSelection::CheckFor10Percent( Results& results, const InstrumentInfo& ii, citerBars begin, citerBars end ) {
   double dblAveragePrice = std::for_each( begin, end, AveragePrice() );
   citerBars iterLast( end - 1 );
   if ( 25.0 < dblAveragePrice ) {
-    mapRankingPos_t::iterator iterPos;
-    mapRankingNeg_t::iterator iterNeg;
     //double dblReturn = ( m_bars.Last()->m_dblClose - m_bars.Last()->m_dblOpen ) / m_bars.Last()->m_dblClose;
     double dblReturn = ( iterLast->Close() - iterLast->Open() ) / iterLast->Close();
-    if ( m_nMaxInList > m_mapMaxPositives.size() ) {
-      m_mapMaxPositives.insert( pairRanking_t( dblReturn, ii ) );  // need to insert the path instead
-    }
-    else {
-      iterPos = m_mapMaxPositives.begin();
-      if ( dblReturn > iterPos->first ) {
-        m_mapMaxPositives.erase( iterPos );
-        m_mapMaxPositives.insert( pairRanking_t( dblReturn, ii ) ); // need to insert the path instead
-      }
-    }
-    if ( m_nMaxInList > m_mapMaxNegatives.size() ) {
-      m_mapMaxNegatives.insert( pairRanking_t( dblReturn, ii ) );// need to insert the path instead
-    }
-    else {
-      iterNeg = m_mapMaxNegatives.begin();
-      if ( dblReturn < iterNeg->first ) {
-        m_mapMaxNegatives.erase( iterNeg );
-        m_mapMaxNegatives.insert( pairRanking_t( dblReturn, ii ) );// need to insert the path instead
-      }
-    }
+    results.rankingMaxPositives.Push( dblReturn, ii );
+    results.rankingMaxNegatives.Push( dblReturn, ii );
   }
 }
 
-void SymbolSelection::WrapUp10Percent( setInstrumentInfo_t& selected ) {
+void SymbolSelection::WrapUp10Percent( Results& results, setInstrumentInfo_t& selected ) {
   std::cout << "Positives: " << std::endl;
-  mapRankingPos_t::iterator iterPos;
-  for ( iterPos = m_mapMaxPositives.begin(); iterPos != m_mapMaxPositives.end(); ++iterPos ) {
-//    size_t pos = (iterPos->second).find_last_of( "/" );
-//    std::string sSymbolName = (iterPos->second).substr( pos + 1 );
-//    std::cout << " " << sSymbolName << "=" << iterPos->first << std::endl;
+  rankingPos_t::vector_t vPositives( results.rankingMaxPositives.Sorted() );
+  for ( rankingPos_t::vector_t::const_iterator iterPos = vPositives.begin(); iterPos != vPositives.end(); ++iterPos ) {
     std::cout << iterPos->second.sName << ": " << iterPos->first << std::endl;
-//    if ( NULL != OnAddSymbol ) OnAddSymbol( sSymbolName, iterPos->second, "10%+" );
     selected.insert( iterPos->second );
   }
-  m_mapMaxPositives.clear();
+  results.rankingMaxPositives.Clear();
 
   std::cout << "Negatives: " << std::endl;
-  mapRankingNeg_t::iterator iterNeg;
-  for ( iterNeg = m_mapMaxNegatives.begin(); iterNeg != m_mapMaxNegatives.end(); ++iterNeg ) {
-//    size_t pos = (iterNeg->second).find_last_of( "/" );
-//    std::string sSymbolName = (iterNeg->second).substr( pos + 1 );
-//    std::cout << " " << sSymbolName << "=" << iterNeg->first << std::endl;
+  rankingNeg_t::vector_t vNegatives( results.rankingMaxNegatives.Sorted() );
+  for ( rankingNeg_t::vector_t::const_iterator iterNeg = vNegatives.begin(); iterNeg != vNegatives.end(); ++iterNeg ) {
     std::cout << " " << iterNeg->second.sName << ": " << iterNeg->first << std::endl;
-//    if ( NULL != OnAddSymbol ) OnAddSymbol( sSymbolName, iterNeg->second, "10%-" );
     selected.insert( iterNeg->second );
   }
-  m_mapMaxNegatives.clear();
+  results.rankingMaxNegatives.Clear();
 }
 
 class AverageVolatility {  
@@ -443,35 +646,21 @@ public:
   };
 };
 
-void SymbolSelection::CheckForVolatility( const InstrumentInfo& ii, citerBars begin, citerBars end ) {
+void SymbolSelection::CheckForVolatility( Results& results, const InstrumentInfo& ii, citerBars begin, citerBars end ) {
   double dblAveragePrice = std::for_each( begin, end, AveragePrice() );
   citerBars iterLast( end - 1 );
   if ( 25.0 < dblAveragePrice ) {
     double dblAverageVolatility = std::for_each( begin, end, AverageVolatility() );
-    mapRankingPos_t::iterator iterPos;
-    if ( m_nMaxInList > m_mapMaxVolatility.size() ) {
-      m_mapMaxVolatility.insert( pairRanking_t( dblAverageVolatility, ii ) );
-    }
-    else {
-      iterPos = m_mapMaxVolatility.begin();
-      if ( dblAverageVolatility > iterPos->first ) {
-        m_mapMaxVolatility.erase( iterPos );
-        m_mapMaxVolatility.insert( pairRanking_t( dblAverageVolatility, ii ) );
-      }
-    }
+    results.rankingMaxVolatility.Push( dblAverageVolatility, ii );
   }
 }
 
-void SymbolSelection::WrapUpVolatility( setInstrumentInfo_t& selected ) {
+void SymbolSelection::WrapUpVolatility( Results& results, setInstrumentInfo_t& selected ) {
   std::cout << "Volatiles: " << std::endl;
-  mapRankingPos_t::iterator iterPos;
-  for ( iterPos = m_mapMaxVolatility.begin(); iterPos != m_mapMaxVolatility.end(); ++iterPos ) {
-//    size_t pos = (iterPos->second).find_last_of( "/" );
-//    std::string sSymbolName = (iterPos->second).substr( pos + 1 );;
-//    cout << " " << sSymbolName << "=" << iterPos->first << endl;
+  rankingPos_t::vector_t vRanked( results.rankingMaxVolatility.Sorted() );
+  for ( rankingPos_t::vector_t::const_iterator iterPos = vRanked.begin(); iterPos != vRanked.end(); ++iterPos ) {
     std::cout << " " << iterPos->second.sName << ": " << iterPos->first << std::endl;
-//    if ( NULL != OnAddSymbol ) OnAddSymbol( sSymbolName, iterPos->second, "Volatile" );
     selected.insert( iterPos->second );
   }
-  m_mapMaxVolatility.clear();
-}
\ No newline at end of file
+  results.rankingMaxVolatility.Clear();
+}
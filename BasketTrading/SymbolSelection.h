@@ -12,10 +12,19 @@
  * See the file LICENSE.txt for redistribution information.             *
  ************************************************************************/
 
+
 #pragma once
 
 #include <map>
+#include <atomic>
 #include <set>
+#include <deque>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/serialization/access.hpp>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 using namespace boost::posix_time;
@@ -24,6 +33,42 @@ using namespace boost::gregorian;
 #include <TFTimeSeries/TimeSeries.h>
 #include <TFHDF5TimeSeries/HDF5DataManager.h>
 
+#include <TFIndicators/Darvas.h>
+
+#include "BoundedRanking.h"
+
+// darvas state of a symbol, kept between scans, fed each daily bar once
+class ProcessDarvas: public ou::tf::Darvas<ProcessDarvas> {
+  friend ou::tf::Darvas<ProcessDarvas>;
+public:
+  ProcessDarvas( void );
+  ~ProcessDarvas( void ) {};
+  bool Calc( const ou::tf::Bar& );  // true when the bar triggers
+  bool Triggered( void ) const { return m_bTriggered; };  // for the last bar seen
+  const std::string& Triggers( void ) const { return m_sTriggers; };  // CT, AT, BO of the last bar seen
+  double StopValue( void ) const { return m_dblStop; };
+  ptime LastBar( void ) const { return m_dtLastBar; };  // not_a_date_time until the first bar
+protected:
+  // CRTP from CDarvas<CProcess>
+  void ConservativeTrigger( void );
+  void AggressiveTrigger( void );
+  void SetStop( double stop ) { m_dblStop = stop; };
+//  void StopTrigger( void ) {};
+  void BreakOutAlert( size_t );
+
+private:
+
+  bool m_bTriggered;  // set when last bar has trigger
+  std::string m_sTriggers;
+  double m_dblStop;
+  ptime m_dtLastBar;
+
+  friend class boost::serialization::access;
+  template<class Archive>
+  void serialize( Archive& ar, const unsigned int );
+
+};
+
 class SymbolSelection {
 public:
 
@@ -40,7 +85,14 @@ public:
   };
   typedef std::set<InstrumentInfo, InstrumentInfoCompare> setInstrumentInfo_t;
 
-  explicit SymbolSelection( ptime eod );
+  typedef std::deque<ou::tf::Bar> dequeBars_t;
+  typedef dequeBars_t::const_iterator citerBars;
+
+  // a filter passes or rejects a symbol on its window of daily bars, end - 1 being the most recent
+  typedef std::function<bool( citerBars begin, citerBars end )> filter_t;
+  static filter_t All( const std::vector<filter_t>& );  // passes when each passes, evaluated in order
+
+  explicit SymbolSelection( ptime eod, unsigned int nThreads = 0 );  // 0: one thread per core
   ~SymbolSelection( void );
 
   void Process( setInstrumentInfo_t& selected );
@@ -48,7 +100,35 @@ public:
 protected:
 private:
 
-  ou::tf::HDF5DataManager m_dm;
+  // trailing window of daily bars and indicator state for each symbol, persisted between runs
+  //   so each scan reads, and feeds the indicators, only the bars which have arrived since the prior scan
+  struct SymbolState {
+    dequeBars_t bars;
+    ProcessDarvas darvas;  // has seen the bars up to bars.back(), expired ones included
+    template<class Archive>
+    void serialize( Archive& ar, const unsigned int ) {
+      ar & bars & darvas;
+    }
+  };
+  typedef std::map<std::string,SymbolState> mapSymbolState_t;
+  mapSymbolState_t m_mapSymbolState;
+
+  static const std::string c_sStateFile;
+  static const unsigned int c_nStateVersion;
+
+  struct Symbol {
+    std::string sPath;
+    std::string sName;
+    SymbolState* pState;  // entry in m_mapSymbolState, bound before the workers start
+    Symbol( const std::string& sPath_, const std::string& sName_ )
+      : sPath( sPath_ ), sName( sName_ ), pState( nullptr ) {};
+  };
+  typedef std::vector<Symbol> vSymbol_t;
+  vSymbol_t m_vSymbol;
+  std::atomic<size_t> m_ixNextSymbol;  // workers claim the symbol at this index
+
+  unsigned int m_nThreads;
+  boost::mutex m_mutexHDF5;  // used when the hdf5 library is not built thread safe
 
   ou::tf::Bars::size_type m_nMinPivotBars;
 
@@ -61,42 +141,53 @@ private:
   ptime m_dt26WeeksAgo;
   ptime m_dtDateOfFirstBar;
 
-  setInstrumentInfo_t* m_psetSymbols;
+  filter_t m_filterUniverse;  // liquidity and price screen applied to every symbol
+  filter_t m_filterDarvas;  // additional history needed for the darvas check
 
-  typedef std::multimap<boost::uint32_t,InstrumentInfo> mapPivotRanking_t;
-  mapPivotRanking_t m_mapPivotRanking;
+  static const unsigned short m_nMaxInList = 10;  // maximum of 10 items in each list
+  static const unsigned short m_nMaxPivots = 35;  // select 35 symbols ( => < 3% weighting by symbol )
+
+  typedef BoundedRanking<boost::uint32_t,InstrumentInfo> rankingPivot_t;
+  typedef BoundedRanking<double,InstrumentInfo> rankingPos_t;
+  typedef BoundedRanking<double,InstrumentInfo,std::greater<double> > rankingNeg_t;  // most negative are best
+
+  // each worker accumulates into its own, merged once the scan is complete
+  struct Results {
+    setInstrumentInfo_t setSelected;
+    rankingPivot_t rankingPivot;
+    rankingPos_t rankingMaxPositives;
+    rankingNeg_t rankingMaxNegatives;
+    rankingPos_t rankingMaxVolatility;
+    std::string sReport;  // output lines, written out in one piece so workers don't interleave
+    size_t cntScanned;
+    size_t cntPassed;
+    Results( void )
+      : rankingPivot( m_nMaxPivots ),
+        rankingMaxPositives( m_nMaxInList ), rankingMaxNegatives( m_nMaxInList ),
+        rankingMaxVolatility( m_nMaxInList ),
+        cntScanned( 0 ), cntPassed( 0 ) {};
+    void Merge( const Results& );
+  };
 
-  typedef std::multimap<int,InstrumentInfo> mapRangeRanking_t;
-  mapRangeRanking_t m_mapRangeRanking;
+  void LoadState( void );
+  void SaveState( void ) const;
 
-  struct MaxNegativesCompare {
-    bool operator() ( double dbl1, double dbl2 ) {
-      return dbl2 < dbl1; // reverse form of operator so most negative at end of list
-    }
-  };
+  void HandleGroupItem( const std::string& sObjectPath, const std::string& sObjectName );
 
-  typedef std::multimap<double, InstrumentInfo> mapRankingPos_t;
-  typedef std::multimap<double, InstrumentInfo, MaxNegativesCompare> mapRankingNeg_t;
-  typedef std::pair<double,InstrumentInfo> pairRanking_t;
+  void ScanShard( Results& );
+  void ScanSymbol( Results&, ou::tf::HDF5DataManager&, const Symbol& );
+  void UpdateWindow( ou::tf::HDF5DataManager&, const std::string& sObjectPath, SymbolState& );
+  void UpdateDarvas( SymbolState& );
 
-  static const unsigned short m_nMaxInList = 10;  // maximum of 10 items in each list
-  mapRankingPos_t m_mapMaxPositives;
-  mapRankingNeg_t m_mapMaxNegatives;
-
-  mapRankingPos_t m_mapMaxVolatility;
-  
-  void ProcessGroupItem( const std::string& sObjectPath, const std::string& sObjectName );
-
-  typedef ou::tf::Bars::const_iterator citerBars;
-  void CheckForDarvas( InstrumentInfo& sSymbol, citerBars begin, citerBars end );
-  void CheckFor10Percent( const InstrumentInfo& sSymbol, citerBars begin, citerBars end );
-  void CheckForVolatility( const InstrumentInfo& sSymbol, citerBars begin, citerBars end );
-  void CheckForPivots( const InstrumentInfo& sSymbol, citerBars begin, citerBars end );
-  void CheckForRange( const InstrumentInfo& sSymbol, citerBars begin, citerBars end );
-
-  void WrapUp10Percent( setInstrumentInfo_t& selected );
-  void WrapUpVolatility( setInstrumentInfo_t& selected );
-  void WrapUpPivots( setInstrumentInfo_t& selected );
+  void CheckForDarvas( Results&, InstrumentInfo& sSymbol, const ProcessDarvas&, citerBars begin, citerBars end );
+  void CheckFor10Percent( Results&, const InstrumentInfo& sSymbol, citerBars begin, citerBars end );
+  void CheckForVolatility( Results&, const InstrumentInfo& sSymbol, citerBars begin, citerBars end );
+  void CheckForPivots( Results&, const InstrumentInfo& sSymbol, citerBars begin, citerBars end );
+  void CheckForRange( Results&, const InstrumentInfo& sSymbol, citerBars begin, citerBars end );
+
+  void WrapUp10Percent( Results&, setInstrumentInfo_t& selected );
+  void WrapUpVolatility( Results&, setInstrumentInfo_t& selected );
+  void WrapUpPivots( Results&, setInstrumentInfo_t& selected );
 
 };
 
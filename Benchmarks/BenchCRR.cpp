@@ -0,0 +1,202 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+// options per second, one expiry slice of american options priced on the cox ross rubinstein tree
+// reference:  the tree as it was, pow() for each node price, a switch on exercise style at each node
+// scalar:  binomial::CRR one option at a time, node prices from a table
+// slice:  binomial::CRR over the slice, strikes stepped through the tree together
+// lanes:  binomial::CRR over the slice, each option at its own volatility, as the implied volatility solver uses it
+// the slice alternates calls and puts over strikes either side of the money
+// option, delta, gamma and theta of each are compared with the reference, for american and european
+
+#include "stdafx.h"
+
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include <TFOptions/Binomial.h>
+
+#include "Benchmarks.h"
+
+using namespace ou::tf::option;
+
+namespace {
+
+  typedef std::chrono::steady_clock steady_t;
+
+  void Reference( const binomial::structInput& input, binomial::structOutput& output ) {
+
+    std::vector<double> v( input.n + 1 );
+    const double z( ( ou::tf::OptionSide::Call == input.optionSide ) ? 1.0 : -1.0 );
+    const double dt( input.T / input.n );
+    const double u( std::exp( input.v * std::sqrt( dt ) ) );
+    const double d( 1.0 / u );
+    const double p( ( std::exp( input.b * dt ) - d ) / ( u - d ) );
+    const double df( std::exp( -input.r * dt ) );
+
+    for ( int ix = 0; ix <= input.n; ++ix ) {
+      v[ ix ] = std::max<double>( 0.0, z * ( input.S * std::pow( u, ix ) * std::pow( d, input.n - ix ) - input.X ) );
+    }
+    for ( int j = input.n - 1; j >= 0; --j ) {
+      for ( int i = 0; i <= j; ++i ) {
+        const double europrice = df * ( p * v[ i + 1 ] + ( 1.0 - p ) * v[ i ] );
+        switch ( input.optionStyle ) {
+        case ou::tf::OptionStyle::American:
+          v[ i ] = std::max<double>( z * ( input.S * std::pow( u, i ) * std::pow( d, j - i ) - input.X ), europrice );
+          break;
+        default:
+          v[ i ] = europrice;
+          break;
+        }
+        if ( 2 == j ) {
+          output.gamma = ( ( v[ 2 ] - v[ 1 ] ) / ( input.S * u * u - input.S )
+            - ( v[ 1 ] - v[ 0 ] ) / ( input.S - input.S * d * d ) )
+            / ( 0.5 * ( input.S * u * u - input.S * d * d ) );
+          output.theta = v[ 1 ];
+        }
+        if ( 1 == j ) {
+          output.delta = ( v[ 1 ] - v[ 0 ] ) / ( input.S * ( u - d ) );
+        }
+      }
+    }
+    output.theta = ( output.theta - v[ 0 ] ) / ( 2.0 * dt ) / 365.0;
+    output.option = v[ 0 ];
+  }
+
+  struct Slice {
+    binomial::structInput input;
+    std::vector<double> vStrike;
+    std::vector<ou::tf::OptionSide::enumOptionSide> vSide;
+    std::vector<double> vVolatility;
+    std::vector<binomial::structOutput> vOutput;
+    Slice( size_t nStrikes, long nSteps ):
+      vStrike( nStrikes ), vSide( nStrikes ), vVolatility( nStrikes ), vOutput( nStrikes )
+    {
+      input.S = 280.0;
+      input.T = 30.0 / 365.0;
+      input.r = input.b = 0.02;
+      input.v = 0.18;
+      input.n = nSteps;
+      for ( size_t ix = 0; ix < nStrikes; ++ix ) {
+        vStrike[ ix ] = input.S - 0.5 * nStrikes + ix;
+        vSide[ ix ] = ( 0 == ( ix % 2 ) ) ? ou::tf::OptionSide::Call : ou::tf::OptionSide::Put;
+        vVolatility[ ix ] = input.v;  // the lanes get the slice's volatility, so their output compares too
+      }
+    }
+  };
+
+  void PriceReference( Slice& slice ) {
+    binomial::structInput input( slice.input );
+    for ( size_t ix = 0; ix < slice.vStrike.size(); ++ix ) {
+      input.X = slice.vStrike[ ix ];
+      input.optionSide = slice.vSide[ ix ];
+      Reference( input, slice.vOutput[ ix ] );
+    }
+  }
+
+  void PriceScalar( Slice& slice ) {
+    binomial::structInput input( slice.input );
+    for ( size_t ix = 0; ix < slice.vStrike.size(); ++ix ) {
+      input.X = slice.vStrike[ ix ];
+      input.optionSide = slice.vSide[ ix ];
+      binomial::CRR( input, slice.vOutput[ ix ] );
+    }
+  }
+
+  void PriceSlice( Slice& slice ) {
+    binomial::CRR( slice.input, slice.vStrike.size(), &slice.vStrike[ 0 ], &slice.vSide[ 0 ], &slice.vOutput[ 0 ] );
+  }
+
+  void PriceLanes( Slice& slice ) {
+    binomial::CRR( slice.input, slice.vStrike.size(),
+      &slice.vStrike[ 0 ], &slice.vSide[ 0 ], &slice.vVolatility[ 0 ], &slice.vOutput[ 0 ] );
+  }
+
+  typedef void (*fPrice_t)( Slice& );
+
+  double Difference( const binomial::structOutput& lhs, const binomial::structOutput& rhs ) {
+    double diff( std::fabs( lhs.option - rhs.option ) );
+    diff = std::max( diff, std::fabs( lhs.delta - rhs.delta ) );
+    diff = std::max( diff, std::fabs( lhs.gamma - rhs.gamma ) );
+    diff = std::max( diff, std::fabs( lhs.theta - rhs.theta ) );
+    return diff;
+  }
+
+  // largest difference from the reference, over both exercise styles
+  double Compare( size_t nStrikes, long nSteps, fPrice_t fPrice ) {
+    double diff( 0.0 );
+    const ou::tf::OptionStyle::enumOptionStyle rStyle[] = { ou::tf::OptionStyle::American, ou::tf::OptionStyle::European };
+    for ( size_t ixStyle = 0; ixStyle < 2; ++ixStyle ) {
+      Slice reference( nStrikes, nSteps );
+      reference.input.optionStyle = rStyle[ ixStyle ];
+      PriceReference( reference );
+      Slice slice( nStrikes, nSteps );
+      slice.input.optionStyle = rStyle[ ixStyle ];
+      fPrice( slice );
+      for ( size_t ix = 0; ix < nStrikes; ++ix ) {
+        diff = std::max( diff, Difference( reference.vOutput[ ix ], slice.vOutput[ ix ] ) );
+      }
+    }
+    return diff;
+  }
+
+  double OptionsPerSecond( size_t nStrikes, long nSteps, int nReps, fPrice_t fPrice ) {
+    Slice slice( nStrikes, nSteps );
+    fPrice( slice );  // scratch buffers and tables are sized on the first call
+    const steady_t::time_point start( steady_t::now() );
+    for ( int ix = 0; ix < nReps; ++ix ) {
+      fPrice( slice );
+    }
+    const double dblSeconds( std::chrono::duration<double>( steady_t::now() - start ).count() );
+    return ( nReps * nStrikes ) / dblSeconds;
+  }
+}
+
+int BenchCRR( int argc, char* argv[] ) {
+
+  const long nStrikes( 0 < argc ? std::atol( argv[ 0 ] ) : 64 );
+  const long nSteps( 1 < argc ? std::atol( argv[ 1 ] ) : 91 );
+  const int nReps( 2 < argc ? std::atoi( argv[ 2 ] ) : 400 );
+  if ( ( 0 >= nStrikes ) || ( 3 > nSteps ) || ( 0 >= nReps ) ) {
+    std::cout << "strikes and repetitions need to be positive, steps at least 3" << std::endl;
+    return 1;
+  }
+
+  std::cout << nStrikes << " strikes, " << nSteps << " steps, " << nReps << " repetitions" << std::endl;
+
+  struct Case {
+    const char* szName;
+    fPrice_t fPrice;
+  };
+  const Case rCase[] = {
+    { "reference  ", &PriceReference },
+    { "scalar     ", &PriceScalar },
+    { "slice      ", &PriceSlice },
+    { "lanes      ", &PriceLanes }
+  };
+
+  for ( size_t ix = 0; ix < sizeof( rCase ) / sizeof( Case ); ++ix ) {
+    const double dblRate( OptionsPerSecond( nStrikes, nSteps, nReps, rCase[ ix ].fPrice ) );
+    std::cout
+      << rCase[ ix ].szName << (long) dblRate << " options/s"
+      << ", max abs difference " << Compare( nStrikes, nSteps, rCase[ ix ].fPrice )
+      << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+// 1000 chained EMAs over a day of quotes
+// the quotes are synthetic:  6.5 hours, exponentially distributed gaps, a random walk midpoint
+// chained:  one TSEMA per level, each a Prices series fed through the previous level's OnAppend,
+//   the way TSMA used to build MA[tau,n]
+// fused:  one EMAChain, all levels stepped in one pass per quote
+// the last level of both is compared, they are expected to agree exactly
+
+#include "stdafx.h"
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+
+#include <TFTimeSeries/TimeSeries.h>
+#include <TFIndicators/TSEMA.h>
+#include <TFIndicators/EMAChain.h>
+
+#include "Benchmarks.h"
+
+using namespace ou::tf;
+
+namespace {
+
+  typedef std::chrono::steady_clock steady_t;
+
+  double Milliseconds( const steady_t::time_point& start ) {
+    return std::chrono::duration<double,std::milli>( steady_t::now() - start ).count();
+  }
+
+  void BuildQuotes( size_t nQuotes, std::vector<Quote>& vQuote ) {
+    std::mt19937 rng( 42 );
+    const double dblMeanGap( ( 6.5 * 3600.0 * 1e6 ) / nQuotes );  // microseconds
+    std::exponential_distribution<double> gap( 1.0 / dblMeanGap );
+    std::normal_distribution<double> step( 0.0, 0.01 );
+    ptime dt( boost::gregorian::date( 2018, 5, 1 ), time_duration( 9, 30, 0 ) );
+    double dblMid( 100.0 );
+    vQuote.reserve( nQuotes );
+    for ( size_t ix = 0; ix < nQuotes; ++ix ) {
+      dt += boost::posix_time::microseconds( (long) gap( rng ) );
+      dblMid += step( rng );
+      vQuote.push_back( Quote( dt, dblMid - 0.01, 100, dblMid + 0.01, 100 ) );
+    }
+  }
+}
+
+int BenchEMA( int argc, char* argv[] ) {
+
+  const size_t nQuotes( 0 < argc ? std::atol( argv[ 0 ] ) : 23400 * 20 );  // twenty a second
+  const unsigned int nLevels( 1 < argc ? std::atol( argv[ 1 ] ) : 1000 );
+  if ( ( 0 == nQuotes ) || ( 0 == nLevels ) ) {
+    std::cout << "quotes and levels need to be non-zero" << std::endl;
+    return 1;
+  }
+  const time_duration tdRange( boost::posix_time::seconds( 60 ) );
+
+  std::vector<Quote> vQuote;
+  BuildQuotes( nQuotes, vQuote );
+
+  std::cout << nQuotes << " quotes, " << nLevels << " levels" << std::endl;
+
+  double dblChained( 0.0 );
+  double dblChainedLast( 0.0 );
+  {
+    Quotes quotes;
+    quotes.DisableAppend();
+    std::vector<hf::TSEMA<Price>*> vEMA;
+    hf::TSEMA<Quote> ema1( quotes, tdRange );
+    ema1.DisableAppend();
+    Prices* pPrices( &ema1 );
+    for ( unsigned int ix = 1; ix < nLevels; ++ix ) {
+      hf::TSEMA<Price>* pEMA( new hf::TSEMA<Price>( *pPrices, tdRange ) );
+      pEMA->DisableAppend();
+      vEMA.push_back( pEMA );
+      pPrices = pEMA;
+    }
+    const steady_t::time_point start( steady_t::now() );
+    for ( std::vector<Quote>::const_iterator iter = vQuote.begin(); vQuote.end() != iter; ++iter ) {
+      quotes.Append( *iter );
+    }
+    dblChained = Milliseconds( start );
+    dblChainedLast = vEMA.empty() ? ema1.GetEMA() : vEMA.back()->GetEMA();
+    for ( std::vector<hf::TSEMA<Price>*>::reverse_iterator iter = vEMA.rbegin(); vEMA.rend() != iter; ++iter ) {
+      delete *iter;
+    }
+  }
+
+  double dblFused( 0.0 );
+  double dblFusedLast( 0.0 );
+  {
+    hf::EMAChain chain( tdRange, nLevels );
+    const steady_t::time_point start( steady_t::now() );
+    for ( std::vector<Quote>::const_iterator iter = vQuote.begin(); vQuote.end() != iter; ++iter ) {
+      chain.Update( iter->DateTime(), iter->Midpoint() );
+    }
+    dblFused = Milliseconds( start );
+    dblFusedLast = chain.Iterated();
+  }
+
+  const double dblSteps( (double) nQuotes * nLevels );
+  std::cout << "chained TSEMA:  " << dblChained << " ms, " << ( dblChained * 1e6 / dblSteps ) << " ns per level update" << std::endl;
+  std::cout << "fused EMAChain: " << dblFused << " ms, " << ( dblFused * 1e6 / dblSteps ) << " ns per level update" << std::endl;
+  std::cout << "last level " << dblChainedLast << " vs " << dblFusedLast
+    << ( dblChainedLast == dblFusedLast ? ", identical" : ", DIFFERENT" ) << std::endl;
+
+  return dblChainedLast == dblFusedLast ? 0 : 2;
+}
@@ -0,0 +1,174 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+// one expiry of american options, Crank Nicolson finite differences against the binomial tree
+// the chain:  a call and a put at each strike 70 to 130 by 2, S 100, T 0.25, v 0.3, r = b = 0.03
+// accuracy:  largest difference in option, delta, gamma and theta from CRR with many steps
+// time:  microseconds to price the chain, the whole expiry in one call for both
+// the european chain is also priced on the default grid, and compared with black scholes
+
+#include "stdafx.h"
+
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include <TFOptions/Formula.h>
+#include <TFOptions/FiniteDifference.h>
+
+#include "Benchmarks.h"
+
+using namespace ou::tf::option;
+
+namespace {
+
+  typedef std::chrono::steady_clock steady_t;
+
+  struct Chain {
+    binomial::structInput input;
+    std::vector<double> vStrike;
+    std::vector<ou::tf::OptionSide::enumOptionSide> vSide;
+    Chain( void ) {
+      input.S = 100.0;
+      input.T = 0.25;
+      input.r = input.b = 0.03;
+      input.v = 0.3;
+      for ( int strike = 70; strike <= 130; strike += 2 ) {
+        vStrike.push_back( strike );
+        vSide.push_back( ou::tf::OptionSide::Call );
+        vStrike.push_back( strike );
+        vSide.push_back( ou::tf::OptionSide::Put );
+      }
+    }
+    size_t Size( void ) const { return vStrike.size(); }
+  };
+
+  struct Error {
+    double dblOption, dblDelta, dblGamma, dblTheta;
+    Error( void ): dblOption( 0.0 ), dblDelta( 0.0 ), dblGamma( 0.0 ), dblTheta( 0.0 ) {};
+  };
+
+  Error Compare( const std::vector<binomial::structOutput>& vReference, const std::vector<binomial::structOutput>& vOutput ) {
+    Error error;
+    for ( size_t ix = 0; ix < vReference.size(); ++ix ) {
+      error.dblOption = std::max( error.dblOption, std::fabs( vOutput[ ix ].option - vReference[ ix ].option ) );
+      error.dblDelta = std::max( error.dblDelta, std::fabs( vOutput[ ix ].delta - vReference[ ix ].delta ) );
+      error.dblGamma = std::max( error.dblGamma, std::fabs( vOutput[ ix ].gamma - vReference[ ix ].gamma ) );
+      error.dblTheta = std::max( error.dblTheta, std::fabs( vOutput[ ix ].theta - vReference[ ix ].theta ) );
+    }
+    return error;
+  }
+
+  void Report( const char* szName, double dblMicroseconds, const Error& error ) {
+    std::cout
+      << szName << dblMicroseconds << " us"
+      << ", price " << error.dblOption << ", delta " << error.dblDelta
+      << ", gamma " << error.dblGamma << ", theta " << error.dblTheta
+      << std::endl;
+  }
+
+  double Microseconds( const steady_t::time_point& start, int nReps ) {
+    return std::chrono::duration<double,std::micro>( steady_t::now() - start ).count() / nReps;
+  }
+
+  void RunFD( const Chain& chain, const std::vector<binomial::structOutput>& vReference, int nReps,
+    const char* szName, long nTime, long nPerStdev ) {
+    fd::structGrid grid;
+    grid.nTime = nTime;
+    grid.nPerStdev = nPerStdev;
+    std::vector<binomial::structOutput> vOutput( chain.Size() );
+    const steady_t::time_point start( steady_t::now() );
+    for ( int ix = 0; ix < nReps; ++ix ) {
+      fd::CrankNicolson( chain.input, chain.Size(), &chain.vStrike[ 0 ], &chain.vSide[ 0 ], &vOutput[ 0 ], grid );
+    }
+    Report( szName, Microseconds( start, nReps ), Compare( vReference, vOutput ) );
+  }
+
+  void RunCRR( const Chain& chain, const std::vector<binomial::structOutput>& vReference, int nReps,
+    const char* szName, long nSteps ) {
+    binomial::structInput input( chain.input );
+    input.n = nSteps;
+    std::vector<binomial::structOutput> vOutput( chain.Size() );
+    const steady_t::time_point start( steady_t::now() );
+    for ( int ix = 0; ix < nReps; ++ix ) {
+      binomial::CRR( input, chain.Size(), &chain.vStrike[ 0 ], &chain.vSide[ 0 ], &vOutput[ 0 ] );
+    }
+    Report( szName, Microseconds( start, nReps ), Compare( vReference, vOutput ) );
+  }
+
+  // largest difference of the european chain, on the default grid, from the closed form
+  double EuropeanError( const Chain& chain ) {
+    binomial::structInput input( chain.input );
+    input.optionStyle = ou::tf::OptionStyle::European;
+    const size_t nOptions( chain.Size() );
+    std::vector<binomial::structOutput> vOutput( nOptions );
+    fd::CrankNicolson( input, nOptions, &chain.vStrike[ 0 ], &chain.vSide[ 0 ], &vOutput[ 0 ] );
+
+    std::vector<double> vS( nOptions, input.S ), vT( nOptions, input.T ), vR( nOptions, input.r ), vQ( nOptions, input.r - input.b );
+    std::vector<double> vV( nOptions, input.v ), vZ( nOptions ), vPrice( nOptions );
+    for ( size_t ix = 0; ix < nOptions; ++ix ) {
+      vZ[ ix ] = ( ou::tf::OptionSide::Call == chain.vSide[ ix ] ) ? 1.0 : -1.0;
+    }
+    bsm::structBatchInput batch;
+    batch.S = &vS[ 0 ];
+    batch.K = &chain.vStrike[ 0 ];
+    batch.T = &vT[ 0 ];
+    batch.r = &vR[ 0 ];
+    batch.q = &vQ[ 0 ];
+    batch.v = &vV[ 0 ];
+    batch.z = &vZ[ 0 ];
+    bsm::Price( nOptions, batch, &vPrice[ 0 ] );
+
+    double error( 0.0 );
+    for ( size_t ix = 0; ix < nOptions; ++ix ) {
+      error = std::max( error, std::fabs( vOutput[ ix ].option - vPrice[ ix ] ) );
+    }
+    return error;
+  }
+}
+
+int BenchFD( int argc, char* argv[] ) {
+
+  const int nReps( 0 < argc ? std::atoi( argv[ 0 ] ) : 100 );
+  const long nStepsReference( 1 < argc ? std::atol( argv[ 1 ] ) : 3000 );
+  if ( ( 0 >= nReps ) || ( 3 > nStepsReference ) ) {
+    std::cout << "repetitions needs to be positive, reference steps at least 3" << std::endl;
+    return 1;
+  }
+
+  Chain chain;
+  std::cout
+    << chain.Size() << " options, " << nReps << " repetitions"
+    << ", largest difference from CRR n=" << nStepsReference << std::endl;
+
+  std::vector<binomial::structOutput> vReference( chain.Size() );
+  {
+    binomial::structInput input( chain.input );
+    input.n = nStepsReference;
+    binomial::CRR( input, chain.Size(), &chain.vStrike[ 0 ], &chain.vSide[ 0 ], &vReference[ 0 ] );
+  }
+
+  RunFD( chain, vReference, nReps, "FD 50x16 (default)  ", 50, 16 );
+  RunFD( chain, vReference, nReps, "FD 25x10            ", 25, 10 );
+  RunFD( chain, vReference, nReps, "FD 100x24           ", 100, 24 );
+  RunCRR( chain, vReference, nReps, "CRR n=91            ", 91 );
+  RunCRR( chain, vReference, nReps, "CRR n=500           ", 500 );
+
+  std::cout << "european FD 50x16 against black scholes, price " << EuropeanError( chain ) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+// OrderManager throughput, microseconds per operation, without a session, through a provider which does nothing
+// construct+place:  a limit order constructed and placed, for each of the orders
+// fill:  two partial executions reported on a random third of the orders, in random order
+// cancel+report:  the remaining orders cancelled, and the cancellation reported, in random order
+// each run uses a fresh OrderManager, the best of the runs is reported
+// only the public interface is used, so the driver also times the trees before the slab table
+
+#include "stdafx.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include <TFTrading/OrderManager.h>
+
+#include "Benchmarks.h"
+
+using namespace ou::tf;
+
+namespace {
+
+  typedef std::chrono::steady_clock steady_t;
+
+  class NullProvider: public ProviderInterfaceBase {
+  public:
+    void AddQuoteHandler( pInstrument_cref, quotehandler_t ) {}
+    void RemoveQuoteHandler( pInstrument_cref, quotehandler_t ) {}
+    void AddOnOpenHandler( pInstrument_cref, tradehandler_t ) {}
+    void RemoveOnOpenHandler( pInstrument_cref, tradehandler_t ) {}
+    void AddTradeHandler( pInstrument_cref, tradehandler_t ) {}
+    void RemoveTradeHandler( pInstrument_cref, tradehandler_t ) {}
+    void AddDepthHandler( pInstrument_cref, depthhandler_t ) {}
+    void RemoveDepthHandler( pInstrument_cref, depthhandler_t ) {}
+    void AddGreekHandler( pInstrument_cref, greekhandler_t ) {}
+    void RemoveGreekHandler( pInstrument_cref, greekhandler_t ) {}
+    void PlaceOrder( pOrder_t ) {}
+    void CancelOrder( pOrder_t ) {}
+  };
+
+  struct Timing {
+    double dblPlace;
+    double dblFill;
+    double dblCancel;
+    Timing( void ): dblPlace( 0.0 ), dblFill( 0.0 ), dblCancel( 0.0 ) {};
+  };
+
+  double Microseconds( const steady_t::time_point& start, const steady_t::time_point& end, long nOperations ) {
+    return std::chrono::duration<double,std::micro>( end - start ).count() / nOperations;
+  }
+
+  Timing Run( long nOrders ) {
+
+    NullProvider provider;
+    Instrument::pInstrument_t pInstrument( new Instrument( "SPY", InstrumentType::Stock, "SMART" ) );
+
+    OrderManager om;
+
+    std::vector<OrderManager::idOrder_t> vId;
+    vId.reserve( nOrders );
+
+    const steady_t::time_point start( steady_t::now() );
+    for ( long ix = 0; ix < nOrders; ++ix ) {
+      OrderManager::pOrder_t pOrder
+        = om.ConstructOrder( pInstrument, OrderType::Limit, OrderSide::Buy,
+            (boost::uint32_t) 200, 100.0 + ( ix % 50 ) * 0.01, (OrderManager::idPosition_t) 1 );
+      vId.push_back( pOrder->GetOrderId() );
+      om.PlaceOrder( &provider, pOrder );
+    }
+    const steady_t::time_point placed( steady_t::now() );
+
+    std::mt19937 rng( 1 );
+    std::shuffle( vId.begin(), vId.end(), rng );
+
+    const long nFilled( nOrders / 3 );
+    for ( long ix = 0; ix < nFilled; ++ix ) {
+      Execution exec( 100.01, 100, OrderSide::Buy, "NSDQ", "bench" );
+      om.ReportExecution( vId[ ix ], exec );
+      om.ReportExecution( vId[ ix ], exec );
+    }
+    const steady_t::time_point filled( steady_t::now() );
+
+    for ( long ix = nFilled; ix < nOrders; ++ix ) {
+      om.CancelOrder( vId[ ix ] );
+      om.ReportCancellation( vId[ ix ] );
+    }
+    const steady_t::time_point cancelled( steady_t::now() );
+
+    Timing timing;
+    timing.dblPlace = Microseconds( start, placed, nOrders );
+    timing.dblFill = Microseconds( placed, filled, 2 * nFilled );
+    timing.dblCancel = Microseconds( filled, cancelled, nOrders - nFilled );
+    return timing;
+  }
+}
+
+int BenchOrders( int argc, char* argv[] ) {
+
+  const long nOrders( 0 < argc ? std::atol( argv[ 0 ] ) : 100000 );
+  const int nRuns( 1 < argc ? std::atoi( argv[ 1 ] ) : 5 );
+  if ( ( 3 > nOrders ) || ( 0 >= nRuns ) ) {
+    std::cout << "orders needs to be at least 3, runs needs to be positive" << std::endl;
+    return 1;
+  }
+
+  std::cout << nOrders << " orders, best of " << nRuns << " runs, microseconds per operation" << std::endl;
+
+  Timing best;
+  for ( int ix = 0; ix < nRuns; ++ix ) {
+    const Timing timing( Run( nOrders ) );
+    if ( ( 0 == ix ) || ( timing.dblPlace < best.dblPlace ) ) best.dblPlace = timing.dblPlace;
+    if ( ( 0 == ix ) || ( timing.dblFill < best.dblFill ) ) best.dblFill = timing.dblFill;
+    if ( ( 0 == ix ) || ( timing.dblCancel < best.dblCancel ) ) best.dblCancel = timing.dblCancel;
+  }
+
+  std::cout << "construct+place  " << best.dblPlace << std::endl;
+  std::cout << "fill             " << best.dblFill << std::endl;
+  std::cout << "cancel+report    " << best.dblCancel << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+// regression and bollinger stats over the last 20 prices, two ways
+// deque:  TSSWStatsPrice with a count of 20, the window walks back along the source series
+// ring:  TSSWStatsPriceRing<20>, the window holds its own ring of the last 20 prices
+// the prices are synthetic:  exponentially distributed gaps, a random walk
+// parity:  both on one series, mean, sd, slope, offset, rr and bands compared after every price,
+//   then the ring is Reset and Backfilled from the series, and compared again
+// time:  each alone on a series of its own
+
+#include "stdafx.h"
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include <TFIndicators/TSSWStats.h>
+
+#include "Benchmarks.h"
+
+using namespace ou::tf;
+
+namespace {
+
+  typedef std::chrono::steady_clock steady_t;
+
+  const size_t nWindow( 20 );
+  typedef TSSWStatsPriceRing<nWindow> ring_t;
+
+  double Milliseconds( const steady_t::time_point& start ) {
+    return std::chrono::duration<double,std::milli>( steady_t::now() - start ).count();
+  }
+
+  void BuildPrices( size_t nPrices, std::vector<Price>& vPrice ) {
+    std::mt19937 rng( 42 );
+    std::exponential_distribution<double> gap( 1.0 / 1e6 );  // a second apart on average, in microseconds
+    std::normal_distribution<double> step( 0.0, 0.01 );
+    ptime dt( boost::gregorian::date( 2018, 5, 1 ), time_duration( 9, 30, 0 ) );
+    double dblPrice( 100.0 );
+    vPrice.reserve( nPrices );
+    for ( size_t ix = 0; ix < nPrices; ++ix ) {
+      dt += boost::posix_time::microseconds( (long) gap( rng ) );
+      dblPrice += step( rng );
+      vPrice.push_back( Price( dt, dblPrice ) );
+    }
+  }
+
+  // both nan, as rr is before the window has spread, counts as the same
+  double Difference( double lhs, double rhs ) {
+    if ( std::isnan( lhs ) && std::isnan( rhs ) ) return 0.0;
+    return std::fabs( lhs - rhs );
+  }
+
+  double Difference( const TSSWStatsPrice& deque, const ring_t& ring ) {
+    double diff( Difference( deque.MeanY(), ring.MeanY() ) );
+    diff = std::max( diff, Difference( deque.SD(), ring.SD() ) );
+    diff = std::max( diff, Difference( deque.Slope(), ring.Slope() ) );
+    diff = std::max( diff, Difference( deque.Offset(), ring.Offset() ) );
+    diff = std::max( diff, Difference( deque.RR(), ring.RR() ) );
+    diff = std::max( diff, Difference( deque.BBUpper(), ring.BBUpper() ) );
+    diff = std::max( diff, Difference( deque.BBLower(), ring.BBLower() ) );
+    return diff;
+  }
+}
+
+int BenchRing( int argc, char* argv[] ) {
+
+  const size_t nPrices( 0 < argc ? std::atol( argv[ 0 ] ) : 100000 );
+  if ( nWindow > nPrices ) {
+    std::cout << "prices needs to be at least " << nWindow << std::endl;
+    return 1;
+  }
+
+  std::vector<Price> vPrice;
+  BuildPrices( nPrices, vPrice );
+
+  std::cout << nPrices << " prices, window of " << nWindow << std::endl;
+
+  double dblDiff( 0.0 );
+  double dblDiffBackfill( 0.0 );
+  {
+    Prices prices;
+    TSSWStatsPrice deque( prices, time_duration( 0, 0, 0 ), nWindow );
+    ring_t ring( prices );
+    for ( std::vector<Price>::const_iterator iter = vPrice.begin(); vPrice.end() != iter; ++iter ) {
+      prices.Append( *iter );
+      dblDiff = std::max( dblDiff, Difference( deque, ring ) );
+    }
+    ring.Reset();
+    ring.Backfill();
+    dblDiffBackfill = Difference( deque, ring );
+  }
+
+  double dblDeque( 0.0 );
+  {
+    Prices prices;
+    TSSWStatsPrice deque( prices, time_duration( 0, 0, 0 ), nWindow );
+    const steady_t::time_point start( steady_t::now() );
+    for ( std::vector<Price>::const_iterator iter = vPrice.begin(); vPrice.end() != iter; ++iter ) {
+      prices.Append( *iter );
+    }
+    dblDeque = Milliseconds( start );
+  }
+
+  double dblRing( 0.0 );
+  {
+    Prices prices;
+    ring_t ring( prices );
+    const steady_t::time_point start( steady_t::now() );
+    for ( std::vector<Price>::const_iterator iter = vPrice.begin(); vPrice.end() != iter; ++iter ) {
+      prices.Append( *iter );
+    }
+    dblRing = Milliseconds( start );
+  }
+
+  std::cout << "TSSWStatsPrice:      " << dblDeque << " ms, " << ( dblDeque * 1e6 / nPrices ) << " ns per price" << std::endl;
+  std::cout << "TSSWStatsPriceRing:  " << dblRing << " ms, " << ( dblRing * 1e6 / nPrices ) << " ns per price" << std::endl;
+  std::cout << "largest difference " << dblDiff << ", after reset and backfill " << dblDiffBackfill
+    << ( ( 0.0 == dblDiff ) && ( 0.0 == dblDiffBackfill ) ? ", identical" : ", DIFFERENT" ) << std::endl;
+
+  return ( 0.0 == dblDiff ) && ( 0.0 == dblDiffBackfill ) ? 0 : 2;
+}
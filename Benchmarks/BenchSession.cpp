@@ -0,0 +1,204 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+// orders persisted per second, each emulating OrderManager::ReportExecution:
+//   an update of the order, and an insert of its execution
+// autocommit:  each statement written in place, its own transaction, as the managers do without a write behind
+// write behind:  queued to the WriteBehind thread, committed in batches, timed through the final Flush
+// each is run with the default journal, then with WAL and synchronous=normal
+// the database file is created afresh for each run, and removed afterwards
+
+#include "stdafx.h"
+
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include <OUSqlite/Session.h>
+#include <OUSqlite/WriteBehind.h>
+
+#include "Benchmarks.h"
+
+namespace {
+
+  typedef std::chrono::steady_clock steady_t;
+
+  struct Order {
+    template<class A>
+    void Fields( A& a ) {
+      ou::db::Field( a, "orderid", idOrder );
+      ou::db::Field( a, "quantityfilled", nFilled );
+      ou::db::Field( a, "orderstatus", nStatus );
+    }
+    long idOrder;
+    long nFilled;
+    long nStatus;
+    Order( long idOrder_ = 0 ): idOrder( idOrder_ ), nFilled( 0 ), nStatus( 1 ) {};
+  };
+
+  struct OrderCreate: Order {
+    template<class A>
+    void Fields( A& a ) {
+      Order::Fields( a );
+      ou::db::Key( a, "orderid" );
+    }
+  };
+
+  struct Execution {
+    template<class A>
+    void Fields( A& a ) {
+      ou::db::Field( a, "orderid", idOrder );
+      ou::db::Field( a, "quantity", nQuantity );
+      ou::db::Field( a, "price", dblPrice );
+      ou::db::Field( a, "exchangeid", sExchange );
+    }
+    long idOrder;
+    long nQuantity;
+    double dblPrice;
+    std::string sExchange;
+    Execution( long idOrder_ = 0 ): idOrder( idOrder_ ), nQuantity( 100 ), dblPrice( 10.25 ), sExchange( "NSDQ" ) {};
+  };
+
+  struct ExecutionCreate: Execution {
+    template<class A>
+    void Fields( A& a ) {
+      ou::db::Field( a, "executionid", idExecution );
+      Execution::Fields( a );
+      ou::db::Key( a, "executionid" );
+    }
+    long idExecution;
+    ExecutionCreate( void ): idExecution( 0 ) {};
+  };
+
+  struct UpdateOrder {
+    template<class A>
+    void Fields( A& a ) {
+      ou::db::Field( a, "quantityfilled", nFilled );
+      ou::db::Field( a, "orderstatus", nStatus );
+      ou::db::Field( a, "orderid", idOrder );
+    }
+    long nFilled;
+    long nStatus;
+    long idOrder;
+    UpdateOrder( long idOrder_ ): nFilled( 100 ), nStatus( 2 ), idOrder( idOrder_ ) {};
+  };
+
+  void HandleRegisterTables( ou::db::Session& session ) {
+    session.RegisterTable<OrderCreate>( "orders" );
+    session.RegisterTable<ExecutionCreate>( "executions" );
+  }
+
+  void HandleRegisterRows( ou::db::Session& session ) {
+    session.MapRowDefToTableName<Order>( "orders" );
+    session.MapRowDefToTableName<Execution>( "executions" );
+  }
+
+  void ReportExecution( ou::db::Session& session, long idOrder ) {
+    UpdateOrder update( idOrder );
+    ou::db::QueryFields<UpdateOrder>::pQueryFields_t pQuery
+      = session.SQL<UpdateOrder>( "update orders set quantityfilled=?, orderstatus=?", update ).Where( "orderid=?" );
+    Execution execution( idOrder );
+    ou::db::QueryFields<Execution>::pQueryFields_t pQueryExecution
+      = session.Insert<Execution>( execution );
+  }
+
+  void Remove( const std::string& sFile ) {
+    std::remove( sFile.c_str() );
+    std::remove( ( sFile + "-journal" ).c_str() );
+    std::remove( ( sFile + "-wal" ).c_str() );
+    std::remove( ( sFile + "-shm" ).c_str() );
+  }
+
+  double Run( const std::string& sFile, long nOrders, bool bWriteBehind, bool bWAL ) {
+
+    Remove( sFile );
+
+    double dblSeconds( 0.0 );
+    {
+      ou::db::Session session;
+      session.OnRegisterTables.Add( &HandleRegisterTables );
+      session.OnRegisterRows.Add( &HandleRegisterRows );
+      session.Open( sFile, ou::db::EOpenFlagsAutoCreate );
+      if ( bWAL ) {
+        session.SetJournalMode( ou::db::EJournalModeWAL );
+        session.SetSynchronous( ou::db::ESynchronousNormal );
+      }
+
+      {  // the orders exist before their executions arrive
+        ou::db::Session::Transaction transaction( session );
+        for ( long idOrder = 0; idOrder < nOrders; ++idOrder ) {
+          Order order( idOrder );
+          ou::db::QueryFields<Order>::pQueryFields_t pQuery = session.Insert<Order>( order );
+        }
+        transaction.Commit();
+      }
+
+      const steady_t::time_point start( steady_t::now() );
+      if ( bWriteBehind ) {
+        ou::db::WriteBehind wb( session );
+        for ( long idOrder = 0; idOrder < nOrders; ++idOrder ) {
+          wb.Enqueue( [idOrder]( ou::db::Session& sessionWriter ){ ReportExecution( sessionWriter, idOrder ); } );
+        }
+        wb.Flush();
+      }
+      else {
+        for ( long idOrder = 0; idOrder < nOrders; ++idOrder ) {
+          ReportExecution( session, idOrder );
+        }
+      }
+      dblSeconds = std::chrono::duration<double>( steady_t::now() - start ).count();
+
+      session.OnRegisterRows.Remove( &HandleRegisterRows );
+      session.OnRegisterTables.Remove( &HandleRegisterTables );
+      session.Close();
+    }
+
+    Remove( sFile );
+
+    return dblSeconds;
+  }
+}
+
+int BenchSession( int argc, char* argv[] ) {
+
+  const long nOrders( 0 < argc ? std::atol( argv[ 0 ] ) : 20000 );
+  const std::string sFile( 1 < argc ? argv[ 1 ] : "benchsession.db" );
+  if ( 0 >= nOrders ) {
+    std::cout << "orders needs to be positive" << std::endl;
+    return 1;
+  }
+
+  std::cout << nOrders << " orders, " << sFile << std::endl;
+
+  struct Case {
+    const char* szName;
+    bool bWriteBehind;
+    bool bWAL;
+  };
+  const Case rCase[] = {
+    { "autocommit per order        ", false, false },
+    { "write behind batches        ", true,  false },
+    { "WAL, autocommit per order   ", false, true },
+    { "WAL, write behind batches   ", true,  true }
+  };
+
+  for ( size_t ix = 0; ix < sizeof( rCase ) / sizeof( Case ); ++ix ) {
+    const double dblSeconds( Run( sFile, nOrders, rCase[ ix ].bWriteBehind, rCase[ ix ].bWAL ) );
+    std::cout << rCase[ ix ].szName << dblSeconds << " s, " << (long) ( nOrders / dblSeconds ) << " orders/s" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,181 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+// InstrumentManager startup, milliseconds to open the database and have every instrument through Get()
+// the database:  options on a number of underlyings, 4 expiries, 60 strikes, call and put,
+//   each with an IQFeed alternate name, 19,200 instruments at the default of 40 underlyings
+// per row:  each Get() loads its instrument, and its alternate names, with a query of its own
+// load all:  LoadAll() reads the instruments and alternate names tables once each, then the Get()s
+// snapshot:  LoadSnapshot() from the binary file saved after the load all run, then the Get()s
+// each run opens the database with a fresh InstrumentManager, the files are removed afterwards
+
+#include "stdafx.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/lexical_cast.hpp>
+
+#include <OUSqlite/Session.h>
+#include <TFTrading/InstrumentManager.h>
+
+#include "Benchmarks.h"
+
+using namespace ou::tf;
+
+namespace {
+
+  typedef std::chrono::steady_clock steady_t;
+
+  const int nExpiries( 4 );
+  const int nStrikes( 60 );
+
+  double Milliseconds( const steady_t::time_point& start ) {
+    return std::chrono::duration<double,std::milli>( steady_t::now() - start ).count();
+  }
+
+  struct Option {
+    std::string sUnderlying;
+    int nMonth;
+    int nStrike;
+    OptionSide::enumOptionSide side;
+    std::string sName;
+  };
+
+  void BuildOptions( int nUnderlyings, std::vector<Option>& vOption ) {
+    for ( int ixUnderlying = 0; ixUnderlying < nUnderlyings; ++ixUnderlying ) {
+      for ( int ixExpiry = 0; ixExpiry < nExpiries; ++ixExpiry ) {
+        for ( int ixStrike = 0; ixStrike < nStrikes; ++ixStrike ) {
+          for ( int ixSide = 0; ixSide < 2; ++ixSide ) {
+            Option option;
+            option.sUnderlying = "U" + boost::lexical_cast<std::string>( ixUnderlying );
+            option.nMonth = 6 + ixExpiry;
+            option.nStrike = 50 + ixStrike;
+            option.side = ( 0 == ixSide ) ? OptionSide::Put : OptionSide::Call;
+            option.sName = Instrument::BuildGenericOptionName( option.sUnderlying, option.side, 2018, option.nMonth, 15, option.nStrike );
+            vOption.push_back( option );
+          }
+        }
+      }
+    }
+  }
+
+  void Remove( const std::string& sFile ) {
+    std::remove( sFile.c_str() );
+    std::remove( ( sFile + "-journal" ).c_str() );
+  }
+
+  void Create( const std::string& sFile, const std::vector<Option>& vOption ) {
+    ou::db::Session session;
+    InstrumentManager im;
+    im.AttachToSession( &session );
+    session.Open( sFile, ou::db::EOpenFlagsAutoCreate );
+    {
+      ou::db::Session::Transaction transaction( session );
+      for ( std::vector<Option>::const_iterator iter = vOption.begin(); vOption.end() != iter; ++iter ) {
+        InstrumentManager::pInstrument_t pInstrument(
+          new Instrument( iter->sName, InstrumentType::Option, "SMART", 2018, iter->nMonth, 15, iter->side, iter->nStrike ) );
+        pInstrument->SetAlternateName( keytypes::EProviderIQF, "IQ" + iter->sName );
+        im.Register( pInstrument );
+      }
+      transaction.Commit();
+    }
+    im.DetachFromSession( &session );
+    session.Close();
+  }
+
+  enum ELoad { PerRow, LoadAll, Snapshot };
+
+  // true when every instrument came back with its alternate name
+  bool Run( const std::string& sFile, const std::string& sSnapshot, const std::vector<Option>& vOption, ELoad load, double& dblMilliseconds ) {
+    size_t nFound( 0 );
+    const steady_t::time_point start( steady_t::now() );
+    ou::db::Session session;
+    InstrumentManager im;
+    im.AttachToSession( &session );
+    session.Open( sFile, ou::db::EOpenFlagsAutoCreate );
+    switch ( load ) {
+      case PerRow:
+        break;
+      case LoadAll:
+        im.LoadAll();
+        break;
+      case Snapshot:
+        if ( !im.LoadSnapshot( sSnapshot ) ) {
+          std::cout << "snapshot " << sSnapshot << " not loaded" << std::endl;
+        }
+        break;
+    }
+    for ( std::vector<Option>::const_iterator iter = vOption.begin(); vOption.end() != iter; ++iter ) {
+      InstrumentManager::pInstrument_t pInstrument( im.Get( iter->sName ) );
+      if ( ( "IQ" + iter->sName ) == pInstrument->GetInstrumentName( keytypes::EProviderIQF ) ) ++nFound;
+    }
+    dblMilliseconds = Milliseconds( start );
+    if ( LoadAll == load ) {
+      const steady_t::time_point startSave( steady_t::now() );
+      im.SaveSnapshot( sSnapshot );
+      std::cout << "snapshot saved in " << Milliseconds( startSave ) << " ms" << std::endl;
+    }
+    im.DetachFromSession( &session );
+    session.Close();
+    return vOption.size() == nFound;
+  }
+}
+
+int BenchStartup( int argc, char* argv[] ) {
+
+  const int nUnderlyings( 0 < argc ? std::atoi( argv[ 0 ] ) : 40 );
+  const std::string sFile( 1 < argc ? argv[ 1 ] : "benchstartup.db" );
+  const std::string sSnapshot( sFile + ".snapshot" );
+  if ( 0 >= nUnderlyings ) {
+    std::cout << "underlyings needs to be positive" << std::endl;
+    return 1;
+  }
+
+  std::vector<Option> vOption;
+  BuildOptions( nUnderlyings, vOption );
+
+  Remove( sFile );
+  std::remove( sSnapshot.c_str() );
+
+  std::cout << vOption.size() << " instruments, " << sFile << std::endl;
+  Create( sFile, vOption );
+
+  struct Case {
+    const char* szName;
+    ELoad load;
+  };
+  const Case rCase[] = {  // load all before snapshot, it saves the snapshot
+    { "per row Get()           ", PerRow },
+    { "LoadAll() + Get()       ", LoadAll },
+    { "LoadSnapshot() + Get()  ", Snapshot }
+  };
+
+  int result( 0 );
+  for ( size_t ix = 0; ix < sizeof( rCase ) / sizeof( Case ); ++ix ) {
+    double dblMilliseconds( 0.0 );
+    const bool bComplete( Run( sFile, sSnapshot, vOption, rCase[ ix ].load, dblMilliseconds ) );
+    std::cout << rCase[ ix ].szName << dblMilliseconds << " ms" << ( bComplete ? "" : ", instruments missing" ) << std::endl;
+    if ( !bComplete ) result = 1;
+  }
+
+  Remove( sFile );
+  std::remove( sSnapshot.c_str() );
+
+  return result;
+}
@@ -0,0 +1,72 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+// timings of library kernels against the code they replace, run one by name:
+//   benchmarks ema [quotes] [levels]
+//   benchmarks session [orders] [file]
+//   benchmarks orders [orders] [runs]
+//   benchmarks crr [strikes] [steps] [repetitions]
+//   benchmarks fd [repetitions] [reference steps]
+//   benchmarks startup [underlyings] [file]
+//   benchmarks ring [prices]
+// build the Release configuration for numbers worth comparing
+
+#include "stdafx.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "Benchmarks.h"
+
+namespace {
+
+  struct Benchmark {
+    const char* szName;
+    int (*fn)( int argc, char* argv[] );
+    const char* szUsage;
+  };
+
+  const Benchmark rBenchmark[] = {
+    { "ema", &BenchEMA, "ema [quotes] [levels]:  chained TSEMA series against one EMAChain" },
+    { "session", &BenchSession, "session [orders] [file]:  orders persisted per second, autocommit against write behind" },
+    { "orders", &BenchOrders, "orders [orders] [runs]:  OrderManager place, fill, cancel, microseconds per operation" },
+    { "crr", &BenchCRR, "crr [strikes] [steps] [repetitions]:  binomial options per second, the tree as it was against scalar, slice and lanes" },
+    { "fd", &BenchFD, "fd [repetitions] [reference steps]:  Crank Nicolson against CRR, time and largest error per expiry" },
+    { "startup", &BenchStartup, "startup [underlyings] [file]:  InstrumentManager per row Get() against LoadAll() and LoadSnapshot()" },
+    { "ring", &BenchRing, "ring [prices]:  TSSWStatsPrice by count against TSSWStatsPriceRing, identical stats, time per price" }
+  };
+
+  const size_t nBenchmark( sizeof( rBenchmark ) / sizeof( Benchmark ) );
+
+  void Usage( void ) {
+    std::cout << "usage: benchmarks <name> [arguments]" << std::endl;
+    for ( size_t ix = 0; ix < nBenchmark; ++ix ) {
+      std::cout << "  " << rBenchmark[ ix ].szUsage << std::endl;
+    }
+  }
+}
+
+int main( int argc, char* argv[] ) {
+  if ( 2 > argc ) {
+    Usage();
+    return 1;
+  }
+  for ( size_t ix = 0; ix < nBenchmark; ++ix ) {
+    if ( 0 == std::strcmp( argv[ 1 ], rBenchmark[ ix ].szName ) ) {
+      return rBenchmark[ ix ].fn( argc - 2, argv + 2 );
+    }
+  }
+  Usage();
+  return 1;
+}
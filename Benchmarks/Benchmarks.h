@@ -0,0 +1,25 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// each benchmark takes the arguments following its name, and returns the process exit code
+
+int BenchEMA( int argc, char* argv[] );
+int BenchSession( int argc, char* argv[] );
+int BenchOrders( int argc, char* argv[] );
+int BenchCRR( int argc, char* argv[] );
+int BenchFD( int argc, char* argv[] );
+int BenchStartup( int argc, char* argv[] );
+int BenchRing( int argc, char* argv[] );
@@ -0,0 +1,163 @@
+#
+# Generated Makefile - do not edit!
+#
+# Edit the Makefile in the project folder instead (../Makefile). Each target
+# has a -pre and a -post target defined where you can add customized code.
+#
+# This makefile implements configuration specific macros and targets.
+
+
+# Environment
+MKDIR=mkdir
+CP=cp
+GREP=grep
+NM=nm
+CCADMIN=CCadmin
+RANLIB=ranlib
+CC=gcc
+CCC=g++
+CXX=g++
+FC=gfortran
+AS=as
+
+# Macros
+CND_PLATFORM=GNU-Linux
+CND_DLIB_EXT=so
+CND_CONF=Release
+CND_DISTDIR=dist
+CND_BUILDDIR=build
+
+# Include project Makefile
+include Makefile
+
+# Object Directory
+OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
+
+# Object Files
+OBJECTFILES= \
+	${OBJECTDIR}/BenchCRR.o \
+	${OBJECTDIR}/BenchEMA.o \
+	${OBJECTDIR}/BenchFD.o \
+	${OBJECTDIR}/BenchOrders.o \
+	${OBJECTDIR}/BenchRing.o \
+	${OBJECTDIR}/BenchSession.o \
+	${OBJECTDIR}/BenchStartup.o \
+	${OBJECTDIR}/Benchmarks.o \
+	${OBJECTDIR}/stdafx.o
+
+
+# C Compiler Flags
+CFLAGS=
+
+# CC Compiler Flags
+CCFLAGS=-m64
+CXXFLAGS=-m64
+
+# Fortran Compiler Flags
+FFLAGS=
+
+# Assembler Flags
+ASFLAGS=
+
+# Link Libraries and Options
+LDLIBSOPTIONS=-L/usr/local/lib -Wl,-rpath,'/usr/local/lib' ../lib/TFOptions/dist/Release/GNU-Linux/libtfoptions.a ../lib/TFTrading/dist/Release/GNU-Linux/libtftrading.a ../lib/TFIndicators/dist/Release/GNU-Linux/libtfindicators.a ../lib/TFHDF5TimeSeries/dist/Release/GNU-Linux/libtfhdf5timeseries.a ../lib/TFTimeSeries/dist/Release/GNU-Linux/libtftimeseries.a ../lib/OUSqlite/dist/Release/GNU-Linux/libousqlite.a ../lib/OUSQL/dist/Release/GNU-Linux/libousql.a ../lib/OUCommon/dist/Release/GNU-Linux/liboucommon.a -lhdf5_cpp -lhdf5 -lsz -lpthread -ldl -lz -lboost_system-mt -lboost_date_time-mt -lboost_filesystem-mt -lboost_serialization-mt -lboost_thread-mt
+
+# Build Targets
+.build-conf: ${BUILD_SUBPROJECTS}
+	"${MAKE}"  -f nbproject/Makefile-${CND_CONF}.mk ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks: ../lib/TFOptions/dist/Release/GNU-Linux/libtfoptions.a
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks: ../lib/TFTrading/dist/Release/GNU-Linux/libtftrading.a
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks: ../lib/TFIndicators/dist/Release/GNU-Linux/libtfindicators.a
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks: ../lib/TFHDF5TimeSeries/dist/Release/GNU-Linux/libtfhdf5timeseries.a
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks: ../lib/TFTimeSeries/dist/Release/GNU-Linux/libtftimeseries.a
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks: ../lib/OUSqlite/dist/Release/GNU-Linux/libousqlite.a
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks: ../lib/OUSQL/dist/Release/GNU-Linux/libousql.a
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks: ../lib/OUCommon/dist/Release/GNU-Linux/liboucommon.a
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks: ${OBJECTFILES}
+	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
+	${LINK.cc} -o ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks ${OBJECTFILES} ${LDLIBSOPTIONS}
+
+${OBJECTDIR}/BenchCRR.o: BenchCRR.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -DNDEBUG -I../lib -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/BenchCRR.o BenchCRR.cpp
+
+${OBJECTDIR}/BenchEMA.o: BenchEMA.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -DNDEBUG -I../lib -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/BenchEMA.o BenchEMA.cpp
+
+${OBJECTDIR}/BenchFD.o: BenchFD.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -DNDEBUG -I../lib -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/BenchFD.o BenchFD.cpp
+
+${OBJECTDIR}/BenchOrders.o: BenchOrders.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -DNDEBUG -I../lib -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/BenchOrders.o BenchOrders.cpp
+
+${OBJECTDIR}/BenchRing.o: BenchRing.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -DNDEBUG -I../lib -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/BenchRing.o BenchRing.cpp
+
+${OBJECTDIR}/BenchSession.o: BenchSession.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -DNDEBUG -I../lib -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/BenchSession.o BenchSession.cpp
+
+${OBJECTDIR}/BenchStartup.o: BenchStartup.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -DNDEBUG -I../lib -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/BenchStartup.o BenchStartup.cpp
+
+${OBJECTDIR}/Benchmarks.o: Benchmarks.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -DNDEBUG -I../lib -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Benchmarks.o Benchmarks.cpp
+
+${OBJECTDIR}/stdafx.o: stdafx.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -DNDEBUG -I../lib -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/stdafx.o stdafx.cpp
+
+# Subprojects
+.build-subprojects:
+	cd ../lib/TFOptions && ${MAKE}  -f Makefile CONF=Release
+	cd ../lib/TFTrading && ${MAKE}  -f Makefile CONF=Release
+	cd ../lib/TFIndicators && ${MAKE}  -f Makefile CONF=Release
+	cd ../lib/TFHDF5TimeSeries && ${MAKE}  -f Makefile CONF=Release
+	cd ../lib/TFTimeSeries && ${MAKE}  -f Makefile CONF=Release
+	cd ../lib/OUSqlite && ${MAKE}  -f Makefile CONF=Release
+	cd ../lib/OUSQL && ${MAKE}  -f Makefile CONF=Release
+	cd ../lib/OUCommon && ${MAKE}  -f Makefile CONF=Release
+
+# Clean Targets
+.clean-conf: ${CLEAN_SUBPROJECTS}
+	${RM} -r ${CND_BUILDDIR}/${CND_CONF}
+
+# Subprojects
+.clean-subprojects:
+	cd ../lib/TFOptions && ${MAKE}  -f Makefile CONF=Release clean
+	cd ../lib/TFTrading && ${MAKE}  -f Makefile CONF=Release clean
+	cd ../lib/TFIndicators && ${MAKE}  -f Makefile CONF=Release clean
+	cd ../lib/TFHDF5TimeSeries && ${MAKE}  -f Makefile CONF=Release clean
+	cd ../lib/TFTimeSeries && ${MAKE}  -f Makefile CONF=Release clean
+	cd ../lib/OUSqlite && ${MAKE}  -f Makefile CONF=Release clean
+	cd ../lib/OUSQL && ${MAKE}  -f Makefile CONF=Release clean
+	cd ../lib/OUCommon && ${MAKE}  -f Makefile CONF=Release clean
+
+# Enable dependency checking
+.dep.inc: .depcheck-impl
+
+include .dep.inc
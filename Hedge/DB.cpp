@@ -32,6 +32,7 @@ DB::~DB(void) {
 }
 
 void DB::HandlePopulateTables( ou::db::Session& session ) {
+  ou::db::WriteBehind::Exclusive exclusive( ou::tf::ManagersWriteBehind() );  // the handler uses the session directly
   if ( 0 != OnPopulateDatabaseHandler ) OnPopulateDatabaseHandler();
 }
 
@@ -67,6 +68,8 @@ struct OptionsQueryParameters {
 
 bool DB::LoadOptions( ou::tf::InstrumentManager::pInstrument_t& pUnderlying, boost::uint16_t nYear, boost::uint16_t nMonth, boost::uint16_t nDay ) {
 
+  ou::db::WriteBehind::Exclusive exclusive( ou::tf::ManagersWriteBehind() );  // null unless enabled
+
   bool bFound = false;
   OptionsQueryParameters query( pUnderlying->GetInstrumentName(), nYear, nMonth, nDay );
 
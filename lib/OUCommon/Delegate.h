@@ -56,6 +56,7 @@ public:
 
   void Add( OnDispatchHandler function );
   void Remove( OnDispatchHandler function );
+  bool Dispatches( OnDispatchHandler function );  // false once a removed function can no longer be called
 
   bool IsEmpty() const { return ( 0 == m_vDispatchMaster.size() ); };
   vsize_t Size( void ) const { return m_vDispatchMaster.size(); };
@@ -177,6 +178,31 @@ void Delegate<T>::Remove( OnDispatchHandler function ) {
 
 }
 
+template<class T> 
+bool Delegate<T>::Dispatches( OnDispatchHandler function ) {
+
+  // a Remove during operator() leaves the function in m_vDispatch until a replacement outside of operator()
+  bool bFound( false );
+
+  m_spinlockVectorUpdate.lock();
+
+  if ( 0 != m_cntChanges.load( boost::memory_order_acquire ) ) {
+    VectorReplace();
+  }
+
+  // operator() iterates m_vDispatch itself, so when not there, not being called, nor about to be
+  for ( const_iterator iter = m_vDispatch.begin(); m_vDispatch.end() != iter; ++iter ) {
+    if ( function == *iter ) {
+      bFound = true;
+      break;
+    }
+  }
+
+  m_spinlockVectorUpdate.unlock();
+
+  return bFound;
+}
+
 template<class T>
 void Delegate<T>::VectorReplace( void ) {
 
@@ -197,10 +223,9 @@ void Delegate<T>::VectorReplace( void ) {
         ++ixSrc, ++ixDst ) {
           *ixDst = *ixSrc;
       }
+      m_cntChanges.store( 0, boost::memory_order_release );  // otherwise left for the end of operator()
     }
 
-    m_cntChanges.store( 0, boost::memory_order_release );
-
 //    m_spinlockVectorUpdate.unlock();
     m_spinlockVectorReplace.unlock();
 
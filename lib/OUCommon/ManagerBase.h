@@ -30,6 +30,7 @@
 
 //#include "Database.h"
 #include <OUSqlite/Session.h>
+#include <OUSqlite/WriteBehind.h>
 
 namespace ou {
 namespace db { // Database
@@ -39,17 +40,35 @@ template<class T>
 class ManagerBase: public ou::Singleton<T> {
 public:
 
-  ManagerBase( void ): m_pSession( 0 ) {};
+  ManagerBase( void ): m_pSession( 0 ), m_pWriteBehind( 0 ) {};
   virtual ~ManagerBase( void ) {};
 
   virtual void AttachToSession( ou::db::Session* pSession ) { m_pSession = pSession; };
   virtual void DetachFromSession( ou::db::Session* pSession ) { m_pSession = 0; };
 
+  // writes on the session are then queued to the write behind's thread, the session still needs to be attached
+  void AttachToWriteBehind( ou::db::WriteBehind* pWriteBehind ) { m_pWriteBehind = pWriteBehind; };
+  void DetachFromWriteBehind( void ) {
+    if ( 0 != m_pWriteBehind ) m_pWriteBehind->Flush();
+    m_pWriteBehind = 0;
+  };
+
 protected:
 
   // if session has been assigned, then persist records, if not, don't
   ou::db::Session* m_pSession;
 
+  // if write behind has been assigned, writes are queued, reads need a WriteBehind::Exclusive
+  ou::db::WriteBehind* m_pWriteBehind;
+
+  // F: void( ou::db::Session& ), a copy of what is to be written, as it may be written later
+  //   F only writes, in memory state is updated by the caller before persisting, as F runs on the writer's thread
+  template<typename F>
+  void Persist( F f ) {
+    if ( 0 != m_pWriteBehind ) m_pWriteBehind->Enqueue( f );
+    else f( *m_pSession );
+  }
+
   template<class K, class M, class Q> // K:key, M:map, Q:query
   void DeleteRecord( const K& key, M& map, const std::string& sWhere );
 
@@ -70,6 +89,7 @@ template<class K, class R, class Q>
 void ManagerBase<T>::UpdateRecord( const K& key, const R& row, const std::string& sWhere ) {
 
   if ( 0 != m_pSession ) {
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );  // the query refers to the row
     Q q( const_cast<R&>( row ), key );
     typename ou::db::QueryFields<Q>::pQueryFields_t pQueryUpdate = m_pSession->Update<Q>( q ).Where( sWhere );
   }
@@ -89,6 +109,7 @@ void ManagerBase<T>::UpdateRecord( const K& key, const R& row, const M& map, con
   }
 
   if ( 0 != m_pSession ) {
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     Q q( const_cast<R&>( row ), key );
     typename ou::db::QueryFields<Q>::pQueryFields_t pQueryUpdate = m_pSession->Update<Q>( q ).Where( sWhere );
   }
@@ -100,6 +121,7 @@ template<class K, class Q> // K:key, Q:query
 void ManagerBase<T>::DeleteRecord( const K& key, const std::string& sWhere ) {
      
   if ( 0 != m_pSession ) {
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     Q q( key );
     typename ou::db::QueryFields<Q>::pQueryFields_t pQueryDelete = m_pSession->Delete<Q>( q ).Where( sWhere );
   }
@@ -119,6 +141,7 @@ void ManagerBase<T>::DeleteRecord( const K& key, M& map, const std::string& sWhe
   }
 
   if ( 0 != m_pSession ) {
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     Q q( key );
     typename ou::db::QueryFields<Q>::pQueryFields_t pQueryDelete = m_pSession->Delete<Q>( q ).Where( sWhere );
   }
@@ -0,0 +1,87 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// 2018/05/06
+// table of T indexed directly by a dense integer key, such as an auto incremented id
+// entries live in fixed size slabs of 2^nBits, allocated as the keys reach them:
+//   a lookup is two indexings, entries don't move once constructed, so pointers to them stay valid,
+//   and neighbouring keys are neighbours in memory
+// sparse keys cost a whole slab each, and a key of k costs k >> nBits slab pointers
+
+#include <vector>
+#include <bitset>
+#include <cassert>
+
+namespace ou { // One Unified
+
+template<class T, unsigned nBits = 8>  // T needs a default constructor
+class SlabTable {
+public:
+
+  typedef size_t key_t;
+
+  SlabTable( void ): m_nEntries( 0 ) {};
+  ~SlabTable( void ) {
+    for ( typename vSlab_t::iterator iter = m_vSlab.begin(); m_vSlab.end() != iter; ++iter ) {
+      delete *iter;
+    }
+  }
+
+  T* Find( key_t key ) {  // null when not present
+    const size_t ixSlab( key >> nBits );
+    if ( m_vSlab.size() <= ixSlab ) return 0;
+    Slab* pSlab( m_vSlab[ ixSlab ] );
+    if ( 0 == pSlab ) return 0;
+    const size_t ix( key & nMask );
+    return pSlab->bsUsed.test( ix ) ? &pSlab->rEntry[ ix ] : 0;
+  }
+
+  T* Insert( key_t key, const T& t ) {  // null when already present
+    const size_t ixSlab( key >> nBits );
+    if ( m_vSlab.size() <= ixSlab ) m_vSlab.resize( ixSlab + 1, 0 );
+    Slab*& pSlab( m_vSlab[ ixSlab ] );
+    if ( 0 == pSlab ) pSlab = new Slab;
+    const size_t ix( key & nMask );
+    if ( pSlab->bsUsed.test( ix ) ) return 0;
+    pSlab->bsUsed.set( ix );
+    pSlab->rEntry[ ix ] = t;
+    ++m_nEntries;
+    return &pSlab->rEntry[ ix ];
+  }
+
+  size_t Size( void ) const { return m_nEntries; };
+
+protected:
+private:
+
+  enum { nPerSlab = 1 << nBits, nMask = nPerSlab - 1 };
+
+  struct Slab {
+    std::bitset<nPerSlab> bsUsed;
+    T rEntry[ nPerSlab ];
+  };
+
+  typedef std::vector<Slab*> vSlab_t;
+  vSlab_t m_vSlab;
+
+  size_t m_nEntries;
+
+  SlabTable( const SlabTable& );  // not copyable
+  SlabTable& operator=( const SlabTable& );
+
+};
+
+} // namespace ou
@@ -16,6 +16,20 @@ enum enumOpenFlags {
   EOpenFlagsAutoCreate = 0x1
 };
 
+enum enumJournalMode {  // how the database keeps its rollback information
+  EJournalModeDelete = 0,  // default, journal file deleted at each commit
+  EJournalModeTruncate,
+  EJournalModePersist,
+  EJournalModeMemory,
+  EJournalModeWAL  // write ahead log, readers don't block the writer, commits append rather than rewrite
+};
+
+enum enumSynchronous {  // when the database waits on the disk
+  ESynchronousOff = 0,  // hands writes to the os, a power loss can corrupt the database
+  ESynchronousNormal,  // with WAL, syncs at checkpoints only, a power loss may lose the last commits
+  ESynchronousFull  // default, syncs at each commit
+};
+
 } // namespace db
 } // namespace ou
 
@@ -21,7 +21,6 @@
 // 2011-01-30
 // need to work on:
 //   getting key back when inserting new record with auto-increment
-//   adding transactions with rollback and commit
 
 // OUSqlite Library
 // was going to be pimpl, but couldn't, as templates are in use, no 'export' keyword
@@ -31,7 +30,12 @@
 // 2011/04/25
 // need to add 'constraint unique ... ' clause during table creation (needs revaming of constraint symbology)
 // need to add ''create index ... ' clause during table creation
-// need to add transaction/commit/rollback capabilities
+
+// a query belongs to whoever holds its pointer, rather than to the session until close:
+//   on the query's destruction, its prepared statement goes back to the database interface,
+//   which keeps it by statement text, so the next query with the same text skips the prepare
+// transactions:  BeginTransaction/CommitTransaction/RollbackTransaction, or the Transaction scope,
+//   nest as savepoints within the outermost transaction
 
 // 2012/10/13
 // QueryFields has a problem.  Things have to be re-written so that a statement can be prepared 
@@ -42,6 +46,7 @@
 
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
 #include <stdexcept>
 #include <typeinfo>
@@ -50,6 +55,7 @@
 #include <boost/intrusive_ptr.hpp>
 #include <boost/smart_ptr.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include "Constants.h"
 #include "Actions.h"
@@ -99,6 +105,8 @@ public:
 
   const std::string& QueryText( void ) { return m_sQueryText; };
 
+  virtual void Detach( void ) {};  // the session has closed, and taken the statement with it
+
 protected:
   enumClause m_clause;
   std::string m_sQueryText;  // 'compose' results end up here
@@ -228,21 +236,25 @@ public:
 
   typedef boost::intrusive_ptr<QueryState<SS, F, S> > pQueryState_t;
 
-  QueryState( S& session, F& f ): Query<F>( f ), m_session( session ) {};
-  ~QueryState( void ) {};
+  QueryState( S& session, F& f ): Query<F>( f ), m_pSession( &session ) {};
+  ~QueryState( void ) {
+    if ( 0 != m_pSession ) m_pSession->Release( *this );
+  };
+
+  void Detach( void ) { m_pSession = 0; };
 
 protected:
 
   void ProcessInQueryState( void ) {
     if ( QueryBase::HasFields() ) {
-      m_session.Bind( *this );
+      m_pSession->Bind( *this );
     }
-    m_session.Execute( *this );
+    m_pSession->Execute( *this );
   }
 
 private:
 
-  S& m_session;
+  S* m_pSession;  // null once the session has closed
 
 };
 
@@ -267,6 +279,48 @@ public:
 
   boost::int64_t GetLastRowId( void ) { return m_db.GetLastRowId(); };
 
+  void SetJournalMode( enumJournalMode mode ) { m_db.SetJournalMode( mode ); };
+  void SetSynchronous( enumSynchronous sync ) { m_db.SetSynchronous( sync ); };
+
+  void BeginTransaction( void );
+  void CommitTransaction( void );  // on failure, the transaction remains open, to be rolled back
+  void RollbackTransaction( void );
+  size_t TransactionDepth( void ) const { return m_nTransaction; };
+
+  class Transaction: boost::noncopyable {  // rolls back unless committed
+  public:
+    explicit Transaction( session_t& session ): m_session( session ), m_bOpen( true ) {
+      m_session.BeginTransaction();
+    }
+    ~Transaction( void ) {
+      if ( m_bOpen ) {
+        try {
+          m_session.RollbackTransaction();
+        }
+        catch (...) {
+        }
+      }
+    }
+    void Commit( void ) {
+      assert( m_bOpen );
+      m_session.CommitTransaction();
+      m_bOpen = false;
+    }
+    void Rollback( void ) {
+      assert( m_bOpen );
+      m_bOpen = false;
+      m_session.RollbackTransaction();
+    }
+  private:
+    session_t& m_session;
+    bool m_bOpen;
+  };
+
+  void Release( QueryBase& qb ) {  // by the query's destructor
+    m_setQuery.erase( &qb );
+    m_db.ReleaseStatement( dynamic_cast<typename IDatabase::structStatementState&>( qb ), qb.QueryText() );
+  }
+
   template<class F>
   void Bind( QueryFields<F>& qf ) {
     typename IDatabase::structStatementState& StatementState
@@ -342,7 +396,7 @@ public:
       m_mapTableDefs.begin(), 
       mapTableDefs_pair_t( sTableName, pQuery) );
 
-    m_vQuery.push_back( pQuery );
+    m_setQuery.insert( pQuery );
 
     return *pQuery;
 
@@ -380,7 +434,7 @@ public:
 
     pQuery->SetExecuteOneTime();
     
-    m_vQuery.push_back( pQuery );
+    m_setQuery.insert( pQuery );
 
     return *pQuery;
   }
@@ -433,7 +487,7 @@ protected:
 
     pQuery->SetExecuteOneTime();
 
-    m_vQuery.push_back( pQuery );
+    m_setQuery.insert( pQuery );
 
     return *pQuery;
   }
@@ -441,6 +495,7 @@ protected:
 private:
 
   bool m_bOpened;
+  size_t m_nTransaction;  // depth, savepoints beyond the first
   
   IDatabase m_db;
 
@@ -451,13 +506,11 @@ private:
   typedef std::pair<std::string, pQueryBase_t> mapTableDefs_pair_t;
   mapTableDefs_t m_mapTableDefs;
 
-  typedef std::vector<pQueryBase_t> vQuery_t;
-  typedef vQuery_t::iterator vQuery_iter_t;
-  vQuery_t m_vQuery;  // 2013/08/26
-  // this is a bad thing to have around, statements should be closed after use.
-  // don't worry about re-use, cross that bridge later.
-  // in one application there are 32,000 queries, and none are closed,
-  // resulting in very long times to reclaim space at the end
+  typedef std::set<QueryBase*> setQuery_t;
+  typedef setQuery_t::iterator setQuery_iter_t;
+  setQuery_t m_setQuery;  // queries alive, not owned, so their statements can be finalized at close
+  // 2013/08/26 was a vector owning every query until close:  32,000 queries in one application, none closed,
+  // resulting in very long times to reclaim space at the end.  2018/05/04 queries now release on destruction.
 
   typedef std::map<std::string, std::string> mapFieldsToTable_t;
   typedef mapFieldsToTable_t::iterator mapFieldsToTable_iter_t;
@@ -468,7 +521,7 @@ private:
 
 // Constructor
 template<class IDatabase>
-SessionImpl<IDatabase>::SessionImpl( void ): m_bOpened( false ) {
+SessionImpl<IDatabase>::SessionImpl( void ): m_bOpened( false ), m_nTransaction( 0 ) {
 }
 
 // Destructor
@@ -495,15 +548,61 @@ template<class IDatabase>
 void SessionImpl<IDatabase>::ImplClose( void ) {
   if ( m_bOpened ) {
     m_mapTableDefs.clear();
-    for ( vQuery_iter_t iter = m_vQuery.begin(); iter != m_vQuery.end(); ++iter ) {
-      m_db.CloseStatement( *dynamic_cast<typename IDatabase::structStatementState*>( iter->get() ) );
-      iter->reset();
+    // queries still held elsewhere lose their statements, those held nowhere are deleted
+    setQuery_t setQuery;
+    setQuery.swap( m_setQuery );
+    for ( setQuery_iter_t iter = setQuery.begin(); iter != setQuery.end(); ++iter ) {
+      m_db.CloseStatement( *dynamic_cast<typename IDatabase::structStatementState*>( *iter ) );
+      ( *iter )->Detach();
+      if ( 0 == ( *iter )->RefCnt() ) delete *iter;
     }
-    m_vQuery.clear();
+    m_nTransaction = 0;  // any open transaction is rolled back by the close
     m_db.SessionClose();
     m_bOpened = false;
-    // 2013/08/26 process memory doesn't appear to be relaimed after this
-    //   trying again with addition of reset();
+  }
+}
+
+// BeginTransaction
+template<class IDatabase>
+void SessionImpl<IDatabase>::BeginTransaction( void ) {
+  if ( 0 == m_nTransaction ) {
+    m_db.Exec( "begin transaction" );
+  }
+  else {
+    m_db.Exec( "savepoint sp" + boost::lexical_cast<std::string>( m_nTransaction ) );
+  }
+  ++m_nTransaction;
+}
+
+// CommitTransaction
+template<class IDatabase>
+void SessionImpl<IDatabase>::CommitTransaction( void ) {
+  if ( 0 == m_nTransaction ) {
+    throw std::runtime_error( "SessionImpl::CommitTransaction: no transaction" );
+  }
+  const size_t n( m_nTransaction - 1 );
+  if ( 0 == n ) {
+    m_db.Exec( "commit transaction" );
+  }
+  else {
+    m_db.Exec( "release savepoint sp" + boost::lexical_cast<std::string>( n ) );
+  }
+  m_nTransaction = n;
+}
+
+// RollbackTransaction
+template<class IDatabase>
+void SessionImpl<IDatabase>::RollbackTransaction( void ) {
+  if ( 0 == m_nTransaction ) {
+    throw std::runtime_error( "SessionImpl::RollbackTransaction: no transaction" );
+  }
+  --m_nTransaction;  // closed even if the rollback fails, sqlite may already have rolled back on the error
+  if ( 0 == m_nTransaction ) {
+    m_db.Exec( "rollback transaction" );
+  }
+  else {
+    const std::string sSavePoint( "sp" + boost::lexical_cast<std::string>( m_nTransaction ) );
+    m_db.Exec( "rollback transaction to savepoint " + sSavePoint + "; release savepoint " + sSavePoint );
   }
 }
 
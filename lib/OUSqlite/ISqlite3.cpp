@@ -23,6 +23,10 @@
 namespace ou {
 namespace db {
 
+namespace {
+  const size_t nCachedPerStatement( 4 );  // more than one for when the same text is in use by overlapping queries
+}
+
 ISqlite3::ISqlite3(void) 
   : m_db( 0 )
 {
@@ -45,6 +49,12 @@ void ISqlite3::SessionOpen( const std::string& sDbFileName, enumOpenFlags flags
 }
 
 void ISqlite3::SessionClose( void ) {
+  for ( mapStmtCache_t::iterator iter = m_mapStmtCache.begin(); m_mapStmtCache.end() != iter; ++iter ) {
+    for ( vStmt_t::iterator iterStmt = iter->second.begin(); iter->second.end() != iterStmt; ++iterStmt ) {
+      sqlite3_finalize( *iterStmt );
+    }
+  }
+  m_mapStmtCache.clear();
   int rtn = sqlite3_close( m_db );
   m_db = 0;
   if (  SQLITE_OK != rtn ) {
@@ -58,8 +68,65 @@ void ISqlite3::SessionClose( void ) {
   }
 }
 
+void ISqlite3::SetJournalMode( enumJournalMode mode ) {
+  std::string sMode;
+  switch ( mode ) {
+    case EJournalModeDelete:   sMode = "delete";   break;
+    case EJournalModeTruncate: sMode = "truncate"; break;
+    case EJournalModePersist:  sMode = "persist";  break;
+    case EJournalModeMemory:   sMode = "memory";   break;
+    case EJournalModeWAL:      sMode = "wal";      break;
+  }
+  std::string sStatement( "pragma journal_mode=" + sMode + ";" );
+  sqlite3_stmt* pStmt( 0 );
+  int rtn = sqlite3_prepare_v2( m_db, sStatement.c_str(), -1, &pStmt, NULL );
+  if ( SQLITE_OK != rtn ) {
+    std::string sErr( "ISqlite3::SetJournalMode: " );
+    sErr += sqlite3_errmsg( m_db );
+    throw std::runtime_error( sErr );
+  }
+  std::string sResult;
+  if ( SQLITE_ROW == sqlite3_step( pStmt ) ) {  // the mode in effect, which differs when the request can't be met
+    const unsigned char* szResult( sqlite3_column_text( pStmt, 0 ) );
+    if ( 0 != szResult ) sResult = reinterpret_cast<const char*>( szResult );
+  }
+  sqlite3_finalize( pStmt );
+  if ( sMode != sResult ) {
+    std::string sErr( "ISqlite3::SetJournalMode: " );
+    sErr += sMode + " not set, mode is " + sResult;
+    throw std::runtime_error( sErr );
+  }
+}
+
+void ISqlite3::SetSynchronous( enumSynchronous sync ) {
+  switch ( sync ) {
+    case ESynchronousOff:    Exec( "pragma synchronous=off" );    break;
+    case ESynchronousNormal: Exec( "pragma synchronous=normal" ); break;
+    case ESynchronousFull:   Exec( "pragma synchronous=full" );   break;
+  }
+}
+
+void ISqlite3::Exec( const std::string& sStatement ) {
+  char* szErr( 0 );
+  int rtn = sqlite3_exec( m_db, sStatement.c_str(), 0, 0, &szErr );
+  if ( SQLITE_OK != rtn ) {
+    std::string sErr( "ISqlite3::Exec: " );
+    sErr += sStatement + ": ";
+    sErr += ( 0 == szErr ) ? boost::lexical_cast<std::string>( rtn ) : szErr;
+    sqlite3_free( szErr );
+    throw std::runtime_error( sErr );
+  }
+}
+
 void ISqlite3::PrepareStatement( structStatementState& statement, std::string& sStatement ) {
   sStatement += ";";
+  mapStmtCache_t::iterator iter = m_mapStmtCache.find( sStatement );
+  if ( ( m_mapStmtCache.end() != iter ) && !iter->second.empty() ) {
+    statement.pStmt = iter->second.back();
+    iter->second.pop_back();
+    statement.bIsReset = true;
+    return;
+  }
   int rtn = sqlite3_prepare_v2( 
     m_db, sStatement.c_str(), -1, &statement.pStmt, NULL );
   if ( SQLITE_OK != rtn ) {
@@ -134,6 +201,22 @@ void ISqlite3::ResetStatement( structStatementState& statement ) {
   }
 }
 
+void ISqlite3::ReleaseStatement( structStatementState& statement, const std::string& sStatement ) {
+  if ( 0 != statement.pStmt ) {
+    sqlite3_reset( statement.pStmt );  // returns the error of a failed step, if any, the statement is reset regardless
+    sqlite3_clear_bindings( statement.pStmt );
+    vStmt_t& v( m_mapStmtCache[ sStatement ] );
+    if ( nCachedPerStatement > v.size() ) {
+      v.push_back( statement.pStmt );
+    }
+    else {
+      sqlite3_finalize( statement.pStmt );
+    }
+    statement.pStmt = 0;
+    statement.bIsReset = true;
+  }
+}
+
 void ISqlite3::CloseStatement( structStatementState& statement ) {
   if ( 0 != statement.pStmt ) { // it shouldn't be zero, but test anyway
     int rtn = sqlite3_finalize( statement.pStmt );
@@ -15,6 +15,8 @@
 #pragma once
 
 #include <string>
+#include <map>
+#include <vector>
 
 //#include <OUSQL/SessionBase.h>  // for the enumerations
 #include <OUSQL/Constants.h>
@@ -50,10 +52,17 @@ public:
   void SessionOpen( const std::string& sDbFileName, enumOpenFlags = EOpenFlagsZero );
   void SessionClose( void );
 
+  void SetJournalMode( enumJournalMode );
+  void SetSynchronous( enumSynchronous );
+
+  void Exec( const std::string& sStatement );  // unprepared, no bindings and no rows, for transaction control
+
+  // prepared statements are cached by their text:  a statement released is reset and kept for the next prepare of the same text
   void PrepareStatement( structStatementState& statement, std::string& sStatement );
   bool ExecuteStatement( structStatementState& statement );  // true when row available
   void ResetStatement(   structStatementState& statement );
-  void CloseStatement(   structStatementState& statement );
+  void ReleaseStatement( structStatementState& statement, const std::string& sStatement );  // return to the cache, does not throw
+  void CloseStatement(   structStatementState& statement );  // finalize
 
   boost::int64_t GetLastRowId( void ) {
     return sqlite3_last_insert_rowid( m_db );
@@ -65,6 +74,10 @@ private:
 
   sqlite3* m_db;
 
+  typedef std::vector<sqlite3_stmt*> vStmt_t;
+  typedef std::map<std::string, vStmt_t> mapStmtCache_t;  // statement text to statements not in use
+  mapStmtCache_t m_mapStmtCache;
+
 };
 
 } // db
@@ -0,0 +1,250 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include "WriteBehind.h"
+
+namespace ou {
+namespace db {
+
+const size_t WriteBehind::c_nCommitAttempts = 3;
+
+WriteBehind::WriteBehind( Session& session, size_t nMaxQueued, size_t nMaxBatch )
+: m_session( session ),
+  m_nMaxQueued( 0 == nMaxQueued ? 1 : nMaxQueued ), m_nMaxBatch( 0 == nMaxBatch ? 1 : nMaxBatch ),
+  m_bStop( false ), m_bStopped( false ), m_nExclusive( 0 )
+{
+  m_thread = boost::thread( boost::bind( &WriteBehind::Run, this ) );
+}
+
+WriteBehind::~WriteBehind( void ) {
+  {
+    boost::mutex::scoped_lock lock( m_mutexQueue );
+    m_bStop = true;
+  }
+  m_cvWork.notify_one();
+  m_thread.join();  // the writer empties the queue before it exits, unless stopped
+  if ( !m_queue.empty() ) {
+    std::cout << "WriteBehind::~WriteBehind: " << m_queue.size() << " writes not committed, " << m_sError << std::endl;
+  }
+}
+
+void WriteBehind::Enqueue( const fWrite_t& f ) {
+  {
+    boost::mutex::scoped_lock lock( m_mutexQueue );
+    if ( m_bStopped ) {
+      throw std::runtime_error( "WriteBehind::Enqueue: stopped, " + m_sError );
+    }
+    if ( boost::this_thread::get_id() != m_idExclusive ) {
+      if ( m_nMaxQueued <= m_queue.size() ) {
+        ++m_stats.nStalls;
+        while ( ( m_nMaxQueued <= m_queue.size() ) && !m_bStopped ) m_cvSpace.wait( lock );
+        if ( m_bStopped ) {
+          throw std::runtime_error( "WriteBehind::Enqueue: stopped, " + m_sError );
+        }
+      }
+      m_queue.push_back( f );
+      ++m_stats.nEnqueued;
+      if ( m_stats.nMaxQueued < m_queue.size() ) m_stats.nMaxQueued = m_queue.size();
+      m_cvWork.notify_one();
+      return;
+    }
+    ++m_stats.nEnqueued;
+  }
+  // this thread holds the session, so the writer is waiting on it, write in place
+  queue_t queue;
+  queue.push_back( f );
+  Commit( queue );
+}
+
+bool WriteBehind::Flush( void ) {
+  Exclusive exclusive( this );  // commits everything queued so far
+  boost::mutex::scoped_lock lock( m_mutexQueue );
+  return !m_bStopped;
+}
+
+void WriteBehind::SetOnError( const fError_t& fError ) {
+  boost::mutex::scoped_lock lock( m_mutexQueue );
+  m_fError = fError;
+}
+
+bool WriteBehind::Stopped( void ) const {
+  boost::mutex::scoped_lock lock( m_mutexQueue );
+  return m_bStopped;
+}
+
+std::string WriteBehind::Error( void ) const {
+  boost::mutex::scoped_lock lock( m_mutexQueue );
+  return m_sError;
+}
+
+void WriteBehind::Restart( void ) {
+  {
+    boost::mutex::scoped_lock lock( m_mutexQueue );
+    m_bStopped = false;
+    m_sError.clear();
+  }
+  m_cvWork.notify_one();
+}
+
+WriteBehind::Stats WriteBehind::GetStats( void ) const {
+  boost::mutex::scoped_lock lock( m_mutexQueue );
+  Stats stats( m_stats );
+  stats.nQueued = m_queue.size();
+  return stats;
+}
+
+void WriteBehind::Run( void ) {
+  while ( true ) {
+    {
+      boost::mutex::scoped_lock lock( m_mutexQueue );
+      while ( ( m_queue.empty() || m_bStopped ) && !m_bStop ) m_cvWork.wait( lock );
+      if ( m_queue.empty() || m_bStopped ) break;  // stopping, and nothing left which can be written
+    }
+    // the batch is taken with the session held, so an Exclusive never misses writes taken but not yet made
+    boost::recursive_mutex::scoped_lock lockSession( m_mutexSession );
+    queue_t batch;
+    {
+      boost::mutex::scoped_lock lock( m_mutexQueue );
+      const size_t n( std::min<size_t>( m_nMaxBatch, m_queue.size() ) );
+      batch.insert( batch.end(), m_queue.begin(), m_queue.begin() + n );
+      m_queue.erase( m_queue.begin(), m_queue.begin() + n );
+    }
+    m_cvSpace.notify_all();
+    Commit( batch );
+  }
+}
+
+void WriteBehind::Commit( queue_t& queue ) {
+
+  if ( queue.empty() ) return;
+
+  std::string sError;
+  size_t nAttempt( 1 );
+  while ( !Write( queue, sError ) ) {
+    if ( c_nCommitAttempts == nAttempt ) {
+      // put the batch back, ahead of anything queued since, so nothing is lost or reordered
+      fError_t fError;
+      {
+        boost::mutex::scoped_lock lock( m_mutexQueue );
+        m_bStopped = true;
+        m_sError = sError;
+        m_queue.insert( m_queue.begin(), queue.begin(), queue.end() );
+        if ( m_stats.nMaxQueued < m_queue.size() ) m_stats.nMaxQueued = m_queue.size();
+        fError = m_fError;
+      }
+      m_cvSpace.notify_all();  // blocked enqueues see the stop
+      std::cout << "WriteBehind::Commit: stopped, " << queue.size() << " writes kept, " << sError << std::endl;
+      if ( fError ) fError( sError );
+      return;
+    }
+    {
+      boost::mutex::scoped_lock lock( m_mutexQueue );
+      ++m_stats.nRetries;
+    }
+    // the session stays held, so nothing else is written in between
+    boost::this_thread::sleep( boost::posix_time::milliseconds( 10 * nAttempt ) );
+    ++nAttempt;
+  }
+}
+
+bool WriteBehind::Write( queue_t& queue, std::string& sError ) {
+
+  const std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+
+  size_t nFailed( 0 );
+  bool bTransaction( true );
+  try {
+    m_session.BeginTransaction();  // a savepoint, when within a transaction of an Exclusive holder
+  }
+  catch ( std::exception& e ) {  // writes are still made, each then its own transaction
+    bTransaction = false;
+    std::cout << "WriteBehind::Write: begin " << e.what() << std::endl;
+  }
+  for ( queue_t::iterator iter = queue.begin(); queue.end() != iter; ++iter ) {
+    try {
+      ( *iter )( m_session );
+    }
+    catch ( std::exception& e ) {
+      ++nFailed;
+      std::cout << "WriteBehind::Write: " << e.what() << std::endl;
+    }
+    catch (...) {
+      ++nFailed;
+      std::cout << "WriteBehind::Write: unknown error" << std::endl;
+    }
+  }
+  if ( bTransaction ) {
+    try {
+      m_session.CommitTransaction();
+    }
+    catch ( std::exception& e ) {
+      sError = e.what();
+      std::cout << "WriteBehind::Write: commit " << e.what() << std::endl;
+      try {
+        m_session.RollbackTransaction();
+      }
+      catch ( std::exception& e ) {
+        std::cout << "WriteBehind::Write: rollback " << e.what() << std::endl;
+      }
+      return false;  // nothing of the batch was kept
+    }
+  }
+
+  const boost::uint64_t us( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count() );
+
+  boost::mutex::scoped_lock lock( m_mutexQueue );
+  m_stats.nCommitted += queue.size();
+  m_stats.nFailed += nFailed;
+  ++m_stats.nBatches;
+  if ( m_stats.usMaxBatch < us ) m_stats.usMaxBatch = us;
+  return true;
+}
+
+WriteBehind::Exclusive::Exclusive( WriteBehind* pWriteBehind )
+: m_pWriteBehind( pWriteBehind )
+{
+  if ( 0 != m_pWriteBehind ) {
+    m_pWriteBehind->m_mutexSession.lock();
+    queue_t queue;
+    {
+      boost::mutex::scoped_lock lock( m_pWriteBehind->m_mutexQueue );
+      if ( 0 == m_pWriteBehind->m_nExclusive ) m_pWriteBehind->m_idExclusive = boost::this_thread::get_id();
+      ++m_pWriteBehind->m_nExclusive;
+      if ( !m_pWriteBehind->m_bStopped ) queue.swap( m_pWriteBehind->m_queue );  // else kept for a Restart
+    }
+    m_pWriteBehind->m_cvSpace.notify_all();
+    m_pWriteBehind->Commit( queue );
+  }
+}
+
+WriteBehind::Exclusive::~Exclusive( void ) {
+  if ( 0 != m_pWriteBehind ) {
+    {
+      boost::mutex::scoped_lock lock( m_pWriteBehind->m_mutexQueue );
+      --m_pWriteBehind->m_nExclusive;
+      if ( 0 == m_pWriteBehind->m_nExclusive ) m_pWriteBehind->m_idExclusive = boost::thread::id();
+    }
+    m_pWriteBehind->m_mutexSession.unlock();
+  }
+}
+
+} // db
+} // ou
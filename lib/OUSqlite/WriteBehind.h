@@ -0,0 +1,121 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// write behind journal for a session:  writes are queued by the caller, typically a provider's
+//   callback thread, and made by a dedicated thread, batched into transactions
+// writes are committed in the order queued, a batch at a time
+// each write is a copy of the state at the time it was queued, not a reference to live objects
+// a full queue blocks the caller, the back pressure is counted in the stats
+// Exclusive hands the session to a caller, for reads and for inserts needing the row id:
+//   queued writes are committed first, so the caller sees them, and the writer waits until released
+// the session is not otherwise thread safe, anything else using it while the writer runs needs an Exclusive
+// a batch whose commit fails is rolled back and retried, after the last attempt the queue stops:
+//   the batch is put back at the front, nothing more is written, enqueues throw, and the owner's error
+//   handler is called, Restart resumes with the failed batch
+// destroy before closing the session, destruction flushes the queue, unless stopped
+
+#include <deque>
+#include <string>
+#include <functional>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "Session.h"
+
+namespace ou {
+namespace db {
+
+class WriteBehind {
+public:
+
+  typedef std::function<void( Session& )> fWrite_t;
+  typedef std::function<void( const std::string& )> fError_t;
+
+  struct Stats {
+    size_t nQueued;  // waiting to be written
+    size_t nMaxQueued;  // high water mark
+    boost::uint64_t nEnqueued;
+    boost::uint64_t nCommitted;  // includes those failed
+    boost::uint64_t nFailed;  // writes which threw, the rest of their batch is still committed
+    boost::uint64_t nBatches;  // transactions
+    boost::uint64_t nRetries;  // commits attempted again
+    boost::uint64_t nStalls;  // enqueues which waited on a full queue
+    boost::uint64_t usMaxBatch;  // longest transaction, begin to commit
+    Stats( void ): nQueued( 0 ), nMaxQueued( 0 ), nEnqueued( 0 ), nCommitted( 0 ), nFailed( 0 ),
+      nBatches( 0 ), nRetries( 0 ), nStalls( 0 ), usMaxBatch( 0 ) {};
+  };
+
+  WriteBehind( Session& session, size_t nMaxQueued = 10000, size_t nMaxBatch = 500 );
+  ~WriteBehind( void );
+
+  void Enqueue( const fWrite_t& );  // throws when stopped
+  bool Flush( void );  // returns once all writes queued before the call are committed, false if stopped instead
+
+  // called on the thread whose commit failed, with the session held, so it should not wait on other threads
+  void SetOnError( const fError_t& );
+  bool Stopped( void ) const;
+  std::string Error( void ) const;  // of the commit which stopped the queue
+  void Restart( void );  // after the cause of the failure has been dealt with
+
+  Stats GetStats( void ) const;
+
+  class Exclusive {  // a null WriteBehind is accepted, so callers needn't test for one
+  public:
+    explicit Exclusive( WriteBehind* );
+    ~Exclusive( void );
+  private:
+    WriteBehind* m_pWriteBehind;
+  };
+
+protected:
+private:
+
+  typedef std::deque<fWrite_t> queue_t;
+
+  static const size_t c_nCommitAttempts;
+
+  Session& m_session;
+  const size_t m_nMaxQueued;
+  const size_t m_nMaxBatch;
+
+  boost::recursive_mutex m_mutexSession;  // held by the writer for a batch, and by an Exclusive
+
+  mutable boost::mutex m_mutexQueue;  // guards the queue, the stats and the exclusive owner
+  boost::condition_variable m_cvWork;
+  boost::condition_variable m_cvSpace;
+  queue_t m_queue;
+  Stats m_stats;
+  bool m_bStop;
+  bool m_bStopped;  // by a failed commit
+  std::string m_sError;
+  fError_t m_fError;
+  boost::thread::id m_idExclusive;  // thread holding the session, its enqueues are written in place
+  size_t m_nExclusive;  // nesting depth
+
+  boost::thread m_thread;
+
+  void Run( void );
+  void Commit( queue_t& );  // with the session held, retries, stops the queue on failure
+  bool Write( queue_t&, std::string& sError );  // with the session held, false when the commit failed
+
+};
+
+} // db
+} // ou
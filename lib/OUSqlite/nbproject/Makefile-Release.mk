@@ -38,6 +38,7 @@ OBJECTFILES= \
 	${OBJECTDIR}/Actions.o \
 	${OBJECTDIR}/ISqlite3.o \
 	${OBJECTDIR}/Session.o \
+	${OBJECTDIR}/WriteBehind.o \
 	${OBJECTDIR}/sqlite3.o
 
 
@@ -82,6 +83,11 @@ ${OBJECTDIR}/Session.o: Session.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Session.o Session.cpp
 
+${OBJECTDIR}/WriteBehind.o: WriteBehind.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/WriteBehind.o WriteBehind.cpp
+
 ${OBJECTDIR}/sqlite3.o: sqlite3.c
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -28,6 +28,7 @@
 #include <fstream>
 
 #include "MarketSymbol.h"
+#include "OptionChainIndex.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
@@ -94,6 +95,7 @@ public:
     bool bReturn = false;
     if ( m_symbols.get<ixSymbol>().end() != iter ) {
       const_cast<std::string&>( iter->sUnderlying ) = sUnderlying;
+      m_chains.Clear();
     }
   }
 
@@ -104,14 +106,28 @@ public:
   }
 
   void LoadFromFile( const std::string& sFilename ) {
-    m_symbols.clear();
+    Clear();
     std::ifstream ifs( sFilename, std::ios::binary );
     if ( ifs ) {
       boost::archive::binary_iarchive ia(ifs);
       ia >> boost::serialization::make_nvp( "symbols", *this );
     }
+    BuildOptionChains();
   }
 
+  // call once the list is complete, LoadFromFile calls it, modifying the list clears the index
+  void BuildOptionChains( void ) {
+    m_chains.Clear();
+    typedef symbols_t::index<ixUnderlying>::type SymbolsByUnderlying_t;
+    const SymbolsByUnderlying_t& ix( m_symbols.get<ixUnderlying>() );
+    for ( SymbolsByUnderlying_t::const_iterator iter = ix.begin(); ix.end() != iter; ++iter ) {
+      m_chains.Add( *iter );
+    }
+    m_chains.Build();
+  }
+
+  const OptionChainIndex& OptionChains( void ) const { return m_chains; }
+
   const trd_t& GetTrd( const std::string& sName ) const {
     typedef symbols_t::index<ixSymbol>::type ixSymbol_t;
     ixSymbol_t::const_iterator endSymbols = m_symbols.get<ixSymbol>().end();
@@ -135,8 +151,13 @@ public:
   }
 
   // requires index by underlying, which may be taking up mucho room, actually doesn't
+  // served from the option chain index when built:  calls and puts only, by expiry and strike
   template<typename Function>
   void SelectOptionsByUnderlying( const std::string& sUnderlying, Function f ) const {
+    if ( m_chains.Built() ) {
+      m_chains.SelectOptions( sUnderlying, f );
+      return;
+    }
     typedef symbols_t::index<ixUnderlying>::type SymbolsByUnderlying_t;
     SymbolsByUnderlying_t::const_iterator endSymbols = m_symbols.get<ixUnderlying>().end();
     for ( SymbolsByUnderlying_t::const_iterator iter = m_symbols.get<ixUnderlying>().find( sUnderlying ); endSymbols != iter; ++iter ) {
@@ -171,20 +192,23 @@ public:
 
   void InsertParsedStructure( const trd_t& trd ) {
     m_symbols.insert( trd );
+    m_chains.Clear();
   }
 
   void operator()( const trd_t& trd ) {
     m_symbols.insert( trd );
+    m_chains.Clear();
   }
 
-  void Clear( void ) { m_symbols.clear(); };
+  void Clear( void ) { m_symbols.clear(); m_chains.Clear(); };
 
 protected:
 private:
 
   symbols_t m_symbols;
+  OptionChainIndex m_chains;  // points into m_symbols
 
-  void insert( trd_t& trd ) { m_symbols.insert( trd ); };
+  void insert( trd_t& trd ) { m_symbols.insert( trd ); m_chains.Clear(); };
 
   /* serialization support */
 
@@ -114,6 +114,8 @@ void LoadMktSymbols( InMemoryMktSymbolList& symbols, MktSymbolLoadType::Enum e,
   validator.PostProcess();
   validator.Summary();
 
+  symbols.BuildOptionChains();  // underlyings are final once post processed
+
 }
 
 } // namespace iqfeed
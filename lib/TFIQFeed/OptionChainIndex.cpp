@@ -0,0 +1,160 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include <algorithm>
+
+#include "OptionChainIndex.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace iqfeed { // IQFeed
+
+namespace {
+
+  typedef OptionChainIndex::trd_t trd_t;
+
+  inline unsigned long ExpiryKey( const trd_t& trd ) {  // yyyymmdd, orders as the date does
+    return ( (unsigned long) trd.nYear * 100 + trd.nMonth ) * 100 + trd.nDay;
+  }
+
+  struct CompareUnderlying {
+    bool operator()( const trd_t* lhs, const trd_t* rhs ) const { return lhs->sUnderlying < rhs->sUnderlying; };
+  };
+
+  inline int SideKey( const trd_t& trd ) {  // calls first
+    return ou::tf::OptionSide::Call == trd.eOptionSide ? 0 : 1;
+  }
+
+  struct CompareContract {  // within an underlying, a total order, so duplicates land the same way each build
+    bool operator()( const trd_t* lhs, const trd_t* rhs ) const {
+      const unsigned long keyLhs( ExpiryKey( *lhs ) );
+      const unsigned long keyRhs( ExpiryKey( *rhs ) );
+      if ( keyLhs != keyRhs ) return keyLhs < keyRhs;
+      if ( lhs->dblStrike != rhs->dblStrike ) return lhs->dblStrike < rhs->dblStrike;
+      const int sideLhs( SideKey( *lhs ) );
+      const int sideRhs( SideKey( *rhs ) );
+      if ( sideLhs != sideRhs ) return sideLhs < sideRhs;
+      return lhs->sSymbol < rhs->sSymbol;
+    }
+  };
+
+  struct CompareStrike {
+    bool operator()( const OptionChainIndex::Strike& lhs, double rhs ) const { return lhs.dblStrike < rhs; };
+    bool operator()( double lhs, const OptionChainIndex::Strike& rhs ) const { return lhs < rhs.dblStrike; };
+  };
+
+  struct CompareExpiry {
+    bool operator()( const OptionChainIndex::Expiry& lhs, const boost::gregorian::date& rhs ) const { return lhs.date < rhs; };
+  };
+
+  struct CompareChain {
+    bool operator()( const OptionChainIndex::Chain& lhs, const std::string& rhs ) const { return lhs.sUnderlying < rhs; };
+  };
+
+}
+
+const OptionChainIndex::Strike* OptionChainIndex::Expiry::Find( double dblStrike ) const {
+  vStrike_t::const_iterator iter = std::lower_bound( vStrike.begin(), vStrike.end(), dblStrike, CompareStrike() );
+  if ( ( vStrike.end() == iter ) || ( dblStrike != iter->dblStrike ) ) return nullptr;
+  return &( *iter );
+}
+
+const OptionChainIndex::Strike* OptionChainIndex::Expiry::FindAtOrBelow( double dblStrike ) const {
+  vStrike_t::const_iterator iter = std::upper_bound( vStrike.begin(), vStrike.end(), dblStrike, CompareStrike() );
+  if ( vStrike.begin() == iter ) return nullptr;
+  --iter;
+  return &( *iter );
+}
+
+const OptionChainIndex::Expiry* OptionChainIndex::Chain::Find( boost::gregorian::date date ) const {
+  vExpiry_t::const_iterator iter = std::lower_bound( vExpiry.begin(), vExpiry.end(), date, CompareExpiry() );
+  if ( ( vExpiry.end() == iter ) || ( date != iter->date ) ) return nullptr;
+  return &( *iter );
+}
+
+OptionChainIndex::OptionChainIndex( void ): m_bBuilt( false ) {
+}
+
+OptionChainIndex::~OptionChainIndex( void ) {
+}
+
+void OptionChainIndex::Clear( void ) {
+  m_vListing.clear();
+  m_vChain.clear();
+  m_bBuilt = false;
+}
+
+void OptionChainIndex::Add( const trd_t& trd ) {
+  if ( trd.sUnderlying.empty() ) return;
+  if ( ( ou::tf::OptionSide::Call != trd.eOptionSide ) && ( ou::tf::OptionSide::Put != trd.eOptionSide ) ) return;
+  if ( ( 0 == trd.nYear ) || ( 0 == trd.nMonth ) || ( 0 == trd.nDay ) ) return;
+  if ( m_bBuilt ) {  // the strikes point into the listings, rebuilt by the next Build
+    m_vChain.clear();
+    m_bBuilt = false;
+  }
+  m_vListing.push_back( &trd );
+}
+
+// group by underlying, which is already so when added from the list's underlying index,
+//   sort each group by expiry, strike, side and symbol, then a single pass lays out the nested arrays
+void OptionChainIndex::Build( void ) {
+
+  m_vChain.clear();
+  if ( !std::is_sorted( m_vListing.begin(), m_vListing.end(), CompareUnderlying() ) ) {
+    std::stable_sort( m_vListing.begin(), m_vListing.end(), CompareUnderlying() );
+  }
+  for ( vListing_t::iterator iterBegin = m_vListing.begin(); m_vListing.end() != iterBegin; ) {
+    vListing_t::iterator iterEnd( iterBegin );
+    while ( ( m_vListing.end() != iterEnd ) && ( ( *iterEnd )->sUnderlying == ( *iterBegin )->sUnderlying ) ) ++iterEnd;
+    std::sort( iterBegin, iterEnd, CompareContract() );
+    iterBegin = iterEnd;
+  }
+  m_vListing.shrink_to_fit();  // final, the strikes point into it
+
+  unsigned long keyExpiry( 0 );
+  for ( vListing_t::const_iterator iter = m_vListing.begin(); m_vListing.end() != iter; ++iter ) {
+    const trd_t& trd( **iter );
+    iterator pListing( &( *iter ) );
+    if ( m_vChain.empty() || ( trd.sUnderlying != m_vChain.back().sUnderlying ) ) {
+      m_vChain.push_back( Chain( trd.sUnderlying ) );
+      keyExpiry = 0;
+    }
+    vExpiry_t& vExpiry( m_vChain.back().vExpiry );
+    const unsigned long key( ExpiryKey( trd ) );
+    if ( key != keyExpiry ) {
+      vExpiry.push_back( Expiry( boost::gregorian::date( trd.nYear, trd.nMonth, trd.nDay ) ) );
+      keyExpiry = key;
+    }
+    vStrike_t& vStrike( vExpiry.back().vStrike );
+    if ( vStrike.empty() || ( trd.dblStrike != vStrike.back().dblStrike ) ) {
+      vStrike.push_back( Strike( trd.dblStrike ) );
+      vStrike.back().beginCall = vStrike.back().beginPut = pListing;
+    }
+    Strike& strike( vStrike.back() );
+    if ( ou::tf::OptionSide::Call == trd.eOptionSide ) strike.beginPut = pListing + 1;  // calls sort ahead of puts
+    strike.endPut = pListing + 1;
+  }
+
+  m_bBuilt = true;
+}
+
+const OptionChainIndex::Chain* OptionChainIndex::Find( const std::string& sUnderlying ) const {
+  vChain_t::const_iterator iter = std::lower_bound( m_vChain.begin(), m_vChain.end(), sUnderlying, CompareChain() );
+  if ( ( m_vChain.end() == iter ) || ( sUnderlying != iter->sUnderlying ) ) return nullptr;
+  return &( *iter );
+}
+
+} // namespace iqfeed
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,110 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// option chains of a symbol list:  underlying -> expiry -> strike -> calls/puts,
+//   each level a sorted flat array, so a chain is one binary search and a strike another
+// a strike keeps every listing of each side, such as SPX and SPXW sharing an expiry, or an adjusted root,
+//   as a range of records ordered by symbol name
+// built once, after the list is loaded, entries point into the list, so the list is not
+//   to be modified while the index is in use, InMemoryMktSymbolList clears it when it is
+
+#include <string>
+#include <vector>
+
+#include <boost/date_time/gregorian/gregorian_types.hpp>
+
+#include "MarketSymbol.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace iqfeed { // IQFeed
+
+class OptionChainIndex {
+public:
+
+  typedef ou::tf::iqfeed::MarketSymbol::TableRowDef trd_t;
+
+  typedef const trd_t* const* iterator;  // over listings
+
+  struct Strike {
+    double dblStrike;
+    iterator beginCall;
+    iterator beginPut;  // also the end of the calls
+    iterator endPut;
+    explicit Strike( double dblStrike_ ): dblStrike( dblStrike_ ), beginCall( nullptr ), beginPut( nullptr ), endPut( nullptr ) {};
+    size_t Calls( void ) const { return beginPut - beginCall; };
+    size_t Puts( void ) const { return endPut - beginPut; };
+    const trd_t* Call( void ) const { return Calls() ? *beginCall : nullptr; };  // the first by symbol name, nullptr when not listed
+    const trd_t* Put( void ) const { return Puts() ? *beginPut : nullptr; };
+  };
+  typedef std::vector<Strike> vStrike_t;  // ascending
+
+  struct Expiry {
+    boost::gregorian::date date;
+    vStrike_t vStrike;
+    explicit Expiry( boost::gregorian::date date_ ): date( date_ ) {};
+    const Strike* Find( double dblStrike ) const;  // nullptr when not listed
+    const Strike* FindAtOrBelow( double dblStrike ) const;  // nullptr when below the lowest
+  };
+  typedef std::vector<Expiry> vExpiry_t;  // ascending
+
+  struct Chain {
+    std::string sUnderlying;
+    vExpiry_t vExpiry;
+    explicit Chain( const std::string& sUnderlying_ ): sUnderlying( sUnderlying_ ) {};
+    const Expiry* Find( boost::gregorian::date ) const;  // nullptr when not listed
+  };
+  typedef std::vector<Chain> vChain_t;  // ascending by underlying
+
+  OptionChainIndex( void );
+  ~OptionChainIndex( void );
+
+  void Clear( void );
+  void Add( const trd_t& );  // options are collected, others ignored, call Build once all are added
+  void Build( void );
+
+  bool Built( void ) const { return m_bBuilt; };
+  vChain_t::size_type Size( void ) const { return m_vChain.size(); };
+
+  const Chain* Find( const std::string& sUnderlying ) const;  // nullptr when no options
+
+  // each option of the underlying, by expiry then strike, calls before puts, each side by symbol name
+  template<typename Function>
+  void SelectOptions( const std::string& sUnderlying, Function f ) const {
+    const Chain* pChain( Find( sUnderlying ) );
+    if ( nullptr == pChain ) return;
+    for ( vExpiry_t::const_iterator iterExpiry = pChain->vExpiry.begin(); pChain->vExpiry.end() != iterExpiry; ++iterExpiry ) {
+      for ( vStrike_t::const_iterator iterStrike = iterExpiry->vStrike.begin(); iterExpiry->vStrike.end() != iterStrike; ++iterStrike ) {
+        for ( iterator iter = iterStrike->beginCall; iterStrike->endPut != iter; ++iter ) {
+          f( **iter );
+        }
+      }
+    }
+  }
+
+protected:
+private:
+
+  typedef std::vector<const trd_t*> vListing_t;
+  vListing_t m_vListing;  // added, then sorted by Build, which points the strikes into it
+  vChain_t m_vChain;
+  bool m_bBuilt;
+
+};
+
+} // namespace iqfeed
+} // namespace tf
+} // namespace ou
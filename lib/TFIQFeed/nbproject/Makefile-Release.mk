@@ -47,6 +47,7 @@ OBJECTFILES= \
 	${OBJECTDIR}/MarketSymbol.o \
 	${OBJECTDIR}/MarketSymbols.o \
 	${OBJECTDIR}/Option.o \
+	${OBJECTDIR}/OptionChainIndex.o \
 	${OBJECTDIR}/OptionChainQuery.o \
 	${OBJECTDIR}/ParseMktSymbolDiskFile.o \
 	${OBJECTDIR}/ParseMktSymbolLine.o \
@@ -140,6 +141,11 @@ ${OBJECTDIR}/Option.o: Option.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Option.o Option.cpp
 
+${OBJECTDIR}/OptionChainIndex.o: OptionChainIndex.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/OptionChainIndex.o OptionChainIndex.cpp
+
 ${OBJECTDIR}/OptionChainQuery.o: OptionChainQuery.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -19,6 +19,8 @@
 
 #include <algorithm>
 
+#include <boost/serialization/access.hpp>
+
 #include <TFTimeSeries/DatedDatum.h>
 
 namespace ou { // One Unified
@@ -48,6 +50,10 @@ public:
     ResetState(); 
     m_dblTop = m_dblBottom = m_dblStop = m_dblGhostHeight = m_cntBreakOuts = 0;
   };
+  double Top( void ) const { return m_dblTop; };
+  double Bottom( void ) const { return m_dblBottom; };
+  double Stop( void ) const { return m_dblStop; };
+  bool BoxFound( void ) const { return ( ETopFound == m_stateTop ) && ( EBottomFound == m_stateBottom ); };
 protected:
   void ConservativeTrigger( void ) {};
   void AggressiveTrigger( void ) {};
@@ -71,6 +77,14 @@ private:
   } m_stateBottom;
 
   void ResetState( void );
+
+  // box state only, a restored Darvas continues with Calc on the bars following the last one it saw
+  friend class boost::serialization::access;
+  template<class Archive>
+  void serialize( Archive& ar, const unsigned int ) {
+    ar & m_dblTop & m_dblBottom & m_dblStop & m_dblGhostHeight & m_cntBreakOuts;
+    ar & m_stateTop & m_stateBottom;
+  }
     
 };
 
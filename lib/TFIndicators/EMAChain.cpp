@@ -0,0 +1,104 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include "stdafx.h"
+
+#include <math.h>
+
+#include "EMAChain.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace hf { // high frequency
+
+namespace {
+  // identical time stamps are treated as one microsecond apart, so alpha is never zero
+  double TimeStep( ptime dt, ptime dtPrevious ) {
+    static const time_duration tdOne( microseconds( 1 ) );
+    time_duration tdDif = dt == dtPrevious ? tdOne : dt - dtPrevious;
+    return (double) tdDif.total_microseconds();
+  }
+}
+
+// ==== EMA
+
+EMA::EMA( time_duration td )
+: m_dtPrevious( not_a_date_time ), m_pRecord( nullptr )
+{
+  assert( 0 < td.total_microseconds() );
+  m_dblTimeRange = (double) td.total_microseconds();
+}
+
+double EMA::Update( ptime dt, double XatT ) {
+  if ( m_dtPrevious.is_not_a_date_time() ) {
+    m_state.Init( XatT );  // initialize with first element
+  }
+  else {
+    EMAWeights w;
+    w.Calc( TimeStep( dt, m_dtPrevious ), m_dblTimeRange );
+    m_state.Step( w, XatT );
+  }
+  m_dtPrevious = dt;
+  if ( nullptr != m_pRecord ) {
+    m_pRecord->Append( Price( dt, m_state.ema ) );
+  }
+  return m_state.ema;
+}
+
+// ==== EMAChain
+
+EMAChain::EMAChain( time_duration td, unsigned int nLevels, ETau eTau )
+: m_dtPrevious( not_a_date_time ), m_dblMA( 0.0 ), m_vState( nLevels ), m_pRecord( nullptr )
+{
+  assert( 0 < td.total_microseconds() );
+  assert( 0 < nLevels );
+  switch ( eTau ) {
+    case ETau::AsIs:
+      m_dblTimeRange = (double) td.total_microseconds();
+      break;
+    case ETau::MovingAverage:
+      // whole microseconds, as the chained TSEMA objects TSMA used before calculated it
+      m_dblTimeRange = (double) ( ( 2 * td.total_microseconds() ) / ( nLevels + 1 ) );
+      break;
+  }
+}
+
+double EMAChain::Update( ptime dt, double XatT ) {
+  if ( m_dtPrevious.is_not_a_date_time() ) {
+    for ( EMAState& state: m_vState ) {
+      state.Init( XatT );
+    }
+    m_dblMA = XatT;
+  }
+  else {
+    EMAWeights w;
+    w.Calc( TimeStep( dt, m_dtPrevious ), m_dblTimeRange );
+    double sum( 0.0 );
+    double x( XatT );
+    for ( EMAState& state: m_vState ) {
+      x = state.Step( w, x );  // output of one level is input to the next
+      sum += x;
+    }
+    m_dblMA = sum / m_vState.size();
+  }
+  m_dtPrevious = dt;
+  if ( nullptr != m_pRecord ) {
+    m_pRecord->Append( Price( dt, m_dblMA ) );
+  }
+  return m_dblMA;
+}
+
+} // namespace hf
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,102 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// EMA operators on irregularly spaced time series, without a time series of their own
+// refer to paper : "Specially Weighted Movng Averages With Repeated Application of the EMA Operator"
+//   Intro to HF Finance, pg 59-61:  EMA[tau], iterated EMA[tau,n], MA[tau,n]
+// state is a few doubles per level, nothing is allocated per update
+// a Prices series can optionally be attached to record results
+
+#include <cmath>
+#include <cassert>
+#include <vector>
+
+#include <TFTimeSeries/TimeSeries.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace hf { // high frequency
+
+// interpolation weights for one time step, shared by every level using the same tau
+struct EMAWeights {
+  double mu;  // decay of previous ema
+  double v;   // linear interpolation weight
+  EMAWeights( void ): mu( 0.0 ), v( 0.0 ) {};
+  void Calc( double dblTimeStep, double dblTimeRange ) {
+    double alpha = dblTimeStep / dblTimeRange;
+    mu = std::exp( -alpha );  // used with any form of interpolation
+    v = ( 1.0 - mu ) / alpha;  // linear interpolation
+    //v = 1.0;  // previous point 
+    //v = std::exp( -alpha / 2.0 ); // or std::sqrt( mu );  // nearest value
+    //v = mu;  // next point
+  }
+};
+
+// one level of the operator
+struct EMAState {
+  double ema;
+  double XatTminus1;  // previous input, needed for the linear interpolation
+  EMAState( void ): ema( 0.0 ), XatTminus1( 0.0 ) {};
+  void Init( double XatT ) { ema = XatT; XatTminus1 = XatT; };
+  double Step( const EMAWeights& w, double XatT ) {
+    ema = w.mu * ema + ( w.v - w.mu ) * XatTminus1 + ( 1.0 - w.v ) * XatT; // ema calc
+    XatTminus1 = XatT;
+    return ema;
+  }
+};
+
+// EMA[tau]
+class EMA {
+public:
+  EMA( time_duration td );
+  double Update( ptime dt, double XatT );
+  double Value( void ) const { return m_state.ema; };
+  void Record( Prices* pPrices ) { m_pRecord = pPrices; };  // nullptr to stop recording
+  void Reset( void ) { m_dtPrevious = not_a_date_time; };
+protected:
+private:
+  double m_dblTimeRange;  // microseconds
+  ptime m_dtPrevious;
+  EMAState m_state;
+  Prices* m_pRecord;
+};
+
+// EMA[tau,1] through EMA[tau,n], evaluated as one fused pass per update:
+//   the weights are calculated once, and each level feeds the next
+// MA[tau,n] is the average of the levels, with tau' = 2 tau / ( n + 1 ) (eq 3.56, pg 61)
+class EMAChain {
+public:
+  enum class ETau { AsIs, MovingAverage };  // MovingAverage: td is the MA range, levels use tau'
+  EMAChain( time_duration td, unsigned int nLevels, ETau eTau = ETau::AsIs );
+  double Update( ptime dt, double XatT );  // returns MA()
+  unsigned int Levels( void ) const { return m_vState.size(); };
+  double Level( unsigned int nLevel ) const { assert( ( 0 < nLevel ) && ( nLevel <= m_vState.size() ) ); return m_vState[ nLevel - 1 ].ema; };  // EMA[tau,nLevel]
+  double Iterated( void ) const { return m_vState.back().ema; };  // EMA[tau,n]
+  double MA( void ) const { return m_dblMA; };  // average over levels 1..n
+  void Record( Prices* pPrices ) { m_pRecord = pPrices; };  // records MA(), nullptr to stop recording
+  void Reset( void ) { m_dtPrevious = not_a_date_time; };
+protected:
+private:
+  double m_dblTimeRange;  // microseconds, per level
+  ptime m_dtPrevious;
+  double m_dblMA;
+  std::vector<EMAState> m_vState;  // sized once at construction
+  Prices* m_pRecord;
+};
+
+} // namespace hf
+} // namespace tf
+} // namespace ou
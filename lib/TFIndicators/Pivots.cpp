@@ -29,6 +29,20 @@ const ou::Colour::enumColour PivotSet::m_rPivotColours[ PivotSet::PivotCount ]
       ou::Colour::DarkRed, 
       ou::Colour::BlueViolet, ou::Colour::Blue, ou::Colour::RoyalBlue, ou::Colour::Purple, ou::Colour::SkyBlue, ou::Colour::Violet };
 
+void PivotRange::Add( const Bar& bar ) {
+  if ( 0 == m_cntBars ) {
+    m_dblHi = bar.High();
+    m_dblLo = bar.Low();
+  }
+  else {
+    m_dblHi = std::max<double>( m_dblHi, bar.High() );
+    m_dblLo = std::min<double>( m_dblLo, bar.Low() );
+  }
+  m_dblClose = bar.Close();
+  m_dtLast = bar.DateTime();
+  ++m_cntBars;
+}
+
 PivotSet::PivotSet(void) 
  {
    for ( unsigned short ix = 0; ix < PivotCount; ++ix ) {
@@ -54,24 +68,16 @@ PivotSet::PivotSet( const std::string &sName, const Bar& bar ) {
 }
 
 PivotSet::PivotSet( const std::string &sName, Bars* bars ) {
-  double hi = 0;
-  double lo = 0;
-  double cl = 0;
+  PivotRange range;
   size_t cnt = bars->Size();
-  //const Bar* pBar;
-  if ( cnt > 0 ) {
-    const Bar& bar0( bars->At( 0 ) );
-    hi = bar0.High();
-    lo = bar0.Low();
-    cl = bar0.Close();
-    for ( unsigned int i = 1; i < cnt; i++ ) {
-      const Bar& bar( bars->At( i ) );
-      hi = std::max<double>( hi, bar.High() );
-      lo = std::min<double>( lo, bar.Low() );
-      cl = bar.Close();
-    }
+  for ( unsigned int i = 0; i < cnt; i++ ) {
+    range.Add( bars->At( i ) );
   }
-  CalcPivots( sName, hi, lo, cl );
+  CalcPivots( sName, range.High(), range.Low(), range.Close() );
+}
+
+PivotSet::PivotSet( const std::string &sName, const PivotRange& range ) {
+  CalcPivots( sName, range.High(), range.Low(), range.Close() );
 }
 
 PivotSet::PivotSet( const std::string &sName, double Hi, double Lo, double Close ) {
@@ -17,6 +17,9 @@
 #include <string>
 #include <utility>
 
+#include <boost/serialization/access.hpp>
+#include <boost/date_time/posix_time/time_serialize.hpp>
+
 #include <OUCommon/Colour.h>
 
 #include <TFTimeSeries/TimeSeries.h>
@@ -24,6 +27,33 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
+// running high/low/close of a span of bars,
+//   extended one bar at a time so a pivot set over a long span needn't rescan the span
+class PivotRange {
+public:
+  PivotRange( void ): m_dblHi( 0 ), m_dblLo( 0 ), m_dblClose( 0 ), m_cntBars( 0 ) {};
+  void Add( const Bar& bar );
+  void Reset( void ) { m_dblHi = m_dblLo = m_dblClose = 0; m_cntBars = 0; };
+  double High( void ) const { return m_dblHi; };
+  double Low( void ) const { return m_dblLo; };
+  double Close( void ) const { return m_dblClose; };
+  const ptime& DateTime( void ) const { return m_dtLast; };  // of last bar added
+  size_t Count( void ) const { return m_cntBars; };
+protected:
+private:
+  double m_dblHi;
+  double m_dblLo;
+  double m_dblClose;
+  ptime m_dtLast;
+  size_t m_cntBars;
+
+  friend class boost::serialization::access;
+  template<class Archive>
+  void serialize( Archive& ar, const unsigned int ) {
+    ar & m_dblHi & m_dblLo & m_dblClose & m_dtLast & m_cntBars;
+  }
+};
+
 class PivotSet {
 public:
 
@@ -42,6 +72,7 @@ public:
   PivotSet( const std::string &sName, double Hi, double Lo, double Close );
   PivotSet( const std::string &sName, const Bar& bar );
   PivotSet( const std::string &sName, Bars* bars );
+  PivotSet( const std::string &sName, const PivotRange& range );
   // add in  a constructor with bar iterators, can then do pivot for weekly bar set or monthly bar set, etc
 
   virtual ~PivotSet(void);
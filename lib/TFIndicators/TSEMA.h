@@ -20,6 +20,8 @@
 
 #include <TFTimeSeries/TimeSeries.h>
 
+#include "EMAChain.h"
+
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 namespace hf { // high frequency
@@ -34,10 +36,9 @@ public:
 protected:
 private:
   time_duration m_tdTimeRange;
-  double m_dblTimeRange;
   TimeSeries<D>& m_seriesSource;
-  double m_XatTminus1;
   double m_dblRecentEMA;
+  ou::tf::hf::EMA m_ema;
 
   double EMA( ptime t, double XatT );
 
@@ -83,17 +84,16 @@ private:
 
 template<class D>
 TSEMA<D>::TSEMA( TimeSeries<D>& series, time_duration td )
-  : Prices(), m_seriesSource( series ), m_tdTimeRange( td ), m_XatTminus1( 0.0 ), m_dblRecentEMA( 0.0 )
+  : Prices(), m_seriesSource( series ), m_tdTimeRange( td ), m_dblRecentEMA( 0.0 ), m_ema( td )
 {
   assert( 0 < td.total_seconds() );
-  m_dblTimeRange = (double) td.total_microseconds();
   m_seriesSource.OnAppend.Add( MakeDelegate( this, &TSEMA<D>::HandleAppend ) );
 }
 
 template<class D>
 TSEMA<D>::TSEMA( const TSEMA<D>& rhs ) 
-  : Prices(), m_tdTimeRange( rhs.m_tdTimeRange ), m_dblTimeRange( rhs.m_dblTimeRange ), m_seriesSource( rhs.m_seriesSource ),
-  m_XatTminus1( rhs.m_XatTminus1 ), m_dblRecentEMA( rhs.m_dblRecentEMA )
+  : Prices(), m_tdTimeRange( rhs.m_tdTimeRange ), m_seriesSource( rhs.m_seriesSource ),
+  m_dblRecentEMA( rhs.m_dblRecentEMA ), m_ema( rhs.m_ema )
 {
   m_seriesSource.OnAppend.Add( MakeDelegate( this, &TSEMA<D>::HandleAppend ) );
 }
@@ -103,32 +103,12 @@ TSEMA<D>::~TSEMA( void ) {
   m_seriesSource.OnAppend.Remove( MakeDelegate( this, &TSEMA<D>::HandleAppend ) );
 }
 
-// refer to paper : "Specially Weighted Movng Averages With Repeated Application of the EMA Operator"
-// Intro to HF Finance, pg 59, has further variation
+// calculation is in hf::EMA (EMAChain.h), this adds the time series of results
 template<class D>
 double TSEMA<D>::EMA( ptime t, double XatT ) {
-  static const time_duration tdOne( microseconds( 1 ) );
-  if ( 0 == Prices::Size() ) {
-    m_dblRecentEMA = XatT;
-    m_XatTminus1 = XatT;
-    Prices::Append( Price( t, XatT ) );  // initialize first element of series
-  }
-  else { 
-    const Price& prvEMA( Prices::Ago( 0 ) );
-    ptime dtPrv = prvEMA.DateTime();
-    time_duration tdDif = t == dtPrv ? tdOne : t - dtPrv;
-    double alpha = ( (double) tdDif.total_microseconds() ) / m_dblTimeRange;
-    double mu = std::exp( -alpha );  // used with any form of interpolation
-    double v = ( 1.0 - mu ) / alpha;  // linear interpolation
-    //double v = 1.0;  // previous point 
-    //double v = std::exp( -alpha / 2.0 ); // or std::sqrt( mu );  // nearest value
-    //double v = mu;  // next point
-    m_dblRecentEMA = mu * prvEMA.Value() + ( v - mu ) * m_XatTminus1 + ( 1.0 - v ) * XatT; // ema calc
-    m_XatTminus1 = XatT;
-    Prices::Append( Price( t, m_dblRecentEMA ) );
-  }
+  m_dblRecentEMA = m_ema.Update( t, XatT );
+  Prices::Append( Price( t, m_dblRecentEMA ) );
   return m_dblRecentEMA;
-
 }
 
 } // namespace hf
@@ -14,9 +14,9 @@
 
 #pragma once
 
-#include <vector>
+#include <TFTimeSeries/TimeSeries.h>
 
-#include "TSEMA.h"
+#include "EMAChain.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
@@ -37,7 +37,7 @@ private:
   unsigned int m_nSup;
   double m_dblRecentMA;
   Prices& m_seriesSource;
-  std::vector<TSEMA<Price>*> m_vEMA;
+  EMAChain m_chain;  // levels 1..n with tau', as one fused pass
   void Initialize( void );
   void HandleUpdate( const Price& );
 };
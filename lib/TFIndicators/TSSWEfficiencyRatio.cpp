@@ -22,13 +22,13 @@ namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 TSSWEfficiencyRatio::TSSWEfficiencyRatio( Trades& trades, time_duration tdWindowWidth ) 
-  : TimeSeriesSlidingWindow<TSSWEfficiencyRatio, Trade>( trades, tdWindowWidth ),
+  : TimeSeriesSlidingWindow<TSSWEfficiencyRatio, Trade, WindowByTime>( trades, tdWindowWidth ),
     m_lastAdd( 0.0 ), m_lastExpire( 0.0 ), m_sum( 0.0 ), m_ratio( 0.0 ), m_total( 0.0 )
 {
 }
 
 TSSWEfficiencyRatio::TSSWEfficiencyRatio( const TSSWEfficiencyRatio& rhs ) 
-  : TimeSeriesSlidingWindow<TSSWEfficiencyRatio, Trade>( rhs ),
+  : TimeSeriesSlidingWindow<TSSWEfficiencyRatio, Trade, WindowByTime>( rhs ),
     m_lastAdd( 0.0 ), m_lastExpire( 0.0 ), m_sum( 0.0 ), m_ratio( 0.0 ), m_total( 0.0 )
 {
 }
@@ -21,8 +21,8 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
-class TSSWEfficiencyRatio: public TimeSeriesSlidingWindow<TSSWEfficiencyRatio, Trade> {
-  friend TimeSeriesSlidingWindow<TSSWEfficiencyRatio, Trade>;
+class TSSWEfficiencyRatio: public TimeSeriesSlidingWindow<TSSWEfficiencyRatio, Trade, WindowByTime> {
+  friend TimeSeriesSlidingWindow<TSSWEfficiencyRatio, Trade, WindowByTime>;
 public:
 
   TSSWEfficiencyRatio( Trades&, time_duration tdWindowWidth );
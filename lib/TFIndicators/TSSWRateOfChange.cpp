@@ -20,13 +20,13 @@ namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 TSSWRateOfChange::TSSWRateOfChange( Prices& prices, time_duration tdWindowWidth ) 
-  : TimeSeriesSlidingWindow<TSSWRateOfChange, Price>( prices, tdWindowWidth ),
+  : TimeSeriesSlidingWindow<TSSWRateOfChange, Price, WindowByTime>( prices, tdWindowWidth ),
   m_tail( 0.0 ), m_head( 0.0 )
 {
 }
 
 TSSWRateOfChange::TSSWRateOfChange( const TSSWRateOfChange& rhs )
-  : TimeSeriesSlidingWindow<TSSWRateOfChange, Price>( rhs ), 
+  : TimeSeriesSlidingWindow<TSSWRateOfChange, Price, WindowByTime>( rhs ), 
   m_tail( rhs.m_tail ), m_head( rhs.m_head )
 {
 }
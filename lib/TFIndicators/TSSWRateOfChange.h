@@ -19,8 +19,8 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
   
-class TSSWRateOfChange: public TimeSeriesSlidingWindow<TSSWRateOfChange, Price> {
-  friend TimeSeriesSlidingWindow<TSSWRateOfChange, Price>;
+class TSSWRateOfChange: public TimeSeriesSlidingWindow<TSSWRateOfChange, Price, WindowByTime> {
+  friend TimeSeriesSlidingWindow<TSSWRateOfChange, Price, WindowByTime>;
 public:
 
   TSSWRateOfChange( Prices&, time_duration tdWindowWidth );
@@ -23,7 +23,7 @@ namespace tf { // TradeFrame
 
 TSSWRealizedVolatility::TSSWRealizedVolatility( Prices& prices, time_duration tdWindowWidth, double p )
   : m_dblSum( 0.0 ), m_dblP( p ), m_n( 0 ), m_dt( not_a_date_time ), m_tdScaledWidth( hours( 365 * 24 ) + hours( 6 ) ),
-    TimeSeriesSlidingWindow<TSSWRealizedVolatility, Price>( prices, tdWindowWidth, 0 )
+    TimeSeriesSlidingWindow<TSSWRealizedVolatility, Price, WindowByTime>( prices, tdWindowWidth, 0 )
 {
   CalcScaleFactor();
 }
@@ -49,7 +49,6 @@ void TSSWRealizedVolatility::Add( const Price& price ) {
 }
 
 void TSSWRealizedVolatility::Expire( const Price& price ) {
-  --m_n;
   double val( price.Value() );
   --m_n;
   if ( 1.0 == m_dblP ) {
@@ -85,7 +84,7 @@ void TSSWRealizedVolatility::CalcScaleFactor( void ) {
   m_dblScaleFactor = 
     std::sqrt( 
     (double) m_tdScaledWidth.total_milliseconds() / 
-    ( (double) TimeSeriesSlidingWindow<TSSWRealizedVolatility, Price>::WindowWidth().total_milliseconds() / m_n ) 
+    ( (double) TimeSeriesSlidingWindow<TSSWRealizedVolatility, Price, WindowByTime>::WindowWidth().total_milliseconds() / m_n ) 
     );
 }
 
@@ -28,10 +28,10 @@ namespace tf { // TradeFrame
 // delta T should be 15min to 2hr
 
 class TSSWRealizedVolatility: 
-  public TimeSeriesSlidingWindow<TSSWRealizedVolatility, Price>,
+  public TimeSeriesSlidingWindow<TSSWRealizedVolatility, Price, WindowByTime>,
   public Prices
 {
-  friend TimeSeriesSlidingWindow<TSSWRealizedVolatility, Price>;
+  friend TimeSeriesSlidingWindow<TSSWRealizedVolatility, Price, WindowByTime>;
 public:
   TSSWRealizedVolatility( Prices& prices, time_duration tdWindowWidth, double p );
   ~TSSWRealizedVolatility( void );
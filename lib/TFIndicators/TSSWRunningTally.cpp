@@ -20,13 +20,13 @@ namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 TSSWRunningTally::TSSWRunningTally( Prices& prices, time_duration tdWindowWidth ) 
-  : TimeSeriesSlidingWindow<TSSWRunningTally, Price>( prices, tdWindowWidth ),
+  : TimeSeriesSlidingWindow<TSSWRunningTally, Price, WindowByTime>( prices, tdWindowWidth ),
   m_net( 0.0 )
 {
 }
 
 TSSWRunningTally::TSSWRunningTally( const TSSWRunningTally& rhs ) 
-  : TimeSeriesSlidingWindow<TSSWRunningTally, Price>( rhs ),
+  : TimeSeriesSlidingWindow<TSSWRunningTally, Price, WindowByTime>( rhs ),
   m_net( rhs.m_net )
 {
 }
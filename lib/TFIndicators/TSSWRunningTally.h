@@ -19,8 +19,8 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
   
-class TSSWRunningTally: public TimeSeriesSlidingWindow<TSSWRunningTally, Price> {
-  friend TimeSeriesSlidingWindow<TSSWRunningTally, Price>;
+class TSSWRunningTally: public TimeSeriesSlidingWindow<TSSWRunningTally, Price, WindowByTime> {
+  friend TimeSeriesSlidingWindow<TSSWRunningTally, Price, WindowByTime>;
 public:
 
   TSSWRunningTally( Prices&, time_duration tdWindowWidth );
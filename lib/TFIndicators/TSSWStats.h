@@ -15,6 +15,7 @@
 #pragma once
 
 #include "TimeSeriesSlidingWindow.h"
+#include "TimeSeriesSlidingWindowRing.h"
 #include "RunningStats.h"
 
 // continuously updated series based upon attachment to an underlying time series.
@@ -22,13 +23,13 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
-template<class T, class D> 
+template<class T, class D, class W = WindowByTimeAndCount> 
 class TimeSeriesSlidingWindowStats
-: public TimeSeriesSlidingWindow<T,D> {
+: public TimeSeriesSlidingWindow<T,D,W> {
 public:
-  TimeSeriesSlidingWindowStats<T,D>( TimeSeries<D>& Series, time_duration tdWindowWidth, size_t WindowSizeCount = 0 );
-  TimeSeriesSlidingWindowStats<T,D>( const TimeSeriesSlidingWindowStats<T,D>& rhs );
-  virtual ~TimeSeriesSlidingWindowStats<T,D>( void );
+  TimeSeriesSlidingWindowStats<T,D,W>( TimeSeries<D>& Series, time_duration tdWindowWidth, size_t WindowSizeCount = 0 );
+  TimeSeriesSlidingWindowStats<T,D,W>( const TimeSeriesSlidingWindowStats<T,D,W>& rhs );
+  virtual ~TimeSeriesSlidingWindowStats<T,D,W>( void );
 //  double Accel( void ) const { return m_stats.B2(); };
   double Slope( void ) const { return m_stats.Slope(); };
   double Offset( void ) const { return m_stats.Offset(); };
@@ -41,7 +42,7 @@ public:
   double BBLower( void ) const { return m_stats.BBLower(); };
   void SetBBMultiplier( double mult ) { m_stats.SetBBMultiplier( mult ); };
   double GetBBMultiplier( void ) const { return m_stats.GetBBMultiplier(); };
-  void Reset( void ) { TimeSeriesSlidingWindow<T,D>::Reset(); m_stats.Reset(); };
+  void Reset( void ) { TimeSeriesSlidingWindow<T,D,W>::Reset(); m_stats.Reset(); };
 protected:
 //  void Add( const T &datum ) {}; // override to process elements passing into window scope
 //  void Expire( const T &datum ) {};  // override to process elements passing out of window scope 
@@ -51,21 +52,21 @@ private:
 };
 
 // constructor
-template<class T, class D> TimeSeriesSlidingWindowStats<T,D>::TimeSeriesSlidingWindowStats( 
+template<class T, class D, class W> TimeSeriesSlidingWindowStats<T,D,W>::TimeSeriesSlidingWindowStats( 
   TimeSeries<D>& Series, time_duration tdWindowWidth, size_t WindowSizeCount ) 
-: TimeSeriesSlidingWindow<T,D>( Series, tdWindowWidth, WindowSizeCount )
+: TimeSeriesSlidingWindow<T,D,W>( Series, tdWindowWidth, WindowSizeCount )
 {
   m_stats.SetBBMultiplier( 2.0 );
 }
 
-template<class T, class D> TimeSeriesSlidingWindowStats<T,D>::TimeSeriesSlidingWindowStats( 
-  const TimeSeriesSlidingWindowStats<T,D>& rhs ) 
-  : TimeSeriesSlidingWindow<T,D>( rhs ), m_stats( rhs.m_stats )
+template<class T, class D, class W> TimeSeriesSlidingWindowStats<T,D,W>::TimeSeriesSlidingWindowStats( 
+  const TimeSeriesSlidingWindowStats<T,D,W>& rhs ) 
+  : TimeSeriesSlidingWindow<T,D,W>( rhs ), m_stats( rhs.m_stats )
 {
   
 }
 
-template<class T, class D> TimeSeriesSlidingWindowStats<T,D>::~TimeSeriesSlidingWindowStats(void) {
+template<class T, class D, class W> TimeSeriesSlidingWindowStats<T,D,W>::~TimeSeriesSlidingWindowStats(void) {
 }
 
 // Convert the following flavours into template based actors so can be used among different indicators
@@ -138,5 +139,38 @@ protected:
 private:
 };
 
+//
+// with Price, over the last N prices, held in the window's own ring
+//
+
+template<std::size_t N>
+class TSSWStatsPriceRing: public TimeSeriesSlidingWindowRing<TSSWStatsPriceRing<N>, Price, N> {
+  friend TimeSeriesSlidingWindowRing<TSSWStatsPriceRing<N>, Price, N>;
+  typedef TimeSeriesSlidingWindowRing<TSSWStatsPriceRing<N>, Price, N> ring_t;
+public:
+  TSSWStatsPriceRing( TimeSeries<Price>& series ): ring_t( series ) { m_stats.SetBBMultiplier( 2.0 ); };
+  TSSWStatsPriceRing( const TSSWStatsPriceRing& rhs ): ring_t( rhs ), m_stats( rhs.m_stats ) {};
+  ~TSSWStatsPriceRing( void ) {};
+  double Slope( void ) const { return m_stats.Slope(); };
+  double Offset( void ) const { return m_stats.Offset(); };
+  double MeanY( void ) const { return m_stats.MeanY(); };
+  double RR( void ) const { return m_stats.RR(); };
+  double SD( void ) const { return m_stats.SD(); };
+  double BBUpper( void ) const { return m_stats.BBUpper(); };
+  double BBLower( void ) const { return m_stats.BBLower(); };
+  void SetBBMultiplier( double mult ) { m_stats.SetBBMultiplier( mult ); };
+  void Reset( void ) { ring_t::Reset(); m_stats.Reset(); };
+protected:
+  void Add( const Price& price ) {
+    m_stats.Add( (double) ( price.DateTime() - ring_t::m_dtZero ).total_seconds(), price.Value() );
+  };
+  void Expire( const Price& price ) {
+    m_stats.Remove( (double) ( price.DateTime() - ring_t::m_dtZero ).total_seconds(), price.Value() );
+  };
+  void PostUpdate( void ) { m_stats.CalcStats(); };
+private:
+  RunningStats m_stats;
+};
+
 } // namespace tf
 } // namespace ou
@@ -20,13 +20,13 @@ namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 TSSWStochastic::TSSWStochastic( Quotes& quotes, time_duration tdWindowWidth ) 
-  : TimeSeriesSlidingWindow<TSSWStochastic, Quote>( quotes, tdWindowWidth ),
+  : TimeSeriesSlidingWindow<TSSWStochastic, Quote, WindowByTime>( quotes, tdWindowWidth ),
     m_lastAdd( 0 ), m_lastExpire( 0 ), m_k( 0 )
 {
 }
 
 TSSWStochastic::TSSWStochastic( const TSSWStochastic& rhs) 
-  : TimeSeriesSlidingWindow<TSSWStochastic, Quote>( rhs ),
+  : TimeSeriesSlidingWindow<TSSWStochastic, Quote, WindowByTime>( rhs ),
   m_lastAdd( rhs.m_lastAdd ), m_lastExpire( rhs.m_lastExpire ), m_k( rhs.m_k ),
   m_minmax( rhs.m_minmax )
 {
@@ -22,8 +22,8 @@ namespace tf { // TradeFrame
 
 // 14,3,1 is standard  14 periods, 3 slow average, 1 fast average
 
-class TSSWStochastic: public TimeSeriesSlidingWindow<TSSWStochastic, Quote> {
-  friend TimeSeriesSlidingWindow<TSSWStochastic, Quote>;
+class TSSWStochastic: public TimeSeriesSlidingWindow<TSSWStochastic, Quote, WindowByTime> {
+  friend TimeSeriesSlidingWindow<TSSWStochastic, Quote, WindowByTime>;
 public:
   TSSWStochastic( Quotes& quotes, time_duration tdWindowWidth );
   TSSWStochastic( const TSSWStochastic& );
@@ -26,6 +26,7 @@ class TSSWTickFrequency:
   public TimeSeriesSlidingWindow<TSSWTickFrequency<TS>, typename TS::datum_t>,
   public Prices
 {
+  friend TimeSeriesSlidingWindow<TSSWTickFrequency<TS>, typename TS::datum_t>;
 public:
   typedef typename TimeSeries<typename TS::datum_t>::size_type size_type;
   TSSWTickFrequency( TS& series, time_duration tdWindowWidth, size_type stWindowSize = 0 );
@@ -24,16 +24,35 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
-template<class T, class D>   // 
+// window policies, resolved at compile time so the expiry loop only carries the tests it needs
+// the constructor arguments are unchanged, the width or count not used by the policy is ignored
+
+struct WindowByTime {
+  static const bool bByTime = true;
+  static const bool bByCount = false;
+};
+
+struct WindowByCount {
+  static const bool bByTime = false;
+  static const bool bByCount = true;
+};
+
+struct WindowByTimeAndCount { // the original behaviour, both are tested, a zero value disables the test
+  static const bool bByTime = true;
+  static const bool bByCount = true;
+};
+
+template<class T, class D, class W = WindowByTimeAndCount>   // W=window policy
 //class TimeSeriesSlidingWindow: public TimeSeries<D> { // T=CRTP class for Add, Expire, PostUpdate; D=DatedDatum
   // the TimeSeries<D> isn't actually used, could use it, I suppose, but is there in order to recurse additional indicators
-class TimeSeriesSlidingWindow { // T=CRTP class for Add, Expire, PostUpdate; D=DatedDatum
+class TimeSeriesSlidingWindow { // T=CRTP class for Add, Expire, PostUpdate; D=DatedDatum; W=WindowBy...
 public:
   typedef typename TimeSeries<D>::size_type size_type;
-  TimeSeriesSlidingWindow<T,D>( TimeSeries<D>& Series, time_duration tdWindowWidth, size_type WindowSizeCount = 0 );
-  TimeSeriesSlidingWindow<T,D>( const TimeSeriesSlidingWindow<T,D>& );  // Delegate is not copied, other values may need some tuning
-  virtual ~TimeSeriesSlidingWindow<T,D>(void);
+  TimeSeriesSlidingWindow<T,D,W>( TimeSeries<D>& Series, time_duration tdWindowWidth, size_type WindowSizeCount = 0 );
+  TimeSeriesSlidingWindow<T,D,W>( const TimeSeriesSlidingWindow<T,D,W>& );  // Delegate is not copied, other values may need some tuning
+  virtual ~TimeSeriesSlidingWindow<T,D,W>(void);
   void Update( void );
+  void Backfill( void );  // process datums already in the series, one at a time, as though each had been appended
   virtual void Reset( void );
   ou::Delegate<const D&> OnAppend;
 protected:
@@ -54,11 +73,12 @@ private:
   bool m_bAutoUpdate; // use the OnAppend event to update stuff, else ue the Update method to process
 
   void Init( void );  // called in constructors
+  void ExpireTrailing( void );  // move trailing index up to the window boundary
   void HandleDatum( const D& );
 };
 
-template<class T, class D> 
-TimeSeriesSlidingWindow<T,D>::TimeSeriesSlidingWindow( 
+template<class T, class D, class W> 
+TimeSeriesSlidingWindow<T,D,W>::TimeSeriesSlidingWindow( 
   TimeSeries<D>& Series, time_duration tdWindowWidth, size_type WindowSizeCount ) 
 : m_Series( Series ), //m_iterTrailing( Series.begin() ), 
   m_ixTrailing( 0 ), m_ixLeading( 0 ), m_dtLeading( not_a_date_time ),
@@ -71,8 +91,8 @@ TimeSeriesSlidingWindow<T,D>::TimeSeriesSlidingWindow(
 }
 
 
-template<class T, class D> 
-TimeSeriesSlidingWindow<T,D>::TimeSeriesSlidingWindow( const TimeSeriesSlidingWindow<T,D>& rhs ) 
+template<class T, class D, class W> 
+TimeSeriesSlidingWindow<T,D,W>::TimeSeriesSlidingWindow( const TimeSeriesSlidingWindow<T,D,W>& rhs ) 
   : m_Series( rhs.m_Series ), 
   m_tdWindowWidth( rhs.m_tdWindowWidth ), m_nWindowSizeCount( rhs.m_nWindowSizeCount ),
   m_ixTrailing( rhs.m_ixTrailing ), m_ixLeading( rhs.m_ixLeading ), m_dtLeading( rhs.m_dtLeading ),
@@ -82,24 +102,24 @@ TimeSeriesSlidingWindow<T,D>::TimeSeriesSlidingWindow( const TimeSeriesSlidingWi
   Init();
 }
 
-template<class T, class D> 
-TimeSeriesSlidingWindow<T,D>::~TimeSeriesSlidingWindow(void) {
-  m_Series.OnAppend.Remove( MakeDelegate( this, &TimeSeriesSlidingWindow<T,D>::HandleDatum ) );
+template<class T, class D, class W> 
+TimeSeriesSlidingWindow<T,D,W>::~TimeSeriesSlidingWindow(void) {
+  m_Series.OnAppend.Remove( MakeDelegate( this, &TimeSeriesSlidingWindow<T,D,W>::HandleDatum ) );
 }
 
-template<class T, class D> 
-void TimeSeriesSlidingWindow<T,D>::Init(void) {
-  m_Series.OnAppend.Add( MakeDelegate( this, &TimeSeriesSlidingWindow<T,D>::HandleDatum ) );
+template<class T, class D, class W> 
+void TimeSeriesSlidingWindow<T,D,W>::Init(void) {
+  m_Series.OnAppend.Add( MakeDelegate( this, &TimeSeriesSlidingWindow<T,D,W>::HandleDatum ) );
 }
 
-template<class T, class D> 
-void TimeSeriesSlidingWindow<T,D>::Reset( void ) {
+template<class T, class D, class W> 
+void TimeSeriesSlidingWindow<T,D,W>::Reset( void ) {
   m_ixTrailing = m_ixLeading = 0;
   m_dtLeading = not_a_date_time;
 }
 
-template<class T, class D> 
-void TimeSeriesSlidingWindow<T,D>::Update( void ) {
+template<class T, class D, class W> 
+void TimeSeriesSlidingWindow<T,D,W>::Update( void ) {
   if ( !m_bFirstDatumFound ) {
     if ( 0 < m_Series.Size() ) {
       m_dtZero = m_Series[ 0 ].DateTime();  // used for zeroing the statistics
@@ -110,7 +130,7 @@ void TimeSeriesSlidingWindow<T,D>::Update( void ) {
   while ( m_ixLeading < m_Series.Size() ) {
     const D& datum( m_Series[ m_ixLeading ] );
     m_dtLeading = datum.DateTime();
-    if ( &TimeSeriesSlidingWindow<T,D>::Add != &T::Add ) {
+    if ( &TimeSeriesSlidingWindow<T,D,W>::Add != &T::Add ) {
       static_cast<T*>( this )->Add( datum ); // add datum to stats
     }
     
@@ -118,34 +138,71 @@ void TimeSeriesSlidingWindow<T,D>::Update( void ) {
     bMovedIndex = true;
   }
   if ( bMovedIndex ) {
-    if ( 0 < m_nWindowSizeCount ) {
-      while ( ( m_ixLeading - m_ixTrailing ) > m_nWindowSizeCount ) {
-        const D& datum( m_Series[ m_ixTrailing ] );
-        if ( &TimeSeriesSlidingWindow<T,D>::Add != &T::Add ) {
-          static_cast<T*>( this )->Expire( datum );  // expire datum from stats
-        }
-        ++m_ixTrailing;
+    ExpireTrailing();
+  }
+  if ( &TimeSeriesSlidingWindow<T,D,W>::PostUpdate != &T::PostUpdate ) {
+    static_cast<T*>( this )->PostUpdate();
+  }
+}
+
+template<class T, class D, class W> 
+void TimeSeriesSlidingWindow<T,D,W>::ExpireTrailing( void ) {
+  // trailing stays below leading, so the vector is indexed directly
+  const typename TimeSeries<D>::const_iterator iterSeries( m_Series.begin() );
+  if ( W::bByCount && ( 0 < m_nWindowSizeCount ) ) {
+    while ( ( m_ixLeading - m_ixTrailing ) > m_nWindowSizeCount ) {
+      const D& datum( iterSeries[ m_ixTrailing ] );
+      if ( &TimeSeriesSlidingWindow<T,D,W>::Add != &T::Add ) {
+        static_cast<T*>( this )->Expire( datum );  // expire datum from stats
       }
+      ++m_ixTrailing;
     }
-    if ( 0 < m_tdWindowWidth.total_milliseconds() ) {
-      while ( ( m_dtLeading - m_Series[ m_ixTrailing ].DateTime() ) > m_tdWindowWidth ) {
-        if ( &TimeSeriesSlidingWindow<T,D>::Add != &T::Add ) {
-          static_cast<T*>( this )->Expire( m_Series[ m_ixTrailing ] );  // expire datum from stats
-        }
-        ++m_ixTrailing;
-        if ( m_ixTrailing >= m_ixLeading ) {
-          break;
-        }
+  }
+  if ( W::bByTime && ( 0 < m_tdWindowWidth.total_milliseconds() ) ) {
+    while ( ( m_dtLeading - iterSeries[ m_ixTrailing ].DateTime() ) > m_tdWindowWidth ) {
+      if ( &TimeSeriesSlidingWindow<T,D,W>::Add != &T::Add ) {
+        static_cast<T*>( this )->Expire( iterSeries[ m_ixTrailing ] );  // expire datum from stats
+      }
+      ++m_ixTrailing;
+      if ( m_ixTrailing >= m_ixLeading ) {
+        break;
       }
     }
   }
-  if ( &TimeSeriesSlidingWindow<T,D>::PostUpdate != &T::PostUpdate ) {
-    static_cast<T*>( this )->PostUpdate();
+}
+
+// used when the series has been loaded in bulk (from hdf5, or with OnAppend not yet attached),
+//   such as when a strategy starts mid-session and the morning's history is replayed.
+// Update() would add the whole block and then expire, producing only the final state,
+//   whereas this steps the window one datum at a time so PostUpdate and OnAppend
+//   produce the same indicator series as a live feed would.
+// Runs on the underlying vector directly, without the per-datum delegate dispatch and bounds checks.
+template<class T, class D, class W> 
+void TimeSeriesSlidingWindow<T,D,W>::Backfill( void ) {
+  const size_type nSize( m_Series.Size() );
+  if ( m_ixLeading >= nSize ) return;
+  if ( !m_bFirstDatumFound ) {
+    m_dtZero = m_Series[ 0 ].DateTime();  // used for zeroing the statistics
+    m_bFirstDatumFound = true;
+  }
+  const typename TimeSeries<D>::const_iterator iterSeries( m_Series.begin() );
+  while ( m_ixLeading < nSize ) {
+    const D& datum( iterSeries[ m_ixLeading ] );
+    m_dtLeading = datum.DateTime();
+    if ( &TimeSeriesSlidingWindow<T,D,W>::Add != &T::Add ) {
+      static_cast<T*>( this )->Add( datum );
+    }
+    ++m_ixLeading;
+    ExpireTrailing();
+    if ( &TimeSeriesSlidingWindow<T,D,W>::PostUpdate != &T::PostUpdate ) {
+      static_cast<T*>( this )->PostUpdate();
+    }
+    OnAppend( datum );
   }
 }
 
-template<class T, class D> 
-void TimeSeriesSlidingWindow<T,D>::HandleDatum( const D& datum ) {
+template<class T, class D, class W> 
+void TimeSeriesSlidingWindow<T,D,W>::HandleDatum( const D& datum ) {
   if ( m_bAutoUpdate ) Update();
   OnAppend( datum );
 }
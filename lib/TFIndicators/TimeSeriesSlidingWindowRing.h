@@ -0,0 +1,143 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// count based sliding window with its own fixed capacity ring buffer
+// datums are copied in as they arrive, so expiry never reaches back into the source TimeSeries,
+//   the window stays contiguous and cache local no matter how large the series grows
+// same CRTP interface as TimeSeriesSlidingWindow:  Add, Expire, PostUpdate
+// N is the window size in datums
+
+#include <array>
+#include <cassert>
+
+#include <TFTimeSeries/TimeSeries.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+template<class T, class D, std::size_t N>
+class TimeSeriesSlidingWindowRing { // T=CRTP class for Add, Expire, PostUpdate; D=DatedDatum; N=window size
+public:
+  typedef typename TimeSeries<D>::size_type size_type;
+  TimeSeriesSlidingWindowRing<T,D,N>( TimeSeries<D>& Series );
+  TimeSeriesSlidingWindowRing<T,D,N>( const TimeSeriesSlidingWindowRing<T,D,N>& );  // Delegate is not copied
+  virtual ~TimeSeriesSlidingWindowRing<T,D,N>( void );
+  void Backfill( void );  // process datums already in the series, call before live datums arrive
+  virtual void Reset( void );  // empties the window, Backfill then replays the series from its start
+  size_type Count( void ) const { return m_nCount; };
+  bool Full( void ) const { return N == m_nCount; };
+  const D& Newest( void ) const { assert( 0 < m_nCount ); return m_ring[ ( 0 == m_ixNext ? N : m_ixNext ) - 1 ]; };
+  const D& Oldest( void ) const { assert( 0 < m_nCount ); return m_ring[ Full() ? m_ixNext : 0 ]; };
+  ou::Delegate<const D&> OnAppend;
+protected:
+  ptime m_dtZero;  // datetime of first element, used as offset
+  static size_type WindowSizeCount( void ) { return N; };
+
+  void Add( const D& datum ) {}; // CRTP override to process elements passing into window scope
+  void Expire( const D& datum ) {};  // CRTP override to process elements passing out of window scope
+  void PostUpdate( void ) {};  // CRTP override to do final calcs
+private:
+  TimeSeries<D>& m_Series;
+  size_type m_ixSeries;  // count of source datums processed, Backfill resumes from here
+  size_type m_ixNext;  // slot to be written next, is the oldest slot once full
+  size_type m_nCount;
+  bool m_bFirstDatumFound;
+  std::array<D,N> m_ring;
+
+  void Init( void );  // called in constructors
+  void Process( const D& );
+  void HandleDatum( const D& );
+};
+
+template<class T, class D, std::size_t N>
+TimeSeriesSlidingWindowRing<T,D,N>::TimeSeriesSlidingWindowRing( TimeSeries<D>& Series )
+: m_Series( Series ), m_ixSeries( 0 ), m_ixNext( 0 ), m_nCount( 0 ),
+  m_bFirstDatumFound( false )
+{
+  static_assert( 0 < N, "window size needs to be non-zero" );
+  Init();
+}
+
+template<class T, class D, std::size_t N>
+TimeSeriesSlidingWindowRing<T,D,N>::TimeSeriesSlidingWindowRing( const TimeSeriesSlidingWindowRing<T,D,N>& rhs )
+: m_dtZero( rhs.m_dtZero ),
+  m_Series( rhs.m_Series ), m_ixSeries( rhs.m_ixSeries ), m_ixNext( rhs.m_ixNext ), m_nCount( rhs.m_nCount ),
+  m_bFirstDatumFound( rhs.m_bFirstDatumFound ), m_ring( rhs.m_ring )
+{
+  Init();
+}
+
+template<class T, class D, std::size_t N>
+TimeSeriesSlidingWindowRing<T,D,N>::~TimeSeriesSlidingWindowRing( void ) {
+  m_Series.OnAppend.Remove( MakeDelegate( this, &TimeSeriesSlidingWindowRing<T,D,N>::HandleDatum ) );
+}
+
+template<class T, class D, std::size_t N>
+void TimeSeriesSlidingWindowRing<T,D,N>::Init( void ) {
+  m_Series.OnAppend.Add( MakeDelegate( this, &TimeSeriesSlidingWindowRing<T,D,N>::HandleDatum ) );
+}
+
+template<class T, class D, std::size_t N>
+void TimeSeriesSlidingWindowRing<T,D,N>::Reset( void ) {
+  m_ixSeries = m_ixNext = m_nCount = 0;
+  m_bFirstDatumFound = false;
+  m_dtZero = not_a_date_time;
+}
+
+// the series is only read here, when attached to a series already holding history
+template<class T, class D, std::size_t N>
+void TimeSeriesSlidingWindowRing<T,D,N>::Backfill( void ) {
+  const size_type nSize( m_Series.Size() );
+  const typename TimeSeries<D>::const_iterator iterSeries( m_Series.begin() );
+  while ( m_ixSeries < nSize ) {
+    Process( iterSeries[ m_ixSeries ] );
+  }
+}
+
+template<class T, class D, std::size_t N>
+void TimeSeriesSlidingWindowRing<T,D,N>::Process( const D& datum ) {
+  if ( !m_bFirstDatumFound ) {
+    m_dtZero = datum.DateTime();  // used for zeroing the statistics
+    m_bFirstDatumFound = true;
+  }
+  if ( &TimeSeriesSlidingWindowRing<T,D,N>::Add != &T::Add ) {
+    static_cast<T*>( this )->Add( datum );  // add datum to stats
+  }
+  if ( N == m_nCount ) {
+    if ( &TimeSeriesSlidingWindowRing<T,D,N>::Add != &T::Add ) {
+      static_cast<T*>( this )->Expire( m_ring[ m_ixNext ] );  // expire datum from stats
+    }
+  }
+  else {
+    ++m_nCount;
+  }
+  m_ring[ m_ixNext ] = datum;
+  ++m_ixNext;
+  if ( N == m_ixNext ) m_ixNext = 0;
+  ++m_ixSeries;
+  if ( &TimeSeriesSlidingWindowRing<T,D,N>::PostUpdate != &T::PostUpdate ) {
+    static_cast<T*>( this )->PostUpdate();
+  }
+  OnAppend( datum );
+}
+
+template<class T, class D, std::size_t N>
+void TimeSeriesSlidingWindowRing<T,D,N>::HandleDatum( const D& datum ) {
+  Process( datum );
+}
+
+} // namespace tf
+} // namespace ou
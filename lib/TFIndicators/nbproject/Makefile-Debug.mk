@@ -36,6 +36,7 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 # Object Files
 OBJECTFILES= \
 	${OBJECTDIR}/Crossing.o \
+	${OBJECTDIR}/EMAChain.o \
 	${OBJECTDIR}/PivotGroup.o \
 	${OBJECTDIR}/Pivots.o \
 	${OBJECTDIR}/RunningMinMax.o \
@@ -92,6 +93,11 @@ ${OBJECTDIR}/Crossing.o: Crossing.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -D_DEBUG -I../ -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Crossing.o Crossing.cpp
 
+${OBJECTDIR}/EMAChain.o: EMAChain.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -D_DEBUG -I../ -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EMAChain.o EMAChain.cpp
+
 ${OBJECTDIR}/PivotGroup.o: PivotGroup.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <stdexcept>
 
+#include "Formula.h"
 #include "Binomial.h"
 
 namespace ou { // One Unified
@@ -27,58 +28,361 @@ namespace tf { // TradeFrame
 namespace option { // options
 namespace binomial { // binomial
 
-void CRR( const structInput& input, structOutput& output ) {
+namespace {
+
+// exercise style resolved at compile time, so the backward induction carries no per node branch
+struct American {
+  static double Value( double continuation, double exercise ) { return std::max<double>( continuation, exercise ); }
+};
 
-  std::vector<double> v; v.resize( input.n + 1 );
-  double u, d, p;
-  double dt;
-  double df;
-  double z;
+struct European {
+  static double Value( double continuation, double ) { return continuation; }  // exercise value is optimized out
+};
 
-  switch ( input.optionSide ) {
+double PayoffSign( ou::tf::OptionSide::enumOptionSide side ) {
+  switch ( side ) {
   case ou::tf::OptionSide::Call:
-    z = 1;
-    break;
+    return 1.0;
   case ou::tf::OptionSide::Put:
-    z = -1;
-    break;
+    return -1.0;
+  default:
+    throw std::runtime_error( "binomial::CRR: option side needs to be call or put" );
   }
+}
+
+// parameters common to every option priced on the same tree
+struct Tree {
+  long n;
+  double dt, u, d, p, q, df;
+  explicit Tree( const structInput& input )
+  : n( input.n ) {
+    dt = input.T / n;
+    u = exp( input.v * sqrt( dt ) );
+    d = 1.0 / u;
+    p = ( exp( input.b * dt ) - d ) / ( u - d );
+    q = 1.0 - p;
+    df = exp( -input.r * dt );
+  }
+};
+
+// scratch space for one thread, grows to the largest tree seen, after which pricing doesn't allocate
+struct Workspace {
+  std::vector<double> vPower;  // u^k, k in [-n,n], stored at k + n
+  std::vector<double> vValue;  // option value at each node of the current time step, by lane
+  std::vector<double> vLanePower;  // per lane u^k, lane minor
+  double uPower;  // u the power table was built for
+  long nPower;  // n the power table was built for
+  Workspace( void ): uPower( 0.0 ), nPower( 0 ) {};
+  const double* Powers( const Tree& tree ) {  // returns u^0, index with [-n,n]
+    if ( ( tree.u != uPower ) || ( tree.n != nPower ) ) {
+      const long n( tree.n );
+      if ( vPower.size() < (size_t)( 2 * n + 1 ) ) vPower.resize( 2 * n + 1 );
+      vPower[ n ] = 1.0;
+      for ( long k = 1; k <= n; ++k ) {
+        vPower[ n + k ] = vPower[ n + k - 1 ] * tree.u;
+        vPower[ n - k ] = vPower[ n - k + 1 ] * tree.d;
+      }
+      uPower = tree.u;
+      nPower = tree.n;
+    }
+    return &vPower[ tree.n ];
+  }
+  double* Values( size_t nValues ) {
+    if ( vValue.size() < nValues ) vValue.resize( nValues );
+    return &vValue[ 0 ];
+  }
+  double* LanePowers( size_t nValues ) {
+    if ( vLanePower.size() < nValues ) vLanePower.resize( nValues );
+    return &vLanePower[ 0 ];
+  }
+};
+
+thread_local Workspace workspace;
+
+// node price at step j, index i: S * u^i * d^(j-i) = S * power[ 2i - j ]
+
+template<typename Exercise>
+void CRR_t( const structInput& input, structOutput& output ) {
+
+  const Tree tree( input );
+  const double* power( workspace.Powers( tree ) );
+  double* v( workspace.Values( input.n + 1 ) );
+
+  const double z( PayoffSign( input.optionSide ) );
+  const double S( input.S );
+  const double X( input.X );
+  const long n( input.n );
+
+  for ( long ix = 0; ix <= n; ++ix ) {
+    v[ ix ] = std::max<double>( 0.0, z * ( S * power[ 2 * ix - n ] - X ) );
+  }
+  for ( long j = n - 1; j >= 0; --j ) {
+    for ( long i = 0; i <= j; ++i ) {
+      const double europrice = tree.df * ( tree.p * v[ i + 1 ] + tree.q * v[ i ] );
+      v[ i ] = Exercise::Value( europrice, z * ( S * power[ 2 * i - j ] - X ) );
+    }
+    if ( 2 == j ) {
+      output.gamma = ( ( v[ 2 ] - v[ 1 ] ) / ( S * tree.u * tree.u - S ) 
+        - ( v[ 1 ] - v[ 0 ] ) / ( S - S * tree.d * tree.d ) )
+        / ( 0.5 * ( S * tree.u * tree.u - S * tree.d * tree.d ) );
+      output.theta = v[ 1 ];
+    }
+    if ( 1 == j ) {
+      output.delta = ( v[ 1 ] - v[ 0 ] ) / ( S * ( tree.u - tree.d ) );
+    }
+  }
+  output.theta = ( output.theta - v[ 0 ] ) / ( 2.0 * tree.dt ) / 365.0;
+  output.option = v[ 0 ];
+}
+
+const size_t c_nLanes = 8;  // options stepped together, values for a node are contiguous across lanes
+
+// one volatility for the chain: every lane shares the tree, and so the node prices
+template<typename Exercise>
+void CRR_t( const structInput& input, size_t nOptions, 
+  const double* rStrike, const ou::tf::OptionSide::enumOptionSide* rSide, structOutput* rOutput ) {
+
+  const Tree tree( input );
+  const double* power( workspace.Powers( tree ) );
+  double* v( workspace.Values( ( input.n + 1 ) * c_nLanes ) );
+
+  const double S( input.S );
+  const long n( input.n );
+
+  for ( size_t ixBlock = 0; ixBlock < nOptions; ixBlock += c_nLanes ) {
+
+    const size_t nInBlock( std::min<size_t>( c_nLanes, nOptions - ixBlock ) );
+
+    double X[ c_nLanes ];
+    double z[ c_nLanes ];
+    for ( size_t l = 0; l < c_nLanes; ++l ) {  // a partial block repeats its first option in the spare lanes
+      const size_t ix( ixBlock + ( l < nInBlock ? l : 0 ) );
+      X[ l ] = rStrike[ ix ];
+      z[ l ] = PayoffSign( rSide[ ix ] );
+    }
+
+    double gamma[ c_nLanes ];
+    double theta[ c_nLanes ];
+    double delta[ c_nLanes ];
 
-  dt = input.T / input.n;
-  u = exp( input.v * sqrt( dt ) );
-  d = 1.0 / u;
-  p = ( exp( input.b * dt ) - d ) / ( u - d );
-  df = exp( -input.r * dt );
-
-  for ( int ix = 0; ix <= input.n; ++ix ) {
-    v[ ix ] = std::max<double>( 0.0, z * ( input.S * pow( u, ix ) * pow( d, input.n - ix ) - input.X ) );
-  }
-  for ( int j = input.n - 1; j >= 0; --j ) {
-    for ( int i = 0; i <= j; ++i ) {
-      double europrice = df * ( p * v[ i + 1 ] + ( 1.0 - p ) * v[ i ] );
-      double exerciseprice;
-      switch ( input.optionStyle ) {
-      case ou::tf::OptionStyle::American:
-        exerciseprice = z * ( input.S * pow( u, i ) * pow( d, j - i ) - input.X );
-        v[ i ] = std::max<double>( exerciseprice, europrice );
-        break;
-      case ou::tf::OptionStyle::European:
-        v[ i ] = europrice;
-        break;
+    for ( long ix = 0; ix <= n; ++ix ) {
+      const double price( S * power[ 2 * ix - n ] );
+      double* vNode( v + ix * c_nLanes );
+      for ( size_t l = 0; l < c_nLanes; ++l ) {
+        vNode[ l ] = std::max<double>( 0.0, z[ l ] * ( price - X[ l ] ) );
+      }
+    }
+    for ( long j = n - 1; j >= 0; --j ) {
+      for ( long i = 0; i <= j; ++i ) {
+        const double price( S * power[ 2 * i - j ] );
+        double* vNode( v + i * c_nLanes );
+        const double* vUp( vNode + c_nLanes );
+        for ( size_t l = 0; l < c_nLanes; ++l ) {
+          const double europrice = tree.df * ( tree.p * vUp[ l ] + tree.q * vNode[ l ] );
+          vNode[ l ] = Exercise::Value( europrice, z[ l ] * ( price - X[ l ] ) );
+        }
       }
       if ( 2 == j ) {
-        output.gamma = ( ( v[ 2 ] - v[ 1 ] ) / ( input.S * u * u - input.S ) 
-          - ( v[ 1 ] - v[ 0 ] ) / ( input.S - input.S * d * d ) )
-          / ( 0.5 * ( input.S * u * u - input.S * d * d ) );
-        output.theta = v[ 1 ];
+        for ( size_t l = 0; l < c_nLanes; ++l ) {
+          const double v0( v[ l ] ), v1( v[ c_nLanes + l ] ), v2( v[ 2 * c_nLanes + l ] );
+          gamma[ l ] = ( ( v2 - v1 ) / ( S * tree.u * tree.u - S ) 
+            - ( v1 - v0 ) / ( S - S * tree.d * tree.d ) )
+            / ( 0.5 * ( S * tree.u * tree.u - S * tree.d * tree.d ) );
+          theta[ l ] = v1;
+        }
       }
       if ( 1 == j ) {
-        output.delta = ( v[ 1 ] - v[ 0 ] ) / ( input.S * ( u - d ) );
+        for ( size_t l = 0; l < c_nLanes; ++l ) {
+          delta[ l ] = ( v[ c_nLanes + l ] - v[ l ] ) / ( S * ( tree.u - tree.d ) );
+        }
       }
     }
+
+    for ( size_t l = 0; l < nInBlock; ++l ) {
+      structOutput& output( rOutput[ ixBlock + l ] );
+      output.option = v[ l ];
+      output.delta = delta[ l ];
+      output.gamma = gamma[ l ];
+      output.theta = ( theta[ l ] - v[ l ] ) / ( 2.0 * tree.dt ) / 365.0;
+    }
+  }
+}
+
+// each lane has its own strike, side and volatility, so its own u, d, p and node prices,
+//   S, T, r, b and n are common to all lanes
+template<typename Exercise>
+void CRR_Lanes( const structInput& input, 
+  const double* rVolatility, const double* rStrike, const double* rSign, structOutput* rOutput ) {
+
+  double X[ c_nLanes ], z[ c_nLanes ];  // local copies, so stores to the tree can't alias them
+  std::copy( rStrike, rStrike + c_nLanes, X );
+  std::copy( rSign, rSign + c_nLanes, z );
+
+  const long n( input.n );
+  const double S( input.S );
+  const double dt( input.T / n );
+  const double df( exp( -input.r * dt ) );
+  const double growth( exp( input.b * dt ) );
+  const double sqrtdt( sqrt( dt ) );
+
+  double u[ c_nLanes ], d[ c_nLanes ], p[ c_nLanes ], q[ c_nLanes ];
+  for ( size_t l = 0; l < c_nLanes; ++l ) {
+    u[ l ] = exp( rVolatility[ l ] * sqrtdt );
+    d[ l ] = 1.0 / u[ l ];
+    p[ l ] = ( growth - d[ l ] ) / ( u[ l ] - d[ l ] );
+    q[ l ] = 1.0 - p[ l ];
+  }
+
+  // node price at step j, index i, lane l: S * power[ ( 2i - j ) * c_nLanes + l ]
+  double* power( workspace.LanePowers( ( 2 * n + 1 ) * c_nLanes ) + n * c_nLanes );
+  for ( size_t l = 0; l < c_nLanes; ++l ) {
+    power[ l ] = S;
+  }
+  for ( long k = 1; k <= n; ++k ) {
+    for ( size_t l = 0; l < c_nLanes; ++l ) {
+      power[ k * c_nLanes + l ] = power[ ( k - 1 ) * c_nLanes + l ] * u[ l ];
+      power[ -k * c_nLanes + l ] = power[ ( 1 - k ) * c_nLanes + l ] * d[ l ];
+    }
+  }
+
+  double* v( workspace.Values( ( n + 1 ) * c_nLanes ) );
+
+  double gamma[ c_nLanes ];
+  double theta[ c_nLanes ];
+  double delta[ c_nLanes ];
+
+  for ( long ix = 0; ix <= n; ++ix ) {
+    const double* price( power + ( 2 * ix - n ) * c_nLanes );
+    double* vNode( v + ix * c_nLanes );
+    for ( size_t l = 0; l < c_nLanes; ++l ) {
+      vNode[ l ] = std::max<double>( 0.0, z[ l ] * ( price[ l ] - X[ l ] ) );
+    }
+  }
+  for ( long j = n - 1; j >= 0; --j ) {
+    for ( long i = 0; i <= j; ++i ) {
+      const double* price( power + ( 2 * i - j ) * c_nLanes );
+      double* vNode( v + i * c_nLanes );
+      const double* vUp( vNode + c_nLanes );
+      double value[ c_nLanes ];  // all loads ahead of the stores, the compiler can't prove the tables don't overlap
+      for ( size_t l = 0; l < c_nLanes; ++l ) {
+        const double europrice = df * ( p[ l ] * vUp[ l ] + q[ l ] * vNode[ l ] );
+        value[ l ] = Exercise::Value( europrice, z[ l ] * ( price[ l ] - X[ l ] ) );
+      }
+      std::copy( value, value + c_nLanes, vNode );
+    }
+    if ( 2 == j ) {
+      for ( size_t l = 0; l < c_nLanes; ++l ) {
+        const double v0( v[ l ] ), v1( v[ c_nLanes + l ] ), v2( v[ 2 * c_nLanes + l ] );
+        const double uu( u[ l ] * u[ l ] ), dd( d[ l ] * d[ l ] );
+        gamma[ l ] = ( ( v2 - v1 ) / ( S * uu - S ) - ( v1 - v0 ) / ( S - S * dd ) ) / ( 0.5 * ( S * uu - S * dd ) );
+        theta[ l ] = v1;
+      }
+    }
+    if ( 1 == j ) {
+      for ( size_t l = 0; l < c_nLanes; ++l ) {
+        delta[ l ] = ( v[ c_nLanes + l ] - v[ l ] ) / ( S * ( u[ l ] - d[ l ] ) );
+      }
+    }
+  }
+
+  for ( size_t l = 0; l < c_nLanes; ++l ) {
+    structOutput& output( rOutput[ l ] );
+    output.option = v[ l ];
+    output.delta = delta[ l ];
+    output.gamma = gamma[ l ];
+    output.theta = ( theta[ l ] - v[ l ] ) / ( 2.0 * dt ) / 365.0;
+  }
+}
+
+void CRR_Lanes( const structInput& input, 
+  const double* rVolatility, const double* X, const double* z, structOutput* rOutput ) {
+  switch ( input.optionStyle ) {
+  case ou::tf::OptionStyle::American:
+    CRR_Lanes<American>( input, rVolatility, X, z, rOutput );
+    break;
+  case ou::tf::OptionStyle::European:
+    CRR_Lanes<European>( input, rVolatility, X, z, rOutput );
+    break;
+  }
+}
+
+} // namespace anonymous
+
+void CRR( const structInput& input, structOutput& output ) {
+  switch ( input.optionStyle ) {
+  case ou::tf::OptionStyle::American:
+    CRR_t<American>( input, output );
+    break;
+  case ou::tf::OptionStyle::European:
+    CRR_t<European>( input, output );
+    break;
+  }
+}
+
+void CRR_ControlVariate( const structInput& input, structOutput& output ) {
+
+  structOutput european;
+  CRR_t<American>( input, output );
+  CRR_t<European>( input, european );  // same tree, so the power table is reused
+
+  const double z( PayoffSign( input.optionSide ) );
+  const double q( input.r - input.b );  // carry to dividend yield
+  bsm::structBatchInput in;
+  in.S = &input.S;
+  in.K = &input.X;
+  in.T = &input.T;
+  in.r = &input.r;
+  in.q = &q;
+  in.v = &input.v;
+  in.z = &z;
+  double price, delta, gamma, theta, vega, rho;
+  bsm::structBatchOutput out;
+  out.price = &price;
+  out.delta = &delta;
+  out.gamma = &gamma;
+  out.theta = &theta;
+  out.vega = &vega;
+  out.rho = &rho;
+  bsm::Greeks( 1, in, out );
+
+  output.option += price - european.option;
+  output.delta += delta - european.delta;
+  output.gamma += gamma - european.gamma;
+  output.theta += theta / 365.0 - european.theta;  // tree theta is per day
+}
+
+void CRR( const structInput& input, size_t nOptions,
+  const double* rStrike, const ou::tf::OptionSide::enumOptionSide* rSide, structOutput* rOutput ) {
+
+  switch ( input.optionStyle ) {
+  case ou::tf::OptionStyle::American:
+    CRR_t<American>( input, nOptions, rStrike, rSide, rOutput );
+    break;
+  case ou::tf::OptionStyle::European:
+    CRR_t<European>( input, nOptions, rStrike, rSide, rOutput );
+    break;
+  }
+}
+
+void CRR( const structInput& input, size_t nOptions,
+  const double* rStrike, const ou::tf::OptionSide::enumOptionSide* rSide, const double* rVolatility, structOutput* rOutput ) {
+
+  double vol[ c_nLanes ];
+  double X[ c_nLanes ];
+  double z[ c_nLanes ];
+  structOutput output[ c_nLanes ];
+
+  for ( size_t ixBlock = 0; ixBlock < nOptions; ixBlock += c_nLanes ) {
+    const size_t nInBlock( std::min<size_t>( c_nLanes, nOptions - ixBlock ) );
+    for ( size_t l = 0; l < c_nLanes; ++l ) {  // a partial block repeats its first option in the spare lanes
+      const size_t ix( ixBlock + ( l < nInBlock ? l : 0 ) );
+      vol[ l ] = rVolatility[ ix ];
+      X[ l ] = rStrike[ ix ];
+      z[ l ] = PayoffSign( rSide[ ix ] );
+    }
+    CRR_Lanes( input, vol, X, z, output );
+    std::copy( output, output + nInBlock, rOutput + ixBlock );
   }
-  output.theta = ( output.theta - v[ 0 ] ) / ( 2.0 * dt ) / 365.0;
-  output.option = v[ 0 ];
 }
 
 double CalcImpliedVolatility( const structInput& input_, double option, structOutput& output, double epsilon ) {
@@ -150,6 +454,179 @@ double CalcImpliedVolatility( const structInput& input_, double option, structOu
   return output.iv;
 }
 
+namespace {
+
+const double c_dblVolatilityMin = 0.0001;
+const double c_dblVolatilityMax = 5.0;
+const double c_dblPi = 3.14159265358979323846;
+
+// pg 454 Option Pricing Formulas, 2e
+double GuessManasterKoehler( const structInput& input, double X ) {
+  return std::sqrt( std::abs( std::log( input.S / X ) + input.r * input.T ) * 2.0 / input.T );
+}
+
+// Corrado and Miller, on the call, with puts mapped across through european put call parity
+double GuessCorradoMiller( const structInput& input, double X, double z, double price ) {
+  const double S( input.S * std::exp( ( input.b - input.r ) * input.T ) );
+  const double K( X * std::exp( -input.r * input.T ) );
+  const double C( 0.0 < z ? price : price + S - K );
+  const double a( C - 0.5 * ( S - K ) );
+  const double root( a * a - ( S - K ) * ( S - K ) / c_dblPi );  // negative near the money, clamp as brenner subrahmanyam
+  return std::sqrt( 2.0 * c_dblPi / input.T ) / ( S + K ) * ( a + std::sqrt( std::max<double>( 0.0, root ) ) );
+}
+
+// analytic black scholes vega, the newton slope, the tree has none of its own
+double VegaBlackScholes( const structInput& input, double X, double v ) {
+  const double sqrtT( std::sqrt( input.T ) );
+  const double d1( ( std::log( input.S / X ) + ( input.b + 0.5 * v * v ) * input.T ) / ( v * sqrtT ) );
+  return input.S * std::exp( ( input.b - input.r ) * input.T ) * std::exp( -0.5 * d1 * d1 ) / std::sqrt( 2.0 * c_dblPi ) * sqrtT;
+}
+
+bool InBracket( double v ) {
+  return ( c_dblVolatilityMin <= v ) && ( c_dblVolatilityMax >= v ) && std::isfinite( v );
+}
+
+// prices rOption[ vIndex[ ix ] ] at vVolatility[ ix ], in lanes
+void PriceLanes( const structInput& input, const structSliceOption* rOption, 
+  const std::vector<size_t>& vIndex, const std::vector<double>& vVolatility, std::vector<structOutput>& vOutput ) {
+
+  double vol[ c_nLanes ];
+  double X[ c_nLanes ];
+  double z[ c_nLanes ];
+  structOutput output[ c_nLanes ];
+
+  const size_t nOptions( vIndex.size() );
+  vOutput.resize( nOptions );
+  for ( size_t ixBlock = 0; ixBlock < nOptions; ixBlock += c_nLanes ) {
+    const size_t nInBlock( std::min<size_t>( c_nLanes, nOptions - ixBlock ) );
+    for ( size_t l = 0; l < c_nLanes; ++l ) {  // a partial block repeats its first option in the spare lanes
+      const size_t ix( ixBlock + ( l < nInBlock ? l : 0 ) );
+      const structSliceOption& option( rOption[ vIndex[ ix ] ] );
+      vol[ l ] = vVolatility[ ix ];
+      X[ l ] = option.X;
+      z[ l ] = ou::tf::OptionSide::Call == option.optionSide ? 1.0 : -1.0;
+    }
+    CRR_Lanes( input, vol, X, z, output );
+    std::copy( output, output + nInBlock, vOutput.begin() + ixBlock );
+  }
+}
+
+} // namespace anonymous
+
+void CalcImpliedVolatility( const structInput& input_, size_t nOptions, structSliceOption* rOption, 
+  double epsilon, unsigned int nMaxIterations ) {
+
+  structInput input( input_ );
+
+  std::vector<size_t> vIndex;  // options still to be solved
+  std::vector<double> vVolatility;  // current estimate for each in vIndex
+  std::vector<double> vLower;  // bracket for each in vIndex
+  std::vector<double> vUpper;
+  std::vector<double> vIntrinsic;  // lower bound on price for each in vIndex
+  std::vector<structOutput> vOutput;
+
+  vIndex.reserve( nOptions );
+
+  for ( size_t ix = 0; ix < nOptions; ++ix ) {
+    structSliceOption& option( rOption[ ix ] );
+    option.nIterations = 0;
+    option.output = structOutput();
+    if ( ( ( ou::tf::OptionSide::Call != option.optionSide ) && ( ou::tf::OptionSide::Put != option.optionSide ) )
+      || !( 0.0 < option.X ) || !( 0.0 < option.price ) || !( 0.0 < input.S ) || !( 0.0 < input.T ) ) {
+      option.status = structSliceOption::BadInput;
+      continue;
+    }
+    const double z( ou::tf::OptionSide::Call == option.optionSide ? 1.0 : -1.0 );
+    // european lower bound, and for american, exercise value too:  the price less this is what volatility has to fit
+    double intrinsic( std::max<double>( 0.0, z * ( input.S * std::exp( ( input.b - input.r ) * input.T ) - option.X * std::exp( -input.r * input.T ) ) ) );
+    if ( ou::tf::OptionStyle::American == input.optionStyle ) {
+      intrinsic = std::max<double>( intrinsic, z * ( input.S - option.X ) );
+    }
+    const double bound( 0.0 < z ? input.S : option.X );
+    if ( intrinsic + epsilon > option.price ) {  // no time value left to fit
+      option.status = structSliceOption::BelowIntrinsic;
+      continue;
+    }
+    if ( bound <= option.price ) {
+      option.status = structSliceOption::AboveBound;
+      continue;
+    }
+    double v( option.guess );
+    if ( !InBracket( v ) ) v = GuessCorradoMiller( input, option.X, z, option.price );
+    if ( !InBracket( v ) ) v = GuessManasterKoehler( input, option.X );
+    if ( !InBracket( v ) ) v = input.v;
+    if ( !InBracket( v ) ) v = 0.3;
+    option.status = structSliceOption::NoConvergence;
+    vIndex.push_back( ix );
+    vVolatility.push_back( v );
+    vIntrinsic.push_back( intrinsic );
+  }
+  vLower.assign( vIndex.size(), c_dblVolatilityMin );
+  vUpper.assign( vIndex.size(), c_dblVolatilityMax );
+
+  std::vector<size_t> vSolved;  // converged, for the rho pass
+  vSolved.reserve( vIndex.size() );
+
+  for ( unsigned int nIteration = 1; ( nIteration <= nMaxIterations ) && !vIndex.empty(); ++nIteration ) {
+    PriceLanes( input, rOption, vIndex, vVolatility, vOutput );
+    size_t ixKeep( 0 );  // compact the unsolved to the front as we go
+    for ( size_t ix = 0; ix < vIndex.size(); ++ix ) {
+      structSliceOption& option( rOption[ vIndex[ ix ] ] );
+      const double v( vVolatility[ ix ] );
+      const double vega( VegaBlackScholes( input, option.X, v ) );
+      const double diff( vOutput[ ix ].option - option.price );
+      option.nIterations = nIteration;
+      option.output = vOutput[ ix ];
+      option.output.iv = v;
+      option.output.vega = vega * 0.01;  // per 1% of volatility, as in the single option solver
+      if ( epsilon >= std::fabs( diff ) ) {
+        option.status = structSliceOption::Converged;
+        vSolved.push_back( vIndex[ ix ] );
+        continue;
+      }
+      double lower( vLower[ ix ] ), upper( vUpper[ ix ] );
+      if ( 0.0 < diff ) upper = v; else lower = v;
+      // newton on the log of the time value, which is near linear in volatility where the price itself
+      //   is not, far from the money, else plain newton
+      const double tvModel( vOutput[ ix ].option - vIntrinsic[ ix ] );
+      const double tvMarket( option.price - vIntrinsic[ ix ] );
+      double vNext( 0.0 < tvModel 
+        ? v - std::log( tvModel / tvMarket ) * tvModel / vega 
+        : v - diff / vega );
+      if ( !( lower < vNext ) || !( upper > vNext ) ) {
+        vNext = 0.5 * ( lower + upper );
+      }
+      vIndex[ ixKeep ] = vIndex[ ix ];
+      vVolatility[ ixKeep ] = vNext;
+      vLower[ ixKeep ] = lower;
+      vUpper[ ixKeep ] = upper;
+      vIntrinsic[ ixKeep ] = vIntrinsic[ ix ];
+      ++ixKeep;
+    }
+    vIndex.resize( ixKeep );
+    vVolatility.resize( ixKeep );
+    vLower.resize( ixKeep );
+    vUpper.resize( ixKeep );
+    vIntrinsic.resize( ixKeep );
+  }
+
+  // rho, formulas on page 313 of black scholes and beyond, one more batch at a shifted rate
+  if ( !vSolved.empty() ) {
+    static const double pct = 0.01;
+    const double dr( 0.0 != input.r ? pct * input.r : pct * pct );
+    input.r += dr;
+    vVolatility.resize( vSolved.size() );
+    for ( size_t ix = 0; ix < vSolved.size(); ++ix ) {
+      vVolatility[ ix ] = rOption[ vSolved[ ix ] ].output.iv;
+    }
+    PriceLanes( input, rOption, vSolved, vVolatility, vOutput );
+    for ( size_t ix = 0; ix < vSolved.size(); ++ix ) {
+      structOutput& output( rOption[ vSolved[ ix ] ].output );
+      output.rho = ( vOutput[ ix ].option - output.option ) / dr;
+    }
+  }
+}
+
 } // namespace binomial
 } // namespace option
 } // namespace tf
@@ -67,8 +67,57 @@ struct structOutput {
 // Cox Ross Rubinstein American Binomial Tree
 // pg 284 Option Pricing Formulas, 2e
 void CRR( const structInput& input, structOutput& output );
+
+// american priced with the european as control variate, pg 294 Hull 8e:  the tree's error on the european,
+//   known exactly from the closed form, is taken off the american, so fewer steps give the same accuracy
+// input.optionStyle is ignored, option, delta, gamma and theta are corrected, iv, vega and rho are not set
+void CRR_ControlVariate( const structInput& input, structOutput& output );
+
+// a slice of a chain: options differing only in strike and side, same expiry, volatility and rates
+// the tree and its node prices are built once for the slice, and strikes are stepped through the
+//   tree together, in blocks laid out so the compiler vectorizes across strikes
+// input.X and input.optionSide are ignored, rStrike[ ix ], rSide[ ix ] price into rOutput[ ix ]
+void CRR( const structInput& input, size_t nOptions,
+  const double* rStrike, const ou::tf::OptionSide::enumOptionSide* rSide, structOutput* rOutput );
+// as above, but each option at its own volatility, input.v is ignored, node prices are built per lane
+void CRR( const structInput& input, size_t nOptions,
+  const double* rStrike, const ou::tf::OptionSide::enumOptionSide* rSide, const double* rVolatility, structOutput* rOutput );
+
 double CalcImpliedVolatility( const structInput& input, double option, structOutput& output, double epsilon = 0.0001 );
 
+// one option of an expiry slice, for the batch implied volatility solver
+struct structSliceOption {
+  enum EStatus { 
+    Unsolved,  // not yet attempted
+    Converged,  // output is filled in
+    NoConvergence,  // iterations exhausted, output.iv is the last estimate
+    BelowIntrinsic, // price at or below exercise value, volatility is undetermined
+    AboveBound,  // price at or above the no-arbitrage upper bound, no volatility fits
+    BadInput  // unknown side, non-positive strike or price
+  };
+  ou::tf::OptionSide::enumOptionSide optionSide;
+  double X;  // strike
+  double price;  // market price, typically the quote midpoint
+  double guess;  // starting volatility, as from a fitted surface, 0.0 for the solver's own guess
+  EStatus status;
+  unsigned int nIterations;
+  structOutput output;
+  structSliceOption( void ): 
+    optionSide( ou::tf::OptionSide::Unknown ), X( 0.0 ), price( 0.0 ), guess( 0.0 ),
+    status( Unsolved ), nIterations( 0 ) {};
+  structSliceOption( ou::tf::OptionSide::enumOptionSide optionSide_, double X_, double price_, double guess_ = 0.0 ):
+    optionSide( optionSide_ ), X( X_ ), price( price_ ), guess( guess_ ),
+    status( Unsolved ), nIterations( 0 ) {};
+};
+
+// solves all options of an expiry slice together, nothing is thrown, each option carries its own status
+// each option starts from its guess, else a closed form one (Corrado Miller, else Manaster Koehler, else input.v),
+//   then newton steps on black scholes vega, kept inside a shrinking bracket by bisection
+// every iteration prices the options still unsolved in lanes of the tree, each at its own volatility
+// input.X, input.optionSide and input.v are taken from each option instead, input.v being a last resort seed
+void CalcImpliedVolatility( const structInput& input, size_t nOptions, structSliceOption* rOption, 
+  double epsilon = 0.0001, unsigned int nMaxIterations = 20 );
+
 } // namespace binomial
 } // namespace option
 } // namespace tf
@@ -12,6 +12,7 @@
  * See the file LICENSE.txt for redistribution information.             *
  ************************************************************************/
 
+#include <cmath>
 #include <sstream>
 
 #include <TFHDF5TimeSeries/HDF5DataManager.h>
@@ -24,6 +25,11 @@ namespace ou { // One Unified
 namespace tf { // TradeFrame
 namespace option { // options
 
+namespace {
+  // a quiet spell this long on the underlying is taken as the overnight close
+  const boost::posix_time::time_duration c_tdSessionGap( boost::posix_time::hours( 4 ) );
+}
+
 ExpiryBundle::ExpiryBundle(void)
   : m_stateOptionWatch( EOWSNoWatch ), //m_bWatching( false ), 
   m_dblUpperTrigger( 0.0 ), m_dblLowerTrigger( 0.0 ), m_bfIVUnderlyingCall( 86400 ), m_bfIVUnderlyingPut( 86400 )
@@ -199,10 +205,10 @@ ExpiryBundle::mapStrikes_iter_t ExpiryBundle::FindStrike( double strike ) {
 }
 
 ExpiryBundle::mapStrikes_iter_t ExpiryBundle::FindStrikeAuto( double strike ) {
-  mapStrikes_iter_t iter = m_mapStrikes.find( strike );
-  if ( m_mapStrikes.end() == iter ) {
-    m_mapStrikes[ strike ] = Strike( strike );
-    iter = m_mapStrikes.find( strike );
+  // one search, which is also the insertion hint, chains from OptionChainIndex arrive in strike order
+  mapStrikes_iter_t iter = m_mapStrikes.lower_bound( strike );
+  if ( ( m_mapStrikes.end() == iter ) || ( strike != iter->first ) ) {
+    iter = m_mapStrikes.insert( iter, mapStrikes_t::value_type( strike, Strike( strike ) ) );
   }
   return iter;
 }
@@ -318,48 +324,19 @@ void ExpiryBundle::SetExpiry( ptime dt ) {
   m_dtExpiry = dt;
 }
 
-void ExpiryBundle::CalcGreeksAtStrike( 
-  ptime now, mapStrikes_iter_t iter, ou::tf::option::binomial::structInput& input ) {
-
-  // use the haskell book to get an estimator
-
-  input.X = iter->first;
-
-  // Manaster and Koehler Start Value, Option Pricing Formulas, pg 454
-  double dblVolatilityGuess = std::sqrt( std::abs( std::log( input.S / input.X ) + input.r * input.T ) * 2.0 / input.T );
-  input.v = dblVolatilityGuess;
-
-//  std::cout << "Guess " << input.v << std::endl;
-  
-  if ( 0 != iter->second.Call() ) {
-//    std::cout << "Call @" << input.X << ": ";
-    try {
-      //input.optionSide = ou::tf::OptionSide::Call;
-      //ou::tf::option::binomial::CalcImpliedVolatility( input, iter->second.Call()->LastQuote().Midpoint(), output );
-      //ou::tf::Greek greek( now, output.iv, output.delta, output.gamma, output.theta, output.vega, output.rho );
-      //iter->second.Call()->AppendGreek( greek );
-      iter->second.Call()->CalcGreeks( input, now, false );
-    }
-    catch (...) {
-//      std::cout << iter->second.Call()->GetInstrument()->GetInstrumentName() << ": IV Calc problem" << std::endl;
-    }
-  }
-  if ( 0 != iter->second.Put() ) {
-//    std::cout << "Put  @" << input.X << ": ";
-    try {
-      //input.optionSide = ou::tf::OptionSide::Put;
-      //ou::tf::option::binomial::CalcImpliedVolatility( input, iter->second.Put()->LastQuote().Midpoint(), output );
-      //ou::tf::Greek greek( now, output.iv, output.delta, output.gamma, output.theta, output.vega, output.rho );
-      //iter->second.Put()->AppendGreek( greek );
-      iter->second.Put()->CalcGreeks( input, now, false );
-    }
-    catch (...) {
-//      std::cout << iter->second.Put()->GetInstrument()->GetInstrumentName() << ": IV Calc problem" << std::endl;
-    }
-  }
+void ExpiryBundle::AddToSlice( Option* pOption ) {
+  if ( 0 == pOption ) return;
+  if ( !pOption->Watching() ) return;  // not watching so no active data
+  const double dblMidpoint( pOption->LastQuote().Midpoint() );
+  if ( 0.0 >= dblMidpoint ) return;  // no quote yet
+  m_vSliceOption.push_back( 
+    ou::tf::option::binomial::structSliceOption( 
+      pOption->GetInstrument()->GetOptionSide(), pOption->GetStrike(), dblMidpoint ) );
+  m_vSliceSource.push_back( pOption );
 }
 
-void ExpiryBundle::CalcGreeks( double dblUnderlying, double dblVolHistorical, ptime now, ou::tf::LiborFromIQFeed& libor ) {
+void ExpiryBundle::CalcGreeks( 
+  double dblUnderlying, double dblVolHistorical, ptime now, ou::tf::LiborFromIQFeed& libor, VolSurface* pSurface, RateCache* pRates ) {
 
   assert( boost::posix_time::not_a_date_time != now );
   assert( boost::posix_time::not_a_date_time != m_dtExpiry );
@@ -369,17 +346,47 @@ void ExpiryBundle::CalcGreeks( double dblUnderlying, double dblVolHistorical, pt
   ou::tf::option::binomial::structInput input;
   
   // todo: need to check if m_dtExpiry is utc.
-  Option::CalcRate( input, libor, now, m_dtExpiry );
+  if ( 0 != pRates ) {
+    pRates->Apply( input, libor, now, m_dtExpiry );
+  }
+  else {
+    Option::CalcRate( input, libor, now, m_dtExpiry );
+  }
 
 //  ou::tf::option::binomial::structOutput output;
   input.S = dblUnderlying;
 
   double dblVolatilityGuess = dblVolHistorical / 100.0;
-  input.v = dblVolatilityGuess;
-
-  CalcGreeksAtStrike( now, m_iterUpper, input );
-  CalcGreeksAtStrike( now, m_iterMid, input );
-  CalcGreeksAtStrike( now, m_iterLower, input );
+  input.v = dblVolatilityGuess;  // seed only for options the solver can't otherwise guess
+
+  // every watched option of the expiry, solved together
+  m_vSliceOption.clear();
+  m_vSliceSource.clear();
+  for ( mapStrikes_iter_t iter = m_mapStrikes.begin(); m_mapStrikes.end() != iter; ++iter ) {
+    AddToSlice( iter->second.Call() );
+    AddToSlice( iter->second.Put() );
+  }
+  if ( !m_vSliceOption.empty() ) {
+    if ( 0 != pSurface ) {
+      for ( size_t ix = 0; ix < m_vSliceOption.size(); ++ix ) {
+        m_vSliceOption[ ix ].guess = pSurface->Volatility( m_dtExpiry, m_vSliceOption[ ix ].X );
+      }
+    }
+    ou::tf::option::binomial::CalcImpliedVolatility( input, m_vSliceOption.size(), &m_vSliceOption[ 0 ] );
+    const double dblForward( input.S * std::exp( input.b * input.T ) );
+    for ( size_t ix = 0; ix < m_vSliceOption.size(); ++ix ) {
+      const ou::tf::option::binomial::structSliceOption& option( m_vSliceOption[ ix ] );
+      if ( ou::tf::option::binomial::structSliceOption::Converged == option.status ) {
+        m_vSliceSource[ ix ]->UpdateGreek( now, option.output );
+        if ( 0 != pSurface ) {
+          pSurface->Update( m_dtExpiry, now, input.T, dblForward, option.X, option.optionSide, option.output.iv );
+        }
+      }
+    }
+    if ( 0 != pSurface ) {
+      pSurface->Fit( m_dtExpiry );
+    }
+  }
 
   double dblIvCall( 0.0 );
   double dblIvPut( 0.0 );
@@ -495,6 +502,7 @@ MultiExpiryBundle::~MultiExpiryBundle( void ) {
   if ( 0 != m_pWatchUnderlying.get() ) {
     StopWatch();
     m_pWatchUnderlying->OnQuote.Remove( MakeDelegate( this, &MultiExpiryBundle::HandleUnderlyingQuote ) );
+    m_pWatchUnderlying->OnTrade.Remove( MakeDelegate( this, &MultiExpiryBundle::HandleUnderlyingTrade ) );
     m_pWatchUnderlying.reset();
   }
 }
@@ -532,17 +540,47 @@ void MultiExpiryBundle::SetWatchUnderlying( pInstrument_t& pInstrument, pProvide
   }
   m_pWatchUnderlying.reset( new ou::tf::Watch( pInstrument, pProvider ) );
   m_pWatchUnderlying->OnQuote.Add( MakeDelegate( this, &MultiExpiryBundle::HandleUnderlyingQuote ) );
+  m_pWatchUnderlying->OnTrade.Add( MakeDelegate( this, &MultiExpiryBundle::HandleUnderlyingTrade ) );
 }
 
 void MultiExpiryBundle::HandleUnderlyingQuote( const ou::tf::Quote& quote ) {
+  {
+    boost::mutex::scoped_lock lock( m_mutexMicrostructure );
+    RollSession( quote.DateTime() );
+    m_microstructure.Add( quote );
+  }
   // on quote mid point change of underlying, re-calculate which options to watch
   for ( mapExpiryBundles_t::iterator iter = m_mapExpiryBundles.begin(); m_mapExpiryBundles.end() != iter; ++iter ) {
     iter->second.UpdateATMWatch( quote.Midpoint() );
   }
 };
 
+void MultiExpiryBundle::HandleUnderlyingTrade( const ou::tf::Trade& trade ) {
+  boost::mutex::scoped_lock lock( m_mutexMicrostructure );
+  RollSession( trade.DateTime() );
+  m_microstructure.Add( trade );
+}
+
+void MultiExpiryBundle::RollSession( ptime dt ) {
+  // the estimators hold one session, the overnight return would otherwise land in the first interval
+  if ( !m_dtLastUnderlying.is_not_a_date_time() && ( c_tdSessionGap <= ( dt - m_dtLastUnderlying ) ) ) {
+    m_microstructure.Reset();
+  }
+  m_dtLastUnderlying = dt;
+}
+
+ou::tf::TSMicrostructure MultiExpiryBundle::Microstructure( void ) const {
+  boost::mutex::scoped_lock lock( m_mutexMicrostructure );
+  return m_microstructure;
+}
+
 void MultiExpiryBundle::StartWatch( void ) {
   if ( !m_pWatchUnderlying->Watching() ) {
+    {
+      boost::mutex::scoped_lock lock( m_mutexMicrostructure );
+      m_microstructure.Reset();  // a new watch is a new session
+      m_dtLastUnderlying = boost::posix_time::not_a_date_time;
+    }
     m_pWatchUnderlying->StartWatch();
   }
   // don't start option watch as that is handled via HandleQuote
@@ -559,11 +597,22 @@ void MultiExpiryBundle::StopWatch( void ) {
 }
 
 void MultiExpiryBundle::CalcIV( ptime dtNow /*utc*/, ou::tf::LiborFromIQFeed& libor ) {
+  // intraday realized volatility once enough has been sampled, else the daily fundamental
+  bool bVolatilityReady;
+  double dblVolRealized;
+  {
+    boost::mutex::scoped_lock lock( m_mutexMicrostructure );
+    bVolatilityReady = m_microstructure.VolatilityReady();
+    dblVolRealized = m_microstructure.AnnualizedVolatility();
+  }
+  double dblVolHistorical = bVolatilityReady
+    ? 100.0 * dblVolRealized  // fundamental is in percent
+    : m_pWatchUnderlying->Fundamentals().dblHistoricalVolatility;
   for ( mapExpiryBundles_t::iterator iter = m_mapExpiryBundles.begin(); m_mapExpiryBundles.end() != iter; ++iter ) {
     iter->second.CalcGreeks( 
       m_pWatchUnderlying->LastQuote().Midpoint(), 
-      m_pWatchUnderlying->Fundamentals().dblHistoricalVolatility,
-      dtNow, libor );
+      dblVolHistorical,
+      dtNow, libor, &m_surface, &m_rates );
   }
 }
 
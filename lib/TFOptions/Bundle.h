@@ -16,8 +16,10 @@
 #pragma once
 
 #include <map>
+#include <vector>
 
 #include <boost/smart_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <OUCommon/Delegate.h>
 
@@ -26,11 +28,14 @@
 #include <TFTrading/Watch.h>
 
 #include <TFTimeSeries/BarFactory.h>
+#include <TFTimeSeries/TSMicrostructure.h>
 
 #include <TFIQFeed/MarketSymbol.h>
 
 #include "Binomial.h"
 #include "Strike.h"
+#include "RateCache.h"
+#include "VolSurface.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
@@ -82,7 +87,8 @@ public:
 
   void SetExpiry( ptime dt ); // utc
 
-  void CalcGreeks( double dblUnderlying, double dblVolHistorical, ptime now, ou::tf::LiborFromIQFeed& libor );
+  // with a surface: solver is seeded from the expiry's smile, and the smile is refit with the solved ivs
+  void CalcGreeks( double dblUnderlying, double dblVolHistorical, ptime now, ou::tf::LiborFromIQFeed& libor, VolSurface* pSurface = nullptr, RateCache* pRates = nullptr );
 
 protected:
 private:
@@ -107,11 +113,15 @@ private:
 
   mapStrikes_t m_mapStrikes;
 
+  // scratch for CalcGreeks, the watched options of the expiry, solved as one slice
+  std::vector<ou::tf::option::binomial::structSliceOption> m_vSliceOption;
+  std::vector<Option*> m_vSliceSource;  // option for each entry in m_vSliceOption
+
   mapStrikes_iter_t FindStrike( double strike );
   mapStrikes_iter_t FindStrikeAuto( double strike ); // Auto insert new strike
 
   void RecalcATMWatch( double dblValue );  
-  void CalcGreeksAtStrike( ptime now, mapStrikes_iter_t iter, ou::tf::option::binomial::structInput& input );
+  void AddToSlice( Option* pOption );
 
   void SaveAtmIv( const std::string& sPrefix, const std::string& sPrefix86400Min );
 };
@@ -164,6 +174,8 @@ public:
 
   void SetWatchUnderlying( pInstrument_t& pInstrument, pProvider_t& pProvider );
   pWatch_t GetWatchUnderlying( void ) { return m_pWatchUnderlying; };
+  ou::tf::TSMicrostructure Microstructure( void ) const;  // a copy, the provider thread keeps updating the original
+  const VolSurface& Surface( void ) const { return m_surface; };  // refreshed by CalcIV
 
   // the references are void when the map has insertions or deletions
   bool ExpiryBundleExists( boost::gregorian::date );
@@ -199,8 +211,16 @@ private:
 
   mapExpiryBundles_t m_mapExpiryBundles;
 
+  ou::tf::TSMicrostructure m_microstructure;  // intraday realized volatility of the underlying
+  mutable boost::mutex m_mutexMicrostructure;  // written on the provider thread, read by CalcIV
+  ptime m_dtLastUnderlying;  // last quote or trade added to m_microstructure
+  VolSurface m_surface;  // smile per expiry, from the ivs solved in CalcIV
+  RateCache m_rates;  // T and r per expiry, shared across CalcIV calls
+
   void HandleUnderlyingQuote( const ou::tf::Quote& quote );
-  void HandleUnderlyingTrade( const ou::tf::Trade& trade ) {};
+  void HandleUnderlyingTrade( const ou::tf::Trade& trade );
+  void RollSession( ptime dt );  // with m_mutexMicrostructure held
+
 
 };
 
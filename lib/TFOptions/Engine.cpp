@@ -21,8 +21,10 @@
 
 /* 
  * set watch on option, set watch on underlying
- * as each changes, recalculate option greeks
- * but set a limit of once a second?  or a when a large move hits
+ * as each changes, recalculate option greeks:
+ *   an option is marked dirty when its quote changes, or the underlying midpoint moves past a threshold,
+ *   dirty options are dispatched to the pool, at most one calc in flight per option,
+ *   changes arriving while in flight are coalesced into one more calc on completion
  * 
  */
 
@@ -41,20 +43,35 @@ namespace ou { // One Unified
 namespace tf { // TradeFrame
 namespace option { // options
 
+OptionEntry::OptionEntry(): 
+  m_cntInstances( 0 ), m_dblUnderlyingThreshold( 0.0 ), m_dblMidpointAtCalc( 0.0 ),
+  m_bDirty( false ), m_bInFlight( false ), m_tpDirty( 0 )
+{}
+
 OptionEntry::OptionEntry( OptionEntry&& rhs ) {
   if ( 0 < rhs.m_cntInstances ) {
     rhs.m_pUnderlying->OnQuote.Remove( MakeDelegate( &rhs, &OptionEntry::HandleUnderlyingQuote ) );
+    rhs.m_pOption->OnQuote.Remove( MakeDelegate( &rhs, &OptionEntry::HandleOptionQuote ) );
   }
   m_cntInstances = rhs.m_cntInstances;
   m_pOption = std::move( rhs.m_pOption );
   m_pUnderlying = std::move( rhs.m_pUnderlying );
   m_fGreek = std::move( rhs.m_fGreek );
+  m_fDirty = std::move( rhs.m_fDirty );
+  m_dblUnderlyingThreshold = rhs.m_dblUnderlyingThreshold;
+  m_quoteLastUnderlying = rhs.m_quoteLastUnderlying;
+  m_quoteLastOption = rhs.m_quoteLastOption;
+  m_dblMidpointAtCalc = rhs.m_dblMidpointAtCalc;
+  m_bDirty = rhs.m_bDirty.load();
+  m_bInFlight = rhs.m_bInFlight.load();
+  m_tpDirty = rhs.m_tpDirty.load();
   //m_bStartedWatch = rhs.m_bStartedWatch;
   //rhs.m_bStartedWatch = false;
   rhs.m_cntInstances = 0; // can this be set, what happens on delete?  what happens when tied to m_bStartedWatch?
   //if ( m_bStartedWatch ) {
   if ( 0 < m_cntInstances ) {
     m_pUnderlying->OnQuote.Add( MakeDelegate( this, &OptionEntry::HandleUnderlyingQuote) );
+    m_pOption->OnQuote.Add( MakeDelegate( this, &OptionEntry::HandleOptionQuote ) );
   }
   //PrintState( "OptionEntry::OptionEntry(0)" );
 }
@@ -67,7 +84,9 @@ OptionEntry::OptionEntry( OptionEntry&& rhs ) {
 OptionEntry::OptionEntry( pWatch_t pUnderlying_, pOption_t pOption_, fCallbackWithGreek_t&& fGreek_ ):
   m_pUnderlying( pUnderlying_ ), m_pOption( pOption_ ), m_fGreek( std::move( fGreek_ ) ), 
   //m_bStartedWatch( false ),
-  m_cntInstances( 0 ) // handled by Inc, Dec
+  m_cntInstances( 0 ), // handled by Inc, Dec
+  m_dblUnderlyingThreshold( 0.0 ), m_dblMidpointAtCalc( 0.0 ),
+  m_bDirty( false ), m_bInFlight( false ), m_tpDirty( 0 )
 {
   //m_pUnderlying->OnQuote.Add( MakeDelegate( this, &OptionEntry::HandleUnderlyingQuote) );
   //m_pUnderlying->StartWatch();
@@ -80,7 +99,9 @@ OptionEntry::OptionEntry( pWatch_t pUnderlying_, pOption_t pOption_, fCallbackWi
 OptionEntry::OptionEntry( pWatch_t pUnderlying_, pOption_t pOption_ ):
   m_pUnderlying( pUnderlying_ ), m_pOption( pOption_ ), 
   //m_bStartedWatch( false ),
-  m_cntInstances( 0 )
+  m_cntInstances( 0 ),
+  m_dblUnderlyingThreshold( 0.0 ), m_dblMidpointAtCalc( 0.0 ),
+  m_bDirty( false ), m_bInFlight( false ), m_tpDirty( 0 )
 {
   //m_pUnderlying->OnQuote.Add( MakeDelegate( this, &OptionEntry::HandleUnderlyingQuote) );
   //m_pUnderlying->StartWatch();
@@ -122,9 +143,16 @@ void OptionEntry::PrintState( const std::string id ) {
 
 void OptionEntry::Inc() { 
   if ( 0 == m_cntInstances ) {
+    {
+      std::lock_guard<std::mutex> lock( m_mutexQuote );
+      m_quoteLastUnderlying = m_pUnderlying->LastQuote();  // a watch already running may have gone quiet
+    }
     m_pUnderlying->OnQuote.Add( MakeDelegate( this, &OptionEntry::HandleUnderlyingQuote ) );
+    m_pOption->OnQuote.Add( MakeDelegate( this, &OptionEntry::HandleOptionQuote ) );
     m_pUnderlying->StartWatch();
-    m_pOption->StartWatch();  }
+    m_pOption->StartWatch();
+    MarkDirty();  // calculate once with what is on hand
+  }
   m_cntInstances++; 
 }
 size_t OptionEntry::Dec() { 
@@ -134,24 +162,64 @@ size_t OptionEntry::Dec() {
     m_pUnderlying->StopWatch();
     m_pOption->StopWatch();
     m_pUnderlying->OnQuote.Remove( MakeDelegate( this, &OptionEntry::HandleUnderlyingQuote ) );
+    m_pOption->OnQuote.Remove( MakeDelegate( this, &OptionEntry::HandleOptionQuote ) );
   }
   return m_cntInstances; 
 }
 
+void OptionEntry::SetDirtyCallback( fDirty_t&& fDirty, double dblUnderlyingThreshold ) {
+  m_fDirty = std::move( fDirty );
+  m_dblUnderlyingThreshold = dblUnderlyingThreshold;
+}
+
+void OptionEntry::MarkDirty() {
+  if ( !m_bDirty.exchange( true ) ) {  // already dirty means a calc is pending and will see this change
+    m_tpDirty.store( std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_release );  // read on the strand
+    if ( nullptr != m_fDirty ) m_fDirty( *this );
+  }
+}
 
 void OptionEntry::HandleUnderlyingQuote(const ou::tf::Quote& quote_) {
-  m_quoteLastUnderlying = quote_;
+  bool bMoved;
+  {
+    std::lock_guard<std::mutex> lock( m_mutexQuote );
+    m_quoteLastUnderlying = quote_;
+    bMoved = m_dblUnderlyingThreshold <= std::abs( quote_.Midpoint() - m_dblMidpointAtCalc );
+  }
+  if ( bMoved ) MarkDirty();
 }
 
-//void OptionEntry::HandleOptionQuote(const ou::tf::Quote& quote_) { // should this be kept?
-//  if ( ! m_quoteLastOption.SameBidAsk( quote_ ) ) {
-//    m_quoteLastOption = quote_;
-//    m_bChanged = true;
-//  }
-//}
+void OptionEntry::HandleOptionQuote(const ou::tf::Quote& quote_) {
+  {
+    std::lock_guard<std::mutex> lock( m_mutexQuote );
+    if ( m_quoteLastOption.SameBidAsk( quote_ ) ) return;
+    m_quoteLastOption = quote_;
+  }
+  MarkDirty();
+}
 
-void OptionEntry::Calc( const fCalc_t& fCalc ) {
-  fCalc( m_pOption, m_quoteLastUnderlying, m_fGreek );
+bool OptionEntry::StartCalc( double& dblMidpointUnderlying ) {
+  m_bDirty = false;  // changes from here on need another calc
+  std::lock_guard<std::mutex> lock( m_mutexQuote );
+  dblMidpointUnderlying = m_quoteLastUnderlying.Midpoint();
+  if ( 0.0 >= dblMidpointUnderlying ) return false;  // only start calculations once underlying has quotes
+  m_dblMidpointAtCalc = dblMidpointUnderlying;
+  m_bInFlight = true;
+  return true;
+}
+
+bool OptionEntry::FinishCalc() {
+  m_bInFlight = false;
+  return m_bDirty.load();
+}
+
+void OptionEntry::AbandonCalc() {
+  {
+    std::lock_guard<std::mutex> lock( m_mutexQuote );
+    m_dblMidpointAtCalc = 0.0;  // so the next underlying quote marks dirty
+  }
+  m_bInFlight = false;
+  m_bDirty = false;  // the next change marks dirty, rather than looping on the failure
 }
 
 // ====================
@@ -159,23 +227,24 @@ void OptionEntry::Calc( const fCalc_t& fCalc ) {
 Engine::Engine( const ou::tf::LiborFromIQFeed& feed ): 
   m_InterestRateFeed( feed ), 
   m_srvcWork(boost::asio::make_work_guard( m_srvc )),
-  m_timerScan( m_srvc )
+  m_strand( m_srvc ),
+  m_timerScan( m_srvc ),
+  m_dblUnderlyingThreshold( 0.01 ),
+  m_nDirty( 0 ), m_nInFlight( 0 ), m_nCalcs( 0 ), m_nFailed( 0 ),
+  m_nsWait( 0 ), m_nsCalc( 0 ), m_nsCalcMax( 0 )
 {
   
-  for ( std::size_t ix = 0; ix < 1; ix++ ) {  // change the final value to add threads, and fix the TODO further down
+  for ( std::size_t ix = 0; ix < 1; ix++ ) {  // change the final value to add threads, an option has at most one calc in flight
     m_threads.create_thread( boost::bind( &boost::asio::io_context::run, &m_srvc ) ); // add handlers
-    
-    m_fCalc =
-      [](ou::tf::option::Option::pOption_t pOption, const ou::tf::Quote& quoteUnderlying, fCallbackWithGreek_t& fGreek){
-    };
   }
   
   m_timerScan.expires_after( boost::asio::chrono::milliseconds(1000) );
   m_timerScan.async_wait(
-    boost::bind( 
-      &Engine::HandleTimerScan, this, 
-      boost::asio::placeholders::error 
-      ) 
+    boost::asio::bind_executor( m_strand,
+      boost::bind( 
+        &Engine::HandleTimerScan, this, 
+        boost::asio::placeholders::error 
+        ) )
     );
 }
 
@@ -270,7 +339,7 @@ void Engine::HandleTimerScan( const boost::system::error_code &ec ) {
   else {
     if ( m_srvcWork.owns_work() ) {
       try {
-        ScanOptionEntryQueue();
+        ProcessOptionEntryOperationQueue();
       }
       catch ( std::runtime_error& e ) {
         std::cout << "Engine::HandleTimerScan runtime: " << e.what() << std::endl;
@@ -284,10 +353,11 @@ void Engine::HandleTimerScan( const boost::system::error_code &ec ) {
       m_timerScan.expires_after( boost::asio::chrono::milliseconds(250) );
       //m_timerScan.expires_after( boost::asio::chrono::milliseconds(750) );
       m_timerScan.async_wait(
-        boost::bind( 
-          &Engine::HandleTimerScan, this, 
-          boost::asio::placeholders::error
-          )
+        boost::asio::bind_executor( m_strand,
+          boost::bind( 
+            &Engine::HandleTimerScan, this, 
+            boost::asio::placeholders::error
+            ) )
         );
     }
   }
@@ -320,6 +390,8 @@ void Engine::ProcessOptionEntryOperationQueue() {
           mapOptionEntry_t::iterator iterOption = m_mapOptionEntry.find( MapKey );
           if ( m_mapOptionEntry.end() == iterOption ) {
             iterOption = m_mapOptionEntry.insert( m_mapOptionEntry.begin(), mapOptionEntry_t::value_type(MapKey, std::move( oe.m_oe ) ) );
+            iterOption->second.SetDirtyCallback( 
+              [this](OptionEntry& oe){ HandleDirty( oe ); }, m_dblUnderlyingThreshold );
             //std::cout << "Engine::AddOption: " << MapKey << " added" << std::endl;
           }
           else {
@@ -339,7 +411,9 @@ void Engine::ProcessOptionEntryOperationQueue() {
 
           OptionEntry::size_type cnt = iterOption->second.Dec();
           if ( 0 == cnt ) {
-            m_mapOptionEntry.erase( iterOption );
+            if ( !iterOption->second.InFlight() ) { // otherwise erased in CompleteCalc
+              m_mapOptionEntry.erase( iterOption );
+            }
             //std::cout << "Engine::RemoveOption: " << MapKey << " erased" << std::endl;
           }
           else {
@@ -354,51 +428,106 @@ void Engine::ProcessOptionEntryOperationQueue() {
   }
 }
 
-// TODO: sort map by expiry?  // then Option::CalcRate is required less often
-void Engine::ScanOptionEntryQueue() {
+Engine::Metrics Engine::GetMetrics() {
+  Metrics metrics;
+  metrics.nDirty = m_nDirty;
+  metrics.nInFlight = m_nInFlight;
+  metrics.nCalcs = m_nCalcs;
+  metrics.nFailed = m_nFailed;
+  metrics.dblWaitMean = ( 0 == metrics.nCalcs ) ? 0.0 : 0.001 * m_nsWait / metrics.nCalcs;
+  metrics.dblCalcMean = ( 0 == metrics.nCalcs ) ? 0.0 : 0.001 * m_nsCalc / metrics.nCalcs;
+  metrics.dblCalcMax = 0.001 * m_nsCalcMax;
+  return metrics;
+}
+
+// at most one notice per clean to dirty transition, 
+//   the entry is found again on the strand, as it may have been removed in the meantime
+void Engine::HandleDirty( OptionEntry& oe ) {
+  std::string sKey( oe.UnderlyingName() + "_" + oe.OptionName() );
+  m_nDirty++;
+  boost::asio::post( m_strand, [this, sKey](){ ProcessDirty( sKey ); } );
+}
 
-  ProcessOptionEntryOperationQueue();
+void Engine::ProcessDirty( const std::string& sKey ) {
+  m_nDirty--;
+  mapOptionEntry_t::iterator iterOption = m_mapOptionEntry.find( sKey );  // entries are erased only on the strand
+  if ( m_mapOptionEntry.end() != iterOption ) {
+    if ( 0 < iterOption->second.Instances() ) {
+      Dispatch( iterOption->second );
+    }
+  }
+}
+
+void Engine::Dispatch( OptionEntry& oe ) {
+  
+  if ( oe.InFlight() ) return;  // CompleteCalc dispatches again as it is still dirty
+  
+  const OptionEntry::time_point_t tpDirty( oe.DirtySince() );
+  double midpointUnderlying;
+  if ( !oe.StartCalc( midpointUnderlying ) ) return;
   
   // dtUtcNow needs to be passed by value
   boost::posix_time::ptime dtUtcNow = ou::TimeSource::GlobalInstance().External();
   
-  // TODO:  process only those being watched
+  OptionEntry::pOption_t pOption( oe.GetOption() );
+  fCallbackWithGreek_t fCallbackWithGreek( oe.GetGreekCallback() );
+  OptionEntry* pEntry( &oe );  // not erased while in flight
+  
+  // options of an expiry share T and r, looked up here on the strand rather than per option in the pool
+  ou::tf::option::binomial::structInput input;
+  input.S = midpointUnderlying;
+  try {
+    m_rates.Apply( input, m_InterestRateFeed, dtUtcNow, pOption->GetInstrument()->GetExpiryUtc() );
+  }
+  catch ( std::runtime_error& e ) {
+    std::cout << "Engine::Dispatch rate: " << e.what() << std::endl;
+    m_nFailed++;
+    oe.AbandonCalc();
+    return;
+  }
+  
+  m_nsWait += std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - tpDirty ).count();
+  m_nInFlight++;
+  
+  boost::asio::post( m_srvc, 
+    [this, pEntry, dtUtcNow, pOption, input, fCallbackWithGreek]() mutable {
+      const std::chrono::steady_clock::time_point tpStart( std::chrono::steady_clock::now() );
+      try {
+        //boost::timer::auto_cpu_timer t;
+        pOption->CalcGreeks( input, dtUtcNow, true );
+        if ( nullptr != fCallbackWithGreek ) {
+          fCallbackWithGreek( pOption->LastGreek() ); // need to create the method
+        }
+      }
+      catch ( std::runtime_error& e ) {
+        std::cout << "Engine::Dispatch runtime: " << e.what() << std::endl;
+      }
+      catch (...) {
+        std::cout << "Engine::Dispatch exception: unknown" << std::endl;
+      }
+      const uint64_t nsCalc( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - tpStart ).count() );
+      boost::asio::post( m_strand, [this, pEntry, nsCalc](){ CompleteCalc( *pEntry, nsCalc ); } );
+  });
+}
+
+void Engine::CompleteCalc( OptionEntry& oe, uint64_t nsCalc ) {
+  
+  m_nInFlight--;
+  m_nCalcs++;
+  m_nsCalc += nsCalc;
+  if ( m_nsCalcMax < nsCalc ) m_nsCalcMax = nsCalc;  // only updated on the strand
   
-  // three step lambda call:
-  //  1) lambda for each active mapOptionEntry
-  //  2) capture private values from the OptionEntry
-  //  3) use the values in a background thread for calculations via post to io_service
-  std::for_each( m_mapOptionEntry.begin(), m_mapOptionEntry.end(), 
-                [this, dtUtcNow](mapOptionEntry_t::value_type& vt){
-                  //std::cout << "for each " << vt.second.GetUnderlying()->GetInstrument()->GetInstrumentName() << std::endl;
-                  //std::cout << "         " << vt.second.GetOption()->GetInstrument()->GetInstrumentName() << std::endl;
-                  vt.second.Calc( 
-                    [this, dtUtcNow](OptionEntry::pOption_t pOption, const ou::tf::Quote& quoteUnderlying, fCallbackWithGreek_t& fCallbackWithGreek ){
-                      double midpointUnderlying( quoteUnderlying.Midpoint() );
-                      if ( 0.0 < midpointUnderlying ) {  // only start calculations once underlying has quotes
-                        // TODO: add flag to start calculation only after previous calculation is complete
-                        boost::asio::post( m_srvc, 
-                          [this, dtUtcNow, pOption, midpointUnderlying, fCallbackWithGreek](){
-                            try {
-                              //boost::timer::auto_cpu_timer t;
-                              ou::tf::option::binomial::structInput input;
-                              input.S = midpointUnderlying;
-                              pOption->CalcRate( input, dtUtcNow, m_InterestRateFeed );
-                              pOption->CalcGreeks( input, dtUtcNow, true );
-                              if ( nullptr != fCallbackWithGreek ) {
-                                fCallbackWithGreek( pOption->LastGreek() ); // need to create the method
-                              }
-                            }
-                            catch ( std::runtime_error& e ) {
-                              std::cout << "Engine::ScanOptionEntryQueue runtime: " << e.what() << std::endl;
-                            }
-                            catch (...) {
-                              std::cout << "Engine::ScanOptionEntryQueue exception: unknown" << std::endl;
-                            }                            
-                        });
-                      }
-                  });
-                });
+  const bool bDirty( oe.FinishCalc() );
+  if ( 0 == oe.Instances() ) {  // removed while in flight
+    std::lock_guard<std::mutex> lock(m_mutexOptionEntryOperationQueue);
+    mapOptionEntry_t::iterator iterOption = m_mapOptionEntry.find( oe.UnderlyingName() + "_" + oe.OptionName() );
+    if ( m_mapOptionEntry.end() != iterOption ) {
+      m_mapOptionEntry.erase( iterOption );
+    }
+  }
+  else {
+    if ( bDirty ) Dispatch( oe );
+  }
 }
 
 } // namespace option
@@ -25,6 +25,7 @@
 #include <map>
 #include <queue>
 #include <mutex>
+#include <atomic>
 #include <chrono>
 #include <functional>
 
@@ -38,6 +39,7 @@
 #include <TFTrading/Watch.h>
 
 #include <TFOptions/Option.h>
+#include <TFOptions/RateCache.h>
 
 #include <TFTrading/ProviderManager.h>
 #include <TFTrading/NoRiskInterestRateSeries.h>
@@ -55,7 +57,8 @@ public:
   typedef Option::pOption_t pOption_t;
   //typedef std::function<void(const ou::tf::Greek&)> fGreekResultCallback_t; // engine provides callback of greek calculation
   typedef Option::fCallbackWithGreek_t fCallbackWithGreek_t;
-  typedef std::function<void(pOption_t, const ou::tf::Quote&, fCallbackWithGreek_t&)> fCalc_t; // underlying quote
+  typedef std::function<void(OptionEntry&)> fDirty_t;  // engine is told once per clean to dirty transition
+  typedef std::chrono::steady_clock::time_point time_point_t;
   
 private:
   size_type m_cntInstances; // when pOption and pUnderlying are added in
@@ -64,14 +67,21 @@ private:
   pWatch_t m_pUnderlying;
   fCallbackWithGreek_t m_fGreek;
 
+  fDirty_t m_fDirty;
+  double m_dblUnderlyingThreshold;  // underlying midpoint move which triggers a recalc
+
+  std::mutex m_mutexQuote;  // quotes arrive on the provider thread, are read by the engine
   ou::tf::Quote m_quoteLastUnderlying;
-  //ou::tf::Quote m_quoteLastOption;  // is this actually needed?
-  //double m_dblLastUnderlyingQuote;  // should these be atomic as well?  can doubles be atomic?
-  //double m_dblLastOptionQuote;
+  ou::tf::Quote m_quoteLastOption;
+  double m_dblMidpointAtCalc;  // underlying midpoint used by the last calc dispatched
+
+  std::atomic<bool> m_bDirty;  // a quote changed since the last calc was dispatched
+  std::atomic<bool> m_bInFlight;  // a calc is queued in, or running on, the pool
+  std::atomic<std::chrono::steady_clock::rep> m_tpDirty;  // ticks since epoch when last marked dirty, for the wait metric
   
 public:
   
-  OptionEntry(): m_cntInstances( 0 ) {};
+  OptionEntry();
   //OptionEntry( pOption_t pOption);  // used for storing deletion aspect
   OptionEntry( const OptionEntry& rhs ) = delete;
   OptionEntry( OptionEntry&& rhs );
@@ -86,13 +96,23 @@ public:
   void Inc();
   size_t Dec();
   
-  void Calc( const fCalc_t& );  // supply underlying and option quotes
+  size_type Instances() const { return m_cntInstances; }
+  
+  void SetDirtyCallback( fDirty_t&&, double dblUnderlyingThreshold );
+  bool InFlight() const { return m_bInFlight.load(); }
+  time_point_t DirtySince() const { return time_point_t( time_point_t::duration( m_tpDirty.load( std::memory_order_acquire ) ) ); }
+  bool StartCalc( double& dblMidpointUnderlying );  // marks clean and in flight, false when no underlying quote yet
+  bool FinishCalc();  // clears in flight, true when marked dirty while in flight
+  void AbandonCalc();  // calc not started after all, clean until the next change
   
   pWatch_t GetUnderlying() { return m_pUnderlying; }
   pOption_t GetOption() { return m_pOption; }
+  const fCallbackWithGreek_t& GetGreekCallback() const { return m_fGreek; }
 private:
   
+  void MarkDirty();
   void HandleUnderlyingQuote( const ou::tf::Quote& );
+  void HandleOptionQuote( const ou::tf::Quote& );
   void PrintState( const std::string id );
 
 };
@@ -120,9 +140,25 @@ public:
   typedef std::function<pWatch_t(pInstrument_t)> fBuildWatch_t;  // constructed elsewhere as it needs provider
   typedef std::function<pOption_t(pInstrument_t)> fBuildOption_t;  // constructed elsewhere as it needs provider
   
+  struct Metrics {
+    size_t nDirty;  // options waiting for dispatch
+    size_t nInFlight;  // calcs queued in, or running on, the pool
+    size_t nCalcs;  // calcs completed
+    size_t nFailed;  // calcs not started, the rate lookup failed
+    double dblWaitMean;  // microseconds from marked dirty to dispatched
+    double dblCalcMean;  // microseconds in the calc
+    double dblCalcMax;
+  };
+  
   explicit Engine( const ou::tf::LiborFromIQFeed& );
   virtual ~Engine( );
   
+  // an option is recalculated when its own quote changes, or when the underlying midpoint 
+  //   has moved at least this much since the option's last calc, applies to options added afterwards
+  void SetUnderlyingThreshold( double dblThreshold ) { m_dblUnderlyingThreshold = dblThreshold; }
+  
+  Metrics GetMetrics();
+  
   void Addv1( pOption_t pOption, pWatch_t pUnderlying, fCallbackWithGreek_t&& ); // reference counted(will be a problem with multiple callback destinations, first one wins currently
   void Add( pOption_t pOption, pWatch_t pUnderlying );  // this is better, the option already has a delegate for callback
   void Remove( pOption_t pOption, pWatch_t pUnderlying ); // part of the reference counting, will change reference count on associated underlying and auto remove
@@ -149,11 +185,21 @@ private:
   boost::asio::io_context m_srvc;
   boost::thread_group m_threads;
   boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_srvcWork;
+  boost::asio::io_context::strand m_strand;  // bookkeeping: entry add/remove, dispatch, completion
   boost::asio::steady_timer m_timerScan;
   
-  OptionEntry::fCalc_t m_fCalc;
-  
   const LiborFromIQFeed& m_InterestRateFeed;
+  RateCache m_rates;  // per expiry, used only in Dispatch, so on the strand
+  
+  double m_dblUnderlyingThreshold;
+  
+  std::atomic<size_t> m_nDirty;  // dirty notices posted to the strand, not yet handled
+  std::atomic<size_t> m_nInFlight;
+  std::atomic<size_t> m_nCalcs;
+  std::atomic<size_t> m_nFailed;
+  std::atomic<uint64_t> m_nsWait;  // totals, for the means
+  std::atomic<uint64_t> m_nsCalc;
+  std::atomic<uint64_t> m_nsCalcMax;
   
   struct OptionEntryOperation {
     Action m_action;
@@ -175,7 +221,11 @@ private:
   
   void HandleTimerScan( const boost::system::error_code &ec );
   void ProcessOptionEntryOperationQueue();
-  void ScanOptionEntryQueue();
+  
+  void HandleDirty( OptionEntry& );  // provider thread
+  void ProcessDirty( const std::string& sKey );  // strand
+  void Dispatch( OptionEntry& );  // strand
+  void CompleteCalc( OptionEntry&, uint64_t nsCalc );  // strand
   
 };
 
@@ -0,0 +1,245 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "FiniteDifference.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+namespace fd { // finite difference
+
+namespace {
+
+// per unit of strike, in y = ln( S / K ), tau the time to expiry:
+//   v_tau = 0.5 * sigma^2 * v_yy + ( b - 0.5 * sigma^2 ) * v_y - r * v
+// node i is at y0 + i * h, h is signed:  nodes run from out of the money at 0 to in the money at the last,
+//   so the back substitution starts in the exercise region, as Brennan Schwartz needs for the projection to hold
+
+// scratch space for one thread, grows to the largest grid seen, after which pricing doesn't allocate
+struct Workspace {
+  std::vector<double> vValue;
+  std::vector<double> vPrevious;  // one step nearer expiry, for theta
+  std::vector<double> vPayoff;
+  std::vector<double> vSolve;  // forward elimination
+  std::vector<double> vUpper;  // eliminated upper diagonal, half steps then full steps
+  std::vector<double> vPivot;  // 1 / pivot, half steps then full steps
+  void Size( size_t nNodes ) {
+    if ( vValue.size() < nNodes ) {
+      vValue.resize( nNodes );
+      vPrevious.resize( nNodes );
+      vPayoff.resize( nNodes );
+      vSolve.resize( nNodes );
+      vUpper.resize( 2 * nNodes );
+      vPivot.resize( 2 * nNodes );
+    }
+  }
+};
+
+thread_local Workspace workspace;
+
+// the spatial operator, constant across the grid
+struct Operator {
+  double lower, diag, upper;
+  Operator( const binomial::structInput& input, double h ) {
+    const double alpha( 0.5 * input.v * input.v / ( h * h ) );
+    const double beta( ( input.b - 0.5 * input.v * input.v ) / ( 2.0 * h ) );
+    lower = alpha - beta;
+    diag = -2.0 * alpha - input.r;
+    upper = alpha + beta;
+  }
+};
+
+// theta weighted step, the implicit side is eliminated once per step size
+struct Step {
+  double dtExplicit;  // ( 1 - theta ) * dt
+  double lower, upper;  // implicit side, off diagonals
+  const double* rUpper;
+  const double* rPivot;
+  Step( const Operator& op, double theta, double dt, long nNodes, double* rUpper_, double* rPivot_ )
+  : dtExplicit( ( 1.0 - theta ) * dt ), rUpper( rUpper_ ), rPivot( rPivot_ ) {
+    lower = -theta * dt * op.lower;
+    upper = -theta * dt * op.upper;
+    const double diag( 1.0 - theta * dt * op.diag );
+    rUpper_[ 0 ] = 0.0;  // the first and last rows are boundary values
+    rPivot_[ 0 ] = 1.0;
+    for ( long i = 1; i < nNodes - 1; ++i ) {
+      rPivot_[ i ] = 1.0 / ( diag - lower * rUpper_[ i - 1 ] );
+      rUpper_[ i ] = upper * rPivot_[ i ];
+    }
+  }
+};
+
+// vValue from tau to tau + dt, dBoundary the in the money value at tau + dt
+template<bool bAmerican>
+void Advance( const Step& step, const Operator& op, long nNodes, double dBoundary, Workspace& ws ) {
+
+  double* v( &ws.vValue[ 0 ] );
+  double* d( &ws.vSolve[ 0 ] );
+  const double* payoff( &ws.vPayoff[ 0 ] );
+  const long iLast( nNodes - 1 );
+
+  d[ 0 ] = 0.0;  // far out of the money
+  for ( long i = 1; i < iLast; ++i ) {
+    const double rhs( v[ i ] + step.dtExplicit * ( op.lower * v[ i - 1 ] + op.diag * v[ i ] + op.upper * v[ i + 1 ] ) );
+    d[ i ] = ( rhs - step.lower * d[ i - 1 ] ) * step.rPivot[ i ];
+  }
+  v[ 0 ] = 0.0;
+  v[ iLast ] = dBoundary;
+  for ( long i = iLast - 1; i > 0; --i ) {
+    const double value( d[ i ] - step.rUpper[ i ] * v[ i + 1 ] );
+    v[ i ] = bAmerican ? std::max<double>( value, payoff[ i ] ) : value;
+  }
+}
+
+// far in the money:  the discounted forward less the discounted strike, at least the payoff when american
+double Boundary( const binomial::structInput& input, bool bAmerican, double z, double yLast, double tau ) {
+  const double value( z * ( std::exp( yLast + ( input.b - input.r ) * tau ) - std::exp( -input.r * tau ) ) );
+  return bAmerican ? std::max<double>( value, z * ( std::exp( yLast ) - 1.0 ) ) : value;
+}
+
+// all strikes of one side, the grid spans yMin to yMax, the log moneyness of the outermost strikes
+template<bool bAmerican>
+void Solve( const binomial::structInput& input, const structGrid& grid, double z, double yMin, double yMax,
+  size_t nOptions, const double* rStrike, const ou::tf::OptionSide::enumOptionSide* rSide,
+  ou::tf::OptionSide::enumOptionSide side, binomial::structOutput* rOutput ) {
+
+  const double sd( input.v * std::sqrt( input.T ) );
+  const double yLo( yMin - grid.dblWidth * sd );
+  const double yHi( yMax + grid.dblWidth * sd );
+  long nNodes( (long) std::ceil( ( yHi - yLo ) * grid.nPerStdev / sd ) + 1 );
+  nNodes = std::max<long>( 8, std::min<long>( nNodes, grid.nSpaceMax ) );
+  const double dy( ( yHi - yLo ) / ( nNodes - 1 ) );
+  const double h( 0.0 < z ? dy : -dy );  // calls in the money at high y, puts at low y
+  const double y0( 0.0 < z ? yLo : yHi );
+  const long iLast( nNodes - 1 );
+
+  Workspace& ws( workspace );
+  ws.Size( nNodes );
+  double* v( &ws.vValue[ 0 ] );
+  double* payoff( &ws.vPayoff[ 0 ] );
+  for ( long i = 0; i < nNodes; ++i ) {
+    payoff[ i ] = std::max<double>( 0.0, z * ( std::exp( y0 + i * h ) - 1.0 ) );
+    v[ i ] = payoff[ i ];
+  }
+
+  const long nTime( std::max<long>( 1, grid.nTime ) );
+  const double dt( input.T / nTime );
+  const double yLast( y0 + iLast * h );
+  const Operator op( input, h );
+  const Step stepHalf( op, 1.0, 0.5 * dt, nNodes, &ws.vUpper[ 0 ], &ws.vPivot[ 0 ] );
+  const Step stepFull( op, 0.5, dt, nNodes, &ws.vUpper[ nNodes ], &ws.vPivot[ nNodes ] );
+
+  double tau( 0.0 );
+  for ( long n = 0; n < nTime; ++n ) {
+    if ( nTime - 1 == n ) std::copy( v, v + nNodes, ws.vPrevious.begin() );
+    if ( 0 == n ) {  // Rannacher start
+      Advance<bAmerican>( stepHalf, op, nNodes, Boundary( input, bAmerican, z, yLast, tau + 0.5 * dt ), ws );
+      Advance<bAmerican>( stepHalf, op, nNodes, Boundary( input, bAmerican, z, yLast, tau + dt ), ws );
+    }
+    else {
+      Advance<bAmerican>( stepFull, op, nNodes, Boundary( input, bAmerican, z, yLast, tau + dt ), ws );
+    }
+    tau += dt;
+  }
+
+  // each strike interpolated between its neighbouring nodes:  value cubic hermite on the nodal slopes,
+  //   slope, curvature and time decay linear, so greeks are continuous in the underlying
+  const double* prev( &ws.vPrevious[ 0 ] );
+  for ( size_t ix = 0; ix < nOptions; ++ix ) {
+    if ( side != rSide[ ix ] ) continue;
+    const double K( rStrike[ ix ] );
+    const double y( std::log( input.S / K ) );
+    const double position( ( y - y0 ) / h );
+    const long j( std::max<long>( 1, std::min<long>( iLast - 2, (long) std::floor( position ) ) ) );
+    const double f( position - j );
+
+    const double m0( 0.5 * ( v[ j + 1 ] - v[ j - 1 ] ) );  // slopes per node
+    const double m1( 0.5 * ( v[ j + 2 ] - v[ j ] ) );
+    const double c0( v[ j + 1 ] - 2.0 * v[ j ] + v[ j - 1 ] );  // curvatures per node
+    const double c1( v[ j + 2 ] - 2.0 * v[ j + 1 ] + v[ j ] );
+    const double f2( f * f ), f3( f2 * f );
+    const double value(
+        ( 2.0 * f3 - 3.0 * f2 + 1.0 ) * v[ j ] + ( f3 - 2.0 * f2 + f ) * m0
+      + ( -2.0 * f3 + 3.0 * f2 ) * v[ j + 1 ] + ( f3 - f2 ) * m1 );
+    const double vy( ( ( 1.0 - f ) * m0 + f * m1 ) / h );
+    const double vyy( ( ( 1.0 - f ) * c0 + f * c1 ) / ( h * h ) );
+    const double decay( ( 1.0 - f ) * ( prev[ j ] - v[ j ] ) + f * ( prev[ j + 1 ] - v[ j + 1 ] ) );
+
+    // V = K * v( y ), dV/dS = v_y * K / S, d2V/dS2 = ( v_yy - v_y ) * K / S^2
+    const double KoverS( K / input.S );
+    binomial::structOutput& output( rOutput[ ix ] );
+    output.option = K * value;
+    output.delta = vy * KoverS;
+    output.gamma = ( vyy - vy ) * KoverS / input.S;
+    output.theta = K * decay / dt / 365.0;
+  }
+}
+
+} // namespace anonymous
+
+void CrankNicolson( const binomial::structInput& input, size_t nOptions,
+  const double* rStrike, const ou::tf::OptionSide::enumOptionSide* rSide, binomial::structOutput* rOutput,
+  const structGrid& grid ) {
+
+  if ( 0 == nOptions ) return;
+  if ( ( 0.0 >= input.S ) || ( 0.0 >= input.T ) || ( 0.0 >= input.v ) ) {
+    throw std::runtime_error( "fd::CrankNicolson: S, T and v need to be positive" );
+  }
+
+  bool bCall( false );
+  bool bPut( false );
+  double yCallMin( 0.0 ), yCallMax( 0.0 ), yPutMin( 0.0 ), yPutMax( 0.0 );
+  for ( size_t ix = 0; ix < nOptions; ++ix ) {
+    if ( 0.0 >= rStrike[ ix ] ) throw std::runtime_error( "fd::CrankNicolson: strike needs to be positive" );
+    const double y( std::log( input.S / rStrike[ ix ] ) );
+    switch ( rSide[ ix ] ) {
+    case ou::tf::OptionSide::Call:
+      yCallMin = bCall ? std::min<double>( yCallMin, y ) : y;
+      yCallMax = bCall ? std::max<double>( yCallMax, y ) : y;
+      bCall = true;
+      break;
+    case ou::tf::OptionSide::Put:
+      yPutMin = bPut ? std::min<double>( yPutMin, y ) : y;
+      yPutMax = bPut ? std::max<double>( yPutMax, y ) : y;
+      bPut = true;
+      break;
+    default:
+      throw std::runtime_error( "fd::CrankNicolson: option side needs to be call or put" );
+    }
+  }
+
+  const bool bAmerican( ou::tf::OptionStyle::American == input.optionStyle );
+  if ( bCall ) {
+    if ( bAmerican ) Solve<true>( input, grid, 1.0, yCallMin, yCallMax, nOptions, rStrike, rSide, ou::tf::OptionSide::Call, rOutput );
+    else Solve<false>( input, grid, 1.0, yCallMin, yCallMax, nOptions, rStrike, rSide, ou::tf::OptionSide::Call, rOutput );
+  }
+  if ( bPut ) {
+    if ( bAmerican ) Solve<true>( input, grid, -1.0, yPutMin, yPutMax, nOptions, rStrike, rSide, ou::tf::OptionSide::Put, rOutput );
+    else Solve<false>( input, grid, -1.0, yPutMin, yPutMax, nOptions, rStrike, rSide, ou::tf::OptionSide::Put, rOutput );
+  }
+}
+
+void CrankNicolson( const binomial::structInput& input, binomial::structOutput& output, const structGrid& grid ) {
+  CrankNicolson( input, 1, &input.X, &input.optionSide, &output, grid );
+}
+
+} // namespace fd
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,52 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// Crank Nicolson finite difference pricer, an alternative to binomial::CRR with smooth greeks
+// with one volatility, the value is homogeneous in underlying and strike, V( S, K ) = K * v( ln( S / K ) ),
+//   so one grid in log moneyness prices every strike of an expiry:  one solve for the calls, one for the puts
+// delta and gamma come from differences across the grid, interpolated to each strike,
+//   rather than from the first levels of a tree, so they change smoothly with the underlying
+// the first step is two implicit half steps (Rannacher), which damps the payoff kink CN alone leaves ringing in gamma
+// early exercise is applied in the tridiagonal solve itself (Brennan Schwartz), a single exercise boundary per side
+
+#include "Binomial.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+namespace fd { // finite difference
+
+struct structGrid {
+  long nTime;  // time steps
+  long nPerStdev;  // space nodes per standard deviation of log price to expiry
+  double dblWidth;  // standard deviations beyond the outermost strikes
+  long nSpaceMax;  // caps the nodes for a wide range of strikes, spacing then widens
+  structGrid( void ): nTime( 50 ), nPerStdev( 16 ), dblWidth( 6.0 ), nSpaceMax( 4000 ) {};
+};
+
+// input.X, input.optionSide and input.n are ignored, rStrike[ ix ], rSide[ ix ] price into rOutput[ ix ]
+// option, delta, gamma and theta (per day, as CRR) are set, iv, vega and rho are not
+void CrankNicolson( const binomial::structInput& input, size_t nOptions,
+  const double* rStrike, const ou::tf::OptionSide::enumOptionSide* rSide, binomial::structOutput* rOutput,
+  const structGrid& grid = structGrid() );
+
+// one option, input.X and input.optionSide
+void CrankNicolson( const binomial::structInput& input, binomial::structOutput& output, const structGrid& grid = structGrid() );
+
+} // namespace fd
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -239,6 +239,46 @@ double BSM_Euro::SeedForFutures( void ) {
   return sqrt( abs( log( m_S / m_K ) ) * 2.0 / m_tue );
 }
 
+namespace bsm { // batch
+
+void Price( size_t nOptions, const structBatchInput& in, double* rPrice ) {
+  for ( size_t ix = 0; ix < nOptions; ++ix ) {
+    const double z( in.z[ ix ] );
+    const double VolRootT( in.v[ ix ] * sqrt( in.T[ ix ] ) );
+    const double d1( ( log( in.S[ ix ] / in.K[ ix ] ) + ( in.r[ ix ] - in.q[ ix ] + 0.5 * in.v[ ix ] * in.v[ ix ] ) * in.T[ ix ] ) / VolRootT );
+    const double d2( d1 - VolRootT );
+    rPrice[ ix ] = z * ( in.S[ ix ] * exp( -in.q[ ix ] * in.T[ ix ] ) * NormalCDF( z * d1 ) 
+                       - in.K[ ix ] * exp( -in.r[ ix ] * in.T[ ix ] ) * NormalCDF( z * d2 ) );
+  }
+}
+
+void Greeks( size_t nOptions, const structBatchInput& in, const structBatchOutput& out ) {
+  const double RecipRootTwoPi( 1.0 / sqrt( 2.0 * boost::math::double_constants::pi ) );
+  for ( size_t ix = 0; ix < nOptions; ++ix ) {
+    const double S( in.S[ ix ] ), K( in.K[ ix ] ), T( in.T[ ix ] ), r( in.r[ ix ] ), q( in.q[ ix ] ), v( in.v[ ix ] );
+    const double z( in.z[ ix ] );
+    const double RootT( sqrt( T ) );
+    const double VolRootT( v * RootT );
+    const double d1( ( log( S / K ) + ( r - q + 0.5 * v * v ) * T ) / VolRootT );
+    const double d2( d1 - VolRootT );
+    const double EToQAndTime( exp( -q * T ) );
+    const double EToRateAndTime( exp( -r * T ) );
+    const double Nd1( NormalCDF( z * d1 ) );
+    const double Nd2( NormalCDF( z * d2 ) );
+    const double NPd1( RecipRootTwoPi * exp( -0.5 * d1 * d1 ) );
+    const double S_( S * EToQAndTime );  // discounted for dividends
+    const double K_( K * EToRateAndTime );  // discounted for rate
+    out.price[ ix ] = z * ( S_ * Nd1 - K_ * Nd2 );
+    out.delta[ ix ] = z * EToQAndTime * Nd1;
+    out.gamma[ ix ] = NPd1 * EToQAndTime / ( S * VolRootT );
+    out.vega[ ix ] = S_ * RootT * NPd1;
+    out.theta[ ix ] = -S_ * NPd1 * v / ( 2.0 * RootT ) - z * r * K_ * Nd2 + z * q * S_ * Nd1;
+    out.rho[ ix ] = z * K_ * T * Nd2;
+  }
+}
+
+} // namespace bsm
+
 } // namespace option
 } // namespace tf
 } // namespace ou
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <cmath>
+
 #include <boost/math/distributions/normal.hpp>
 //#include <boost/date_time/posix_time/posix_time.hpp>
 
@@ -92,6 +94,47 @@ private:
   double NPrime( double x );
 };
 
+// batch closed form for european options, generalized black scholes merton, pg 180
+//   arrays rather than a class per option, the loops carry no branches, so vectorize where the
+//   compiler has vector exp and log (eg glibc libmvec with -O3 -ffast-math), else still avoid boost::math per call
+// black 76 on futures:  S is the futures price and q = r
+namespace bsm { // batch
+
+// cumulative standard normal, Abramowitz and Stegun 26.2.17, absolute error < 7.5e-8
+inline double NormalCDF( double x ) {
+  const double ax( x < 0.0 ? -x : x );
+  const double t( 1.0 / ( 1.0 + 0.2316419 * ax ) );
+  const double poly( t * ( 0.319381530 + t * ( -0.356563782 + t * ( 1.781477937 + t * ( -1.821255978 + t * 1.330274429 ) ) ) ) );
+  const double upper( 1.0 - 0.398942280401432678 * std::exp( -0.5 * ax * ax ) * poly );
+  return x < 0.0 ? 1.0 - upper : upper;
+}
+
+struct structBatchInput { // structure of arrays, each with an entry per option
+  const double* S;  // underlying, futures price for black 76
+  const double* K;  // strike
+  const double* T;  // years to expiry
+  const double* r;  // risk free rate
+  const double* q;  // continuous dividend yield
+  const double* v;  // volatility
+  const double* z;  // 1.0 call, -1.0 put
+  structBatchInput( void ): S( 0 ), K( 0 ), T( 0 ), r( 0 ), q( 0 ), v( 0 ), z( 0 ) {};
+};
+
+struct structBatchOutput { // each with an entry per option, units as in BSM_Euro
+  double* price;
+  double* delta;
+  double* gamma;
+  double* theta;  // per year
+  double* vega;  // per 1.0 of volatility
+  double* rho;  // per 1.0 of rate, q held fixed
+  structBatchOutput( void ): price( 0 ), delta( 0 ), gamma( 0 ), theta( 0 ), vega( 0 ), rho( 0 ) {};
+};
+
+void Price( size_t nOptions, const structBatchInput& input, double* rPrice );
+void Greeks( size_t nOptions, const structBatchInput& input, const structBatchOutput& output );  // all outputs needed
+
+} // namespace bsm
+
 } // namespace option
 } // namespace tf
 } // namespace ou
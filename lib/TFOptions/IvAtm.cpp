@@ -128,18 +128,18 @@ double IvAtm::Call_Otm( double value ) {
 }
  
 void IvAtm::SetIQFeedNameCall( double dblStrike, const std::string& sIQFeedSymbolName ) {
-  mapChain_t::iterator iter = m_mapChain.find( dblStrike );
-  if ( m_mapChain.end() == iter ) {
-    iter = m_mapChain.insert( m_mapChain.begin(), mapChain_t::value_type( dblStrike, OptionsAtStrike() ) );
+  mapChain_t::iterator iter = m_mapChain.lower_bound( dblStrike );
+  if ( ( m_mapChain.end() == iter ) || ( dblStrike != iter->first ) ) {
+    iter = m_mapChain.insert( iter, mapChain_t::value_type( dblStrike, OptionsAtStrike() ) );
   }
   assert( 0 == iter->second.sCall.size() );
   iter->second.sCall = sIQFeedSymbolName;
 }
 
 void IvAtm::SetIQFeedNamePut( double dblStrike, const std::string& sIQFeedSymbolName ) {
-  mapChain_t::iterator iter = m_mapChain.find( dblStrike );
-  if ( m_mapChain.end() == iter ) {
-    iter = m_mapChain.insert( m_mapChain.begin(), mapChain_t::value_type( dblStrike, OptionsAtStrike() ) );
+  mapChain_t::iterator iter = m_mapChain.lower_bound( dblStrike );
+  if ( ( m_mapChain.end() == iter ) || ( dblStrike != iter->first ) ) {
+    iter = m_mapChain.insert( iter, mapChain_t::value_type( dblStrike, OptionsAtStrike() ) );
   }
   assert( 0 == iter->second.sPut.size() );
   iter->second.sPut = sIQFeedSymbolName;
@@ -0,0 +1,516 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include <set>
+#include <deque>
+#include <limits>
+#include <algorithm>
+
+#include <TFTrading/PositionGreek.h>
+
+#include "MarginEvaluator.h"
+
+// http://www.cboe.com/LearnCenter/pdf/margin2-00.pdf
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+namespace margin { // options
+
+namespace {
+
+  // a contract after netting, long and short of the same series cancel
+  struct Contract {
+    ou::tf::OptionSide::enumOptionSide side;
+    double dblStrike;
+    boost::gregorian::date dateExpiry;
+    double dblMultiplier;
+    double dblPrice;
+    long quantity;
+  };
+  typedef std::vector<Contract> vContract_t;
+
+  struct CompareSeries {
+    bool operator()( const Contract& lhs, const Contract& rhs ) const {
+      if ( lhs.dblMultiplier != rhs.dblMultiplier ) return lhs.dblMultiplier < rhs.dblMultiplier;
+      if ( lhs.side != rhs.side ) return lhs.side < rhs.side;
+      if ( lhs.dateExpiry != rhs.dateExpiry ) return lhs.dateExpiry < rhs.dateExpiry;
+      return lhs.dblStrike < rhs.dblStrike;
+    }
+  };
+
+  // per share, as in Margin.cpp
+  inline double NakedCall( double S, double K, double price ) {
+    const double otm( std::max( K - S, 0.0 ) );
+    return price + std::max( 0.20 * S - otm, 0.10 * S );
+  }
+
+  inline double NakedPut( double S, double K, double price ) {
+    const double otm( std::max( S - K, 0.0 ) );
+    return price + std::max( 0.20 * S - otm, 0.10 * K );
+  }
+
+  // min cost flow, successive shortest paths, graphs are a few dozen nodes
+  class Flow {
+  public:
+    explicit Flow( size_t nNodes ): m_vAdjacent( nNodes ) {};
+    size_t AddEdge( size_t from, size_t to, long cap, double cost ) {
+      const size_t ix( m_vEdge.size() );
+      m_vEdge.push_back( Edge( to, cap, cost ) );
+      m_vAdjacent[ from ].push_back( ix );
+      m_vEdge.push_back( Edge( from, 0, -cost ) );
+      m_vAdjacent[ to ].push_back( ix + 1 );
+      return ix;
+    }
+    long Used( size_t ixEdge ) const { return m_vEdge[ ixEdge + 1 ].cap; };
+    void Run( size_t source, size_t sink );
+  private:
+    struct Edge {
+      size_t to;
+      long cap;
+      double cost;
+      Edge( size_t to_, long cap_, double cost_ ): to( to_ ), cap( cap_ ), cost( cost_ ) {};
+    };
+    std::vector<Edge> m_vEdge;
+    std::vector<std::vector<size_t> > m_vAdjacent;
+  };
+
+  void Flow::Run( size_t source, size_t sink ) {
+    const size_t nNodes( m_vAdjacent.size() );
+    const double inf( std::numeric_limits<double>::infinity() );
+    std::vector<double> vDistance( nNodes );
+    std::vector<size_t> vVia( nNodes );  // edge into the node on the shortest path
+    std::vector<bool> vQueued( nNodes );
+    std::deque<size_t> queue;
+    while ( true ) {
+      std::fill( vDistance.begin(), vDistance.end(), inf );
+      std::fill( vQueued.begin(), vQueued.end(), false );
+      vDistance[ source ] = 0.0;
+      queue.push_back( source );
+      while ( !queue.empty() ) {  // bellman-ford, residual edges carry negative costs
+        const size_t node( queue.front() );
+        queue.pop_front();
+        vQueued[ node ] = false;
+        for ( size_t ixEdge: m_vAdjacent[ node ] ) {
+          const Edge& edge( m_vEdge[ ixEdge ] );
+          if ( ( 0 < edge.cap ) && ( vDistance[ node ] + edge.cost < vDistance[ edge.to ] - 1e-9 ) ) {
+            vDistance[ edge.to ] = vDistance[ node ] + edge.cost;
+            vVia[ edge.to ] = ixEdge;
+            if ( !vQueued[ edge.to ] ) {
+              vQueued[ edge.to ] = true;
+              queue.push_back( edge.to );
+            }
+          }
+        }
+      }
+      if ( inf == vDistance[ sink ] ) break;
+      long push( std::numeric_limits<long>::max() );
+      for ( size_t node = sink; source != node; node = m_vEdge[ vVia[ node ] ^ 1 ].to ) {
+        push = std::min( push, m_vEdge[ vVia[ node ] ].cap );
+      }
+      for ( size_t node = sink; source != node; node = m_vEdge[ vVia[ node ] ^ 1 ].to ) {
+        m_vEdge[ vVia[ node ] ].cap -= push;
+        m_vEdge[ vVia[ node ] ^ 1 ].cap += push;
+      }
+    }
+  }
+
+  struct Naked {  // a short left uncovered, per contract
+    double requirement;
+    double premium;
+    long quantity;
+    Contract* pContract;  // when pairing ahead of the flow, the short to be reduced
+    Naked( double requirement_, double premium_, long quantity_, Contract* pContract_ = nullptr )
+      : requirement( requirement_ ), premium( premium_ ), quantity( quantity_ ), pContract( pContract_ ) {};
+    bool operator<( const Naked& rhs ) const { return requirement > rhs.requirement; };  // largest first
+  };
+  typedef std::vector<Naked> vNaked_t;
+
+  // the shorts of one side, of one multiplier, against its longs and the underlying
+  //   dblShares is the stock available as cover, reduced by what is used
+  void SolveSide(
+    ou::tf::OptionSide::enumOptionSide side, double S, double dblMultiplier,
+    vContract_t::const_iterator begin, vContract_t::const_iterator end,
+    double& dblShares, Requirement& requirement, vNaked_t& vNaked
+  ) {
+    std::vector<const Contract*> vShort;
+    std::vector<const Contract*> vLong;
+    for ( vContract_t::const_iterator iter = begin; end != iter; ++iter ) {
+      if ( 0 > iter->quantity ) vShort.push_back( &( *iter ) );
+      if ( 0 < iter->quantity ) vLong.push_back( &( *iter ) );
+    }
+    if ( vShort.empty() ) return;
+
+    const bool bCall( ou::tf::OptionSide::Call == side );
+    const long nStock( (long)( dblShares / dblMultiplier ) );  // whole contracts' worth
+
+    // source, shorts, longs, stock, sink
+    const size_t ixSource( 0 );
+    const size_t ixShort( 1 );
+    const size_t ixLong( ixShort + vShort.size() );
+    const size_t ixStock( ixLong + vLong.size() );
+    const size_t ixSink( ixStock + 1 );
+    Flow flow( ixSink + 1 );
+
+    std::vector<size_t> vNakedEdge( vShort.size() );
+    std::vector<std::pair<size_t,double> > vSpreadEdge;  // edge, cost per contract
+    std::vector<std::pair<size_t,double> > vStockEdge;
+    for ( size_t ixS = 0; ixS < vShort.size(); ++ixS ) {
+      const Contract& shrt( *vShort[ ixS ] );
+      const long q( -shrt.quantity );
+      const double K( shrt.dblStrike );
+      flow.AddEdge( ixSource, ixShort + ixS, q, 0.0 );
+      const double naked( dblMultiplier * ( bCall ? NakedCall( S, K, shrt.dblPrice ) : NakedPut( S, K, shrt.dblPrice ) ) );
+      vNakedEdge[ ixS ] = flow.AddEdge( ixShort + ixS, ixSink, q, naked );
+      for ( size_t ixL = 0; ixL < vLong.size(); ++ixL ) {
+        const Contract& lng( *vLong[ ixL ] );
+        if ( lng.dateExpiry < shrt.dateExpiry ) continue;  // long needs to expire on or after the short
+        const double cost( dblMultiplier * std::max( bCall ? lng.dblStrike - K : K - lng.dblStrike, 0.0 ) );
+        vSpreadEdge.push_back( std::make_pair( flow.AddEdge( ixShort + ixS, ixLong + ixL, q, cost ), cost ) );
+      }
+      if ( 0 < nStock ) {
+        const double cost( dblMultiplier * std::max( bCall ? S - K : K - S, 0.0 ) );  // in the money amount
+        vStockEdge.push_back( std::make_pair( flow.AddEdge( ixShort + ixS, ixStock, q, cost ), cost ) );
+      }
+    }
+    for ( size_t ixL = 0; ixL < vLong.size(); ++ixL ) {
+      flow.AddEdge( ixLong + ixL, ixSink, vLong[ ixL ]->quantity, 0.0 );
+    }
+    if ( 0 < nStock ) flow.AddEdge( ixStock, ixSink, nStock, 0.0 );
+
+    flow.Run( ixSource, ixSink );
+
+    for ( size_t ixS = 0; ixS < vShort.size(); ++ixS ) {
+      const long n( flow.Used( vNakedEdge[ ixS ] ) );
+      if ( 0 < n ) {
+        const Contract& shrt( *vShort[ ixS ] );
+        const double K( shrt.dblStrike );
+        const double naked( dblMultiplier * ( bCall ? NakedCall( S, K, shrt.dblPrice ) : NakedPut( S, K, shrt.dblPrice ) ) );
+        vNaked.push_back( Naked( naked, dblMultiplier * shrt.dblPrice, n ) );
+      }
+    }
+    for ( const std::pair<size_t,double>& edge: vSpreadEdge ) {
+      const long n( flow.Used( edge.first ) );
+      requirement.spread += n * edge.second;
+      requirement.nSpread += n;
+    }
+    long nStockUsed( 0 );
+    for ( const std::pair<size_t,double>& edge: vStockEdge ) {
+      const long n( flow.Used( edge.first ) );
+      requirement.covered += n * edge.second;
+      nStockUsed += n;
+    }
+    requirement.nCovered += nStockUsed;
+    dblShares -= nStockUsed * dblMultiplier;
+  }
+
+  // a naked call and a naked put together need the larger requirement plus the other's premium
+  void PairStraddles( vNaked_t& vCall, vNaked_t& vPut, Requirement& requirement ) {
+    std::sort( vCall.begin(), vCall.end() );
+    std::sort( vPut.begin(), vPut.end() );
+    vNaked_t::iterator iterCall( vCall.begin() );
+    vNaked_t::iterator iterPut( vPut.begin() );
+    while ( ( vCall.end() != iterCall ) && ( vPut.end() != iterPut ) ) {
+      const bool bCallLarger( iterCall->requirement >= iterPut->requirement );
+      const double combined( bCallLarger
+        ? iterCall->requirement + iterPut->premium
+        : iterPut->requirement + iterCall->premium );
+      if ( combined >= iterCall->requirement + iterPut->requirement ) {  // no saving, try the next smaller one
+        if ( bCallLarger ) ++iterPut; else ++iterCall;
+        continue;
+      }
+      const long n( std::min( iterCall->quantity, iterPut->quantity ) );
+      requirement.straddle += n * combined;
+      requirement.nStraddle += n;
+      iterCall->quantity -= n;
+      iterPut->quantity -= n;
+      if ( 0 == iterCall->quantity ) ++iterCall;
+      if ( 0 == iterPut->quantity ) ++iterPut;
+    }
+  }
+
+  void AddNaked( const vNaked_t& vCall, const vNaked_t& vPut, Requirement& requirement ) {
+    for ( const Naked& naked: vCall ) {
+      requirement.naked += naked.quantity * naked.requirement;
+      requirement.nNaked += naked.quantity;
+    }
+    for ( const Naked& naked: vPut ) {
+      requirement.naked += naked.quantity * naked.requirement;
+      requirement.nNaked += naked.quantity;
+    }
+  }
+
+  // the contracts of one multiplier, calls ahead of puts, the flow assigns covers to shorts, 
+  //   pairing calls with puts ahead of it can do better when the covers are costly, so both are tried
+  void SolvePartition(
+    bool bPairFirst, double S, double dblMultiplier, vContract_t vContract,
+    double& dblLong, double& dblShort, Requirement& requirement
+  ) {
+    if ( bPairFirst ) {
+      vNaked_t vCall;
+      vNaked_t vPut;
+      for ( Contract& contract: vContract ) {
+        if ( 0 > contract.quantity ) {
+          const double K( contract.dblStrike );
+          if ( ou::tf::OptionSide::Call == contract.side ) {
+            vCall.push_back( Naked( dblMultiplier * NakedCall( S, K, contract.dblPrice ), dblMultiplier * contract.dblPrice, -contract.quantity, &contract ) );
+          }
+          else {
+            vPut.push_back( Naked( dblMultiplier * NakedPut( S, K, contract.dblPrice ), dblMultiplier * contract.dblPrice, -contract.quantity, &contract ) );
+          }
+        }
+      }
+      PairStraddles( vCall, vPut, requirement );
+      for ( const Naked& naked: vCall ) naked.pContract->quantity = -naked.quantity;
+      for ( const Naked& naked: vPut ) naked.pContract->quantity = -naked.quantity;
+    }
+    vContract_t::const_iterator iterSplit( vContract.begin() );  // calls, 'C', sort ahead of puts, 'P'
+    while ( ( vContract.end() != iterSplit ) && ( ou::tf::OptionSide::Call == iterSplit->side ) ) ++iterSplit;
+    vNaked_t vNakedCall;
+    vNaked_t vNakedPut;
+    SolveSide( ou::tf::OptionSide::Call, S, dblMultiplier, vContract.begin(), iterSplit, dblLong, requirement, vNakedCall );
+    SolveSide( ou::tf::OptionSide::Put, S, dblMultiplier, iterSplit, vContract.end(), dblShort, requirement, vNakedPut );
+    PairStraddles( vNakedCall, vNakedPut, requirement );
+    AddNaked( vNakedCall, vNakedPut, requirement );
+  }
+
+}
+
+// ==== Requirement
+
+Requirement& Requirement::operator+=( const Requirement& rhs ) {
+  total += rhs.total; underlying += rhs.underlying; premium += rhs.premium;
+  spread += rhs.spread; covered += rhs.covered; naked += rhs.naked; straddle += rhs.straddle;
+  nSpread += rhs.nSpread; nCovered += rhs.nCovered; nNaked += rhs.nNaked; nStraddle += rhs.nStraddle;
+  return *this;
+}
+
+Requirement& Requirement::operator-=( const Requirement& rhs ) {
+  total -= rhs.total; underlying -= rhs.underlying; premium -= rhs.premium;
+  spread -= rhs.spread; covered -= rhs.covered; naked -= rhs.naked; straddle -= rhs.straddle;
+  nSpread -= rhs.nSpread; nCovered -= rhs.nCovered; nNaked -= rhs.nNaked; nStraddle -= rhs.nStraddle;
+  return *this;
+}
+
+// ==== Leg
+
+Evaluator::Leg Evaluator::Leg::Underlying( const std::string& sUnderlying, long quantity, double dblPrice ) {
+  Leg leg;
+  leg.sUnderlying = sUnderlying;
+  leg.side = ou::tf::OptionSide::Unknown;
+  leg.dblStrike = 0.0;
+  leg.quantity = quantity;
+  leg.dblMultiplier = 1.0;
+  leg.dblPrice = dblPrice;
+  leg.dblUnderlying = dblPrice;
+  return leg;
+}
+
+Evaluator::Leg Evaluator::Leg::Option(
+  const std::string& sUnderlying, ou::tf::OptionSide::enumOptionSide side, double dblStrike, boost::gregorian::date dateExpiry,
+  long quantity, double dblMultiplier, double dblPrice, double dblUnderlying
+) {
+  Leg leg;
+  leg.sUnderlying = sUnderlying;
+  leg.side = side;
+  leg.dblStrike = dblStrike;
+  leg.dateExpiry = dateExpiry;
+  leg.quantity = quantity;
+  leg.dblMultiplier = dblMultiplier;
+  leg.dblPrice = dblPrice;
+  leg.dblUnderlying = dblUnderlying;
+  return leg;
+}
+
+// ==== Evaluator
+
+Evaluator::Evaluator( void ): m_nSkipped( 0 ) {
+}
+
+Evaluator::~Evaluator( void ) {
+}
+
+void Evaluator::Clear( void ) {
+  m_mapGroup.clear();
+  m_mapRequirement.clear();
+  m_requirement = Requirement();
+  m_nSkipped = 0;
+}
+
+void Evaluator::Add( const Leg& leg ) {
+  Group& group( m_mapGroup[ leg.sUnderlying ] );
+  group.vLeg.push_back( leg );
+  group.bChanged = true;
+}
+
+void Evaluator::Load( const ou::tf::Portfolio& portfolio, bool bSubPortfolios ) {
+
+  portfolio.ScanPositions( [this]( ou::tf::Portfolio::pPosition_t pPosition ){
+    const ou::tf::Position::TableRowDef& row( pPosition->GetRow() );
+    if ( 0 == row.nPositionActive ) return;
+    const long quantity( ( ou::tf::OrderSide::Buy == row.eOrderSideActive ? 1 : -1 ) * (long) row.nPositionActive );
+    ou::tf::Instrument::pInstrument_t pInstrument( pPosition->GetInstrument() );
+    const double dblPrice( pPosition->GetWatch()->LastQuote().Midpoint() );
+    if ( pInstrument->IsOption() || pInstrument->IsFuturesOption() ) {
+      ou::tf::PositionGreek* pPositionGreek( dynamic_cast<ou::tf::PositionGreek*>( pPosition.get() ) );
+      if ( ( nullptr == pPositionGreek ) || ( 0.0 >= dblPrice ) ) {
+        ++m_nSkipped;
+        return;
+      }
+      ou::tf::PositionGreek::pUnderlying_t pUnderlying( pPositionGreek->GetUnderlying() );
+      const double dblUnderlying( pUnderlying->LastQuote().Midpoint() );
+      if ( 0.0 >= dblUnderlying ) {
+        ++m_nSkipped;
+        return;
+      }
+      Add( Leg::Option(
+        pUnderlying->GetInstrument()->GetInstrumentName(), pInstrument->GetOptionSide(), pInstrument->GetStrike(),
+        pInstrument->GetExpiry(), quantity, pInstrument->GetMultiplier(), dblPrice, dblUnderlying ) );
+    }
+    else {
+      if ( 0.0 >= dblPrice ) {
+        ++m_nSkipped;
+        return;
+      }
+      Add( Leg::Underlying( pInstrument->GetInstrumentName(), quantity, dblPrice ) );
+    }
+  } );
+
+  if ( bSubPortfolios ) {
+    portfolio.ScanSubPortfolios( [this]( ou::tf::Portfolio::pPortfolio_t pPortfolio ){
+      Load( *pPortfolio, true );
+    } );
+  }
+}
+
+const Requirement& Evaluator::Evaluate( void ) {
+  for ( mapGroup_t::iterator iter = m_mapGroup.begin(); m_mapGroup.end() != iter; ++iter ) {
+    if ( iter->second.bChanged ) {
+      Requirement& requirement( m_mapRequirement[ iter->first ] );
+      requirement = Requirement();
+      Solve( iter->second.vLeg, requirement );
+      iter->second.bChanged = false;
+    }
+  }
+  m_requirement = Requirement();
+  for ( mapRequirement_t::const_iterator iter = m_mapRequirement.begin(); m_mapRequirement.end() != iter; ++iter ) {
+    m_requirement += iter->second;
+  }
+  return m_requirement;
+}
+
+Requirement Evaluator::WhatIf( const vLeg_t& vProposed ) {
+
+  Evaluate();  // brings the cache up to date
+
+  std::set<std::string> setUnderlying;
+  for ( const Leg& leg: vProposed ) setUnderlying.insert( leg.sUnderlying );
+
+  Requirement requirement( m_requirement );
+  vLeg_t vLeg;
+  for ( const std::string& sUnderlying: setUnderlying ) {
+    vLeg.clear();
+    mapGroup_t::const_iterator iterGroup = m_mapGroup.find( sUnderlying );
+    if ( m_mapGroup.end() != iterGroup ) {
+      vLeg = iterGroup->second.vLeg;
+      requirement -= m_mapRequirement[ sUnderlying ];
+    }
+    for ( const Leg& leg: vProposed ) {
+      if ( sUnderlying == leg.sUnderlying ) vLeg.push_back( leg );
+    }
+    Requirement proposed;
+    Solve( vLeg, proposed );
+    requirement += proposed;
+  }
+  return requirement;
+}
+
+// the legs of one underlying
+void Evaluator::Solve( const vLeg_t& vLeg, Requirement& requirement ) {
+
+  double dblShares( 0.0 );
+  double S( 0.0 );
+  vContract_t vContract;
+  for ( const Leg& leg: vLeg ) {
+    if ( ou::tf::OptionSide::Unknown == leg.side ) {
+      dblShares += leg.quantity;
+      S = leg.dblPrice;  // the underlying's own quote is preferred
+    }
+    else {
+      if ( 0.0 == S ) S = leg.dblUnderlying;
+      Contract contract = { leg.side, leg.dblStrike, leg.dateExpiry, leg.dblMultiplier, leg.dblPrice, leg.quantity };
+      vContract.push_back( contract );
+    }
+  }
+
+  // net each series
+  std::sort( vContract.begin(), vContract.end(), CompareSeries() );
+  vContract_t::iterator iterNet( vContract.begin() );
+  for ( vContract_t::iterator iter = vContract.begin(); vContract.end() != iter; ) {
+    Contract net( *iter );
+    for ( ++iter; ( vContract.end() != iter ) && !CompareSeries()( net, *iter ); ++iter ) {
+      net.quantity += iter->quantity;
+    }
+    if ( 0 != net.quantity ) *iterNet++ = net;
+  }
+  vContract.erase( iterNet, vContract.end() );
+
+  if ( 0.0 < dblShares ) requirement.underlying = 0.25 * S * dblShares;
+  if ( 0.0 > dblShares ) requirement.underlying = 0.30 * S * -dblShares;
+
+  for ( const Contract& contract: vContract ) {
+    if ( 0 < contract.quantity ) {
+      requirement.premium += contract.quantity * contract.dblMultiplier * contract.dblPrice;
+    }
+  }
+
+  // by multiplier, the largest first has first claim on the underlying as cover
+  double dblLong( std::max( dblShares, 0.0 ) );  // covers calls
+  double dblShort( std::max( -dblShares, 0.0 ) );  // covers puts
+  vContract_t::const_iterator iterEnd( vContract.end() );
+  while ( vContract.begin() != iterEnd ) {
+    const double dblMultiplier( ( iterEnd - 1 )->dblMultiplier );
+    vContract_t::const_iterator iterBegin( iterEnd );
+    while ( ( vContract.begin() != iterBegin ) && ( dblMultiplier == ( iterBegin - 1 )->dblMultiplier ) ) --iterBegin;
+    const vContract_t vPartition( iterBegin, iterEnd );
+    Requirement flowFirst;
+    double dblLongFlowFirst( dblLong );
+    double dblShortFlowFirst( dblShort );
+    SolvePartition( false, S, dblMultiplier, vPartition, dblLongFlowFirst, dblShortFlowFirst, flowFirst );
+    flowFirst.Sum();
+    Requirement pairFirst;
+    double dblLongPairFirst( dblLong );
+    double dblShortPairFirst( dblShort );
+    SolvePartition( true, S, dblMultiplier, vPartition, dblLongPairFirst, dblShortPairFirst, pairFirst );
+    pairFirst.Sum();
+    if ( pairFirst.total < flowFirst.total ) {
+      requirement += pairFirst;
+      dblLong = dblLongPairFirst;
+      dblShort = dblShortPairFirst;
+    }
+    else {
+      requirement += flowFirst;
+      dblLong = dblLongFlowFirst;
+      dblShort = dblShortFlowFirst;
+    }
+    iterEnd = iterBegin;
+  }
+
+  requirement.Sum();
+}
+
+} // namespace margin
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,117 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// reg-t initial requirement of a whole book, rather than of one known combination as in Margin.h
+// per underlying and multiplier, each short option is either naked, or covered by a long option
+//   of the same side expiring on or after it (a spread), or by the underlying (covered call/put)
+// the cheapest assignment is a min cost flow from the shorts to the covers, calls and puts apart,
+//   shorts left naked are then paired call with put, largest first, as short straddles/strangles,
+//   pairing ahead of the flow is also tried, and the cheaper of the two kept
+// formulas are those of Margin.cpp:  naked, spread, covered, underlying at 25% long / 30% short
+// long options are paid in full
+// Evaluate caches each underlying, so WhatIf, for a pre-trade check, re-solves only the
+//   underlyings of the proposed legs
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/date_time/gregorian/gregorian_types.hpp>
+
+#include <TFTrading/Portfolio.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+namespace margin { // options
+
+struct Requirement {
+  double total;
+  double underlying;  // the underlying itself, long or short
+  double premium;  // long options, paid in full
+  double spread;  // short options covered by long options
+  double covered;  // short options covered by the underlying
+  double naked;
+  double straddle;  // naked calls paired with naked puts
+  long nSpread;  // contracts, of the short leg
+  long nCovered;
+  long nNaked;
+  long nStraddle;  // pairs
+  Requirement( void )
+    : total( 0.0 ), underlying( 0.0 ), premium( 0.0 ), spread( 0.0 ), covered( 0.0 ), naked( 0.0 ), straddle( 0.0 ),
+      nSpread( 0 ), nCovered( 0 ), nNaked( 0 ), nStraddle( 0 ) {};
+  void Sum( void ) { total = underlying + premium + spread + covered + naked + straddle; };
+  Requirement& operator+=( const Requirement& );
+  Requirement& operator-=( const Requirement& );
+};
+
+class Evaluator {
+public:
+
+  struct Leg {
+    std::string sUnderlying;  // name shared by the underlying and its options
+    ou::tf::OptionSide::enumOptionSide side;  // Unknown for the underlying itself
+    double dblStrike;
+    boost::gregorian::date dateExpiry;
+    long quantity;  // signed, contracts or shares
+    double dblMultiplier;
+    double dblPrice;  // per share
+    double dblUnderlying;  // price of the underlying
+    static Leg Underlying( const std::string& sUnderlying, long quantity, double dblPrice );
+    static Leg Option(
+      const std::string& sUnderlying, ou::tf::OptionSide::enumOptionSide, double dblStrike, boost::gregorian::date dateExpiry,
+      long quantity, double dblMultiplier, double dblPrice, double dblUnderlying );
+  };
+  typedef std::vector<Leg> vLeg_t;
+
+  typedef std::map<std::string,Requirement> mapRequirement_t;  // by underlying
+
+  Evaluator( void );
+  ~Evaluator( void );
+
+  void Clear( void );
+  void Add( const Leg& );
+  // active positions, from current quotes, options need to be PositionGreek for their underlying
+  void Load( const ou::tf::Portfolio&, bool bSubPortfolios = true );
+  size_t Skipped( void ) const { return m_nSkipped; };  // positions Load could not price
+
+  const Requirement& Evaluate( void );  // the book, solves only underlyings changed since the last
+  const mapRequirement_t& ByUnderlying( void ) const { return m_mapRequirement; };  // as of Evaluate
+
+  Requirement WhatIf( const vLeg_t& vProposed );  // the book with the proposed legs added
+
+protected:
+private:
+
+  struct Group {
+    vLeg_t vLeg;
+    bool bChanged;
+    Group( void ): bChanged( true ) {};
+  };
+  typedef std::map<std::string,Group> mapGroup_t;
+  mapGroup_t m_mapGroup;
+
+  mapRequirement_t m_mapRequirement;
+  Requirement m_requirement;
+  size_t m_nSkipped;
+
+  static void Solve( const vLeg_t&, Requirement& );
+};
+
+} // namespace margin
+} // namespace option
+} // namespace tf
+} // namespace ou
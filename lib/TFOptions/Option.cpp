@@ -60,6 +60,7 @@ Option::Option( const Option& rhs ) :
 Option::~Option( void ) {
   //std::cout << "Option::~Option destruction: " << m_pInstrument->GetInstrumentName() << std::endl;
 //  StopWatch();  // issues here
+  SetDispatch( 0 );  // before the option's members go, rather than in ~Watch
 }
 
 Option& Option::operator=( const Option& rhs ) {
@@ -173,6 +174,11 @@ void Option::CalcGreeks(
   }
 }
 
+void Option::UpdateGreek( ptime dtUtcNow, const ou::tf::option::binomial::structOutput& output ) {
+  ou::tf::Greek greek( dtUtcNow, output.iv, output.delta, output.gamma, output.theta, output.vega, output.rho );
+  AppendGreek( greek );
+}
+
 bool Option::StopWatch( void ) {
   bool b = Watch::StopWatch();
   if ( b ) {
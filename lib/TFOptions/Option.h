@@ -56,6 +56,8 @@ public:
   void CalcRate( ou::tf::option::binomial::structInput& input, const ptime dtUtcNow, const ou::tf::LiborFromIQFeed& libor );
   // caller needs to have updated input with CalcRate
   void CalcGreeks( ou::tf::option::binomial::structInput& input, ptime dtUtcNow, bool bNeedsGuess = true ); // Calc and Append
+  // append greeks solved elsewhere, as by the slice solver in ExpiryBundle::CalcGreeks
+  void UpdateGreek( ptime dtUtcNow, const ou::tf::option::binomial::structOutput& output );
 
   double ImpliedVolatility( void ) const { return m_greek.ImpliedVolatility(); };
   double Delta( void ) const { return m_greek.Delta(); }
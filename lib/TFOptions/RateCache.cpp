@@ -0,0 +1,79 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "Option.h"
+#include "RateCache.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+RateCache::RateCache( time_duration tdRefresh )
+  : m_tdRefresh( tdRefresh )
+{
+}
+
+RateCache::~RateCache( void ) {
+}
+
+const RateCache::Block& RateCache::Get( const ou::tf::LiborFromIQFeed& libor, ptime dtUtcNow, ptime dtUtcExpiry ) {
+
+  if ( dtUtcNow >= dtUtcExpiry ) {
+    std::stringstream s;
+    s << "RateCache::Get - " << "now=" << dtUtcNow << "," << "expiry=" << dtUtcExpiry;
+    throw std::runtime_error( s.str().c_str() );
+  }
+
+  Entry& entry( m_mapEntry[ dtUtcExpiry ] );
+  const unsigned int nVersion( libor.Version() );
+  if ( ( &libor != entry.pLibor ) || ( nVersion != entry.nVersion ) || ( dtUtcNow >= entry.dtRefresh ) ) {
+    binomial::structInput input;
+    Option::CalcRate( input, libor, dtUtcNow, dtUtcExpiry );
+    Block& block( entry.block );
+    block.T = input.T;
+    block.r = input.r;
+    block.b = input.b;
+    block.discount = std::exp( -input.r * input.T );
+    block.days = input.T * 365.0;
+    entry.dtRefresh = std::min( dtUtcNow + m_tdRefresh, dtUtcExpiry );
+    entry.pLibor = &libor;
+    entry.nVersion = nVersion;
+  }
+  return entry.block;
+}
+
+void RateCache::Apply( binomial::structInput& input, const ou::tf::LiborFromIQFeed& libor, ptime dtUtcNow, ptime dtUtcExpiry ) {
+  const Block& block( Get( libor, dtUtcNow, dtUtcExpiry ) );
+  input.T = block.T;
+  input.r = block.r;
+  input.b = block.b;
+}
+
+void RateCache::Invalidate( void ) {
+  for ( mapEntry_t::iterator iter = m_mapEntry.begin(); m_mapEntry.end() != iter; ++iter ) {
+    iter->second.pLibor = nullptr;
+  }
+}
+
+void RateCache::Erase( ptime dtUtcExpiry ) {
+  m_mapEntry.erase( dtUtcExpiry );
+}
+
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,78 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// time to expiry and rate, computed once per expiry rather than once per option
+// a block is recomputed, through Option::CalcRate, once its refresh interval has passed
+//   or when the curve has ticked since, so between refreshes T is stale by at most the interval
+// not thread safe, each owner uses it from a single thread or strand
+
+#include <map>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "Binomial.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+class LiborFromIQFeed;
+namespace option { // options
+
+class RateCache {
+public:
+
+  typedef boost::posix_time::ptime ptime;
+  typedef boost::posix_time::time_duration time_duration;
+
+  struct Block {
+    double T;  // years, 365 day count
+    double r;
+    double b;  // carry
+    double discount;  // exp( -r * T )
+    double days;  // calendar days to expiry
+    Block( void ): T( 0.0 ), r( 0.0 ), b( 0.0 ), discount( 1.0 ), days( 0.0 ) {};
+  };
+
+  explicit RateCache( time_duration tdRefresh = boost::posix_time::seconds( 1 ) );
+  ~RateCache( void );
+
+  // throws std::runtime_error when now is at or beyond expiry, as Option::CalcRate does
+  const Block& Get( const ou::tf::LiborFromIQFeed&, ptime dtUtcNow, ptime dtUtcExpiry );
+  void Apply( binomial::structInput& input, const ou::tf::LiborFromIQFeed&, ptime dtUtcNow, ptime dtUtcExpiry );  // T, r, b
+
+  void SetRefresh( time_duration td ) { m_tdRefresh = td; };
+  void Invalidate( void );  // every block recomputes on next use
+  void Erase( ptime dtUtcExpiry );
+
+protected:
+private:
+
+  struct Entry {
+    Block block;
+    ptime dtRefresh;  // recompute at or after
+    const ou::tf::LiborFromIQFeed* pLibor;  // curve and its version the block came from
+    unsigned int nVersion;
+    Entry( void ): pLibor( nullptr ), nVersion( 0 ) {};
+  };
+  typedef std::map<ptime,Entry> mapEntry_t;
+  mapEntry_t m_mapEntry;
+
+  time_duration m_tdRefresh;
+
+};
+
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,246 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include <cmath>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include <iostream>
+
+#include <boost/bind.hpp>
+
+#include "Option.h"
+#include "ScenarioGrid.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+namespace {
+  const double c_dblMinVolatility( 0.01 );  // floor on a shifted volatility
+  const double c_dblMinT( 1.0 / ( 365.0 * 24.0 ) );  // less than an hour to go is priced at intrinsic
+}
+
+ScenarioGrid::ScenarioGrid( const ou::tf::LiborFromIQFeed& libor, unsigned int nThreads )
+  : m_libor( libor ), m_nThreads( nThreads ), m_nSteps( binomial::structInput().n ), m_ixNextItem( 0 ),
+    m_srvcWork( boost::asio::make_work_guard( m_srvc ) ),
+    m_nRunning( 0 )
+{
+  if ( 0 == m_nThreads ) m_nThreads = boost::thread::hardware_concurrency();
+  if ( 0 == m_nThreads ) m_nThreads = 1;
+
+  for ( size_t ix = 0; ix < m_nThreads; ++ix ) {
+    m_threads.create_thread( boost::bind( &boost::asio::io_context::run, &m_srvc ) );
+  }
+
+  const double rUnderlying[] = { -0.10, -0.05, -0.02, -0.01, 0.0, 0.01, 0.02, 0.05, 0.10 };
+  const double rVolatility[] = { -0.10, -0.05, 0.0, 0.05, 0.10 };
+  const double rDays[] = { 0.0, 1.0, 7.0 };
+  m_vUnderlying.assign( rUnderlying, rUnderlying + sizeof( rUnderlying ) / sizeof( double ) );
+  m_vVolatility.assign( rVolatility, rVolatility + sizeof( rVolatility ) / sizeof( double ) );
+  m_vDays.assign( rDays, rDays + sizeof( rDays ) / sizeof( double ) );
+}
+
+ScenarioGrid::~ScenarioGrid( void ) {
+  m_srvcWork.reset();
+  m_threads.join_all();
+}
+
+void ScenarioGrid::Evaluate( ptime dtUtcNow, const ou::tf::Portfolio& portfolio, mapMatrix_t& mapMatrix ) {
+
+  m_vGroup.clear();
+  m_vPortfolio.clear();
+  m_mapGroup.clear();
+  Gather( dtUtcNow, portfolio, 0 );
+
+  const size_t nGrid( m_vUnderlying.size() * m_vVolatility.size() * m_vDays.size() );
+  std::vector<Results> vResults( m_nThreads );
+  for ( std::vector<Results>::iterator iter = vResults.begin(); vResults.end() != iter; ++iter ) {
+    iter->vPL.assign( m_vPortfolio.size() * nGrid, 0.0 );
+  }
+
+  Run( &ScenarioGrid::PriceBase, vResults );
+  Run( &ScenarioGrid::PriceGrid, vResults );
+
+  // merge the workers, then roll children into parents, children always follow their parent
+  std::vector<double> vPL( m_vPortfolio.size() * nGrid, 0.0 );
+  for ( std::vector<Results>::const_iterator iter = vResults.begin(); vResults.end() != iter; ++iter ) {
+    for ( size_t ix = 0; ix < vPL.size(); ++ix ) vPL[ ix ] += iter->vPL[ ix ];
+  }
+  for ( size_t ixPortfolio = m_vPortfolio.size(); 1 < ixPortfolio; ) {
+    --ixPortfolio;
+    Portfolio& child( m_vPortfolio[ ixPortfolio ] );
+    Portfolio& parent( m_vPortfolio[ child.ixParent ] );
+    for ( size_t ix = 0; ix < nGrid; ++ix ) {
+      vPL[ child.ixParent * nGrid + ix ] += vPL[ ixPortfolio * nGrid + ix ];
+    }
+    parent.nLegs += child.nLegs;
+    parent.nSkipped += child.nSkipped;
+  }
+
+  mapMatrix.clear();
+  for ( size_t ixPortfolio = 0; ixPortfolio < m_vPortfolio.size(); ++ixPortfolio ) {
+    const Portfolio& p( m_vPortfolio[ ixPortfolio ] );
+    Matrix& matrix( mapMatrix[ p.idPortfolio ] );
+    matrix.vUnderlying = m_vUnderlying;
+    matrix.vVolatility = m_vVolatility;
+    matrix.vDays = m_vDays;
+    matrix.vPL.assign( vPL.begin() + ixPortfolio * nGrid, vPL.begin() + ( ixPortfolio + 1 ) * nGrid );
+    matrix.nLegs = p.nLegs;
+    matrix.nSkipped = p.nSkipped;
+  }
+}
+
+// depth first, so a portfolio's index is always above its parent's
+void ScenarioGrid::Gather( ptime dtUtcNow, const ou::tf::Portfolio& portfolio, size_t ixParent ) {
+
+  const size_t ixPortfolio( m_vPortfolio.size() );
+  m_vPortfolio.push_back( Portfolio( portfolio.GetRow().idPortfolio, m_vPortfolio.empty() ? 0 : ixParent ) );
+
+  portfolio.ScanPositions( [this, dtUtcNow, ixPortfolio]( ou::tf::Portfolio::pPosition_t pPosition ){
+    ou::tf::PositionGreek* pPositionGreek( dynamic_cast<ou::tf::PositionGreek*>( pPosition.get() ) );
+    if ( nullptr == pPositionGreek ) return;  // not an option leg
+    const ou::tf::Position::TableRowDef& row( pPositionGreek->GetRow() );
+    if ( 0 == row.nPositionActive ) return;
+
+    ou::tf::PositionGreek::pOption_t pOption( pPositionGreek->GetOption() );
+    ou::tf::PositionGreek::pUnderlying_t pUnderlying( pPositionGreek->GetUnderlying() );
+    const double S( pUnderlying->LastQuote().Midpoint() );
+    const double v( pOption->ImpliedVolatility() );
+    ou::tf::Instrument::pInstrument_t pInstrument( pOption->GetInstrument() );
+    const ptime dtExpiry( pInstrument->GetExpiryUtc() );
+    if ( ( 0.0 >= S ) || ( 0.0 >= v ) || ( dtUtcNow >= dtExpiry ) ) {
+      ++m_vPortfolio[ ixPortfolio ].nSkipped;
+      return;
+    }
+
+    const keyGroup_t key( pUnderlying.get(), dtExpiry );
+    mapGroup_t::iterator iterGroup = m_mapGroup.find( key );
+    if ( m_mapGroup.end() == iterGroup ) {
+      iterGroup = m_mapGroup.insert( mapGroup_t::value_type( key, m_vGroup.size() ) ).first;
+      m_vGroup.push_back( Group() );
+      binomial::structInput& input( m_vGroup.back().input );
+      input.S = S;
+      input.n = m_nSteps;
+      m_rates.Apply( input, m_libor, dtUtcNow, dtExpiry );
+    }
+
+    const double quantity(
+      ( ou::tf::OrderSide::Sell == row.eOrderSideActive ? -1.0 : 1.0 )
+      * row.nPositionActive * pInstrument->GetMultiplier() );
+    m_vGroup[ iterGroup->second ].vLeg.push_back(
+      Leg( pOption->GetStrike(), pInstrument->GetOptionSide(), v, quantity, ixPortfolio ) );
+    ++m_vPortfolio[ ixPortfolio ].nLegs;
+  } );
+
+  portfolio.ScanSubPortfolios( [this, dtUtcNow, ixPortfolio]( ou::tf::Portfolio::pPortfolio_t pPortfolio ){
+    Gather( dtUtcNow, *pPortfolio, ixPortfolio );
+  } );
+}
+
+// one pass per worker on the pool, returns once each has finished
+void ScenarioGrid::Run( void ( ScenarioGrid::*pWorker )( Results& ), std::vector<Results>& vResults ) {
+  m_ixNextItem = 0;
+  {
+    boost::mutex::scoped_lock lock( m_mutexRun );
+    m_nRunning = m_nThreads;
+  }
+  for ( size_t ix = 0; ix < m_nThreads; ++ix ) {
+    Results* pResults( &vResults[ ix ] );
+    boost::asio::post( m_srvc, [this, pWorker, pResults](){
+      try {
+        ( this->*pWorker )( *pResults );
+      }
+      catch ( std::runtime_error& e ) {
+        std::cout << "ScenarioGrid::Run runtime: " << e.what() << std::endl;
+      }
+      catch (...) {
+        std::cout << "ScenarioGrid::Run exception: unknown" << std::endl;
+      }
+      boost::mutex::scoped_lock lock( m_mutexRun );
+      if ( 0 == --m_nRunning ) m_cvRun.notify_all();
+    } );
+  }
+  boost::mutex::scoped_lock lock( m_mutexRun );
+  while ( 0 != m_nRunning ) m_cvRun.wait( lock );
+}
+
+// each group's legs at the unshifted point, the reference for the p/l
+void ScenarioGrid::PriceBase( Results& results ) {
+  for ( size_t ix = m_ixNextItem++; m_vGroup.size() > ix; ix = m_ixNextItem++ ) {
+    Group& group( m_vGroup[ ix ] );
+    Price( results, group, group.input.S, group.input.T, 0.0 );
+    for ( size_t ixLeg = 0; ixLeg < group.vLeg.size(); ++ixLeg ) {
+      group.vLeg[ ixLeg ].value = results.vOutput[ ixLeg ].option;
+    }
+  }
+}
+
+// an item is a group at one grid point, group major so neighbouring items share the rate inputs
+void ScenarioGrid::PriceGrid( Results& results ) {
+  const size_t nU( m_vUnderlying.size() );
+  const size_t nV( m_vVolatility.size() );
+  const size_t nGrid( nU * nV * m_vDays.size() );
+  const size_t nItems( m_vGroup.size() * nGrid );
+  for ( size_t ix = m_ixNextItem++; nItems > ix; ix = m_ixNextItem++ ) {
+    const Group& group( m_vGroup[ ix / nGrid ] );
+    const size_t ixGrid( ix % nGrid );
+    const size_t ixU( ixGrid % nU );
+    const size_t ixV( ( ixGrid / nU ) % nV );
+    const size_t ixD( ixGrid / ( nU * nV ) );
+
+    const double S( group.input.S * ( 1.0 + m_vUnderlying[ ixU ] ) );
+    const double T( group.input.T - m_vDays[ ixD ] / 365.0 );
+    Price( results, group, S, T, m_vVolatility[ ixV ] );
+
+    for ( size_t ixLeg = 0; ixLeg < group.vLeg.size(); ++ixLeg ) {
+      const Leg& leg( group.vLeg[ ixLeg ] );
+      results.vPL[ leg.ixPortfolio * nGrid + ixGrid ] += leg.quantity * ( results.vOutput[ ixLeg ].option - leg.value );
+    }
+  }
+}
+
+// leaves the group's leg values in results.vOutput
+void ScenarioGrid::Price( Results& results, const Group& group, double S, double T, double dv ) {
+  const size_t nLegs( group.vLeg.size() );
+  results.vOutput.resize( nLegs );
+  if ( c_dblMinT > T ) {
+    for ( size_t ix = 0; ix < nLegs; ++ix ) {
+      const Leg& leg( group.vLeg[ ix ] );
+      const double intrinsic( ou::tf::OptionSide::Call == leg.side ? S - leg.X : leg.X - S );
+      results.vOutput[ ix ] = binomial::structOutput();
+      results.vOutput[ ix ].option = std::max( 0.0, intrinsic );
+    }
+  }
+  else {
+    results.vStrike.resize( nLegs );
+    results.vSide.resize( nLegs );
+    results.vVolatility.resize( nLegs );
+    for ( size_t ix = 0; ix < nLegs; ++ix ) {
+      const Leg& leg( group.vLeg[ ix ] );
+      results.vStrike[ ix ] = leg.X;
+      results.vSide[ ix ] = leg.side;
+      results.vVolatility[ ix ] = std::max( c_dblMinVolatility, leg.v + dv );
+    }
+    binomial::structInput input( group.input );
+    input.S = S;
+    input.T = T;
+    binomial::CRR( input, nLegs, &results.vStrike[ 0 ], &results.vSide[ 0 ], &results.vVolatility[ 0 ], &results.vOutput[ 0 ] );
+  }
+}
+
+} // namespace option
+} // namespace tf
+} // namespace ou
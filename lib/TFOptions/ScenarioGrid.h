@@ -0,0 +1,148 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// scenario risk:  reprice every option position of a portfolio tree across a grid of
+//   underlying shift x volatility shift x days forward, giving a p/l matrix for each portfolio
+// legs are grouped by underlying and expiry, so each grid point of a group is one slice of
+//   the lane kernel, grid points are claimed by worker threads from a shared index
+// p/l is against each leg repriced at the unshifted point, so model error drops out and the
+//   zero shift of the zero day scenario is 0
+// sub portfolios roll up into their parents, the option legs are the PositionGreek positions of the tree
+// the workers are started once, with the grid, and are handed each pass of an evaluation
+
+#include <map>
+#include <atomic>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <TFTrading/PortfolioGreek.h>
+
+#include "Binomial.h"
+#include "RateCache.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+class LiborFromIQFeed;
+namespace option { // options
+
+class ScenarioGrid {
+public:
+
+  typedef boost::posix_time::ptime ptime;
+  typedef ou::tf::Portfolio::idPortfolio_t idPortfolio_t;
+  typedef std::vector<double> vShift_t;
+
+  struct Matrix {
+    vShift_t vUnderlying;  // copies of the grid's axes
+    vShift_t vVolatility;
+    vShift_t vDays;
+    std::vector<double> vPL;  // days major, underlying minor
+    size_t nLegs;  // priced in this portfolio and below
+    size_t nSkipped;  // no quote on the underlying, no implied volatility, or expired
+    Matrix( void ): nLegs( 0 ), nSkipped( 0 ) {};
+    double PL( size_t ixDays, size_t ixVolatility, size_t ixUnderlying ) const {
+      return vPL[ ( ixDays * vVolatility.size() + ixVolatility ) * vUnderlying.size() + ixUnderlying ];
+    };
+  };
+  typedef std::map<idPortfolio_t,Matrix> mapMatrix_t;
+
+  explicit ScenarioGrid( const ou::tf::LiborFromIQFeed& libor, unsigned int nThreads = 0 );  // 0: one thread per core
+  ~ScenarioGrid( void );
+
+  void SetUnderlyingShifts( const vShift_t& v ) { m_vUnderlying = v; };  // fraction of the price, -0.1 is a 10% drop
+  void SetVolatilityShifts( const vShift_t& v ) { m_vVolatility = v; };  // absolute, 0.05 adds five vol points
+  void SetDaysForward( const vShift_t& v ) { m_vDays = v; };  // calendar days
+  void SetSteps( long n ) { m_nSteps = n; };  // tree depth, fewer steps trades accuracy for speed
+
+  // quotes and implied volatilities are read once, up front, on the calling thread
+  void Evaluate( ptime dtUtcNow, const ou::tf::Portfolio&, mapMatrix_t& );
+
+protected:
+private:
+
+  struct Leg {
+    double X;
+    ou::tf::OptionSide::enumOptionSide side;
+    double v;
+    double quantity;  // signed, times the multiplier
+    double value;  // at the unshifted point
+    size_t ixPortfolio;
+    Leg( double X_, ou::tf::OptionSide::enumOptionSide side_, double v_, double quantity_, size_t ixPortfolio_ )
+      : X( X_ ), side( side_ ), v( v_ ), quantity( quantity_ ), value( 0.0 ), ixPortfolio( ixPortfolio_ ) {};
+  };
+  typedef std::vector<Leg> vLeg_t;
+
+  struct Group {  // legs sharing an underlying and expiry
+    binomial::structInput input;  // S, T, r, b at the unshifted point
+    vLeg_t vLeg;
+  };
+  typedef std::vector<Group> vGroup_t;
+  typedef std::pair<const ou::tf::Watch*,ptime> keyGroup_t;  // underlying, expiry
+  typedef std::map<keyGroup_t,size_t> mapGroup_t;  // index into vGroup_t
+
+  struct Portfolio {
+    idPortfolio_t idPortfolio;
+    size_t ixParent;  // ix of itself at the root
+    size_t nLegs;
+    size_t nSkipped;
+    Portfolio( const idPortfolio_t& id, size_t ixParent_ ): idPortfolio( id ), ixParent( ixParent_ ), nLegs( 0 ), nSkipped( 0 ) {};
+  };
+  typedef std::vector<Portfolio> vPortfolio_t;
+
+  // per worker, buffers are reused from one grid point to the next
+  struct Results {
+    std::vector<double> vPL;  // per portfolio, each a full grid
+    vShift_t vStrike;
+    std::vector<ou::tf::OptionSide::enumOptionSide> vSide;
+    vShift_t vVolatility;
+    std::vector<binomial::structOutput> vOutput;
+  };
+
+  const ou::tf::LiborFromIQFeed& m_libor;
+  unsigned int m_nThreads;
+  long m_nSteps;
+  RateCache m_rates;  // groups sharing an expiry, and successive evaluations, share T and r
+
+  vShift_t m_vUnderlying;
+  vShift_t m_vVolatility;
+  vShift_t m_vDays;
+
+  vGroup_t m_vGroup;
+  mapGroup_t m_mapGroup;
+  vPortfolio_t m_vPortfolio;
+  std::atomic<size_t> m_ixNextItem;  // workers claim the group or grid point at this index
+
+  boost::asio::io_context m_srvc;
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_srvcWork;
+  boost::thread_group m_threads;
+
+  boost::mutex m_mutexRun;
+  boost::condition_variable m_cvRun;
+  size_t m_nRunning;  // workers yet to finish the current pass
+
+  void Gather( ptime dtUtcNow, const ou::tf::Portfolio&, size_t ixParent );
+  void Run( void ( ScenarioGrid::*pWorker )( Results& ), std::vector<Results>& );
+  void PriceBase( Results& );
+  void PriceGrid( Results& );
+  void Price( Results&, const Group&, double S, double T, double dv );
+};
+
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,376 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include <cmath>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+
+#include "VolSurface.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+namespace {
+
+const size_t c_nParameters = 5;  // a, b, rho, m, sigma
+const size_t c_nMinimumForSVI = c_nParameters;  // fewer observations than this are interpolated
+const unsigned int c_nIterationsCold = 40;  // levenberg marquardt steps for a first fit
+const unsigned int c_nIterationsWarm = 8;  // steps when starting from the prior fit
+
+// gaussian elimination with partial pivoting, A is n x n row major, solution left in b
+bool Solve( double* A, double* b, size_t n ) {
+  for ( size_t col = 0; col < n; ++col ) {
+    size_t ixPivot( col );
+    for ( size_t row = col + 1; row < n; ++row ) {
+      if ( std::fabs( A[ row * n + col ] ) > std::fabs( A[ ixPivot * n + col ] ) ) ixPivot = row;
+    }
+    if ( 0.0 == A[ ixPivot * n + col ] ) return false;
+    if ( ixPivot != col ) {
+      for ( size_t ix = 0; ix < n; ++ix ) std::swap( A[ col * n + ix ], A[ ixPivot * n + ix ] );
+      std::swap( b[ col ], b[ ixPivot ] );
+    }
+    for ( size_t row = col + 1; row < n; ++row ) {
+      const double factor( A[ row * n + col ] / A[ col * n + col ] );
+      for ( size_t ix = col; ix < n; ++ix ) A[ row * n + ix ] -= factor * A[ col * n + ix ];
+      b[ row ] -= factor * b[ col ];
+    }
+  }
+  for ( size_t row = n; row-- > 0; ) {
+    double sum( b[ row ] );
+    for ( size_t ix = row + 1; ix < n; ++ix ) sum -= A[ row * n + ix ] * b[ ix ];
+    b[ row ] = sum / A[ row * n + row ];
+  }
+  return true;
+}
+
+// keep the parameters where the curve is a valid smile
+void Constrain( VolSurface::SVI& svi ) {
+  svi.b = std::max<double>( 0.0, svi.b );
+  svi.rho = std::max<double>( -0.999, std::min<double>( 0.999, svi.rho ) );
+  svi.sigma = std::max<double>( 0.0001, svi.sigma );
+  const double floor( -svi.b * svi.sigma * std::sqrt( 1.0 - svi.rho * svi.rho ) );  // minimum variance non-negative
+  svi.a = std::max<double>( floor, svi.a );
+}
+
+// the in the money side of a strike is left out, its iv mostly reflects the intrinsic value
+bool InTheMoney( VolSurface::enumOptionSide side, double dblStrike, double dblForward ) {
+  switch ( side ) {
+    case ou::tf::OptionSide::Call: return dblStrike < dblForward;
+    case ou::tf::OptionSide::Put: return dblStrike > dblForward;
+    default: return true;  // unknown side, not used
+  }
+}
+
+double SumOfSquares( const VolSurface::SVI& svi, const std::vector<double>& vk, const std::vector<double>& vw ) {
+  double sum( 0.0 );
+  for ( size_t ix = 0; ix < vk.size(); ++ix ) {
+    const double diff( svi.Variance( vk[ ix ] ) - vw[ ix ] );
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+} // namespace anonymous
+
+// ==== SVI
+
+double VolSurface::SVI::Variance( double k ) const {
+  const double d( k - m );
+  return a + b * ( rho * d + std::sqrt( d * d + sigma * sigma ) );
+}
+
+// ==== Smile
+
+VolSurface::Smile::Smile( void )
+: m_T( 0.0 ), m_dblForward( 0.0 ), m_bFitted( false ), m_bChanged( false ), m_dblResidual( 0.0 )
+{}
+
+void VolSurface::Smile::Update( ptime dtObserved, double T, double dblForward, double dblStrike, enumOptionSide side, double dblIV ) {
+  assert( 0.0 < T );
+  assert( 0.0 < dblForward );
+  assert( 0.0 < dblStrike );
+  m_T = T;
+  if ( m_dblForward != dblForward ) {
+    m_dblForward = dblForward;
+    m_bChanged = true;  // the fit moves with the forward, even without new ivs
+  }
+  if ( m_dtLatest.is_not_a_date_time() || ( m_dtLatest < dtObserved ) ) m_dtLatest = dtObserved;
+  if ( InTheMoney( side, dblStrike, dblForward ) ) return;  // the put or call at the strike carries the smile
+  mapObservation_t::iterator iter = m_mapObservation.find( dblStrike );
+  if ( m_mapObservation.end() == iter ) {
+    m_mapObservation.insert( mapObservation_t::value_type( dblStrike, Observation( dtObserved, side, dblIV ) ) );
+  }
+  else {
+    iter->second.dt = dtObserved;
+    iter->second.side = side;
+    iter->second.iv = dblIV;
+  }
+  m_bChanged = true;
+}
+
+void VolSurface::Smile::Fit( const time_duration& tdMaxAge ) {
+
+  m_bChanged = false;
+
+  // drop what has gone stale, or into the money, since it was observed
+  const ptime dtOldest( m_dtLatest - tdMaxAge );
+  for ( mapObservation_t::iterator iter = m_mapObservation.begin(); m_mapObservation.end() != iter; ) {
+    if ( ( iter->second.dt < dtOldest ) || InTheMoney( iter->second.side, iter->first, m_dblForward ) ) {
+      m_mapObservation.erase( iter++ );
+    }
+    else {
+      ++iter;
+    }
+  }
+
+  const size_t n( m_mapObservation.size() );
+  if ( c_nMinimumForSVI > n ) {
+    m_bFitted = false;
+    m_dblResidual = 0.0;
+    return;
+  }
+
+  std::vector<double> vk;
+  std::vector<double> vw;
+  vk.reserve( n );
+  vw.reserve( n );
+  for ( mapObservation_t::const_iterator iter = m_mapObservation.begin(); m_mapObservation.end() != iter; ++iter ) {
+    vk.push_back( K( iter->first ) );
+    vw.push_back( iter->second.iv * iter->second.iv * m_T );
+  }
+
+  SVI svi( m_svi );
+  unsigned int nIterations( c_nIterationsWarm );
+  if ( !m_bFitted ) {  // cold start: vertex at the lowest variance, wings from the average slope out to the ends
+    nIterations = c_nIterationsCold;
+    const size_t ixMin( std::min_element( vw.begin(), vw.end() ) - vw.begin() );
+    svi.m = vk[ ixMin ];
+    svi.rho = 0.0;
+    svi.sigma = 0.1;
+    const double slopeLeft( ( 0 == ixMin ) ? 0.0 : ( vw.front() - vw[ ixMin ] ) / ( vk[ ixMin ] - vk.front() ) );
+    const double slopeRight( ( n - 1 == ixMin ) ? 0.0 : ( vw.back() - vw[ ixMin ] ) / ( vk.back() - vk[ ixMin ] ) );
+    svi.b = std::max<double>( 0.001, 0.5 * ( slopeLeft + slopeRight ) );
+    svi.a = vw[ ixMin ] - svi.b * svi.sigma;
+    Constrain( svi );
+  }
+
+  // levenberg marquardt on the total variance residuals
+  double cost( SumOfSquares( svi, vk, vw ) );
+  double lambda( 0.001 );
+  for ( unsigned int nIteration = 0; nIteration < nIterations; ++nIteration ) {
+    double JtJ[ c_nParameters * c_nParameters ] = { 0.0 };
+    double Jtr[ c_nParameters ] = { 0.0 };
+    for ( size_t ix = 0; ix < n; ++ix ) {
+      const double d( vk[ ix ] - svi.m );
+      const double s( std::sqrt( d * d + svi.sigma * svi.sigma ) );
+      const double r( svi.a + svi.b * ( svi.rho * d + s ) - vw[ ix ] );
+      const double J[ c_nParameters ] = {
+        1.0,  // a
+        svi.rho * d + s,  // b
+        svi.b * d,  // rho
+        -svi.b * ( svi.rho + d / s ),  // m
+        svi.b * svi.sigma / s  // sigma
+      };
+      for ( size_t row = 0; row < c_nParameters; ++row ) {
+        Jtr[ row ] -= J[ row ] * r;
+        for ( size_t col = 0; col < c_nParameters; ++col ) {
+          JtJ[ row * c_nParameters + col ] += J[ row ] * J[ col ];
+        }
+      }
+    }
+    bool bImproved( false );
+    while ( !bImproved && ( 1e10 > lambda ) ) {
+      double A[ c_nParameters * c_nParameters ];
+      double step[ c_nParameters ];
+      std::copy( JtJ, JtJ + c_nParameters * c_nParameters, A );
+      std::copy( Jtr, Jtr + c_nParameters, step );
+      for ( size_t ix = 0; ix < c_nParameters; ++ix ) {
+        A[ ix * c_nParameters + ix ] *= ( 1.0 + lambda );
+        A[ ix * c_nParameters + ix ] += 1e-12;  // b = 0 leaves rho, m, sigma without gradient
+      }
+      if ( Solve( A, step, c_nParameters ) ) {
+        SVI trial( svi );
+        trial.a += step[ 0 ];
+        trial.b += step[ 1 ];
+        trial.rho += step[ 2 ];
+        trial.m += step[ 3 ];
+        trial.sigma += step[ 4 ];
+        Constrain( trial );
+        const double costTrial( SumOfSquares( trial, vk, vw ) );
+        if ( costTrial < cost ) {
+          bImproved = true;
+          const double improvement( cost - costTrial );
+          svi = trial;
+          cost = costTrial;
+          lambda = std::max<double>( 1e-7, lambda / 3.0 );
+          if ( 1e-12 * cost >= improvement ) nIteration = nIterations;  // converged
+        }
+      }
+      if ( !bImproved ) lambda *= 3.0;
+    }
+    if ( !bImproved ) break;  // at a minimum, or as close as it gets
+  }
+
+  if ( std::isfinite( cost ) ) {
+    m_svi = svi;
+    m_bFitted = true;
+    double sum( 0.0 );
+    for ( size_t ix = 0; ix < n; ++ix ) {
+      const double diff( std::sqrt( std::max<double>( 0.0, svi.Variance( vk[ ix ] ) ) / m_T ) - std::sqrt( vw[ ix ] / m_T ) );
+      sum += diff * diff;
+    }
+    m_dblResidual = std::sqrt( sum / n );
+  }
+  else {
+    m_bFitted = false;
+    m_dblResidual = 0.0;
+  }
+}
+
+// linear in k between observations, flat beyond them
+double VolSurface::Smile::Interpolate( double k ) const {
+  if ( m_mapObservation.empty() ) return 0.0;
+  mapObservation_t::const_iterator iterPrev( m_mapObservation.end() );
+  for ( mapObservation_t::const_iterator iter = m_mapObservation.begin(); m_mapObservation.end() != iter; ++iter ) {
+    const double kObservation( K( iter->first ) );
+    if ( k <= kObservation ) {
+      const double w( iter->second.iv * iter->second.iv * m_T );
+      if ( m_mapObservation.end() == iterPrev ) return w;
+      const double wPrev( iterPrev->second.iv * iterPrev->second.iv * m_T );
+      const double kPrev( K( iterPrev->first ) );
+      const double ratio( ( k - kPrev ) / ( kObservation - kPrev ) );
+      return wPrev + ( w - wPrev ) * ratio;
+    }
+    iterPrev = iter;
+  }
+  return iterPrev->second.iv * iterPrev->second.iv * m_T;
+}
+
+double VolSurface::Smile::Variance( double k ) const {
+  return m_bFitted ? std::max<double>( 0.0, m_svi.Variance( k ) ) : Interpolate( k );
+}
+
+double VolSurface::Smile::Volatility( double dblStrike ) const {
+  if ( ( 0.0 >= m_T ) || ( 0.0 >= dblStrike ) ) return 0.0;
+  return std::sqrt( Variance( std::log( dblStrike / m_dblForward ) ) / m_T );
+}
+
+// ==== VolSurface
+
+VolSurface::VolSurface( void )
+: m_tdMaxAge( 0, 5, 0 )
+{
+}
+
+VolSurface::~VolSurface( void ) {
+}
+
+void VolSurface::Update( 
+  ptime dtExpiry, ptime dtObserved, double T, double dblForward, double dblStrike, enumOptionSide side, double dblIV 
+) {
+  m_mapSmile[ dtExpiry ].Update( dtObserved, T, dblForward, dblStrike, side, dblIV );
+}
+
+void VolSurface::Fit( ptime dtExpiry ) {
+  mapSmile_t::iterator iter = m_mapSmile.find( dtExpiry );
+  if ( ( m_mapSmile.end() != iter ) && iter->second.Changed() ) {
+    iter->second.Fit( m_tdMaxAge );
+  }
+}
+
+void VolSurface::Fit( void ) {
+  for ( mapSmile_t::iterator iter = m_mapSmile.begin(); m_mapSmile.end() != iter; ++iter ) {
+    if ( iter->second.Changed() ) iter->second.Fit( m_tdMaxAge );
+  }
+}
+
+void VolSurface::Clear( void ) {
+  m_mapSmile.clear();
+}
+
+void VolSurface::Clear( ptime dtExpiry ) {
+  m_mapSmile.erase( dtExpiry );
+}
+
+bool VolSurface::Exists( ptime dtExpiry ) const {
+  return m_mapSmile.end() != m_mapSmile.find( dtExpiry );
+}
+
+bool VolSurface::Fitted( ptime dtExpiry ) const {
+  mapSmile_t::const_iterator iter = m_mapSmile.find( dtExpiry );
+  return ( m_mapSmile.end() != iter ) && iter->second.Fitted();
+}
+
+const VolSurface::SVI& VolSurface::Parameters( ptime dtExpiry ) const {
+  mapSmile_t::const_iterator iter = m_mapSmile.find( dtExpiry );
+  assert( m_mapSmile.end() != iter );
+  return iter->second.Parameters();
+}
+
+double VolSurface::Residual( ptime dtExpiry ) const {
+  mapSmile_t::const_iterator iter = m_mapSmile.find( dtExpiry );
+  return ( m_mapSmile.end() == iter ) ? 0.0 : iter->second.Residual();
+}
+
+double VolSurface::Volatility( ptime dtExpiry, double dblStrike ) const {
+  mapSmile_t::const_iterator iter = m_mapSmile.find( dtExpiry );
+  return ( m_mapSmile.end() == iter ) ? 0.0 : iter->second.Volatility( dblStrike );
+}
+
+void VolSurface::Volatility( ptime dtExpiry, size_t nStrikes, const double* rStrike, double* rVolatility ) const {
+  mapSmile_t::const_iterator iter = m_mapSmile.find( dtExpiry );
+  if ( m_mapSmile.end() == iter ) {
+    std::fill( rVolatility, rVolatility + nStrikes, 0.0 );
+  }
+  else {
+    for ( size_t ix = 0; ix < nStrikes; ++ix ) {
+      rVolatility[ ix ] = iter->second.Volatility( rStrike[ ix ] );
+    }
+  }
+}
+
+double VolSurface::Volatility( double T, double dblForward, double dblStrike ) const {
+  if ( m_mapSmile.empty() || ( 0.0 >= T ) || ( 0.0 >= dblForward ) || ( 0.0 >= dblStrike ) ) return 0.0;
+  const double k( std::log( dblStrike / dblForward ) );
+  const Smile* pBefore( nullptr );  // nearest smile at or before T
+  const Smile* pAfter( nullptr );  // nearest smile after T
+  for ( mapSmile_t::const_iterator iter = m_mapSmile.begin(); m_mapSmile.end() != iter; ++iter ) {
+    const Smile& smile( iter->second );
+    if ( 0.0 >= smile.T() ) continue;
+    if ( smile.T() <= T ) {
+      if ( ( nullptr == pBefore ) || ( pBefore->T() < smile.T() ) ) pBefore = &smile;
+    }
+    else {
+      if ( ( nullptr == pAfter ) || ( pAfter->T() > smile.T() ) ) pAfter = &smile;
+    }
+  }
+  double w( 0.0 );
+  if ( ( nullptr != pBefore ) && ( nullptr != pAfter ) ) {
+    const double wBefore( pBefore->Variance( k ) );
+    const double wAfter( pAfter->Variance( k ) );
+    w = wBefore + ( wAfter - wBefore ) * ( T - pBefore->T() ) / ( pAfter->T() - pBefore->T() );
+  }
+  else {  // beyond the ends, the same volatility
+    const Smile* pSmile( ( nullptr != pBefore ) ? pBefore : pAfter );
+    if ( nullptr == pSmile ) return 0.0;
+    w = pSmile->Variance( k ) * T / pSmile->T();
+  }
+  return std::sqrt( std::max<double>( 0.0, w ) / T );
+}
+
+} // namespace option
+} // namespace tf
+} // namespace ou
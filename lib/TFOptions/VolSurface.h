@@ -0,0 +1,122 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// implied volatility surface:  one smile per expiry, interpolated in time between expiries
+// each smile is a raw SVI (stochastic volatility inspired, Gatheral) curve in total variance
+//   w(k) = a + b * ( rho * ( k - m ) + sqrt( ( k - m )^2 + sigma^2 ) ),  k = ln( strike / forward ), w = iv^2 * T
+// only out of the money options are observed, calls at and above the forward, puts at and below,
+//   an observation replaces the prior one at its strike, a fit is warm started from the previous one,
+//   so a refit after a tick of new ivs is a few small least squares steps
+// log moneyness is taken against the latest forward at each fit, observations which have become
+//   in the money, or are older than the maximum age relative to the latest, are dropped at the fit
+// until a smile has enough observations for SVI, it interpolates its observations linearly in k
+// not thread safe, used from the thread calculating the bundle's greeks
+
+#include <map>
+#include <cmath>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <TFTrading/TradingEnumerations.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+class VolSurface {
+public:
+
+  typedef boost::posix_time::ptime ptime;
+  typedef boost::posix_time::time_duration time_duration;
+  typedef ou::tf::OptionSide::enumOptionSide enumOptionSide;
+
+  struct SVI {  // raw parameterization
+    double a, b, rho, m, sigma;
+    SVI( void ): a( 0.0 ), b( 0.0 ), rho( 0.0 ), m( 0.0 ), sigma( 0.1 ) {};
+    double Variance( double k ) const;  // total variance at log moneyness k
+  };
+
+  VolSurface( void );
+  ~VolSurface( void );
+
+  void SetMaxAge( const time_duration& td ) { m_tdMaxAge = td; };  // applies to subsequent fits, default 5 minutes
+
+  // T in years, forward of the underlying to expiry, replaces any prior observation at the strike,
+  //   ignored when the option is in the money at this forward
+  void Update( ptime dtExpiry, ptime dtObserved, double T, double dblForward, double dblStrike, enumOptionSide, double dblIV );
+  void Fit( ptime dtExpiry );  // refit the smile if it has new observations
+  void Fit( void );  // refit every smile with new observations
+
+  void Clear( void );
+  void Clear( ptime dtExpiry );
+
+  bool Exists( ptime dtExpiry ) const;
+  bool Fitted( ptime dtExpiry ) const;  // SVI fitted, rather than interpolating observations
+  const SVI& Parameters( ptime dtExpiry ) const;  // expiry needs to exist
+  double Residual( ptime dtExpiry ) const;  // root mean square iv error of the fit
+
+  // 0.0 when nothing is known for the expiry
+  double Volatility( ptime dtExpiry, double dblStrike ) const;
+  void Volatility( ptime dtExpiry, size_t nStrikes, const double* rStrike, double* rVolatility ) const;
+  // any expiry:  total variance interpolated linearly in T at the same log moneyness, flat beyond the ends
+  double Volatility( double T, double dblForward, double dblStrike ) const;
+
+protected:
+private:
+
+  class Smile {
+  public:
+    Smile( void );
+    void Update( ptime dtObserved, double T, double dblForward, double dblStrike, enumOptionSide, double dblIV );
+    void Fit( const time_duration& tdMaxAge );
+    bool Fitted( void ) const { return m_bFitted; };
+    bool Changed( void ) const { return m_bChanged; };
+    const SVI& Parameters( void ) const { return m_svi; };
+    double Residual( void ) const { return m_dblResidual; };
+    double T( void ) const { return m_T; };
+    double Forward( void ) const { return m_dblForward; };
+    double Variance( double k ) const;  // total variance
+    double Volatility( double dblStrike ) const;
+  private:
+    struct Observation {
+      ptime dt;
+      enumOptionSide side;
+      double iv;  // total variance is taken at the smile's current T
+      Observation( ptime dt_, enumOptionSide side_, double iv_ ): dt( dt_ ), side( side_ ), iv( iv_ ) {};
+    };
+    typedef std::map<double,Observation> mapObservation_t;  // by strike, so ordered by k as well
+    mapObservation_t m_mapObservation;
+    ptime m_dtLatest;  // of the observations
+    double m_T;
+    double m_dblForward;
+    SVI m_svi;
+    bool m_bFitted;
+    bool m_bChanged;  // observations, or a forward move, since the last fit
+    double m_dblResidual;
+    double Interpolate( double k ) const;
+    double K( double dblStrike ) const { return std::log( dblStrike / m_dblForward ); };
+  };
+
+  typedef std::map<ptime,Smile> mapSmile_t;
+  mapSmile_t m_mapSmile;
+
+  time_duration m_tdMaxAge;
+
+};
+
+} // namespace option
+} // namespace tf
+} // namespace ou
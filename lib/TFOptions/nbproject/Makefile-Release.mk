@@ -39,12 +39,17 @@ OBJECTFILES= \
 	${OBJECTDIR}/Bundle.o \
 	${OBJECTDIR}/CalcExpiry.o \
 	${OBJECTDIR}/Engine.o \
+	${OBJECTDIR}/FiniteDifference.o \
 	${OBJECTDIR}/Formula.o \
 	${OBJECTDIR}/IvAtm.o \
 	${OBJECTDIR}/Margin.o \
+	${OBJECTDIR}/MarginEvaluator.o \
 	${OBJECTDIR}/Option.o \
 	${OBJECTDIR}/PopulateWithIBOptions.o \
-	${OBJECTDIR}/Strike.o
+	${OBJECTDIR}/RateCache.o \
+	${OBJECTDIR}/ScenarioGrid.o \
+	${OBJECTDIR}/Strike.o \
+	${OBJECTDIR}/VolSurface.o
 
 
 # C Compiler Flags
@@ -93,6 +98,11 @@ ${OBJECTDIR}/Engine.o: Engine.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Engine.o Engine.cpp
 
+${OBJECTDIR}/FiniteDifference.o: FiniteDifference.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/FiniteDifference.o FiniteDifference.cpp
+
 ${OBJECTDIR}/Formula.o: Formula.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -108,6 +118,11 @@ ${OBJECTDIR}/Margin.o: Margin.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Margin.o Margin.cpp
 
+${OBJECTDIR}/MarginEvaluator.o: MarginEvaluator.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/MarginEvaluator.o MarginEvaluator.cpp
+
 ${OBJECTDIR}/Option.o: Option.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -118,11 +133,26 @@ ${OBJECTDIR}/PopulateWithIBOptions.o: PopulateWithIBOptions.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/PopulateWithIBOptions.o PopulateWithIBOptions.cpp
 
+${OBJECTDIR}/RateCache.o: RateCache.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/RateCache.o RateCache.cpp
+
+${OBJECTDIR}/ScenarioGrid.o: ScenarioGrid.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/ScenarioGrid.o ScenarioGrid.cpp
+
 ${OBJECTDIR}/Strike.o: Strike.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Strike.o Strike.cpp
 
+${OBJECTDIR}/VolSurface.o: VolSurface.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/VolSurface.o VolSurface.cpp
+
 # Subprojects
 .build-subprojects:
 
@@ -0,0 +1,194 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "BarCascade.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+namespace {
+  const ptime dtEpoch( boost::gregorian::date( 1970, 1, 1 ) );
+}
+
+BarCascade::BarCascade( void )
+: m_ixTimeFinest( npos ), m_ixTimeCoarsest( npos )
+{
+}
+
+BarCascade::~BarCascade( void ) {
+  OnBarComplete = NULL;
+}
+
+BarCascade::level_t BarCascade::AddLevel( const Level& level ) {
+  m_vLevel.push_back( level );
+  m_vCompleted.reserve( m_vLevel.size() );
+  return m_vLevel.size() - 1;
+}
+
+BarCascade::level_t BarCascade::AddTimeLevel( duration_t nSeconds ) {
+  if ( 0 == nSeconds ) {
+    throw std::runtime_error( "BarCascade::AddTimeLevel: width needs to be non-zero" );
+  }
+  if ( npos != m_ixTimeCoarsest ) {
+    const duration_t nFiner( m_vLevel[ m_ixTimeCoarsest ].nSeconds );
+    if ( ( nSeconds <= nFiner ) || ( 0 != ( nSeconds % nFiner ) ) ) {
+      throw std::runtime_error( "BarCascade::AddTimeLevel: width needs to be a multiple of the previous time level" );
+    }
+  }
+  level_t ix = AddLevel( Level( Time, nSeconds, 0.0, m_ixTimeCoarsest ) );
+  if ( npos == m_ixTimeFinest ) m_ixTimeFinest = ix;
+  m_ixTimeCoarsest = ix;
+  return ix;
+}
+
+BarCascade::level_t BarCascade::AddVolumeLevel( volume_t nVolume ) {
+  return AddLevel( Level( Volume, 0, std::max<double>( 1.0, nVolume ), npos ) );
+}
+
+BarCascade::level_t BarCascade::AddTickLevel( size_t nTicks ) {
+  return AddLevel( Level( Tick, 0, std::max<double>( 1.0, nTicks ), npos ) );
+}
+
+BarCascade::level_t BarCascade::AddDollarLevel( double dblDollars ) {
+  return AddLevel( Level( Dollar, 0, dblDollars, npos ) );
+}
+
+// interval counted from the epoch rather than from midnight, so day bars roll over too
+boost::int64_t BarCascade::Interval( const ptime& dt, duration_t nSeconds ) {
+  return ( dt - dtEpoch ).total_seconds() / nSeconds;
+}
+
+ptime BarCascade::IntervalStart( const Level& level, boost::int64_t nInterval ) const {
+  return dtEpoch + boost::posix_time::seconds( nInterval * level.nSeconds );
+}
+
+void BarCascade::Fold( Bar& bar, const Bar& src ) {
+  if ( bar.IsNull() ) {
+    bar = src;
+  }
+  else {
+    bar.High( std::max( bar.High(), src.High() ) );
+    bar.Low( std::min( bar.Low(), src.Low() ) );
+    bar.Close( src.Close() );
+    bar.Volume( bar.Volume() + src.Volume() );
+  }
+}
+
+void BarCascade::Fold( Bar& bar, const ptime& dt, price_t price, volume_t volume ) {
+  if ( bar.IsNull() ) {
+    bar = Bar( dt, price, price, price, price, volume );
+  }
+  else {
+    bar.High( std::max( bar.High(), price ) );
+    bar.Low( std::min( bar.Low(), price ) );
+    bar.Close( price );
+    bar.Volume( bar.Volume() + volume );
+  }
+}
+
+void BarCascade::Complete( level_t ix ) {
+  Level& level( m_vLevel[ ix ] );
+  level.barCompleted = level.bar;
+  level.bar = Bar();
+  level.bCompleted = true;
+  m_vCompleted.push_back( ix );
+}
+
+void BarCascade::Add( const ptime& dt, price_t price, volume_t volume ) {
+
+  m_vCompleted.clear();
+
+  for ( vLevel_t::iterator iter = m_vLevel.begin(); m_vLevel.end() != iter; ++iter ) {
+    Level& level( *iter );
+    const level_t ix( iter - m_vLevel.begin() );
+    level.bCompleted = false;
+    switch ( level.eType ) {
+      case Time: {
+        const boost::int64_t nInterval( Interval( dt, level.nSeconds ) );
+        if ( npos == level.ixFiner ) {  // finest, built from trades
+          if ( ( nInterval != level.nInterval ) && !level.bar.IsNull() ) {
+            Complete( ix );
+          }
+          Fold( level.bar, dt, price, volume );
+          if ( nInterval != level.nInterval ) {
+            level.bar.DateTime( IntervalStart( level, nInterval ) );
+          }
+        }
+        else {  // built from the finer level, which precedes it, so is already up to date
+          const Level& finer( m_vLevel[ level.ixFiner ] );
+          if ( finer.bCompleted ) {
+            Fold( level.bar, finer.barCompleted );  // belongs to this level's current interval
+            level.bar.DateTime( IntervalStart( level, level.nInterval ) );
+          }
+          if ( ( nInterval != level.nInterval ) && !level.bar.IsNull() ) {
+            Complete( ix );
+          }
+        }
+        level.nInterval = nInterval;
+        }
+        break;
+      case Volume:
+      case Tick:
+      case Dollar:
+        Fold( level.bar, dt, price, volume );
+        switch ( level.eType ) {
+          case Volume:
+            level.dblAccumulated += volume;
+            break;
+          case Tick:
+            level.dblAccumulated += 1.0;
+            break;
+          case Dollar:
+            level.dblAccumulated += price * volume;
+            break;
+          default:
+            break;
+        }
+        if ( level.dblThreshold <= level.dblAccumulated ) {
+          Complete( ix );
+          level.dblAccumulated = 0.0;
+        }
+        break;
+    }
+  }
+
+  if ( 0 != OnBarComplete ) {
+    for ( std::vector<level_t>::const_iterator iter = m_vCompleted.begin(); m_vCompleted.end() != iter; ++iter ) {
+      OnBarComplete( *iter, m_vLevel[ *iter ].barCompleted );
+    }
+  }
+
+}
+
+Bar BarCascade::CurrentBar( level_t ix ) const {
+  const Level& level( m_vLevel[ ix ] );
+  if ( ( Time == level.eType ) && ( npos != level.ixFiner ) ) {
+    Bar bar( level.bar );
+    Fold( bar, CurrentBar( level.ixFiner ) );
+    if ( !bar.IsNull() ) bar.DateTime( IntervalStart( level, level.nInterval ) );
+    return bar;
+  }
+  else {
+    return level.bar;
+  }
+}
+
+} // namespace tf
+} // namespace ou
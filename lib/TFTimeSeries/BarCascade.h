@@ -0,0 +1,109 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+
+#pragma once
+
+// one Add( trade ) maintains bars at several resolutions:
+//   time levels: the finest is built from trades, each coarser one from the bars completed by the level below it,
+//     so a trade touches only the finest time bar, whatever the number of time levels
+//   volume, tick and dollar levels: each built directly from trades, a bar completes on the trade which
+//     brings it to the threshold (trades are not split across bars)
+// completions are gathered while all levels are brought up to date, then emitted in one pass,
+//   finest first, so handlers see a consistent set of bars
+
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "DatedDatum.h"
+
+#include <OUCommon/FastDelegate.h>
+using namespace fastdelegate;
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class BarCascade {
+public:
+
+  typedef unsigned long duration_t;  // seconds
+  typedef Bar::volume_t volume_t;
+  typedef Bar::price_t price_t;
+  typedef std::vector<Bar>::size_type level_t;  // index returned when a level is added
+
+  enum EType { Time, Volume, Tick, Dollar };
+
+  BarCascade( void );
+  virtual ~BarCascade( void );
+
+  // time levels are added finest first, each width an exact multiple of the previous time level
+  level_t AddTimeLevel( duration_t nSeconds );
+  level_t AddVolumeLevel( volume_t nVolume );
+  level_t AddTickLevel( size_t nTicks );
+  level_t AddDollarLevel( double dblDollars );
+
+  void Add( const ptime&, price_t, volume_t );
+  void Add( const Trade& trade ) { Add( trade.DateTime(), trade.Price(), trade.Volume() ); };
+
+  level_t Levels( void ) const { return m_vLevel.size(); };
+  EType Type( level_t ix ) const { return m_vLevel[ ix ].eType; };
+  Bar CurrentBar( level_t ix ) const;  // bar in progress, includes what the finer levels have yet to complete
+
+  typedef FastDelegate2<level_t, const Bar&> OnBarCompleteHandler;
+  void SetOnBarComplete( OnBarCompleteHandler function ) {
+    OnBarComplete = function;
+  }
+
+protected:
+private:
+
+  static const level_t npos = (level_t)-1;
+
+  struct Level {
+    EType eType;
+    duration_t nSeconds;  // Time: bar width
+    double dblThreshold;  // Volume, Tick, Dollar: completes when reached
+    level_t ixFiner;  // Time: level the bars are built from, npos when built from trades
+    boost::int64_t nInterval;  // Time: interval of the bar in progress
+    double dblAccumulated;  // Volume, Tick, Dollar: towards the threshold
+    bool bCompleted;  // a bar completed during the current Add
+    Bar bar;  // in progress, for a derived time level holds only completed finer bars
+    Bar barCompleted;
+    Level( EType eType_, duration_t nSeconds_, double dblThreshold_, level_t ixFiner_ )
+      : eType( eType_ ), nSeconds( nSeconds_ ), dblThreshold( dblThreshold_ ), ixFiner( ixFiner_ ),
+        nInterval( -1 ), dblAccumulated( 0 ), bCompleted( false ) {};
+  };
+
+  typedef std::vector<Level> vLevel_t;
+  vLevel_t m_vLevel;
+
+  level_t m_ixTimeFinest;
+  level_t m_ixTimeCoarsest;
+
+  std::vector<level_t> m_vCompleted;  // emission queue, reused on each Add
+
+  OnBarCompleteHandler OnBarComplete;
+
+  level_t AddLevel( const Level& );
+  void Complete( level_t ix );
+  ptime IntervalStart( const Level&, boost::int64_t nInterval ) const;
+  static boost::int64_t Interval( const ptime&, duration_t nSeconds );
+  static void Fold( Bar& bar, const Bar& src );  // merge src into bar, which is later in time
+  static void Fold( Bar& bar, const ptime&, price_t, volume_t );
+
+};
+
+} // namespace tf
+} // namespace ou
@@ -12,11 +12,290 @@
  * See the file LICENSE.txt for redistribution information.             *
  ************************************************************************/
 
+
 #include "stdafx.h"
+
+#include <cmath>
+
+#include <boost/math/constants/constants.hpp>
+
 #include "TSMicrostructure.h"
 
-TSMicrostructure::TSMicrostructure(void) { 
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace microstructure {
+
+// ==== SampledReturns
+
+SampledReturns::SampledReturns( time_duration tdInterval )
+: m_tdInterval( tdInterval ), m_dtNextSample( not_a_date_time ), m_dblLatest( 0.0 ), m_dblSampled( 0.0 )
+{
+  assert( 0 < tdInterval.total_milliseconds() );
+}
+
+void SampledReturns::Reset( void ) {
+  m_dtNextSample = not_a_date_time;
+  m_dblLatest = m_dblSampled = 0.0;
+}
+
+bool SampledReturns::Add( ptime dt, double dblPrice, double& dblReturn ) {
+  bool bReturn( false );
+  if ( 0.0 < dblPrice ) {
+    if ( m_dtNextSample.is_not_a_date_time() ) {
+      m_dblSampled = dblPrice;
+      m_dtNextSample = dt + m_tdInterval;
+    }
+    else {
+      if ( dt >= m_dtNextSample ) {
+        // previous tick is the value at the grid point
+        dblReturn = std::log( m_dblLatest / m_dblSampled );
+        m_dblSampled = m_dblLatest;
+        bReturn = true;
+        // re-align after a gap, empty intervals are not counted as samples
+        while ( dt >= m_dtNextSample ) m_dtNextSample += m_tdInterval;
+      }
+    }
+    m_dblLatest = dblPrice;
+  }
+  return bReturn;
+}
+
+// ==== BipowerVariation
+
+BipowerVariation::BipowerVariation( void )
+: m_n( 0 ), m_dblPrevAbs( 0.0 ), m_dblSumRR( 0.0 ), m_dblSumAbsAbs( 0.0 )
+{}
+
+void BipowerVariation::Reset( void ) {
+  m_n = 0;
+  m_dblPrevAbs = m_dblSumRR = m_dblSumAbsAbs = 0.0;
+}
+
+void BipowerVariation::Add( double dblReturn ) {
+  double dblAbs = std::abs( dblReturn );
+  m_dblSumRR += dblReturn * dblReturn;
+  m_dblSumAbsAbs += dblAbs * m_dblPrevAbs;  // zero on first
+  m_dblPrevAbs = dblAbs;
+  ++m_n;
+}
+
+double BipowerVariation::BV( void ) const {
+  return boost::math::constants::half_pi<double>() * m_dblSumAbsAbs;
+}
+
+double BipowerVariation::Jump( void ) const {
+  double jump = RV() - BV();
+  return ( 0.0 < jump ) ? jump : 0.0;
+}
+
+// ==== RealizedKernel
+
+namespace {
+  double Parzen( double x ) {
+    if ( 0.5 >= x ) return 1.0 - 6.0 * x * x + 6.0 * x * x * x;
+    if ( 1.0 >= x ) return 2.0 * ( 1.0 - x ) * ( 1.0 - x ) * ( 1.0 - x );
+    return 0.0;
+  }
+}
+
+RealizedKernel::RealizedKernel( unsigned int nLags )
+: m_nLags( nLags ), m_n( 0 ), m_ixRing( 0 ), m_dblGamma0( 0.0 ), m_dblSum( 0.0 )
+{
+  assert( nLags <= c_nMaxLags );
+  m_rWeight.fill( 0.0 );
+  m_rReturn.fill( 0.0 );
+  for ( unsigned int h = 1; h <= m_nLags; ++h ) {
+    m_rWeight[ h - 1 ] = 2.0 * Parzen( (double) h / ( m_nLags + 1 ) );  // gamma(h) and gamma(-h)
+  }
+}
+
+void RealizedKernel::Reset( void ) {
+  m_n = m_ixRing = 0;
+  m_dblGamma0 = m_dblSum = 0.0;
+  m_rReturn.fill( 0.0 );
+}
+
+void RealizedKernel::Add( double dblReturn ) {
+  double rr = dblReturn * dblReturn;
+  m_dblGamma0 += rr;
+  double sum( rr );
+  // m_ixRing is the slot of the oldest return, walk back from the newest
+  unsigned int ix = m_ixRing;
+  for ( unsigned int h = 1; h <= m_nLags; ++h ) {
+    ix = ( 0 == ix ) ? m_nLags - 1 : ix - 1;
+    sum += m_rWeight[ h - 1 ] * dblReturn * m_rReturn[ ix ];  // zeros until ring is filled
+  }
+  m_dblSum += sum;
+  if ( 0 < m_nLags ) {
+    m_rReturn[ m_ixRing ] = dblReturn;
+    ++m_ixRing;
+    if ( m_nLags == m_ixRing ) m_ixRing = 0;
+  }
+  ++m_n;
+}
+
+// ==== OrderFlow
+
+OrderFlow::OrderFlow( void )
+: m_dblTradePrev( 0.0 ), m_nTickSign( 0 ), m_nBuyVolume( 0 ), m_nSellVolume( 0 ), m_dblOFI( 0.0 )
+{}
+
+void OrderFlow::Reset( void ) {
+  m_quote = Quote();
+  m_dblTradePrev = 0.0;
+  m_nTickSign = 0;
+  m_nBuyVolume = m_nSellVolume = 0;
+  m_dblOFI = 0.0;
+}
+
+void OrderFlow::Add( const Quote& quote ) {
+  if ( quote.IsValid() ) {
+    if ( m_quote.IsValid() ) {
+      double e( 0.0 );
+      if ( quote.Bid() >= m_quote.Bid() ) e += quote.BidSize();
+      if ( quote.Bid() <= m_quote.Bid() ) e -= m_quote.BidSize();
+      if ( quote.Ask() <= m_quote.Ask() ) e -= quote.AskSize();
+      if ( quote.Ask() >= m_quote.Ask() ) e += m_quote.AskSize();
+      m_dblOFI += e;
+    }
+    m_quote = quote;
+  }
+}
+
+void OrderFlow::Add( const Trade& trade ) {
+  double price = trade.Price();
+  if ( 0.0 != m_dblTradePrev ) {
+    if ( price > m_dblTradePrev ) m_nTickSign = 1;
+    else if ( price < m_dblTradePrev ) m_nTickSign = -1;
+  }
+  m_dblTradePrev = price;
+  int sign( m_nTickSign );  // tick test, used at the mid or when there is no quote
+  if ( m_quote.IsValid() ) {
+    double mid = m_quote.Midpoint();
+    if ( price > mid ) sign = 1;
+    else if ( price < mid ) sign = -1;
+  }
+  if ( 0 < sign ) m_nBuyVolume += trade.Volume();
+  else if ( 0 > sign ) m_nSellVolume += trade.Volume();
+}
+
+double OrderFlow::VolumeImbalance( void ) const {
+  boost::int64_t total = m_nBuyVolume + m_nSellVolume;
+  return ( 0 == total ) ? 0.0 : (double) ( m_nBuyVolume - m_nSellVolume ) / total;
+}
+
+// ==== Spread
+
+Spread::Spread( void )
+: m_dblMid( 0.0 ), m_nVolume( 0 ), m_dblSumEffective( 0.0 ), m_dblSumRelative( 0.0 ),
+  m_dblTradePrev( 0.0 ), m_dblDeltaPrev( 0.0 ), m_bDeltaPrev( false ), m_nPairs( 0 ),
+  m_dblSumXY( 0.0 ), m_dblSumX( 0.0 ), m_dblSumY( 0.0 )
+{}
+
+void Spread::Reset( void ) {
+  m_dblMid = 0.0;
+  m_nVolume = 0;
+  m_dblSumEffective = m_dblSumRelative = 0.0;
+  m_dblTradePrev = m_dblDeltaPrev = 0.0;
+  m_bDeltaPrev = false;
+  m_nPairs = 0;
+  m_dblSumXY = m_dblSumX = m_dblSumY = 0.0;
+}
+
+void Spread::Add( const Quote& quote ) {
+  if ( quote.IsValid() && !quote.CrossedQuote() ) {
+    m_dblMid = quote.Midpoint();
+  }
+}
+
+void Spread::Add( const Trade& trade ) {
+  double price = trade.Price();
+  if ( 0.0 < m_dblMid ) {
+    double effective = 2.0 * std::abs( price - m_dblMid );
+    m_dblSumEffective += effective * trade.Volume();
+    m_dblSumRelative += ( effective / m_dblMid ) * trade.Volume();
+    m_nVolume += trade.Volume();
+  }
+  if ( 0.0 != m_dblTradePrev ) {
+    double delta = price - m_dblTradePrev;
+    if ( m_bDeltaPrev ) {
+      m_dblSumXY += delta * m_dblDeltaPrev;
+      m_dblSumX += delta;
+      m_dblSumY += m_dblDeltaPrev;
+      ++m_nPairs;
+    }
+    m_dblDeltaPrev = delta;
+    m_bDeltaPrev = true;
+  }
+  m_dblTradePrev = price;
+}
+
+double Spread::Roll( void ) const {
+  double spread( 0.0 );
+  if ( 1 < m_nPairs ) {
+    double cov = ( m_dblSumXY - m_dblSumX * m_dblSumY / m_nPairs ) / ( m_nPairs - 1 );
+    if ( 0.0 > cov ) spread = 2.0 * std::sqrt( -cov );
+  }
+  return spread;
+}
+
+} // namespace microstructure
+
+// ==== TSMicrostructure
+
+namespace {
+  const double c_dblTradingSecondsPerYear = 252.0 * 6.5 * 60.0 * 60.0;
+}
+
+TSMicrostructure::TSMicrostructure( time_duration tdSampleInterval, unsigned int nKernelLags )
+: m_returns( tdSampleInterval ), m_rk( nKernelLags ) 
+{ 
+  m_dblAnnualize = c_dblTradingSecondsPerYear / ( (double) tdSampleInterval.total_milliseconds() / 1000.0 );
 }
 
 TSMicrostructure::~TSMicrostructure(void) {
 }
+
+void TSMicrostructure::Reset( void ) {
+  m_returns.Reset();
+  m_bv.Reset();
+  m_rk.Reset();
+  m_flow.Reset();
+  m_spread.Reset();
+}
+
+void TSMicrostructure::Add( const Quote& quote ) {
+  if ( quote.IsValid() && !quote.CrossedQuote() ) {
+    double r;
+    if ( m_returns.Add( quote.DateTime(), quote.Midpoint(), r ) ) {
+      m_bv.Add( r );
+      m_rk.Add( r );
+    }
+  }
+  m_flow.Add( quote );
+  m_spread.Add( quote );
+}
+
+void TSMicrostructure::Add( const Trade& trade ) {
+  m_flow.Add( trade );
+  m_spread.Add( trade );
+}
+
+bool TSMicrostructure::VolatilityReady( void ) const {
+  return m_rk.Count() > ( 2 * m_rk.Lags() + 4 );
+}
+
+double TSMicrostructure::Annualize( double dblVariance, unsigned int nSamples ) const {
+  return ( 0 == nSamples ) ? 0.0 : std::sqrt( dblVariance / nSamples * m_dblAnnualize );
+}
+
+double TSMicrostructure::AnnualizedVolatility( void ) const {
+  return Annualize( m_rk.Value(), m_rk.Count() );
+}
+
+double TSMicrostructure::AnnualizedBipowerVolatility( void ) const {
+  return Annualize( m_bv.BV(), m_bv.Count() );
+}
+
+} // namespace tf
+} // namespace ou
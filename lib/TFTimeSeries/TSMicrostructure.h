@@ -12,12 +12,162 @@
  * See the file LICENSE.txt for redistribution information.             *
  ************************************************************************/
 
+
 #pragma once
+
+// streaming estimators for the quote/trade feed
+// each is O(1) per tick and allocates nothing once constructed,
+//   so can be attached live to Watch::OnQuote/OnTrade, or fed from a MergeDatedDatums replay
+
+// refer to:
+//   Intro HF Finance, ch 3 (regular time sampling with previous tick)
+//   Barndorff-Nielsen & Shephard: bipower variation
+//   Barndorff-Nielsen, Hansen, Lunde & Shephard: realized kernel, Parzen weights
+//   Cont, Kukanov & Stoikov: order flow imbalance
+//   Lee & Ready: trade classification
+//   Roll: implicit spread from serial covariance of price changes
+
+#include <array>
+
+#include <boost/cstdint.hpp>
+
+#include "DatedDatum.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace microstructure {
+
+// log returns on a regular calendar time grid, using the previous tick,
+//   reduces the bid/ask bounce seen in tick by tick returns
+class SampledReturns {
+public:
+  SampledReturns( time_duration tdInterval );
+  bool Add( ptime dt, double dblPrice, double& dblReturn ); // true when a return is produced
+  void Reset( void );
+  time_duration Interval( void ) const { return m_tdInterval; };
+private:
+  time_duration m_tdInterval;
+  ptime m_dtNextSample;
+  double m_dblLatest;  // most recent price
+  double m_dblSampled;  // price at previous grid point
+};
+
+// realized variance, and bipower variation which is robust to jumps
+class BipowerVariation {
+public:
+  BipowerVariation( void );
+  void Add( double dblReturn );
+  void Reset( void );
+  double RV( void ) const { return m_dblSumRR; };
+  double BV( void ) const;
+  double Jump( void ) const; // RV - BV, floored at zero
+  unsigned int Count( void ) const { return m_n; };
+private:
+  unsigned int m_n;
+  double m_dblPrevAbs;
+  double m_dblSumRR;
+  double m_dblSumAbsAbs;
+};
+
+// realized kernel with Parzen weights, robust to market microstructure noise
+// H lags are kept in a fixed ring, the kernel sum is updated incrementally
+class RealizedKernel {
+public:
+  static const unsigned int c_nMaxLags = 32;
+  RealizedKernel( unsigned int nLags );
+  void Add( double dblReturn );
+  void Reset( void );
+  double Value( void ) const { return ( 0.0 < m_dblSum ) ? m_dblSum : m_dblGamma0; };  // kernel can go negative on tiny samples
+  unsigned int Count( void ) const { return m_n; };
+  unsigned int Lags( void ) const { return m_nLags; };
+private:
+  unsigned int m_nLags;
+  unsigned int m_n;
+  unsigned int m_ixRing;
+  double m_dblGamma0;
+  double m_dblSum;
+  std::array<double,c_nMaxLags> m_rWeight;  // 2 * k( h / ( H + 1 ) ), index h - 1
+  std::array<double,c_nMaxLags> m_rReturn;  // previous returns
+};
+
+// signed volume with Lee-Ready classification against the prevailing quote, tick test at the mid,
+//   and order flow imbalance from changes at the inside
+class OrderFlow {
+public:
+  OrderFlow( void );
+  void Add( const Quote& );
+  void Add( const Trade& );
+  void Reset( void );
+  boost::int64_t SignedVolume( void ) const { return m_nBuyVolume - m_nSellVolume; };
+  boost::int64_t BuyVolume( void ) const { return m_nBuyVolume; };
+  boost::int64_t SellVolume( void ) const { return m_nSellVolume; };
+  double VolumeImbalance( void ) const; // ( buy - sell ) / ( buy + sell )
+  double OFI( void ) const { return m_dblOFI; };
+private:
+  Quote m_quote;  // previous quote
+  double m_dblTradePrev;
+  int m_nTickSign;  // last non-zero tick direction
+  boost::int64_t m_nBuyVolume;
+  boost::int64_t m_nSellVolume;
+  double m_dblOFI;
+};
+
+// effective spread:  2 |p - m| against the prevailing quote, volume weighted
+// Roll:  2 sqrt( -cov( dp(t), dp(t-1) ) ) from trade prices alone
+class Spread {
+public:
+  Spread( void );
+  void Add( const Quote& );
+  void Add( const Trade& );
+  void Reset( void );
+  double Effective( void ) const { return ( 0 == m_nVolume ) ? 0.0 : m_dblSumEffective / m_nVolume; };
+  double EffectiveRelative( void ) const { return ( 0 == m_nVolume ) ? 0.0 : m_dblSumRelative / m_nVolume; };
+  double Roll( void ) const;
+private:
+  double m_dblMid;
+  boost::int64_t m_nVolume;
+  double m_dblSumEffective;
+  double m_dblSumRelative;
+  double m_dblTradePrev;
+  double m_dblDeltaPrev;
+  bool m_bDeltaPrev;
+  unsigned int m_nPairs;
+  double m_dblSumXY, m_dblSumX, m_dblSumY;
+};
+
+} // namespace microstructure
+
+// the set of estimators on one instrument
+// volatility from mid quotes sampled on a grid, flow and spread from trades
 class TSMicrostructure {
 public:
-  TSMicrostructure(void);
+  TSMicrostructure( time_duration tdSampleInterval = seconds( 300 ), unsigned int nKernelLags = 2 );
   virtual ~TSMicrostructure(void);
+
+  void Add( const Quote& );
+  void Add( const Trade& );
+  void Reset( void );  // start of a new session
+
+  // annualized, as fraction, from realized kernel (or bipower variation) over the time sampled
+  bool VolatilityReady( void ) const;
+  double AnnualizedVolatility( void ) const;
+  double AnnualizedBipowerVolatility( void ) const;
+
+  const microstructure::BipowerVariation& Bipower( void ) const { return m_bv; };
+  const microstructure::RealizedKernel& Kernel( void ) const { return m_rk; };
+  const microstructure::OrderFlow& Flow( void ) const { return m_flow; };
+  const microstructure::Spread& Spreads( void ) const { return m_spread; };
+
 protected:
 private:
+  microstructure::SampledReturns m_returns;
+  microstructure::BipowerVariation m_bv;
+  microstructure::RealizedKernel m_rk;
+  microstructure::OrderFlow m_flow;
+  microstructure::Spread m_spread;
+  double m_dblAnnualize;  // trading seconds per year / seconds per sample
+  double Annualize( double dblVariance, unsigned int nSamples ) const;
 };
 
+} // namespace tf
+} // namespace ou
@@ -35,6 +35,7 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
+	${OBJECTDIR}/BarCascade.o \
 	${OBJECTDIR}/BarFactory.o \
 	${OBJECTDIR}/DatedDatum.o \
 	${OBJECTDIR}/DoubleBuffer.o \
@@ -72,6 +73,11 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libtftimeseries.a: ${OBJECTFILES}
 	${AR} -rv ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libtftimeseries.a ${OBJECTFILES} 
 	$(RANLIB) ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libtftimeseries.a
 
+${OBJECTDIR}/BarCascade.o: BarCascade.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/BarCascade.o BarCascade.cpp
+
 ${OBJECTDIR}/BarFactory.o: BarFactory.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -46,6 +46,7 @@ AccountManager::pAccountAdvisor_t AccountManager::ConstructAccountAdvisor( const
   }
   else {
     m_mapAccountAdvisor.insert( pairAccountAdvisor_t( idAdvisor, p ) );
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     ou::db::QueryFields<AccountAdvisor::TableRowDef>::pQueryFields_t pQuery 
       = m_pSession->Insert<AccountAdvisor::TableRowDef>( const_cast<AccountAdvisor::TableRowDef&>( p->GetRow() ) );
   }
@@ -74,6 +75,7 @@ AccountManager::pAccountAdvisor_t AccountManager::GetAccountAdvisor( const idAcc
   }
   else {
     AccountManagerQueries::AccountAdvisorKey key( idAdvisor );
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     ou::db::QueryFields<AccountManagerQueries::AccountAdvisorKey>::pQueryFields_t pExistsQuery // shouldn't do a * as fields may change order
       = m_pSession->SQL<AccountManagerQueries::AccountAdvisorKey>( "select * from accountadvisors", key ).Where( "accountadvisorid = ?" ).NoExecute();
     m_pSession->Bind<AccountManagerQueries::AccountAdvisorKey>( pExistsQuery );
@@ -117,6 +119,7 @@ AccountManager::pAccountOwner_t AccountManager::ConstructAccountOwner(
   }
   else {
     m_mapAccountOwner.insert( pairAccountOwner_t( idAccountOwner, p ) );
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     ou::db::QueryFields<AccountOwner::TableRowDef>::pQueryFields_t pQuery 
       = m_pSession->Insert<AccountOwner::TableRowDef>( const_cast<AccountOwner::TableRowDef&>( p->GetRow() ) );
   }
@@ -145,6 +148,7 @@ AccountManager::pAccountOwner_t AccountManager::GetAccountOwner( const idAccount
   }
   else {
     AccountManagerQueries::AccountOwnerKey key( idAccountOwner );
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     ou::db::QueryFields<AccountManagerQueries::AccountOwnerKey>::pQueryFields_t pExistsQuery // shouldn't do a * as fields may change order
       = m_pSession->SQL<AccountManagerQueries::AccountOwnerKey>( "select * from accountowners", key ).Where( "accountownerid = ?" ).NoExecute();
     m_pSession->Bind<AccountManagerQueries::AccountOwnerKey>( pExistsQuery );
@@ -190,6 +194,7 @@ AccountManager::pAccount_t AccountManager::ConstructAccount(
   }
   else {
     m_mapAccount.insert( pairAccount_t( idAccount, p ) );
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     ou::db::QueryFields<Account::TableRowDef>::pQueryFields_t pQuery 
       = m_pSession->Insert<Account::TableRowDef>( const_cast<Account::TableRowDef&>( p->GetRow() ) );
   }
@@ -218,6 +223,7 @@ AccountManager::pAccount_t AccountManager::GetAccount( const idAccount_t& idAcco
   }
   else {
     AccountManagerQueries::AccountKey key( idAccount );
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     ou::db::QueryFields<AccountManagerQueries::AccountKey>::pQueryFields_t pExistsQuery // shouldn't do a * as fields may change order
       = m_pSession->SQL<AccountManagerQueries::AccountKey>( "select * from accounts", key ).Where( "accountid = ?" ).NoExecute();
     m_pSession->Bind<AccountManagerQueries::AccountKey>( pExistsQuery );
@@ -39,10 +39,12 @@ DBOps::~DBOps(void) {
 }
 
 void DBOps::HandlePopulateTables( ou::db::Session& session ) {
+  ou::db::WriteBehind::Exclusive exclusive( ou::tf::ManagersWriteBehind() );  // the handler uses the session directly
   if ( 0 != OnPopulateDatabaseHandler ) OnPopulateDatabaseHandler();
 }
 
 void DBOps::HandleLoadTables( ou::db::Session& session ) {
+  ou::db::WriteBehind::Exclusive exclusive( ou::tf::ManagersWriteBehind() );
   if ( 0 != OnLoadDatabaseHandler ) OnLoadDatabaseHandler();
 }
 
@@ -84,6 +86,8 @@ struct OptionsQueryParameters {
 //bool DBOps::LoadOptions( ou::tf::InstrumentManager::pInstrument_t& pUnderlying, boost::uint16_t nYear, boost::uint16_t nMonth, boost::uint16_t nDay ) {
 bool DBOps::LoadOptions( idInstrument_cref sInstrumentName, boost::uint16_t nYear, boost::uint16_t nMonth, boost::uint16_t nDay ) {
 
+  ou::db::WriteBehind::Exclusive exclusive( ou::tf::ManagersWriteBehind() );  // null unless enabled
+
   bool bFound = false;
   OptionsQueryParameters query( sInstrumentName, nYear, nMonth, nDay );
 
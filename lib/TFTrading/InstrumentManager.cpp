@@ -14,8 +14,11 @@
 
 #include "stdafx.h"
 
-#include <stdexcept>
 #include <vector>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 
 #include <boost/assign/std/vector.hpp>
 using namespace boost::assign;
@@ -30,7 +33,7 @@ using namespace boost::assign;
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
-InstrumentManager::InstrumentManager(void) {
+InstrumentManager::InstrumentManager(void): m_bComplete( false ) {
 //  file.OpenIQFSymbols();
 }
 
@@ -107,6 +110,7 @@ void InstrumentManager::Register( pInstrument_t& pInstrument ) {
   }
   Assign( pInstrument );
   if ( 0 != m_pSession ) {
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     ou::db::QueryFields<Instrument::TableRowDef>::pQueryFields_t pQuery 
       = m_pSession->Insert<Instrument::TableRowDef>( const_cast<Instrument::TableRowDef&>( pInstrument->GetRow() ) );
     // save alternate instrument names
@@ -124,6 +128,7 @@ void InstrumentManager::SaveAlternateInstrumentName(
 
 void InstrumentManager::SaveAlternateInstrumentName( const AlternateInstrumentName::TableRowDef& row ) {
   if ( 0 != m_pSession ) {
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     ou::db::QueryFields<AlternateInstrumentName::TableRowDef>::pQueryFields_t pQuery 
       = m_pSession->Insert<AlternateInstrumentName::TableRowDef>( const_cast<AlternateInstrumentName::TableRowDef&>( row ) );
   }
@@ -148,7 +153,7 @@ InstrumentManager::pInstrument_t InstrumentManager::Get( idInstrument_cref idNam
   }
   else {
     bool bFound = false;
-    if ( 0 != m_pSession ) {
+    if ( ( 0 != m_pSession ) && !m_bComplete ) {
       bFound = LoadInstrument( idName, pInstrument );
     }
     if ( !bFound ) {
@@ -161,7 +166,7 @@ InstrumentManager::pInstrument_t InstrumentManager::Get( idInstrument_cref idNam
 bool InstrumentManager::Exists( idInstrument_cref id ) {  // todo:  cache the query to make the get faster rather than searching the map again
   bool bFound = ( m_map.end() != m_map.find( id ) );
   if ( !bFound ) {
-    if ( 0 != m_pSession ) {
+    if ( ( 0 != m_pSession ) && !m_bComplete ) {
       Instrument::pInstrument_t pInstrument;
       bFound = LoadInstrument( id, pInstrument );
     }
@@ -181,7 +186,7 @@ bool InstrumentManager::Exists( idInstrument_cref id, pInstrument_t& pInstrument
     bFound = true;
   }
   else {
-    if ( 0 != m_pSession ) {
+    if ( ( 0 != m_pSession ) && !m_bComplete ) {
 //      Instrument::pInstrument_t pInstrument;
       bFound = LoadInstrument( id, pInstrument );
     }
@@ -207,6 +212,7 @@ bool InstrumentManager::LoadInstrument( idInstrument_t id, pInstrument_t& pInstr
 
   bool bFound = false;
   InstrumentManagerQueries::InstrumentKey idInstrument( id );
+  ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
   ou::db::QueryFields<InstrumentManagerQueries::InstrumentKey>::pQueryFields_t pExistsQuery // shouldn't do a * as fields may change order
     = m_pSession->SQL<InstrumentManagerQueries::InstrumentKey>( "select * from instruments", idInstrument ).Where( "instrumentid = ?" ).NoExecute();
   m_pSession->Bind<InstrumentManagerQueries::InstrumentKey>( pExistsQuery );
@@ -253,6 +259,7 @@ void InstrumentManager::Delete( idInstrument_cref idInstrument ) {
 void InstrumentManager::LoadAlternateInstrumentNames( pInstrument_t& pInstrument ) {
   assert( 0 != pInstrument.get() );
   InstrumentManagerQueries::InstrumentKey idInstrument( pInstrument->GetInstrumentName() );
+  ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
    ou::db::QueryFields<InstrumentManagerQueries::InstrumentKey>::pQueryFields_t pExistsQuery // shouldn't do a * as fields may change order
      = m_pSession->SQL<InstrumentManagerQueries::InstrumentKey>( "select * from altinstrumentnames", idInstrument ).Where( "instrumentid = ?" ).NoExecute();
   m_pSession->Bind<InstrumentManagerQueries::InstrumentKey>( pExistsQuery );
@@ -263,6 +270,177 @@ void InstrumentManager::LoadAlternateInstrumentNames( pInstrument_t& pInstrument
   }
 }
 
+void InstrumentManager::Add( const Instrument::TableRowDef& row ) {
+  if ( m_map.end() == m_map.find( row.idInstrument ) ) {
+    pInstrument_t pInstrument( new Instrument( row ) );
+    Assign( pInstrument );
+  }
+}
+
+void InstrumentManager::LoadAll( void ) {
+
+  if ( 0 == m_pSession ) {
+    throw std::runtime_error( "InstrumentManager::LoadAll: no session" );
+  }
+
+  ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
+
+  ou::db::QueryFields<ou::db::NoBind>::pQueryFields_t pInstrumentQuery
+    = m_pSession->SQL<ou::db::NoBind>( "select * from instruments" ).NoExecute();
+  Instrument::TableRowDef instrument;
+  while ( m_pSession->Execute( pInstrumentQuery ) ) {
+    m_pSession->Columns<ou::db::NoBind, Instrument::TableRowDef>( pInstrumentQuery, instrument );
+    Add( instrument );
+  }
+
+  ou::db::QueryFields<ou::db::NoBind>::pQueryFields_t pAlternateQuery
+    = m_pSession->SQL<ou::db::NoBind>( "select * from altinstrumentnames" ).NoExecute();
+  AlternateInstrumentName::TableRowDef altname;
+  while ( m_pSession->Execute( pAlternateQuery ) ) {
+    m_pSession->Columns<ou::db::NoBind, AlternateInstrumentName::TableRowDef>( pAlternateQuery, altname );
+    iterMap iter = m_map.find( altname.idInstrument );
+    if ( m_map.end() != iter ) {
+      iter->second->SetAlternateName( altname.idProvider, altname.idAlternate );
+    }
+  }
+
+  m_bComplete = true;
+}
+
+// the snapshot is a cache for the machine which wrote it:  the rows' fields in native byte order,
+//   strings are prefixed with their length, version 1:
+//   "OUIM", version, instrument count, instrument rows, alternate name count, alternate name rows
+namespace InstrumentManagerSnapshot {
+
+  const char szMagic[] = { 'O', 'U', 'I', 'M' };
+  const boost::uint32_t nVersion( 1 );
+  const boost::uint32_t nMaxString( 1 << 16 );  // a longer length means a damaged file
+
+  struct Write {  // an action for the Fields of a row
+    std::ostream& out;
+    Write( std::ostream& out_ ): out( out_ ) {};
+    template<typename T>
+    void Field( const std::string&, const T& var ) { Put( var ); };
+    template<typename T>
+    void Field( const std::string&, const T& var, const std::string& ) { Put( var ); };
+    void Put( const std::string& s ) {
+      Put( static_cast<boost::uint32_t>( s.size() ) );
+      out.write( s.data(), s.size() );
+    }
+    template<typename T>
+    void Put( const T& var ) {
+      static_assert( std::is_arithmetic<T>::value || std::is_enum<T>::value, "InstrumentManagerSnapshot::Write: field type" );
+      out.write( reinterpret_cast<const char*>( &var ), sizeof( T ) );
+    }
+  };
+
+  struct Read {
+    std::istream& in;
+    Read( std::istream& in_ ): in( in_ ) {};
+    template<typename T>
+    void Field( const std::string&, T& var ) { Get( var ); };
+    template<typename T>
+    void Field( const std::string&, T& var, const std::string& ) { Get( var ); };
+    void Get( std::string& s ) {
+      boost::uint32_t n( 0 );
+      Get( n );
+      if ( nMaxString < n ) in.setstate( std::ios::failbit );
+      if ( !in ) return;
+      s.resize( n );
+      if ( 0 < n ) in.read( &s[ 0 ], n );
+    }
+    template<typename T>
+    void Get( T& var ) {
+      static_assert( std::is_arithmetic<T>::value || std::is_enum<T>::value, "InstrumentManagerSnapshot::Read: field type" );
+      in.read( reinterpret_cast<char*>( &var ), sizeof( T ) );
+    }
+  };
+}
+
+void InstrumentManager::SaveSnapshot( const std::string& sFileName ) {
+
+  std::vector<pInstrument_t> vInstrument;
+  vInstrument.reserve( m_map.size() );
+  for ( iterMap iter = m_map.begin(); m_map.end() != iter; ++iter ) {
+    if ( iter->first == iter->second->GetInstrumentName() ) {  // entries under a changed alternate name are skipped
+      vInstrument.push_back( iter->second );
+    }
+  }
+
+  std::vector<AlternateInstrumentName::TableRowDef> vAlternate;
+  for ( std::vector<pInstrument_t>::iterator iter = vInstrument.begin(); vInstrument.end() != iter; ++iter ) {
+    ( *iter )->ScanAlternateNames(
+      [&vAlternate]( const keytypes::eidProvider_t& idProvider, const keytypes::idInstrument_t& idAlternate, const keytypes::idInstrument_t& idInstrument ) {
+        vAlternate.push_back( AlternateInstrumentName::TableRowDef( idProvider, idAlternate, idInstrument ) );
+      } );
+  }
+
+  std::ofstream out( sFileName.c_str(), std::ios::binary | std::ios::trunc );
+  InstrumentManagerSnapshot::Write write( out );
+  out.write( InstrumentManagerSnapshot::szMagic, sizeof( InstrumentManagerSnapshot::szMagic ) );
+  write.Put( InstrumentManagerSnapshot::nVersion );
+  write.Put( static_cast<boost::uint32_t>( vInstrument.size() ) );
+  for ( std::vector<pInstrument_t>::iterator iter = vInstrument.begin(); vInstrument.end() != iter; ++iter ) {
+    const_cast<Instrument::TableRowDef&>( ( *iter )->GetRow() ).Fields( write );
+  }
+  write.Put( static_cast<boost::uint32_t>( vAlternate.size() ) );
+  for ( std::vector<AlternateInstrumentName::TableRowDef>::iterator iter = vAlternate.begin(); vAlternate.end() != iter; ++iter ) {
+    iter->Fields( write );
+  }
+  out.close();
+  if ( !out ) {
+    throw std::runtime_error( "InstrumentManager::SaveSnapshot: can't write " + sFileName );
+  }
+}
+
+bool InstrumentManager::LoadSnapshot( const std::string& sFileName ) {
+
+  std::ifstream in( sFileName.c_str(), std::ios::binary );
+  if ( !in ) return false;
+
+  InstrumentManagerSnapshot::Read read( in );
+  char szMagic[ sizeof( InstrumentManagerSnapshot::szMagic ) ];
+  in.read( szMagic, sizeof( szMagic ) );
+  boost::uint32_t nVersion( 0 );
+  read.Get( nVersion );
+  if ( !in || !std::equal( szMagic, szMagic + sizeof( szMagic ), InstrumentManagerSnapshot::szMagic )
+    || ( InstrumentManagerSnapshot::nVersion != nVersion ) ) {
+    return false;
+  }
+
+  // read it all before anything is loaded, so a damaged file loads nothing
+  boost::uint32_t nInstrument( 0 );
+  read.Get( nInstrument );
+  std::vector<Instrument::TableRowDef> vInstrument;
+  vInstrument.reserve( std::min<boost::uint32_t>( nInstrument, 1 << 20 ) );
+  for ( boost::uint32_t ix = 0; ( ix < nInstrument ) && in; ++ix ) {
+    vInstrument.push_back( Instrument::TableRowDef() );
+    vInstrument.back().Fields( read );
+  }
+  boost::uint32_t nAlternate( 0 );
+  read.Get( nAlternate );
+  std::vector<AlternateInstrumentName::TableRowDef> vAlternate;
+  vAlternate.reserve( std::min<boost::uint32_t>( nAlternate, 1 << 20 ) );
+  for ( boost::uint32_t ix = 0; ( ix < nAlternate ) && in; ++ix ) {
+    vAlternate.push_back( AlternateInstrumentName::TableRowDef() );
+    vAlternate.back().Fields( read );
+  }
+  if ( !in ) return false;
+
+  m_map.reserve( m_map.size() + vInstrument.size() );
+  for ( std::vector<Instrument::TableRowDef>::iterator iter = vInstrument.begin(); vInstrument.end() != iter; ++iter ) {
+    Add( *iter );
+  }
+  for ( std::vector<AlternateInstrumentName::TableRowDef>::iterator iter = vAlternate.begin(); vAlternate.end() != iter; ++iter ) {
+    iterMap iterInstrument = m_map.find( iter->idInstrument );
+    if ( m_map.end() != iterInstrument ) {
+      iterInstrument->second->SetAlternateName( iter->idProvider, iter->idAlternate );
+    }
+  }
+
+  return true;
+}
+
 void InstrumentManager::HandleAlternateNameAdded( const Instrument::AlternateNameChangeInfo_t& info ) {
   iterMap iterKey = m_map.find( info.s1 );
   iterMap iterAlt = m_map.find( info.s2 );
@@ -347,6 +525,7 @@ void InstrumentManager::DetachFromSession( ou::db::Session* pSession ) {
   pSession->OnRegisterRows.Remove( MakeDelegate( this, &InstrumentManager::HandleRegisterRows ) );
   pSession->OnPopulate.Remove( MakeDelegate( this, &InstrumentManager::HandlePopulateTables ) );
   ManagerBase::DetachFromSession( pSession );
+  m_bComplete = false;
 }
 
 
@@ -14,9 +14,13 @@
 #pragma once
 
 // 2011/03/16  add persist-to-db superclass for saving/retrieving instruments
+// 2018/05/08  bulk load:  LoadAll reads the instruments and alternate names tables in one pass each,
+//   after which the cache is complete, and a name not in it is not looked for in the database,
+//   a snapshot of the cache can be saved to, and restored from, a binary file, for faster restarts,
+//   names not in a restored snapshot are still looked for in the database
 
-#include <map>
 #include <string>
+#include <unordered_map>
 
 #include <OUCommon/ManagerBase.h>
 
@@ -76,6 +80,10 @@ public:
 
   template<typename F> void ScanOptions( F f, idInstrument_cref, boost::uint16_t year, boost::uint16_t month, boost::uint16_t day );
 
+  void LoadAll( void );  // from the attached session
+  void SaveSnapshot( const std::string& sFileName );
+  bool LoadSnapshot( const std::string& sFileName );  // false if missing or unreadable, nothing is loaded
+
   void AttachToSession( ou::db::Session* pSession );
   void DetachFromSession( ou::db::Session* pSession );
 
@@ -93,11 +101,14 @@ protected:
 
 private:
 
-  typedef std::map<idInstrument_t,pInstrument_t> map_t;
+  typedef std::unordered_map<idInstrument_t,pInstrument_t> map_t;
   typedef map_t::iterator iterMap;
   typedef std::pair<idInstrument_t,pInstrument_t> pair_t;
 
   map_t m_map;
+  bool m_bComplete;  // everything in the database is in the map
+
+  void Add( const Instrument::TableRowDef& );  // skipped when already loaded
 
   void SaveAlternateInstrumentName( const AlternateInstrumentName::TableRowDef& );
   void SaveAlternateInstrumentName( 
@@ -140,6 +151,7 @@ namespace InstrumentManagerQueries {
 
 template<typename F> 
 void InstrumentManager::ScanOptions( F f, idInstrument_cref id, boost::uint16_t nYear, boost::uint16_t nMonth, boost::uint16_t nDay ) {
+  ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );  // as in LoadInstrument, which Get may call
   InstrumentManagerQueries::OptionSelection idInstrument( id, nYear, nMonth, nDay );
   ou::db::QueryFields<InstrumentManagerQueries::OptionSelection>::pQueryFields_t pExistsQuery // shouldn't do a * as fields may change order
     = m_pSession->SQL<InstrumentManagerQueries::OptionSelection>( 
@@ -13,6 +13,8 @@
 
 #include "stdafx.h"
 
+#include <memory>
+
 #include "Managers.h"
 
 #include "ProviderManager.h"
@@ -24,6 +26,19 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
+namespace {
+  bool bWriteBehind( false );
+  std::unique_ptr<ou::db::WriteBehind> pWriteBehind;
+}
+
+void EnableManagersWriteBehind( bool bEnable ) {
+  bWriteBehind = bEnable;
+}
+
+ou::db::WriteBehind* ManagersWriteBehind( void ) {
+  return pWriteBehind.get();
+}
+
 // providers need to have been opened elsewhere, as this is a lookup into the provider map only
 void HandlePositionDetails( Position::pPosition_t& pPosition ) {
   const Position::TableRowDef& row( pPosition->GetRow() );
@@ -44,6 +59,15 @@ void HandleInitializeManagers( ou::db::Session* pSession ) {
   PortfolioManager::Instance().AttachToSession( pSession );
   OrderManager::Instance().AttachToSession( pSession );
 
+  if ( bWriteBehind ) {
+    pWriteBehind.reset( new ou::db::WriteBehind( *pSession ) );
+  }
+  ProviderManager::Instance().AttachToWriteBehind( pWriteBehind.get() );
+  InstrumentManager::Instance().AttachToWriteBehind( pWriteBehind.get() );
+  AccountManager::Instance().AttachToWriteBehind( pWriteBehind.get() );
+  PortfolioManager::Instance().AttachToWriteBehind( pWriteBehind.get() );
+  OrderManager::Instance().AttachToWriteBehind( pWriteBehind.get() );
+
   // link up with PortfolioManager for call back
   PortfolioManager::Instance().SetOnPositionNeedDetails( &HandlePositionDetails );
   // link up with OrderManager for call back
@@ -55,6 +79,14 @@ void HandleDenitializeManagers( ou::db::Session& session ) {
   OrderManager::Instance().SetOnOrderNeedsDetails( 0 );
   PortfolioManager::Instance().SetOnPositionNeedDetails( 0 );
 
+  // the first detach flushes, the writer is then stopped while the session is still open
+  OrderManager::Instance().DetachFromWriteBehind();
+  PortfolioManager::Instance().DetachFromWriteBehind();
+  AccountManager::Instance().DetachFromWriteBehind();
+  InstrumentManager::Instance().DetachFromWriteBehind();
+  ProviderManager::Instance().DetachFromWriteBehind();
+  pWriteBehind.reset();
+
   ProviderManager::Instance().DetachFromSession( &session );
   InstrumentManager::Instance().DetachFromSession( &session );
   AccountManager::Instance().DetachFromSession( &session );
@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <OUSqlite/WriteBehind.h>
+
 #include "Database.h"
 
 namespace ou { // One Unified
@@ -21,6 +23,15 @@ namespace tf { // TradeFrame
 void HandleInitializeManagers( ou::db::Session* pSession );
 void HandleDenitializeManagers( ou::db::Session& session );
 
+// off by default, the managers then write to the session directly, on the caller's thread
+// when on, set before the session opens, every manager sharing the session writes through one WriteBehind,
+//   its writer thread then shares the session:  anything else using the session, such as an OnPopulate handler,
+//   or option loading, holds a WriteBehind::Exclusive on ManagersWriteBehind() meanwhile
+void EnableManagersWriteBehind( bool bEnable = true );
+
+// exists between the two handlers above when enabled, null otherwise, for stats, error handling, and Exclusive
+ou::db::WriteBehind* ManagersWriteBehind( void );
+
 } // namespace tf
 } // namespace ou
 
@@ -26,7 +26,7 @@ namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 NoRiskInterestRateSeries::NoRiskInterestRateSeries( void ) 
-  : m_bInitialized( false ), m_bWatching( false ), m_sDescription( "rates")
+  : m_sDescription( "rates"), m_bInitialized( false ), m_bWatching( false ), m_nVersion( 0 )
 {
 }
 
@@ -58,6 +58,7 @@ void NoRiskInterestRateSeries::SetWatchOn( pProvider_t pProvider ) {
   if ( !m_bWatching ) {
     m_bWatching = true;
     for ( vInterestRate_iter_t iter = m_vInterestRate.begin(); m_vInterestRate.end() != iter; ++ iter ) {
+      iter->pWatch->OnTrade.Add( MakeDelegate( this, &NoRiskInterestRateSeries::HandleTrade ) );
       iter->pWatch->StartWatch();
     }
   }
@@ -68,10 +69,15 @@ void NoRiskInterestRateSeries::SetWatchOff( void ) {
     m_bWatching = false;
     for ( vInterestRate_iter_t iter = m_vInterestRate.begin(); m_vInterestRate.end() != iter; ++ iter ) {
       iter->pWatch->StopWatch();
+      iter->pWatch->OnTrade.Remove( MakeDelegate( this, &NoRiskInterestRateSeries::HandleTrade ) );
     }
   }
 }
 
+void NoRiskInterestRateSeries::HandleTrade( const ou::tf::Trade& ) {
+  m_nVersion++;
+}
+
 void NoRiskInterestRateSeries::SaveSeries( const std::string& sPrefix ) {
   for ( vInterestRate_t::iterator iter = m_vInterestRate.begin(); m_vInterestRate.end() != iter; ++iter ) {
     iter->pWatch->SaveSeries( sPrefix + "/" + m_sDescription );
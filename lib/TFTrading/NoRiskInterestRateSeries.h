@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <ostream>
@@ -56,6 +57,7 @@ public:
   void SetWatchOff( void );
 
   double ValueAt( boost::posix_time::time_duration td ) const;  // index to determine appropriate interest rate
+  unsigned int Version( void ) const { return m_nVersion; }  // changes with each rate tick, for caches of ValueAt
   
   bool Watching( void ) const { return m_bWatching; }
   
@@ -95,10 +97,12 @@ private:
 
   bool m_bInitialized;
   bool m_bWatching;
+  std::atomic<unsigned int> m_nVersion;
   
   pProvider_t m_pProvider;
 
   void Initialize( void );
+  void HandleTrade( const ou::tf::Trade& );
 
 };
 
@@ -234,5 +234,12 @@ void Order::MarkAsCancelled( void ) {
   OnOrderCancelled( *this );
 }
 
+void Order::MarkAsRejected( void ) {
+  assert( OrderStatus::Created == m_row.eOrderStatus );
+  m_row.eOrderStatus = OrderStatus::Rejected;
+  m_row.dtOrderClosed = ou::TimeSource::LocalCommonInstance().Internal();
+  OnOrderCancelled( *this );  // nothing filled, so those holding the order treat it as cancelled
+}
+
 } // namespace tf
 } // namespace ou
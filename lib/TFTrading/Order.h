@@ -226,6 +226,7 @@ public:
   };
   double GetIncrementalCommission( void ) const { return m_dblIncrementalCommission; };
   void MarkAsCancelled( void );  // called from OrderManager
+  void MarkAsRejected( void );  // called from OrderManager, refused before reaching the provider
 
   ou::Delegate<const std::pair<const Order&, const Execution&>& > OnExecution;
   ou::Delegate<const Order&> OnOrderCancelled;
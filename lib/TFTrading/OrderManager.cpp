@@ -86,19 +86,20 @@ void OrderManager::ConstructOrder( pOrder_t& pOrder ) {
   pOrder->SetOrderId( id );
   // need to create an exception free way to check that order does not exist, in the meantime:
   try {
-    iterOrders_t iter;
-    if ( LocateOrder( id, iter ) ) {
+    if ( 0 != LocateOrder( id ) ) {
       std::cout << "OrderManager::ConstructOrder:  OrderId Already Exists" << std::endl;
     }
     else {
-      pairOrderState_t pair( id, structOrderState( pOrder ) );
-      m_mapOrders.insert( pair );
+      m_tableOrders.Insert( id, structOrderState( pOrder ) );
 
       if ( 0 != m_pSession ) {
         // add to database
         assert( 0 != pOrder->GetRow().idPosition );
-        ou::db::QueryFields<Order::TableRowDef>::pQueryFields_t pQuery
-          = m_pSession->Insert<Order::TableRowDef>( const_cast<Order::TableRowDef&>( pOrder->GetRow() ) );
+        Order::TableRowDef row( pOrder->GetRow() );
+        Persist( [row]( ou::db::Session& session ) mutable {
+          ou::db::QueryFields<Order::TableRowDef>::pQueryFields_t pQuery
+            = session.Insert<Order::TableRowDef>( row );
+        } );
       }
     }
   }
@@ -122,23 +123,53 @@ namespace OrderManagerQueries {
     UpdateAtPlaceOrder( Order::idOrder_t id, OrderStatus::enumOrderStatus status, ptime dtOrderSubmitted_ )
       : idOrder( id ), dtOrderSubmitted( dtOrderSubmitted_ ), eOrderStatus( status ) {};
   };
+  struct UpdateAtOrderClose {
+    template<class A>
+    void Fields( A& a ) {
+      ou::db::Field( a, "orderstatus", eOrderStatus );
+      ou::db::Field( a, "datetimeclosed", dtOrderClosed );
+      ou::db::Field( a, "orderid", idOrder );
+    }
+    Order::idOrder_t idOrder;
+    ptime dtOrderClosed;
+    OrderStatus::enumOrderStatus eOrderStatus;
+    UpdateAtOrderClose( Order::idOrder_t id, OrderStatus::enumOrderStatus status, ptime dtOrderClosed_ )
+      : idOrder( id ), dtOrderClosed( dtOrderClosed_ ), eOrderStatus( status ) {};
+  };
 }
 
 void OrderManager::PlaceOrder(ProviderInterfaceBase *pProvider, pOrder_t pOrder) {
 
   try {
-    iterOrders_t iter;
-    if ( LocateOrder( pOrder->GetOrderId(), iter ) ) {
+    structOrderState* pState( LocateOrder( pOrder->GetOrderId() ) );
+    if ( 0 != pState ) {
       assert( NULL != pProvider );
-      iter->second.pProvider = pProvider;
+      RiskManager::EReject eReject( RiskManager::LocalCommonInstance().Check( *pOrder, pState->exposure ) );
+      if ( RiskManager::ERejectNone != eReject ) {
+        std::cout << "OrderManager::PlaceOrder:  order " << pOrder->GetOrderId() << " rejected, " << RiskManager::Name( eReject ) << std::endl;
+        pOrder->MarkAsRejected();
+        if ( 0 != m_pSession ) {
+          OrderManagerQueries::UpdateAtOrderClose 
+            close( pOrder->GetOrderId(), pOrder->GetRow().eOrderStatus, pOrder->GetRow().dtOrderClosed );
+          Persist( [close]( ou::db::Session& session ) mutable {
+            ou::db::QueryFields<OrderManagerQueries::UpdateAtOrderClose>::pQueryFields_t pQuery
+              = session.SQL<OrderManagerQueries::UpdateAtOrderClose>(
+                "update orders set orderstatus=?, datetimeclosed=?", close ).Where( "orderid=?" );
+          } );
+        }
+        return;
+      }
+      pState->pProvider = pProvider;
       pOrder->SetSendingToProvider();
       pProvider->PlaceOrder( pOrder );
       if ( 0 != m_pSession ) {
         OrderManagerQueries::UpdateAtPlaceOrder 
           update( pOrder->GetOrderId(), pOrder->GetRow().eOrderStatus, pOrder->GetRow().dtOrderSubmitted );
-        ou::db::QueryFields<OrderManagerQueries::UpdateAtPlaceOrder>::pQueryFields_t pQuery
-          = m_pSession->SQL<OrderManagerQueries::UpdateAtPlaceOrder>( // todo:  cache this query
-            "update orders set orderstatus=?, datetimesubmitted=?", update ).Where( "orderid=?" );
+        Persist( [update]( ou::db::Session& session ) mutable {
+          ou::db::QueryFields<OrderManagerQueries::UpdateAtPlaceOrder>::pQueryFields_t pQuery
+            = session.SQL<OrderManagerQueries::UpdateAtPlaceOrder>(
+              "update orders set orderstatus=?, datetimesubmitted=?", update ).Where( "orderid=?" );
+        } );
       }
     }
     else {
@@ -170,23 +201,19 @@ namespace OrderManagerQueries {
   };
 }
 
-bool OrderManager::LocateOrder( idOrder_t nOrderId, iterOrders_t& iter ) {
+OrderManager::structOrderState* OrderManager::LocateOrder( idOrder_t nOrderId ) {
   // if not in memory, the load order and executions from disk
-  bool bFound = false;
-//  iterOrders_t iter = m_mapOrders.find( nOrderId );
-  iter = m_mapOrders.find( nOrderId );
-  if ( m_mapOrders.end() != iter ) {
-    bFound = true;
-  }
-  else {
+  if ( 0 >= nOrderId ) return 0;  // ids are positive, and the table is indexed by them
+  structOrderState* pState( m_tableOrders.Find( nOrderId ) );
+  if ( 0 == pState ) {
     // check in database first, and if found, load order and executions
     if ( 0 != m_pSession ) {
+      ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
       OrderManagerQueries::OrderKey keyOrder( nOrderId );
       ou::db::QueryFields<OrderManagerQueries::OrderKey>::pQueryFields_t pOrderExistsQuery
         = m_pSession->SQL<OrderManagerQueries::OrderKey>( "select * from orders", keyOrder ).Where( "orderid=?" ).NoExecute();
       m_pSession->Bind<OrderManagerQueries::OrderKey>( pOrderExistsQuery );
       if ( m_pSession->Execute( pOrderExistsQuery ) ) {
-        bFound = true;
         // load order as well as associated executions
         Order::TableRowDef rowOrder;
         m_pSession->Columns<OrderManagerQueries::OrderKey, Order::TableRowDef>( pOrderExistsQuery, rowOrder );
@@ -196,12 +223,11 @@ bool OrderManager::LocateOrder( idOrder_t nOrderId, iterOrders_t& iter ) {
         pInstrument_t pInstrument;
         OnOrderNeedsDetails( rowOrder.idInstrument, pInstrument );
         pOrder_t pOrder( new Order( rowOrder, pInstrument ) );
-        std::pair<iterOrders_t, bool> response;
-        response = m_mapOrders.insert( pairOrderState_t(rowOrder.idOrder, structOrderState( pOrder ) ) );
-        if ( false == response.second ) {
-          throw std::runtime_error( "OrderManager::LocateOrder:  couldn't insert order into map" );
+        pState = m_tableOrders.Insert( rowOrder.idOrder, structOrderState( pOrder ) );
+        if ( 0 == pState ) {
+          throw std::runtime_error( "OrderManager::LocateOrder:  couldn't insert order into table" );
         }
-        iter = response.first;
+        RiskManager::LocalCommonInstance().Attach( *pOrder, pState->exposure );  // so its fills still move the positions
 
         // load up executions
         ou::db::QueryFields<OrderManagerQueries::OrderKey>::pQueryFields_t pExecutionQuery
@@ -209,42 +235,20 @@ bool OrderManager::LocateOrder( idOrder_t nOrderId, iterOrders_t& iter ) {
         while ( m_pSession->Execute( pExecutionQuery ) ) {
           Execution::TableRowDef rowExecution;
           m_pSession->Columns<OrderManagerQueries::OrderKey, Execution::TableRowDef>( pExecutionQuery, rowExecution );
-          pExecution_t pExecution( new Execution( rowExecution ) );
-          iter->second.pmapExecutions->insert( pairExecution_t( rowExecution.idExecution, pExecution ) );
+          pState->vExecutions.push_back( Execution( rowExecution ) );
         }
       }
     }
   }
-//  if ( !bFound ) {
-//    std::cout << "OrderManager::LocateOrder order not found:  " << nOrderId << std::endl;
-//    throw std::out_of_range( "OrderId not found" );
-//  }
-//  return iter;
-  return bFound;
-}
-
-namespace OrderManagerQueries {
-  struct UpdateAtOrderClose {
-    template<class A>
-    void Fields( A& a ) {
-      ou::db::Field( a, "orderstatus", eOrderStatus );
-      ou::db::Field( a, "datetimeclosed", dtOrderClosed );
-      ou::db::Field( a, "orderid", idOrder );
-    }
-    Order::idOrder_t idOrder;
-    ptime dtOrderClosed;
-    OrderStatus::enumOrderStatus eOrderStatus;
-    UpdateAtOrderClose( Order::idOrder_t id, OrderStatus::enumOrderStatus status, ptime dtOrderClosed_ )
-      : idOrder( id ), dtOrderClosed( dtOrderClosed_ ), eOrderStatus( status ) {};
-  };
+  return pState;
 }
 
 void OrderManager::CancelOrder( idOrder_t nOrderId) {  // this needs to work in conjunction with ReportCancellation, database update maybe premature
   try {
-    mapOrders_t::iterator iter;
-    if ( LocateOrder( nOrderId, iter ) ) {
-      pOrder_t pOrder = iter->second.pOrder;
-      iter->second.pProvider->CancelOrder( pOrder );  // check which fields have changed for the db
+    structOrderState* pState( LocateOrder( nOrderId ) );
+    if ( 0 != pState ) {
+      pOrder_t pOrder = pState->pOrder;
+      pState->pProvider->CancelOrder( pOrder );  // check which fields have changed for the db
     }
     else {
       std::cout << "OrderManager::CancelOrder:  OrderId Not Found" << std::endl;
@@ -257,16 +261,19 @@ void OrderManager::CancelOrder( idOrder_t nOrderId) {  // this needs to work in
 
 void OrderManager::ReportCancellation( idOrder_t nOrderId ) {
   try {
-    iterOrders_t iter;
-    if ( LocateOrder( nOrderId, iter ) ) {
-      pOrder_t pOrder = iter->second.pOrder;
+    structOrderState* pState( LocateOrder( nOrderId ) );
+    if ( 0 != pState ) {
+      pOrder_t pOrder = pState->pOrder;
       pOrder->MarkAsCancelled();
+      RiskManager::LocalCommonInstance().Release( pState->exposure );
       if ( 0 != m_pSession ) {
         OrderManagerQueries::UpdateAtOrderClose 
           close( pOrder->GetOrderId(), pOrder->GetRow().eOrderStatus, pOrder->GetRow().dtOrderClosed );
-        ou::db::QueryFields<OrderManagerQueries::UpdateAtOrderClose>::pQueryFields_t pQuery
-          = m_pSession->SQL<OrderManagerQueries::UpdateAtOrderClose>( // todo:  cache this query
-            "update orders set orderstatus=?, datetimeclosed=?", close ).Where( "orderid=?" );
+        Persist( [close]( ou::db::Session& session ) mutable {
+          ou::db::QueryFields<OrderManagerQueries::UpdateAtOrderClose>::pQueryFields_t pQuery
+            = session.SQL<OrderManagerQueries::UpdateAtOrderClose>(
+              "update orders set orderstatus=?, datetimeclosed=?", close ).Where( "orderid=?" );
+        } );
       }
     }
     else {
@@ -307,42 +314,36 @@ namespace OrderManagerQueries {
 
 void OrderManager::ReportExecution( idOrder_t nOrderId, const Execution& exec) { 
   try {
-    mapOrders_t::iterator iter;
-    if ( LocateOrder( nOrderId, iter ) ) {
-      pOrder_t pOrder = iter->second.pOrder;
+    structOrderState* pState( LocateOrder( nOrderId ) );
+    if ( 0 != pState ) {
+      pOrder_t pOrder = pState->pOrder;
       OrderStatus::enumOrderStatus status = pOrder->ReportExecution( exec );
+      RiskManager::LocalCommonInstance().Fill( pState->exposure, exec.GetSize() );
+      if ( OrderStatus::CancelledWithPartialFill == status ) RiskManager::LocalCommonInstance().Release( pState->exposure );
+      pState->vExecutions.push_back( exec );
+      pState->vExecutions.back().SetOrderId( nOrderId );
       if ( 0 != m_pSession ) {
         const Order::TableRowDef& row( pOrder->GetRow() );
+        ptime dtClosed( boost::date_time::not_a_date_time );
         switch ( status ) {
         case OrderStatus::CancelledWithPartialFill:
         case OrderStatus::Filled:
-          {
-            OrderManagerQueries::UpdateOrder 
-              order( nOrderId, row.eOrderStatus, row.nQuantityRemaining, row.nQuantityFilled, row.dblAverageFillPrice, ou::TimeSource::LocalCommonInstance().Internal() );
-            ou::db::QueryFields<OrderManagerQueries::UpdateOrder>::pQueryFields_t pQuery
-              = m_pSession->SQL<OrderManagerQueries::UpdateOrder>( // todo:  cache this query
-              OrderManagerQueries::sUpdateOrderQuery, order ).Where( "orderid=?" );
-          }
+          dtClosed = ou::TimeSource::LocalCommonInstance().Internal();
           break;
         default:
-          {
-            OrderManagerQueries::UpdateOrder 
-              order( nOrderId, row.eOrderStatus, row.nQuantityRemaining, row.nQuantityFilled, row.dblAverageFillPrice );
-            ou::db::QueryFields<OrderManagerQueries::UpdateOrder>::pQueryFields_t pQuery
-              = m_pSession->SQL<OrderManagerQueries::UpdateOrder>( // todo:  cache this query
-              OrderManagerQueries::sUpdateOrderQuery, order ).Where( "orderid=?" );
-          }
           break;
         }
+        OrderManagerQueries::UpdateOrder 
+          order( nOrderId, row.eOrderStatus, row.nQuantityRemaining, row.nQuantityFilled, row.dblAverageFillPrice, dtClosed );
         // add execution record
-        pExecution_t pExecution( new Execution( exec ) );
-        pExecution->SetOrderId( nOrderId );
-        ou::db::QueryFields<Execution::TableRowDefNoKey>::pQueryFields_t pQueryExecutionWrite
-          = m_pSession->Insert<Execution::TableRowDefNoKey>( 
-            const_cast<Execution::TableRowDefNoKey&>( dynamic_cast<const Execution::TableRowDefNoKey&>( pExecution->GetRow() ) ) );
-        idExecution_t idExecution = m_pSession->GetLastRowId();
-        pairExecution_t pair( idExecution, pExecution );
-        iter->second.pmapExecutions->insert( pair );
+        Execution::TableRowDefNoKey rowExecution( pState->vExecutions.back().GetRow() );
+        Persist( [order, rowExecution]( ou::db::Session& session ) mutable {
+          ou::db::QueryFields<OrderManagerQueries::UpdateOrder>::pQueryFields_t pQuery
+            = session.SQL<OrderManagerQueries::UpdateOrder>(
+            OrderManagerQueries::sUpdateOrderQuery, order ).Where( "orderid=?" );
+          ou::db::QueryFields<Execution::TableRowDefNoKey>::pQueryFields_t pQueryExecutionWrite
+            = session.Insert<Execution::TableRowDefNoKey>( rowExecution );
+        } );
       }
   //    switch ( status ) {
   //      case OrderStatus::Filled:
@@ -375,15 +376,17 @@ namespace OrderManagerQueries {
 
 void OrderManager::ReportCommission( idOrder_t nOrderId, double dblCommission ) {
   try {
-    mapOrders_t::iterator iter;
-    if ( LocateOrder( nOrderId, iter ) ) {
-      pOrder_t pOrder = iter->second.pOrder;
+    structOrderState* pState( LocateOrder( nOrderId ) );
+    if ( 0 != pState ) {
+      pOrder_t pOrder = pState->pOrder;
       if ( 0 != m_pSession ) {
         OrderManagerQueries::UpdateCommission 
           commission( pOrder->GetOrderId(), dblCommission );
-        ou::db::QueryFields<OrderManagerQueries::UpdateCommission>::pQueryFields_t pQuery
-          = m_pSession->SQL<OrderManagerQueries::UpdateCommission>( // todo:  cache this query
-            "update orders set commission=?", commission ).Where( "orderid=?" );
+        Persist( [commission]( ou::db::Session& session ) mutable {
+          ou::db::QueryFields<OrderManagerQueries::UpdateCommission>::pQueryFields_t pQuery
+            = session.SQL<OrderManagerQueries::UpdateCommission>(
+              "update orders set commission=?", commission ).Where( "orderid=?" );
+        } );
       }
       pOrder->SetCommission( dblCommission );  // need to do afterwards as delegated objects may query the db (other stuff above may not obey this format)
       // as a result, may need to set delegates here so database is updated before order calls delegates.
@@ -415,17 +418,20 @@ namespace OrderManagerQueries {
 
 void OrderManager::ReportErrors( idOrder_t nOrderId, OrderErrors::enumOrderErrors eError) {
   try {
-    mapOrders_t::iterator iter;
-    if ( LocateOrder( nOrderId, iter ) ) {
-      pOrder_t pOrder = iter->second.pOrder;
+    structOrderState* pState( LocateOrder( nOrderId ) );
+    if ( 0 != pState ) {
+      pOrder_t pOrder = pState->pOrder;
       pOrder->ActOnError( eError );
+      if ( OrderErrors::NotCancellable != eError ) RiskManager::LocalCommonInstance().Release( pState->exposure );
       //MoveActiveOrderToCompleted( nOrderId );
       if ( 0 != m_pSession ) {
         OrderManagerQueries::UpdateOnOrderError 
           error( pOrder->GetOrderId(), pOrder->GetRow().eOrderStatus, pOrder->GetRow().dtOrderClosed );
-        ou::db::QueryFields<OrderManagerQueries::UpdateOnOrderError>::pQueryFields_t pQuery
-          = m_pSession->SQL<OrderManagerQueries::UpdateOnOrderError>( // todo:  cache this query
-            "update orders set orderstatus=?, datetimeclosed=?", error ).Where( "orderid=?" );
+        Persist( [error]( ou::db::Session& session ) mutable {
+          ou::db::QueryFields<OrderManagerQueries::UpdateOnOrderError>::pQueryFields_t pQuery
+            = session.SQL<OrderManagerQueries::UpdateOnOrderError>(
+              "update orders set orderstatus=?, datetimeclosed=?", error ).Where( "orderid=?" );
+        } );
       }
     }
     else {
@@ -16,12 +16,14 @@
 // 2010/09/12
 // At some point, make order manager responsible for constructing Order
 
-#include <map>
 #include <vector>
 #include <stdexcept>
 
+#include <boost/container/small_vector.hpp>
+
 #include <OUCommon/Delegate.h>
 #include <OUCommon/ManagerBase.h>
+#include <OUCommon/SlabTable.h>
 
 #include "KeyTypes.h"
 
@@ -29,6 +31,7 @@
 #include "TradingEnumerations.h"
 #include "Order.h"
 #include "Execution.h"
+#include "RiskManager.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
@@ -96,28 +99,25 @@ public:
 
 protected:
 
-  typedef std::pair<idExecution_t, pExecution_t> pairExecution_t;
-  typedef std::map<idExecution_t, pExecution_t> mapExecutions_t;
-  typedef mapExecutions_t::iterator iterExecutions_t;
-  typedef boost::shared_ptr<mapExecutions_t> pmapExecutions_t;
+  // 2018/05/06 executions are kept in the order of arrival, in place for the usual one or two fills,
+  //   those loaded from the database have their execution id, those reported since have 0,
+  //   as the id is assigned when written, possibly later by the write behind thread
+  typedef boost::container::small_vector<Execution, 2> vExecutions_t;
 
   struct structOrderState {
     pOrder_t pOrder;
     ProviderInterfaceBase* pProvider;
-    pmapExecutions_t pmapExecutions;
+    vExecutions_t vExecutions;
+    RiskManager::Exposure exposure;  // reserved by the pre-trade checks
+    structOrderState( void ): pProvider( 0 ) {};
     structOrderState( pOrder_t& pOrder_ )
-      : pOrder( pOrder_ ), pProvider( 0 ), pmapExecutions( new mapExecutions_t ) {};
+      : pOrder( pOrder_ ), pProvider( 0 ) {};
     structOrderState( pOrder_t& pOrder_, ProviderInterfaceBase* pProvider_ )
-      : pOrder( pOrder_ ), pProvider( pProvider_ ), pmapExecutions( new mapExecutions_t ) {};
-    ~structOrderState( void ) {
-//      delete pmapExecutions;  // check that executions have been committed to db?
-      // check that orders have been committed to db?
-    }
+      : pOrder( pOrder_ ), pProvider( pProvider_ ) {};
   };
 
-  typedef std::pair<idOrder_t, structOrderState> pairOrderState_t;
-  typedef std::map<idOrder_t, structOrderState> mapOrders_t;  // used for active orders
-  typedef mapOrders_t::iterator iterOrders_t;
+  // order ids are auto incremented, so index the states directly by id, rather than through a tree of nodes
+  typedef ou::SlabTable<structOrderState> tableOrders_t;
 
 private:
 
@@ -133,10 +133,9 @@ private:
     int GetCurrentId( void ) { return i; };
   } m_orderIds;
 
-  mapOrders_t m_mapOrders; // all orders for when checking for consistency
+  tableOrders_t m_tableOrders; // all orders for when checking for consistency
 
-//  iterOrders_t LocateOrder( idOrder_t nOrderId );  // in memory or from disk
-  bool LocateOrder( idOrder_t nOrderId, iterOrders_t& );  // in memory or from disk, return true if order found
+  structOrderState* LocateOrder( idOrder_t nOrderId );  // in memory or from disk, null if not found
 
   OnOrderNeedsDetailsHandler OnOrderNeedsDetails;
 
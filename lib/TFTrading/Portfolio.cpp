@@ -46,7 +46,9 @@ namespace tf { // TradeFrame
 Portfolio::Portfolio( // portfolio record
   const idPortfolio_t& idPortfolio, const idAccountOwner_t& idAccountOwner, const idPortfolio_t& idOwner,
    EPortfolioType ePortfolioType, currency_t sCurrency, const std::string& sDescription ) 
-: m_row( idPortfolio, idAccountOwner, idOwner, ePortfolioType, sCurrency, sDescription )
+: m_row( idPortfolio, idAccountOwner, idOwner, ePortfolioType, sCurrency, sDescription ),
+  m_pOwner( 0 ), m_bQueued( false ), m_bChanged( false ), m_dblUnRealizedPending( 0.0 ), m_nChangesPending( 0 ),
+  m_durPublish( std::chrono::steady_clock::duration::zero() )
 {
   bool bOk = true;
   if ( "" == idPortfolio ) bOk = false;
@@ -58,7 +60,9 @@ Portfolio::Portfolio( // portfolio record
 }
 
 Portfolio::Portfolio( const TableRowDef& row ) 
-  : m_row( row )
+  : m_row( row ),
+  m_pOwner( 0 ), m_bQueued( false ), m_bChanged( false ), m_dblUnRealizedPending( 0.0 ), m_nChangesPending( 0 ),
+  m_durPublish( std::chrono::steady_clock::duration::zero() )
 {
   m_plCurrent.dblCommissionsPaid = m_row.dblCommissionsPaid;
   m_plCurrent.dblRealized = m_row.dblRealizedPL;
@@ -67,6 +71,11 @@ Portfolio::Portfolio( const TableRowDef& row )
 }
 
 Portfolio::~Portfolio(void) {
+  lock_t lock( LockTree() );
+  for ( mapPortfolios_iter_t iter = m_mapSubPortfolios.begin(); m_mapSubPortfolios.end() != iter; ++iter ) {
+    iter->second->m_pOwner = 0;
+    iter->second->m_bQueued = false;
+  }
 }
 
 Portfolio::pPosition_t Portfolio::AddPosition( const std::string &sName, pPosition_t pPosition ) {
@@ -165,6 +174,9 @@ void Portfolio::ReCalc( void ) {
 
 void Portfolio::AddSubPortfolio( pPortfolio_t& pPortfolio ) {
 
+  lock_t lock( LockTree() );
+  lock_t lockSub( pPortfolio->LockTree() );  // its own, until it is attached
+
   if ( Master == pPortfolio->GetRow().ePortfolioType ) {
     //throw std::runtime_error( "Portfolio::AddSubPortfolio: sub-portfolio cannot be a master portfolio" );
     std::cout << "Master portfolio found" << std::endl;
@@ -187,11 +199,17 @@ void Portfolio::AddSubPortfolio( pPortfolio_t& pPortfolio ) {
       throw std::runtime_error( "Portfolio::AddSubPortfolio portfolio already exists: " + idSubPortfolio );
     }
 
+    if ( 0 != pPortfolio->m_pOwner ) {
+      throw std::runtime_error( "Portfolio::AddSubPortfolio portfolio already has an owner: " + idSubPortfolio );
+    }
+
+    pPortfolio->Publish();  // settles it as a top portfolio, nothing it had is pending for this one
+
     m_mapSubPortfolios[ idSubPortfolio ] = pPortfolio;
 
     pPortfolio->OnCommission.Add( MakeDelegate( this, &Portfolio::HandleCommission ) );
     pPortfolio->OnExecution.Add( MakeDelegate( this, &Portfolio::HandleExecution ) );
-    pPortfolio->OnUnRealizedPL.Add( MakeDelegate( this, &Portfolio::HandleUnRealizedPL ) );
+    pPortfolio->m_pOwner = this;  // unrealized comes up through Queue and Collect
   }
 }
 
@@ -199,15 +217,19 @@ void Portfolio::RemoveSubPortfolio( const idPortfolio_t& idPortfolio ) {
 
   mapPortfolios_iter_t iter = m_mapSubPortfolios.find( idPortfolio );
 
-  if ( m_mapSubPortfolios.end() != iter ) {
+  if ( m_mapSubPortfolios.end() == iter ) {
     throw std::runtime_error( "Portfolio::RemoveSubPortfolio portfolio does not exist: " + idPortfolio );
   }
 
   Portfolio* pPortfolio = iter->second.get();
 
-  pPortfolio->OnCommission.Add( MakeDelegate( this, &Portfolio::HandleCommission ) );
-  pPortfolio->OnExecution.Add( MakeDelegate( this, &Portfolio::HandleExecution ) );
-  pPortfolio->OnUnRealizedPL.Add( MakeDelegate( this, &Portfolio::HandleUnRealizedPL ) );
+  lock_t lock( LockTree() );
+
+  Publish();  // take in what is pending from the sub portfolio before it leaves
+
+  pPortfolio->OnCommission.Remove( MakeDelegate( this, &Portfolio::HandleCommission ) );
+  pPortfolio->OnExecution.Remove( MakeDelegate( this, &Portfolio::HandleExecution ) );
+  pPortfolio->m_pOwner = 0;
 
   m_mapSubPortfolios.erase( iter );
 }
@@ -224,7 +246,11 @@ void Portfolio::SetOwnerPortfolio( const idPortfolio_t& idOwner, pPortfolio_t& p
 
 void Portfolio::HandleUnRealizedPL( const PositionDelta_delegate_t& position ) {
 
-  m_plCurrent.dblUnRealized += ( -position.get<1>() + position.get<2>() );
+  lock_t lock( LockTree() );
+
+  const double dblDelta( -position.get<1>() + position.get<2>() );
+
+  m_plCurrent.dblUnRealized += dblDelta;
 
 //  m_row.db.dblUnRealized = m_plCurrent.dblUnRealized;
 
@@ -232,14 +258,106 @@ void Portfolio::HandleUnRealizedPL( const PositionDelta_delegate_t& position ) {
   if ( m_plCurrent > m_plMax ) m_plMax.dblUnRealized = m_plCurrent.dblUnRealized;
   if ( m_plCurrent < m_plMin ) m_plMin.dblUnRealized = m_plCurrent.dblUnRealized;
 
-  // need to propogate up portfolios yet
-  OnUnRealizedPL( position );
-  OnUnRealizedPLUpdate( *this );
+  m_bChanged = true;
+  ++m_counts.nChanges;
+  m_dblUnRealizedPending += dblDelta;
+  ++m_nChangesPending;
+  Queue();
+
+  Portfolio* pTop( this );
+  while ( 0 != pTop->m_pOwner ) pTop = pTop->m_pOwner;
+  if ( std::chrono::steady_clock::duration::zero() == pTop->m_durPublish ) {
+    pTop->Publish();
+  }
+  else {
+    std::chrono::steady_clock::time_point tpNow( std::chrono::steady_clock::now() );
+    if ( tpNow >= pTop->m_tpPublish ) {
+      pTop->m_tpPublish = tpNow + pTop->m_durPublish;
+      pTop->Publish();
+    }
+  }
+}
+
+void Portfolio::SetPublishInterval( const boost::posix_time::time_duration& td ) {
+  lock_t lock( LockTree() );
+  m_durPublish = std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::microseconds( td.total_microseconds() ) );
+  m_tpPublish = std::chrono::steady_clock::now();
+}
+
+const Portfolio* Portfolio::Top( void ) const {
+  const Portfolio* pTop( this );
+  while ( 0 != pTop->m_pOwner ) pTop = pTop->m_pOwner;
+  return pTop;
+}
+
+Portfolio::lock_t Portfolio::LockTree( void ) const {
+  while ( true ) {
+    const Portfolio* pTop( Top() );
+    lock_t lock( pTop->m_mutex );
+    if ( Top() == pTop ) return lock;  // not attached elsewhere while waiting
+  }
+}
+
+void Portfolio::Queue( void ) {  // with the owner, and it with its owner, as far as not yet queued
+  Portfolio* pPortfolio( this );
+  while ( ( 0 != pPortfolio->m_pOwner ) && !pPortfolio->m_bQueued ) {
+    pPortfolio->m_bQueued = true;
+    pPortfolio->m_pOwner.load()->m_vQueued.push_back( pPortfolio );
+    pPortfolio = pPortfolio->m_pOwner;
+  }
+}
 
+void Portfolio::Collect( vPortfolio_t& vChanged ) {
+  for ( vPortfolio_t::iterator iter = m_vQueued.begin(); m_vQueued.end() != iter; ++iter ) {
+    Portfolio* pPortfolio( *iter );
+    pPortfolio->Collect( vChanged );
+    if ( 0 < pPortfolio->m_nChangesPending ) {
+      m_plCurrent.dblUnRealized += pPortfolio->m_dblUnRealizedPending;
+      m_dblUnRealizedPending += pPortfolio->m_dblUnRealizedPending;
+      m_counts.nChanges += pPortfolio->m_nChangesPending;
+      m_nChangesPending += pPortfolio->m_nChangesPending;
+      m_bChanged = true;
+    }
+    pPortfolio->m_dblUnRealizedPending = 0.0;
+    pPortfolio->m_nChangesPending = 0;
+    pPortfolio->m_bQueued = false;
+  }
+  m_vQueued.clear();
+  if ( m_bChanged ) {
+    m_plCurrent.Sum();
+    if ( m_plCurrent > m_plMax ) m_plMax.dblUnRealized = m_plCurrent.dblUnRealized;
+    if ( m_plCurrent < m_plMin ) m_plMin.dblUnRealized = m_plCurrent.dblUnRealized;
+    m_bChanged = false;
+    vChanged.push_back( this );
+  }
+}
+
+void Portfolio::Publish( void ) {
+  lock_t lock( LockTree() );
+  vPortfolio_t vChanged;  // collected first, so handlers see settled totals, and may read them
+  Collect( vChanged );
+  if ( 0 == m_pOwner ) {  // nothing above to take the pending
+    m_dblUnRealizedPending = 0.0;
+    m_nChangesPending = 0;
+  }
+  for ( vPortfolio_t::iterator iter = vChanged.begin(); vChanged.end() != iter; ++iter ) {
+    ++( *iter )->m_counts.nUpdates;
+    ( *iter )->OnUnRealizedPLUpdate( **iter );
+  }
+}
+
+double Portfolio::UnRealizedPending( void ) const {
+  double dblPending( 0.0 );
+  for ( vPortfolio_t::const_iterator iter = m_vQueued.begin(); m_vQueued.end() != iter; ++iter ) {
+    dblPending += ( *iter )->m_dblUnRealizedPending + ( *iter )->UnRealizedPending();
+  }
+  return dblPending;
 }
 
 void Portfolio::HandleExecution( const PositionDelta_delegate_t& position ) {
 
+  lock_t lock( LockTree() );
+
   m_row.dblRealizedPL += ( -position.get<1>() + position.get<2>() );
 
   m_plCurrent.dblRealized = m_row.dblRealizedPL;
@@ -255,6 +373,8 @@ void Portfolio::HandleExecution( const PositionDelta_delegate_t& position ) {
 
 void Portfolio::HandleCommission( const PositionDelta_delegate_t& position ) {
 
+  lock_t lock( LockTree() );
+
   m_row.dblCommissionsPaid += ( -position.get<1>() + position.get<2>() );
 
   m_plCurrent.dblCommissionsPaid = m_row.dblCommissionsPaid;
@@ -14,8 +14,14 @@
 
 #include <string>
 #include <map>
+#include <vector>
+#include <atomic>
+#include <chrono>
 
+#include <boost/cstdint.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/date_time/posix_time/posix_time_duration.hpp>
 
 #include <OUCommon/Delegate.h>
 
@@ -39,6 +45,18 @@ namespace tf { // TradeFrame
 //   sub portfolios for subsequent instrument collections under appropriate master portfolio
 // monitor delta at each portfolio/sub-portfolio level.  Each level may have different master hedging positions.
 
+// unrealized pl is coalesced up the tree of portfolios, rather than re-fired at each level on each quote:
+//   a position's change is applied to its portfolio, and left pending for the owner portfolio,
+//   the portfolio is queued with its owner, and the owner with its owner, up to the first already queued
+// Publish collects the pending changes up the queued branches, and fires OnUnRealizedPLUpdate once per changed portfolio
+// the top portfolio publishes on a change once its interval has passed, zero (the default) publishes on every change,
+//   so with an interval, something with a timer calls Publish for the tail of a burst of quotes
+// QueryStats and AddStats include what is pending below, so totals read are exact at any time
+// a tree of portfolios shares the lock of its top portfolio:  positions update it from the provider's thread,
+//   and from dispatch workers (see Watch::SetDispatch), the OnXxxUpdate handlers run with it held,
+//   so they may read the tree, but should not wait on another thread which does
+// attach and detach sub portfolios while nothing is updating them
+
 class Portfolio {
 public:
 
@@ -149,26 +167,51 @@ public:
   void RemoveSubPortfolio( const idPortfolio_t& idPortfolio );
 //  void SetOwnerPortfolio( const idPortfolio_t& idPortfolio, pPortfolio_t& pPortfolio );
 
+  template<typename Function>
+  void ScanPositions( Function f ) const {  // f( pPosition_t ), for each position, by name
+    for ( mapPositions_t::const_iterator iter = m_mapPositionsViaUserName.begin(); m_mapPositionsViaUserName.end() != iter; ++iter ) {
+      f( iter->second );
+    }
+  }
+
+  template<typename Function>
+  void ScanSubPortfolios( Function f ) const {  // f( pPortfolio_t ), for each direct sub portfolio
+    for ( mapPortfolios_t::const_iterator iter = m_mapSubPortfolios.begin(); m_mapSubPortfolios.end() != iter; ++iter ) {
+      f( iter->second );
+    }
+  }
+
   void QueryStats( double& dblUnRealized, double& dblRealized, double& dblCommissionsPaid, double& dblTotal ) const {
-    dblTotal  = ( dblUnRealized = m_plCurrent.dblUnRealized );
+    lock_t lock( LockTree() );
+    dblTotal  = ( dblUnRealized = m_plCurrent.dblUnRealized + UnRealizedPending() );
     dblTotal += ( dblRealized = m_plCurrent.dblRealized );
     dblTotal -= ( dblCommissionsPaid = m_plCurrent.dblCommissionsPaid );
   }
   void AddStats( double& dblUnRealized, double& dblRealized, double& dblCommissionsPaid ) const {
-    dblUnRealized += m_plCurrent.dblUnRealized;
+    lock_t lock( LockTree() );
+    dblUnRealized += m_plCurrent.dblUnRealized + UnRealizedPending();
     dblRealized += m_plCurrent.dblRealized;
     dblCommissionsPaid += m_plCurrent.dblCommissionsPaid;
   }
 
   const TableRowDef& GetRow( void ) const { return m_row; };
 
+  void SetPublishInterval( const boost::posix_time::time_duration& );  // used by the top portfolio
+  void Publish( void );  // this portfolio and those below, fires OnUnRealizedPLUpdate for those changed
+
+  struct UpdateCounts {
+    boost::uint64_t nChanges;  // position unrealized changes reaching this portfolio, each was an update before coalescing
+    boost::uint64_t nUpdates;  // OnUnRealizedPLUpdate fired
+    UpdateCounts( void ): nChanges( 0 ), nUpdates( 0 ) {};
+  };
+  const UpdateCounts& GetUpdateCounts( void ) const { return m_counts; };  // updates saved: nChanges - nUpdates
+
   ou::Delegate<const Portfolio&> OnUnRealizedPLUpdate;
   ou::Delegate<const Portfolio&> OnExecutionUpdate;
   ou::Delegate<const Portfolio&> OnCommissionUpdate;
 
   ou::Delegate<const PositionDelta_delegate_t&> OnExecution;  // < - use by owning portfolio
   ou::Delegate<const PositionDelta_delegate_t&> OnCommission;  // < - use by owning portfolio
-  ou::Delegate<const PositionDelta_delegate_t&> OnUnRealizedPL;/* ( *this, dblPreviousUnRealizedPL, m_row.dblUnRealizedPL ) */  // < - use by portfolio
 
 protected:
   
@@ -203,8 +246,32 @@ private:
   structPL m_plMax;
   structPL m_plMin;
 
+  typedef std::vector<Portfolio*> vPortfolio_t;
+
+  typedef boost::unique_lock<boost::recursive_mutex> lock_t;
+  mutable boost::recursive_mutex m_mutex;  // used while this is the top portfolio
+
+  std::atomic<Portfolio*> m_pOwner;  // set while attached as a sub portfolio
+  bool m_bQueued;  // this, or something below, has changes pending for the owner
+  bool m_bChanged;  // unrealized has changed since the last publish
+  double m_dblUnRealizedPending;  // applied here, not yet to the owner
+  boost::uint64_t m_nChangesPending;
+  vPortfolio_t m_vQueued;  // sub portfolios with changes pending
+
+  UpdateCounts m_counts;
+
+  std::chrono::steady_clock::duration m_durPublish;
+  std::chrono::steady_clock::time_point m_tpPublish;  // next due
+
   void ReCalc( void );  // not used at the moment, may require tuning
 
+  const Portfolio* Top( void ) const;
+  lock_t LockTree( void ) const;  // the top portfolio's lock
+
+  void Queue( void );
+  void Collect( vPortfolio_t& vChanged );
+  double UnRealizedPending( void ) const;  // in the queued sub portfolios
+
   void HandleExecution( const PositionDelta_delegate_t& );
   void HandleCommission( const PositionDelta_delegate_t& );
   void HandleUnRealizedPL( const PositionDelta_delegate_t& );
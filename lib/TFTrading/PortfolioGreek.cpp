@@ -53,7 +53,7 @@ void PortfolioGreek::RemoveSubPortfolio( const idPortfolio_t& idPortfolio ) {
 std::ostream& operator<<( std::ostream& os, const PortfolioGreek& portfolio ) {
 
   os 
-    << (Portfolio) portfolio
+    << static_cast<const Portfolio&>( portfolio )
     ;
   return os;
 }
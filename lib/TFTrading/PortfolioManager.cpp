@@ -13,6 +13,7 @@
 
 #include "stdafx.h"
 
+#include "RiskManager.h"
 #include "PortfolioManager.h"
 
 // todo:  need to store the prepared queries for re-use
@@ -36,6 +37,7 @@ PortfolioManager::pPortfolio_t PortfolioManager::ConstructPortfolio(
   pPortfolio.reset( new Portfolio( idPortfolio, idAccountOwner, idOwner, ePortfolioType, eCurrency, sDescription ) );
   m_mapPortfolios.insert( mapPortfolio_pair_t( idPortfolio, pPortfolio ) );
   if ( 0 != m_pSession ) {
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );  // the query refers to the portfolio's row
     ou::db::QueryFields<Portfolio::TableRowDef>::pQueryFields_t pQuery
       = m_pSession->Insert<Portfolio::TableRowDef>( const_cast<Portfolio::TableRowDef&>( pPortfolio->GetRow() ) );
   }
@@ -87,9 +89,11 @@ void PortfolioManager::HandlePositionOnExecution( const Position& position ) {
     const Position::TableRowDef& row( position.GetRow() );
     PortfolioManagerQueries::UpdatePositionData update( row.idPosition, row.eOrderSidePending, row.nPositionPending,
       row.eOrderSideActive, row.nPositionActive, row.dblConstructedValue, row.dblUnRealizedPL, row.dblRealizedPL );
-    ou::db::QueryFields<PortfolioManagerQueries::UpdatePositionData>::pQueryFields_t pQuery
-      = m_pSession->SQL<PortfolioManagerQueries::UpdatePositionData>( 
-        "update positions set ordersidepending=?, quantitypending=?, ordersideactive=?, quantityactive=?, constructedvalue=?, unrealizedpl=?, realizedpl=?", update ).Where( "positionid=?" );
+    Persist( [update]( ou::db::Session& session ) mutable {
+      ou::db::QueryFields<PortfolioManagerQueries::UpdatePositionData>::pQueryFields_t pQuery
+        = session.SQL<PortfolioManagerQueries::UpdatePositionData>( 
+          "update positions set ordersidepending=?, quantitypending=?, ordersideactive=?, quantityactive=?, constructedvalue=?, unrealizedpl=?, realizedpl=?", update ).Where( "positionid=?" );
+    } );
   }
 }
 
@@ -113,8 +117,10 @@ void PortfolioManager::HandlePositionOnCommission( const Position& position ) {
   if ( 0 != m_pSession ) {
     const Position::TableRowDef& row( position.GetRow() );
     PortfolioManagerQueries::UpdatePositionCommission update( row.idPosition, row.dblCommissionPaid );
-    ou::db::QueryFields<PortfolioManagerQueries::UpdatePositionCommission>::pQueryFields_t pQuery
-      = m_pSession->SQL<PortfolioManagerQueries::UpdatePositionCommission>( "update positions set commission=?", update ).Where( "positionid=?" );
+    Persist( [update]( ou::db::Session& session ) mutable {
+      ou::db::QueryFields<PortfolioManagerQueries::UpdatePositionCommission>::pQueryFields_t pQuery
+        = session.SQL<PortfolioManagerQueries::UpdatePositionCommission>( "update positions set commission=?", update ).Where( "positionid=?" );
+    } );
   }
 }  // the Where could be appended with boost::fusion type structure for the fields, and bind?
   // need to cache the queries
@@ -139,8 +145,10 @@ void PortfolioManager::HandlePortfolioOnExecution( const Portfolio& portfolio )
   if ( 0 != m_pSession ) {
     const Portfolio::TableRowDef& row( portfolio.GetRow() );
     PortfolioManagerQueries::UpdatePortfolioRealizedPL update( row.idPortfolio, row.dblRealizedPL );
-    ou::db::QueryFields<PortfolioManagerQueries::UpdatePortfolioRealizedPL>::pQueryFields_t pQuery
-      = m_pSession->SQL<PortfolioManagerQueries::UpdatePortfolioRealizedPL>( "update portfolios set realizedpl=?", update ).Where( "portfolioid=?" );
+    Persist( [update]( ou::db::Session& session ) mutable {
+      ou::db::QueryFields<PortfolioManagerQueries::UpdatePortfolioRealizedPL>::pQueryFields_t pQuery
+        = session.SQL<PortfolioManagerQueries::UpdatePortfolioRealizedPL>( "update portfolios set realizedpl=?", update ).Where( "portfolioid=?" );
+    } );
   }
 }
 
@@ -164,8 +172,10 @@ void PortfolioManager::HandlePortfolioOnCommission( const Portfolio& portfolio )
   if ( 0 != m_pSession ) {
     const Portfolio::TableRowDef& row( portfolio.GetRow() );
     PortfolioManagerQueries::UpdatePortfolioCommission update( row.idPortfolio, row.dblCommissionsPaid );
-    ou::db::QueryFields<PortfolioManagerQueries::UpdatePortfolioCommission>::pQueryFields_t pQuery
-      = m_pSession->SQL<PortfolioManagerQueries::UpdatePortfolioCommission>( "update portfolios set commission=?", update ).Where( "portfolioid=?" );
+    Persist( [update]( ou::db::Session& session ) mutable {
+      ou::db::QueryFields<PortfolioManagerQueries::UpdatePortfolioCommission>::pQueryFields_t pQuery
+        = session.SQL<PortfolioManagerQueries::UpdatePortfolioCommission>( "update portfolios set commission=?", update ).Where( "portfolioid=?" );
+    } );
   }
 }
 
@@ -192,6 +202,7 @@ PortfolioManager::pPortfolio_t PortfolioManager::GetPortfolio( const idPortfolio
     pPortfolio = iter->second.pPortfolio;
   }
   else {
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     // following portfolio / position code is shared with LoadActivePortfolios and could be factored out
     PortfolioManagerQueries::PortfolioKey key( idPortfolio );
     ou::db::QueryFields<PortfolioManagerQueries::PortfolioKey>::pQueryFields_t pExistsQuery // shouldn't do a * as fields may change order
@@ -232,6 +243,7 @@ bool PortfolioManager::PortfolioExists( const idPortfolio_t& idPortfolio ) {
     bExists = true;
   }
   else {
+    ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
     // following portfolio / position code is shared with LoadActivePortfolios and could be factored out
     PortfolioManagerQueries::PortfolioKey key( idPortfolio );
     ou::db::QueryFields<PortfolioManagerQueries::PortfolioKey>::pQueryFields_t pExistsQuery // shouldn't do a * as fields may change order
@@ -295,6 +307,8 @@ void PortfolioManager::UpdateReportingPortfolio( idPortfolio_t idOwner, idPortfo
 void PortfolioManager::LoadActivePortfolios( void ) {
   // todo:  work with sub-portfolios, and get them attached properly
 
+  ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
+
   PortfolioManagerQueries::ActivePortfolios parameter( true );
   ou::db::QueryFields<PortfolioManagerQueries::ActivePortfolios>::pQueryFields_t pQuery
     = m_pSession->SQL<PortfolioManagerQueries::ActivePortfolios>( "select * from portfolios", parameter ).Where( "active=?" ).NoExecute();
@@ -352,6 +366,8 @@ void PortfolioManager::PortfolioCommon( pPortfolio_t& pPortfolio ) {
 
 void PortfolioManager::LoadPositions( const idPortfolio_t& idPortfolio, mapPosition_t& mapPosition ) {
 
+  ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );
+
   PortfolioManagerQueries::PortfolioKey key( idPortfolio );
 
   ou::db::QueryFields<PortfolioManagerQueries::PortfolioKey>::pQueryFields_t pPositionQuery
@@ -368,6 +384,18 @@ void PortfolioManager::LoadPositions( const idPortfolio_t& idPortfolio, mapPosit
       throw std::runtime_error( "PortfolioManager::LoadPositions has no Details Callback" );
     }
     OnPositionNeedsDetails( pPosition );
+    boost::int64_t nPosition( 0 );  // the risk buckets start from what the position holds
+    switch ( rowPosition.eOrderSideActive ) {
+    case OrderSide::Buy:
+      nPosition = rowPosition.nPositionActive;
+      break;
+    case OrderSide::Sell:
+      nPosition = -static_cast<boost::int64_t>( rowPosition.nPositionActive );
+      break;
+    default:
+      break;
+    }
+    RiskManager::LocalCommonInstance().RegisterPosition( rowPosition.idPosition, idPortfolio, rowPosition.idInstrument, nPosition );
     mapPosition.insert( mapPosition_pair_t( rowPosition.sName, pPosition ) );
 
     this->GetPortfolio( idPortfolio )->AddPosition( pPosition->GetInstrument()->GetInstrumentName(), pPosition );
@@ -463,11 +491,13 @@ void PortfolioManager::ConstructPosition( // re-factored code
     throw std::runtime_error( "ConstructPosition:  database session not available" );
   }
 
+  ou::db::WriteBehind::Exclusive exclusive( m_pWriteBehind );  // the row id is needed now
   ou::db::QueryFields<Position::TableRowDefNoKey>::pQueryFields_t pQuery
     = m_pSession->Insert<Position::TableRowDefNoKey>( 
     const_cast<Position::TableRowDefNoKey&>( dynamic_cast<const Position::TableRowDefNoKey&>( pPosition->GetRow() ) ) );
   idPosition_t idPosition( m_pSession->GetLastRowId() );
   pPosition->Set( idPosition );
+  RiskManager::LocalCommonInstance().RegisterPosition( idPosition, idPortfolio, pPosition->GetRow().idInstrument );
 
   pPosition->OnUpdateCommissionForPortfolioManager.Add( MakeDelegate( this, &PortfolioManager::HandlePositionOnCommission ) );
   pPosition->OnUpdateExecutionForPortfolioManager.Add( MakeDelegate( this, &PortfolioManager::HandlePositionOnExecution ) );
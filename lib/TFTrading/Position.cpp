@@ -168,27 +168,34 @@ void Position::HandleQuote( quote_t quote ) {
 
   OnQuote( quote );
 
-  double dblPreviousUnRealizedPL = m_row.dblUnRealizedPL;
+  double dblPreviousUnRealizedPL;
+  double dblUnRealizedPL;
 
   bool bProcessed(false);
-  double dblMarketValue;
-  switch ( m_row.eOrderSideActive ) {
-    case OrderSide::Buy:
-      dblMarketValue = m_row.nPositionActive * quote.Bid() * m_dblMultiplier;
-      m_row.dblUnRealizedPL = dblMarketValue - m_row.dblConstructedValue;
-      bProcessed = true;
-      break;
-    case OrderSide::Sell:
-      dblMarketValue = - ( m_row.nPositionActive * quote.Ask() ) * m_dblMultiplier;
-      m_row.dblUnRealizedPL = dblMarketValue - m_row.dblConstructedValue;
-      bProcessed = true;
-      break;
+  {
+    boost::mutex::scoped_lock lock( m_mutexRow );
+    dblPreviousUnRealizedPL = m_row.dblUnRealizedPL;
+    double dblMarketValue;
+    switch ( m_row.eOrderSideActive ) {
+      case OrderSide::Buy:
+        dblMarketValue = m_row.nPositionActive * quote.Bid() * m_dblMultiplier;
+        m_row.dblUnRealizedPL = dblMarketValue - m_row.dblConstructedValue;
+        bProcessed = true;
+        break;
+      case OrderSide::Sell:
+        dblMarketValue = - ( m_row.nPositionActive * quote.Ask() ) * m_dblMultiplier;
+        m_row.dblUnRealizedPL = dblMarketValue - m_row.dblConstructedValue;
+        bProcessed = true;
+        break;
+    }
+    dblUnRealizedPL = m_row.dblUnRealizedPL;
   }
 
+  // the pair fired is the one this quote made, so deltas sum correctly against interleaved executions
   if ( bProcessed ) {
     OnQuotePostProcess( quote_pair_t( *this, quote ) );
-    if ( dblPreviousUnRealizedPL != m_row.dblUnRealizedPL ) {
-      OnUnRealizedPL( PositionDelta_delegate_t( *this, dblPreviousUnRealizedPL, m_row.dblUnRealizedPL ) );
+    if ( dblPreviousUnRealizedPL != dblUnRealizedPL ) {
+      OnUnRealizedPL( PositionDelta_delegate_t( *this, dblPreviousUnRealizedPL, dblUnRealizedPL ) );
     }
   }
 
@@ -287,11 +294,13 @@ void Position::PlaceOrder( pOrder_t pOrder ) {
 //    }
 //  }
 
-  if ( 0 == m_row.nPositionPending ) m_row.eOrderSidePending = pOrder->GetOrderSide();  // first to set non-zero gives us our predominant side
-
-  m_row.nPositionPending += pOrder->GetQuantity();
-  m_vAllOrders.push_back( pOrder );
-  m_vOpenOrders.push_back( pOrder );
+  {
+    boost::mutex::scoped_lock lock( m_mutexRow );
+    if ( 0 == m_row.nPositionPending ) m_row.eOrderSidePending = pOrder->GetOrderSide();  // first to set non-zero gives us our predominant side
+    m_row.nPositionPending += pOrder->GetQuantity();
+    m_vAllOrders.push_back( pOrder );
+    m_vOpenOrders.push_back( pOrder );
+  }
   pOrder->OnExecution.Add( MakeDelegate( this, &Position::HandleExecution ) ); 
   pOrder->OnCommission.Add( MakeDelegate( this, &Position::HandleCommission ) );
   pOrder->OnOrderCancelled.Add( MakeDelegate( this, &Position::HandleCancellation ) );
@@ -321,18 +330,21 @@ void Position::CancelOrder( idOrder_t idOrder ) {
 
 void Position::HandleCancellation( const Order& order ) {
   Order::idOrder_t idOrder = order.GetOrderId();
-  for ( vOrders_t::iterator iter = m_vOpenOrders.begin(); iter != m_vOpenOrders.end(); ++iter ) {
-    if ( idOrder == iter->get()->GetOrderId() ) {
-      if ( m_row.nPositionPending >= iter->get()->GetQuanRemaining() ) {
-        m_row.nPositionPending -= iter->get()->GetQuanRemaining(); 
-        if ( 0 == m_row.nPositionPending ) m_row.eOrderSidePending = OrderSide::Unknown;
-        //CancelOrder( iter );
-        m_vClosedOrders.push_back( *iter );
-        m_vOpenOrders.erase( iter );
-        break;
-      }
-      else {
-        throw std::runtime_error( "problems" );
+  {
+    boost::mutex::scoped_lock lock( m_mutexRow );
+    for ( vOrders_t::iterator iter = m_vOpenOrders.begin(); iter != m_vOpenOrders.end(); ++iter ) {
+      if ( idOrder == iter->get()->GetOrderId() ) {
+        if ( m_row.nPositionPending >= iter->get()->GetQuanRemaining() ) {
+          m_row.nPositionPending -= iter->get()->GetQuanRemaining(); 
+          if ( 0 == m_row.nPositionPending ) m_row.eOrderSidePending = OrderSide::Unknown;
+          //CancelOrder( iter );
+          m_vClosedOrders.push_back( *iter );
+          m_vOpenOrders.erase( iter );
+          break;
+        }
+        else {
+          throw std::runtime_error( "problems" );
+        }
       }
     }
   }
@@ -456,35 +468,46 @@ void Position::HandleExecution( const std::pair<const Order&, const Execution&>&
   const Execution& exec = status.second;
   Order::idOrder_t orderId = order.GetOrderId();
 
-  double dblOldRealizedPL = m_row.dblRealizedPL;
-  double dblOldUnRealizedPL = m_row.dblUnRealizedPL;
+  double dblOldRealizedPL, dblRealizedPL;
+  double dblOldUnRealizedPL, dblUnRealizedPL;
 
   //std::cout << "Position Exec: " << exec.GetSize() << "," << exec.GetPrice() << std::endl;
 
-  // update position, regardless of whether we see order open or closed
-  UpdateRowValues( exec.GetPrice(), exec.GetSize(), exec.GetOrderSide() );
-
-  if ( ( 0 == m_row.nPositionActive ) && ( OrderSide::Unknown != m_row.eOrderSideActive ) ) {
-    std::cout << "problems" << std::endl;
-  }
-  
-  // check that we think that the order is still active
   bool bOrderFound = false;
-  for ( std::vector<pOrder_t>::iterator iter = m_vOpenOrders.begin(); iter != m_vOpenOrders.end(); ++iter ) {
-    if ( orderId == iter->get()->GetOrderId() ) {
-      // update position based upon current position and what is executing
-      //   decrease position when execution is opposite position
-      //   increase position when execution is same as position
-      m_row.nPositionPending -= exec.GetSize();
-      if ( 0 == m_row.nPositionPending ) m_row.eOrderSidePending = OrderSide::Unknown;
-
-      if ( 0 == order.GetQuanRemaining() ) {  // move from open to closed on order filled
-        m_vClosedOrders.push_back( *iter );
-        m_vOpenOrders.erase( iter );
+  {
+    // quotes may be arriving on a dispatch worker, see Watch::SetDispatch
+    boost::mutex::scoped_lock lock( m_mutexRow );
+
+    dblOldRealizedPL = m_row.dblRealizedPL;
+    dblOldUnRealizedPL = m_row.dblUnRealizedPL;
+
+    // update position, regardless of whether we see order open or closed
+    UpdateRowValues( exec.GetPrice(), exec.GetSize(), exec.GetOrderSide() );
+
+    dblRealizedPL = m_row.dblRealizedPL;
+    dblUnRealizedPL = m_row.dblUnRealizedPL;
+
+    if ( ( 0 == m_row.nPositionActive ) && ( OrderSide::Unknown != m_row.eOrderSideActive ) ) {
+      std::cout << "problems" << std::endl;
+    }
+
+    // check that we think that the order is still active
+    for ( std::vector<pOrder_t>::iterator iter = m_vOpenOrders.begin(); iter != m_vOpenOrders.end(); ++iter ) {
+      if ( orderId == iter->get()->GetOrderId() ) {
+        // update position based upon current position and what is executing
+        //   decrease position when execution is opposite position
+        //   increase position when execution is same as position
+        m_row.nPositionPending -= exec.GetSize();
+        if ( 0 == m_row.nPositionPending ) m_row.eOrderSidePending = OrderSide::Unknown;
+
+        if ( 0 == order.GetQuanRemaining() ) {  // move from open to closed on order filled
+          m_vClosedOrders.push_back( *iter );
+          m_vOpenOrders.erase( iter );
+        }
+
+        bOrderFound = true;
+        break;
       }
-      
-      bOrderFound = true;
-      break;
     }
   }
   if ( !bOrderFound ) {
@@ -492,12 +515,12 @@ void Position::HandleExecution( const std::pair<const Order&, const Execution&>&
     throw std::runtime_error( "Position::HandleExecution doesn't have an Open Order" );
   }
 
-  OnUnRealizedPL( PositionDelta_delegate_t( *this, dblOldUnRealizedPL, m_row.dblUnRealizedPL ) );  // used by portfolio updates
+  OnUnRealizedPL( PositionDelta_delegate_t( *this, dblOldUnRealizedPL, dblUnRealizedPL ) );  // used by portfolio updates
 
   OnExecutionRaw( execution_pair_t( *this, exec ) );
   OnUpdateExecutionForPortfolioManager( *this );
 
-  OnExecution( PositionDelta_delegate_t( *this, dblOldRealizedPL, m_row.dblRealizedPL ) );  // used by portfolio updates
+  OnExecution( PositionDelta_delegate_t( *this, dblOldRealizedPL, dblRealizedPL ) );  // used by portfolio updates
 
   OnPositionChanged( *this );
   
@@ -510,7 +533,10 @@ void Position::HandleCommission( const Order& order ) {
   //std::cout << "," << dblNewCommissionPaid << std::endl;
 
   if ( 0 != dblNewCommissionPaid ) {
-    m_row.dblCommissionPaid += dblNewCommissionPaid;
+    {
+      boost::mutex::scoped_lock lock( m_mutexRow );
+      m_row.dblCommissionPaid += dblNewCommissionPaid;
+    }
     OnUpdateCommissionForPortfolioManager( *this );
     OnCommission( PositionDelta_delegate_t( *this, 0, dblNewCommissionPaid ) );
   }
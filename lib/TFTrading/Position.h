@@ -17,6 +17,7 @@
 #include <sstream>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/tuple/tuple.hpp>
 
 #include <boost/serialization/version.hpp>
@@ -293,6 +294,8 @@ private:
   bool m_bWatchConstructedLocally;
 
   double m_dblMultiplier;
+
+  boost::mutex m_mutexRow;  // the pl and position fields, quotes may arrive on a dispatch worker while executions arrive on the provider's thread
   
   void ConstructWatch( pInstrument_cref, pProvider_t pDataProvider );
   void Construction( void );
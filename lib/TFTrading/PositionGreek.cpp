@@ -86,7 +86,7 @@ void PositionGreek::PositionPendingDelta( int n ) {
 std::ostream& operator<<( std::ostream& os, const PositionGreek& position ) {
   const ou::tf::Greek& greek( position.m_pOption->LastGreek() );
   os 
-    << (Position) position
+    << static_cast<const Position&>( position )
     << ", ImpVol " << greek.ImpliedVolatility() 
     << ", Delta " << greek.Delta()
     << ", Gamma " << greek.Gamma()
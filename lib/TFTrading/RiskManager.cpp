@@ -15,16 +15,271 @@
 
 #include "stdafx.h"
 
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
 #include "RiskManager.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
-RiskManager::RiskManager(void): ou::db::ManagerBase<RiskManager>() {
+RiskManager::Bucket::Bucket( void )
+: nMaxPosition( 0 ), dblMaxNotional( 0.0 ), nMaxOrdersPerSecond( 0 ), dblMaxPriceDeviation( 0.0 ),
+  dblReferencePrice( 0.0 ), nPosition( 0 ), nBuyOpen( 0 ), nSellOpen( 0 ), dblNotional( 0.0 ),
+  nWindow( 0 ), nInWindow( 0 )
+{
+}
+
+void RiskManager::Bucket::Set( const Limits& limits ) {
+  nMaxPosition.store( limits.nMaxPosition, std::memory_order_relaxed );
+  dblMaxNotional.store( limits.dblMaxNotional, std::memory_order_relaxed );
+  nMaxOrdersPerSecond.store( limits.nMaxOrdersPerSecond, std::memory_order_relaxed );
+  dblMaxPriceDeviation.store( limits.dblMaxPriceDeviation, std::memory_order_relaxed );
+}
+
+void RiskManager::Bucket::Get( State& state ) const {
+  state.nPosition = nPosition.load( std::memory_order_relaxed );
+  state.nBuyOpen = nBuyOpen.load( std::memory_order_relaxed );
+  state.nSellOpen = nSellOpen.load( std::memory_order_relaxed );
+  state.dblNotional = dblNotional.load( std::memory_order_relaxed );
+}
+
+RiskManager::RiskManager(void): ou::db::ManagerBase<RiskManager>(),
+  m_indexInstrument( 1024 ), m_indexPortfolio( 64 ), m_indexPosition( 1024 ),
+  m_bKillSwitch( false ), m_nChecked( 0 ), m_nAccepted( 0 )
+{
+  for ( unsigned ix = 0; ix < _ERejectCount; ++ix ) m_rnRejected[ ix ].store( 0 );
 }
 
 RiskManager::~RiskManager(void) {
 }
 
+const char* RiskManager::Name( EReject eReject ) {
+  switch ( eReject ) {
+  case ERejectNone: return "none";
+  case ERejectKillSwitch: return "kill switch";
+  case ERejectPosition: return "position limit";
+  case ERejectNotional: return "notional limit";
+  case ERejectOrderRate: return "order rate limit";
+  case ERejectPrice: return "price limit";
+  default: return "unknown";
+  }
+}
+
+RiskManager::Bucket* RiskManager::LocateInstrument( const idInstrument_t& idInstrument ) {
+  Bucket* pBucket( m_indexInstrument.Find( idInstrument ) );
+  if ( 0 == pBucket ) {
+    boost::mutex::scoped_lock lock( m_mutexConfigure );
+    pBucket = m_indexInstrument.Insert( idInstrument );  // may have been added while waiting on the lock
+  }
+  return pBucket;
+}
+
+RiskManager::Bucket* RiskManager::FindPortfolio( idPosition_t idPosition ) const {
+  const std::atomic<Bucket*>* ppBucket( m_indexPosition.Find( idPosition ) );
+  return 0 == ppBucket ? 0 : ppBucket->load( std::memory_order_acquire );
+}
+
+void RiskManager::SetInstrumentLimits( const idInstrument_t& idInstrument, const Limits& limits ) {
+  LocateInstrument( idInstrument )->Set( limits );
+}
+
+void RiskManager::SetPortfolioLimits( const idPortfolio_t& idPortfolio, const Limits& limits ) {
+  boost::mutex::scoped_lock lock( m_mutexConfigure );
+  m_indexPortfolio.Insert( idPortfolio )->Set( limits );
+}
+
+void RiskManager::SetReferencePrice( const idInstrument_t& idInstrument, double dblPrice ) {
+  LocateInstrument( idInstrument )->dblReferencePrice.store( dblPrice, std::memory_order_relaxed );
+}
+
+void RiskManager::RegisterPosition(
+  idPosition_t idPosition, const idPortfolio_t& idPortfolio, const idInstrument_t& idInstrument, boost::int64_t nPosition
+) {
+  boost::mutex::scoped_lock lock( m_mutexConfigure );
+  Bucket* pPortfolio( m_indexPortfolio.Insert( idPortfolio ) );
+  Bucket* pInstrument( m_indexInstrument.Insert( idInstrument ) );
+  m_indexPosition.Insert( idPosition )->store( pPortfolio, std::memory_order_release );
+  if ( 0 != nPosition ) {
+    pPortfolio->nPosition.fetch_add( nPosition, std::memory_order_relaxed );
+    pInstrument->nPosition.fetch_add( nPosition, std::memory_order_relaxed );
+  }
+}
+
+bool RiskManager::GetInstrumentState( const idInstrument_t& idInstrument, State& state ) const {
+  Bucket* pBucket( m_indexInstrument.Find( idInstrument ) );
+  if ( 0 == pBucket ) return false;
+  pBucket->Get( state );
+  return true;
+}
+
+bool RiskManager::GetPortfolioState( const idPortfolio_t& idPortfolio, State& state ) const {
+  Bucket* pBucket( m_indexPortfolio.Find( idPortfolio ) );
+  if ( 0 == pBucket ) return false;
+  pBucket->Get( state );
+  return true;
+}
+
+RiskManager::Counters RiskManager::GetCounters( void ) const {
+  Counters counters;
+  counters.nChecked = m_nChecked.load( std::memory_order_relaxed );
+  counters.nAccepted = m_nAccepted.load( std::memory_order_relaxed );
+  for ( unsigned ix = 0; ix < _ERejectCount; ++ix ) counters.nRejected[ ix ] = m_rnRejected[ ix ].load( std::memory_order_relaxed );
+  return counters;
+}
+
+double RiskManager::AddNotional( std::atomic<double>& dblTotal, double dblAmount ) {
+  double dblCurrent( dblTotal.load( std::memory_order_relaxed ) );
+  while ( !dblTotal.compare_exchange_weak( dblCurrent, dblCurrent + dblAmount, std::memory_order_relaxed ) ) {}  // reloads dblCurrent on failure
+  return dblCurrent + dblAmount;
+}
+
+// each limit is taken before it is tested, and given back on failure, so concurrent orders can not
+//   both squeeze under a limit, at worst both are refused
+RiskManager::EReject RiskManager::Reserve( Bucket& bucket, OrderSide::enumOrderSide eOrderSide, boost::uint32_t nQuantity, double dblNotional ) {
+
+  const boost::uint32_t nMaxOrdersPerSecond( bucket.nMaxOrdersPerSecond.load( std::memory_order_relaxed ) );
+  if ( 0 != nMaxOrdersPerSecond ) {
+    const boost::int64_t nSecond(
+      std::chrono::duration_cast<std::chrono::seconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+    boost::int64_t nWindow( bucket.nWindow.load( std::memory_order_relaxed ) );
+    if ( ( nWindow != nSecond ) && bucket.nWindow.compare_exchange_strong( nWindow, nSecond, std::memory_order_relaxed ) ) {
+      bucket.nInWindow.store( 0, std::memory_order_relaxed );  // an order racing the roll over may be missed, the window is approximate
+    }
+    if ( nMaxOrdersPerSecond < bucket.nInWindow.fetch_add( 1, std::memory_order_relaxed ) + 1 ) {
+      bucket.nInWindow.fetch_sub( 1, std::memory_order_relaxed );
+      return ERejectOrderRate;
+    }
+  }
+
+  const boost::int64_t nMaxPosition( bucket.nMaxPosition.load( std::memory_order_relaxed ) );
+  bool bOk( true );
+  if ( OrderSide::Buy == eOrderSide ) {
+    const boost::int64_t nOpen( bucket.nBuyOpen.fetch_add( nQuantity, std::memory_order_relaxed ) + nQuantity );
+    bOk = ( 0 == nMaxPosition ) || ( nMaxPosition >= bucket.nPosition.load( std::memory_order_relaxed ) + nOpen );
+  }
+  else {
+    const boost::int64_t nOpen( bucket.nSellOpen.fetch_add( nQuantity, std::memory_order_relaxed ) + nQuantity );
+    bOk = ( 0 == nMaxPosition ) || ( nMaxPosition >= nOpen - bucket.nPosition.load( std::memory_order_relaxed ) );
+  }
+  if ( !bOk ) {
+    Unreserve( bucket, eOrderSide, nQuantity, 0.0, 0 != nMaxOrdersPerSecond );
+    return ERejectPosition;
+  }
+
+  const double dblMaxNotional( bucket.dblMaxNotional.load( std::memory_order_relaxed ) );
+  if ( 0.0 != dblNotional ) {
+    if ( ( dblMaxNotional < AddNotional( bucket.dblNotional, dblNotional ) ) && ( 0.0 != dblMaxNotional ) ) {
+      Unreserve( bucket, eOrderSide, nQuantity, dblNotional, 0 != nMaxOrdersPerSecond );
+      return ERejectNotional;
+    }
+  }
+
+  return ERejectNone;
+}
+
+void RiskManager::Unreserve( Bucket& bucket, OrderSide::enumOrderSide eOrderSide, boost::uint32_t nQuantity, double dblNotional, bool bRate ) {
+  if ( OrderSide::Buy == eOrderSide ) {
+    bucket.nBuyOpen.fetch_sub( nQuantity, std::memory_order_relaxed );
+  }
+  else {
+    bucket.nSellOpen.fetch_sub( nQuantity, std::memory_order_relaxed );
+  }
+  if ( 0.0 != dblNotional ) AddNotional( bucket.dblNotional, -dblNotional );
+  if ( bRate ) bucket.nInWindow.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+RiskManager::EReject RiskManager::Check( const Order& order, Exposure& exposure ) {
+
+  m_nChecked.fetch_add( 1, std::memory_order_relaxed );
+
+  EReject eReject( ERejectNone );
+
+  if ( m_bKillSwitch.load( std::memory_order_acquire ) ) {
+    eReject = ERejectKillSwitch;
+  }
+  else {
+
+    const Order::TableRowDef& row( order.GetRow() );
+
+    Bucket* pInstrument( LocateInstrument( row.idInstrument ) );
+    Bucket* pPortfolio( FindPortfolio( row.idPosition ) );
+
+    const double dblReferencePrice( pInstrument->dblReferencePrice.load( std::memory_order_relaxed ) );
+    const double dblMaxPriceDeviation( pInstrument->dblMaxPriceDeviation.load( std::memory_order_relaxed ) );
+    const bool bPriced( ( OrderType::Market != row.eOrderType ) && ( 0.0 < row.dblPrice1 ) );
+    if ( bPriced && ( 0.0 != dblMaxPriceDeviation ) && ( 0.0 < dblReferencePrice ) ) {
+      if ( dblMaxPriceDeviation * dblReferencePrice < std::abs( row.dblPrice1 - dblReferencePrice ) ) {
+        eReject = ERejectPrice;
+      }
+    }
+
+    if ( ERejectNone == eReject ) {
+      const double dblNotionalPerUnit(
+        ( bPriced ? row.dblPrice1 : dblReferencePrice ) * order.GetInstrument()->GetMultiplier() );
+      const double dblNotional( dblNotionalPerUnit * row.nOrderQuantity );
+      eReject = Reserve( *pInstrument, row.eOrderSide, row.nOrderQuantity, dblNotional );
+      if ( ( ERejectNone == eReject ) && ( 0 != pPortfolio ) ) {
+        eReject = Reserve( *pPortfolio, row.eOrderSide, row.nOrderQuantity, dblNotional );
+        if ( ERejectNone != eReject ) {
+          Unreserve( *pInstrument, row.eOrderSide, row.nOrderQuantity, dblNotional,
+            0 != pInstrument->nMaxOrdersPerSecond.load( std::memory_order_relaxed ) );
+        }
+      }
+      if ( ERejectNone == eReject ) {
+        exposure.pInstrument = pInstrument;
+        exposure.pPortfolio = pPortfolio;
+        exposure.eOrderSide = row.eOrderSide;
+        exposure.nOpen = row.nOrderQuantity;
+        exposure.dblNotionalPerUnit = dblNotionalPerUnit;
+      }
+    }
+  }
+
+  if ( ERejectNone == eReject ) {
+    m_nAccepted.fetch_add( 1, std::memory_order_relaxed );
+  }
+  else {
+    m_rnRejected[ ERejectNone ].fetch_add( 1, std::memory_order_relaxed );
+    m_rnRejected[ eReject ].fetch_add( 1, std::memory_order_relaxed );
+  }
+
+  return eReject;
+}
+
+void RiskManager::Attach( const Order& order, Exposure& exposure ) {
+  const Order::TableRowDef& row( order.GetRow() );
+  exposure = Exposure();
+  exposure.pInstrument = LocateInstrument( row.idInstrument );
+  exposure.pPortfolio = FindPortfolio( row.idPosition );
+  exposure.eOrderSide = row.eOrderSide;
+}
+
+void RiskManager::Fill( Exposure& exposure, boost::uint32_t nQuantity ) {
+  if ( 0 == exposure.pInstrument ) return;  // neither checked nor attached, the order was never placed
+  const boost::uint32_t nReleased( std::min( nQuantity, exposure.nOpen ) );  // over fills move the position only
+  const boost::int64_t nSigned( OrderSide::Buy == exposure.eOrderSide ? nQuantity : -static_cast<boost::int64_t>( nQuantity ) );
+  const double dblNotional( exposure.dblNotionalPerUnit * nReleased );
+  Bucket* rpBucket[] = { exposure.pInstrument, exposure.pPortfolio };
+  for ( unsigned ix = 0; ix < 2; ++ix ) {
+    if ( 0 != rpBucket[ ix ] ) {
+      rpBucket[ ix ]->nPosition.fetch_add( nSigned, std::memory_order_relaxed );
+      Unreserve( *rpBucket[ ix ], exposure.eOrderSide, nReleased, dblNotional, false );
+    }
+  }
+  exposure.nOpen -= nReleased;
+}
+
+void RiskManager::Release( Exposure& exposure ) {
+  if ( ( 0 == exposure.pInstrument ) || ( 0 == exposure.nOpen ) ) return;
+  const double dblNotional( exposure.dblNotionalPerUnit * exposure.nOpen );
+  Unreserve( *exposure.pInstrument, exposure.eOrderSide, exposure.nOpen, dblNotional, false );
+  if ( 0 != exposure.pPortfolio ) {
+    Unreserve( *exposure.pPortfolio, exposure.eOrderSide, exposure.nOpen, dblNotional, false );
+  }
+  exposure.nOpen = 0;
+}
+
 } // namespace tf
 } // namespace ou
@@ -13,19 +13,204 @@
 
 // Started 20130407
 
+// pre-trade checks, run by OrderManager::PlaceOrder before an order goes to its provider
+// limits are kept per instrument and per portfolio, a zero limit is not enforced:
+//   position:  filled position plus working orders on the side of the new order, in units
+//   notional:  working orders, price x quantity x multiplier, market orders are valued at the reference price
+//   order rate:  orders accepted per second, a fixed one second window
+//   price:  fraction the order's price may stray from the reference price, instruments only
+// an accepted order reserves its quantity and notional, released as it fills, or when it closes unfilled
+// a bucket of limits and counters is kept for each instrument and portfolio, created when first named,
+//   normally as limits are set and positions are registered, so not on an order's path
+// buckets are found through insert only hash tables, read without locks, only the first order of an
+//   instrument which was never named takes the configuration lock to add its bucket
+// the filled position of a bucket starts from the positions registered with it, and moves with fills
+// limits may be changed at any time, the kill switch rejects everything until released
+
 #pragma once
 
+#include <atomic>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include <OUCommon/ManagerBase.h>
 
+#include "KeyTypes.h"
+#include "TradingEnumerations.h"
+#include "Order.h"
+
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 class RiskManager: public ou::db::ManagerBase<RiskManager> {
+  struct Bucket;
 public:
+
+  typedef keytypes::idInstrument_t idInstrument_t;
+  typedef keytypes::idPortfolio_t idPortfolio_t;
+  typedef keytypes::idPosition_t idPosition_t;
+
+  enum EReject { ERejectNone = 0, ERejectKillSwitch, ERejectPosition, ERejectNotional, ERejectOrderRate, ERejectPrice, _ERejectCount };
+
+  struct Limits {  // zero for no limit
+    boost::int64_t nMaxPosition;
+    double dblMaxNotional;
+    boost::uint32_t nMaxOrdersPerSecond;
+    double dblMaxPriceDeviation;  // 0.05 for five percent
+    Limits( void ): nMaxPosition( 0 ), dblMaxNotional( 0.0 ), nMaxOrdersPerSecond( 0 ), dblMaxPriceDeviation( 0.0 ) {};
+  };
+
+  struct Exposure {  // what an accepted order holds in reserve, kept with the order by OrderManager
+    Bucket* pInstrument;
+    Bucket* pPortfolio;
+    OrderSide::enumOrderSide eOrderSide;
+    boost::uint32_t nOpen;
+    double dblNotionalPerUnit;
+    Exposure( void ): pInstrument( 0 ), pPortfolio( 0 ), eOrderSide( OrderSide::Unknown ), nOpen( 0 ), dblNotionalPerUnit( 0.0 ) {};
+  };
+
+  struct State {
+    boost::int64_t nPosition;  // filled, long is positive
+    boost::int64_t nBuyOpen;
+    boost::int64_t nSellOpen;
+    double dblNotional;  // working orders
+    State( void ): nPosition( 0 ), nBuyOpen( 0 ), nSellOpen( 0 ), dblNotional( 0.0 ) {};
+  };
+
+  struct Counters {
+    boost::uint64_t nChecked;
+    boost::uint64_t nAccepted;
+    boost::uint64_t nRejected[ _ERejectCount ];  // by reason, ERejectNone is the total
+    Counters( void ): nChecked( 0 ), nAccepted( 0 ) { for ( unsigned ix = 0; ix < _ERejectCount; ++ix ) nRejected[ ix ] = 0; };
+  };
+
   RiskManager(void);
   ~RiskManager(void);
+
+  void SetInstrumentLimits( const idInstrument_t&, const Limits& );
+  void SetPortfolioLimits( const idPortfolio_t&, const Limits& );  // the price deviation is not used
+  void SetReferencePrice( const idInstrument_t&, double dblPrice );  // typically the last trade or mid quote
+  // orders of the position count against its portfolio, nPosition is its filled quantity when loaded, long positive
+  void RegisterPosition( idPosition_t, const idPortfolio_t&, const idInstrument_t&, boost::int64_t nPosition = 0 );
+
+  void SetKillSwitch( bool bKill ) { m_bKillSwitch.store( bKill, std::memory_order_release ); };
+  bool GetKillSwitch( void ) const { return m_bKillSwitch.load( std::memory_order_acquire ); };
+
+  EReject Check( const Order&, Exposure& );  // reserves the order's exposure when accepted
+  void Attach( const Order&, Exposure& );  // an order loaded rather than checked, its fills move the positions, nothing is reserved
+  void Fill( Exposure&, boost::uint32_t nQuantity );
+  void Release( Exposure& );  // the order closed, whatever didn't fill is freed
+
+  bool GetInstrumentState( const idInstrument_t&, State& ) const;  // false if never named
+  bool GetPortfolioState( const idPortfolio_t&, State& ) const;
+  Counters GetCounters( void ) const;
+
+  static const char* Name( EReject );
+
 protected:
 private:
+
+  struct Bucket {
+    std::atomic<boost::int64_t> nMaxPosition;
+    std::atomic<double> dblMaxNotional;
+    std::atomic<boost::uint32_t> nMaxOrdersPerSecond;
+    std::atomic<double> dblMaxPriceDeviation;
+    std::atomic<double> dblReferencePrice;
+    std::atomic<boost::int64_t> nPosition;
+    std::atomic<boost::int64_t> nBuyOpen;
+    std::atomic<boost::int64_t> nSellOpen;
+    std::atomic<double> dblNotional;
+    std::atomic<boost::int64_t> nWindow;  // second of the rate window
+    std::atomic<boost::int64_t> nInWindow;
+    Bucket( void );
+    void Set( const Limits& );
+    void Get( State& ) const;
+  };
+
+  // open addressed, linear probing, at most half full, entries are never moved nor removed
+  // grows by doubling, outgrown slot arrays are kept, as readers may still be probing them,
+  //   together they are smaller than the current array, so memory stays proportional to the entries
+  template<typename K, typename V>
+  class Index {
+  public:
+    explicit Index( size_t nSlots ) // a power of two
+    : m_pSlots( new Slots( nSlots ) ) {}
+    ~Index( void ) {
+      for ( typename std::vector<Entry*>::iterator iter = m_vEntry.begin(); m_vEntry.end() != iter; ++iter ) delete *iter;
+      for ( typename std::vector<Slots*>::iterator iter = m_vSlotsRetired.begin(); m_vSlotsRetired.end() != iter; ++iter ) delete *iter;
+      delete m_pSlots.load();
+    }
+    V* Find( const K& key ) const {  // null if absent
+      const Slots* pSlots( m_pSlots.load( std::memory_order_acquire ) );
+      for ( size_t ix = std::hash<K>()( key ) & pSlots->nMask; true; ix = ( ix + 1 ) & pSlots->nMask ) {
+        Entry* pEntry( pSlots->rpEntry[ ix ].load( std::memory_order_acquire ) );
+        if ( 0 == pEntry ) return 0;
+        if ( key == pEntry->key ) return &pEntry->value;
+      }
+    }
+    V* Insert( const K& key ) {  // with the writers serialized, returns the existing value if present
+      V* pValue( Find( key ) );
+      if ( 0 != pValue ) return pValue;
+      Slots* pSlots( m_pSlots.load( std::memory_order_relaxed ) );
+      if ( pSlots->nMask + 1 < 2 * ( m_vEntry.size() + 1 ) ) {
+        Slots* pGrown( new Slots( 2 * ( pSlots->nMask + 1 ) ) );
+        for ( typename std::vector<Entry*>::iterator iter = m_vEntry.begin(); m_vEntry.end() != iter; ++iter ) pGrown->Place( *iter );
+        m_pSlots.store( pGrown, std::memory_order_release );
+        m_vSlotsRetired.push_back( pSlots );
+        pSlots = pGrown;
+      }
+      Entry* pEntry( new Entry( key ) );
+      m_vEntry.push_back( pEntry );
+      pSlots->Place( pEntry );
+      return &pEntry->value;
+    }
+  private:
+    struct Entry {
+      const K key;
+      V value;
+      explicit Entry( const K& key_ ): key( key_ ), value() {}
+    };
+    struct Slots {
+      const size_t nMask;
+      std::atomic<Entry*>* rpEntry;
+      explicit Slots( size_t nSlots ): nMask( nSlots - 1 ), rpEntry( new std::atomic<Entry*>[ nSlots ] ) {
+        for ( size_t ix = 0; ix < nSlots; ++ix ) rpEntry[ ix ].store( 0, std::memory_order_relaxed );
+      }
+      ~Slots( void ) { delete[] rpEntry; }
+      void Place( Entry* pEntry ) {  // published to readers by the release
+        size_t ix( std::hash<K>()( pEntry->key ) & nMask );
+        while ( 0 != rpEntry[ ix ].load( std::memory_order_relaxed ) ) ix = ( ix + 1 ) & nMask;
+        rpEntry[ ix ].store( pEntry, std::memory_order_release );
+      }
+    };
+    std::atomic<Slots*> m_pSlots;
+    std::vector<Slots*> m_vSlotsRetired;
+    std::vector<Entry*> m_vEntry;
+  };
+
+  Index<std::string, Bucket> m_indexInstrument;
+  Index<std::string, Bucket> m_indexPortfolio;
+  Index<idPosition_t, std::atomic<Bucket*> > m_indexPosition;  // to the bucket of the position's portfolio
+
+  boost::mutex m_mutexConfigure;  // serializes the writers of the indexes
+
+  std::atomic<bool> m_bKillSwitch;
+
+  std::atomic<boost::uint64_t> m_nChecked;
+  std::atomic<boost::uint64_t> m_nAccepted;
+  std::atomic<boost::uint64_t> m_rnRejected[ _ERejectCount ];
+
+  Bucket* LocateInstrument( const idInstrument_t& );  // find, or add
+  Bucket* FindPortfolio( idPosition_t ) const;  // of the position, null if not registered
+
+  static EReject Reserve( Bucket&, OrderSide::enumOrderSide, boost::uint32_t nQuantity, double dblNotional );
+  static void Unreserve( Bucket&, OrderSide::enumOrderSide, boost::uint32_t nQuantity, double dblNotional, bool bRate );
+  static double AddNotional( std::atomic<double>&, double );  // returns the new total
+
 };
 
 } // namespace tf
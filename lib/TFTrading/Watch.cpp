@@ -23,6 +23,7 @@
 
 #include <TFIQFeed/IQFeedProvider.h>
 
+#include "WatchDispatch.h"
 #include "Watch.h"
 
 namespace ou { // One Unified
@@ -31,7 +32,8 @@ namespace tf { // TradeFrame
 Watch::Watch( pInstrument_t pInstrument, pProvider_t pDataProvider ) :
   m_pInstrument( pInstrument ), 
   m_pDataProvider( pDataProvider ), 
-  m_cntWatching( 0 ), m_bWatching( false ), m_bWatchingEnabled( false )
+  m_cntWatching( 0 ), m_bWatching( false ), m_bWatchingEnabled( false ),
+  m_pDispatch( 0 ), m_ixDispatch( 0 )
 {
   assert( 0 != pInstrument.get() );
   assert( 0 != pDataProvider.get() );
@@ -42,7 +44,8 @@ Watch::Watch( const Watch& rhs ) :
   m_pInstrument( rhs.m_pInstrument ),
   m_pDataProvider( rhs.m_pDataProvider ),
   m_quote( rhs.m_quote ), m_trade( rhs.m_trade ), 
-  m_cntWatching( 0 ), m_bWatching( false ), m_bWatchingEnabled( false )
+  m_cntWatching( 0 ), m_bWatching( false ), m_bWatchingEnabled( false ),
+  m_pDispatch( rhs.m_pDispatch ), m_ixDispatch( rhs.m_ixDispatch )
 {
   assert( 0 == rhs.m_cntWatching );
   assert( !rhs.m_bWatching );
@@ -53,6 +56,7 @@ Watch::~Watch(void) {
   while ( 0 != m_cntWatching ) {
     StopWatch();
   }
+  SetDispatch( 0 );  // nothing posted is delivered after destruction
 }
 
 Watch& Watch::operator=( const Watch& rhs ) {
@@ -63,6 +67,7 @@ Watch& Watch::operator=( const Watch& rhs ) {
   m_pInstrument = rhs.m_pInstrument;
   m_pDataProvider = rhs.m_pDataProvider;
   m_cntWatching = 0;
+  SetDispatch( rhs.m_pDispatch );
   Initialize();
   return *this;
 }
@@ -188,7 +193,25 @@ void Watch::EmitValues( void ) const {
     << std::endl;
 }
 
+void Watch::SetDispatch( WatchDispatch* pDispatch ) {
+  if ( 0 != m_pDispatch ) {
+    m_pDispatch->Detach( m_ixDispatch, this );  // so nothing arrives out of order, or after destruction
+  }
+  m_pDispatch = pDispatch;
+  m_ixDispatch = 0 == pDispatch ? 0 : pDispatch->Assign( m_pInstrument->GetInstrumentName() );
+}
+
 void Watch::HandleQuote( const Quote& quote ) {
+  if ( 0 != m_pDispatch ) m_pDispatch->Post( m_ixDispatch, this, quote );
+  else DeliverQuote( quote );
+}
+
+void Watch::HandleTrade( const Trade& trade ) {
+  if ( 0 != m_pDispatch ) m_pDispatch->Post( m_ixDispatch, this, trade );
+  else DeliverTrade( trade );
+}
+
+void Watch::DeliverQuote( const Quote& quote ) {
   m_quote = quote;
   //OnPossibleResizeBegin( stateTimeSeries_t( m_quotes.Capacity(), m_quotes.Size() ) );
   {
@@ -201,7 +224,7 @@ void Watch::HandleQuote( const Quote& quote ) {
   OnQuote( quote );
 }
 
-void Watch::HandleTrade( const Trade& trade ) {
+void Watch::DeliverTrade( const Trade& trade ) {
   m_trade = trade;
   //OnPossibleResizeBegin( stateTimeSeries_t( m_trades.Capacity(), m_trades.Size() ) );
   {
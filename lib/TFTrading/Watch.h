@@ -35,7 +35,10 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
+class WatchDispatch;
+
 class Watch {
+  friend class WatchDispatch;
 public:
 
   typedef boost::shared_ptr<Watch> pWatch_t;
@@ -76,6 +79,15 @@ public:
 
   bool Watching( void ) const { return 0 != m_cntWatching; };
 
+  // with a dispatch, quotes and trades are appended, and OnQuote/OnTrade fired, on one of its workers,
+  //   rather than on the provider's thread, null to return to the provider's thread,
+  //   so OnQuote/OnTrade subscribers need to be thread safe, see WatchDispatch.h
+  // what the previous dispatch has queued is delivered first, or dropped when called from a handler on its worker
+  // a class derived from Watch, with its own handlers on OnQuote/OnTrade, sets null in its destructor,
+  //   as ~Watch detaches only once the derived part is gone
+  // a Watch is not destroyed from within its own OnQuote/OnTrade handlers
+  void SetDispatch( WatchDispatch* );
+
   // TODO: these need spinlocks
   inline const Quote& LastQuote( void ) const { return m_quote; };  // may have thread sync issue
   inline const Trade& LastTrade( void ) const { return m_trade; };  // may have thread sync issue
@@ -123,6 +135,9 @@ private:
 
   bool m_bWatchingEnabled;
   bool m_bWatching; // in/out of connected state
+
+  WatchDispatch* m_pDispatch;
+  size_t m_ixDispatch;  // worker assigned to the instrument
   
 
   Fundamentals_t m_fundamentals;
@@ -144,6 +159,9 @@ private:
   void HandleQuote( const Quote& quote );
   void HandleTrade( const Trade& trade );
 
+  void DeliverQuote( const Quote& quote );  // on the provider's thread, or on a dispatch worker
+  void DeliverTrade( const Trade& trade );
+
   void HandleIQFeedFundamentalMessage( ou::tf::IQFeedSymbol& symbol );
   void HandleIQFeedSummaryMessage( ou::tf::IQFeedSymbol& symbol );
   
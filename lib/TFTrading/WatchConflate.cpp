@@ -0,0 +1,193 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include "stdafx.h"
+
+#include <set>
+#include <stdexcept>
+
+#include <boost/thread/thread.hpp>
+
+#include "WatchConflate.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+void WatchConflate::Slot::HandleQuote( const Quote& quote_ ) {
+  const boost::uint64_t n( nSequence.load( std::memory_order_relaxed ) );
+  nSequence.store( n + 1, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_release );
+  quote = quote_;
+  nSequence.store( n + 2, std::memory_order_release );
+}
+
+boost::uint64_t WatchConflate::Slot::Read( Quote& quote_ ) const {
+  while ( true ) {
+    const boost::uint64_t n( nSequence.load( std::memory_order_acquire ) );
+    if ( 0 == ( n & 1 ) ) {
+      quote_ = quote;
+      std::atomic_thread_fence( std::memory_order_acquire );
+      if ( n == nSequence.load( std::memory_order_relaxed ) ) return n;
+    }
+    boost::this_thread::yield();  // the writer may be descheduled mid write
+  }
+}
+
+void WatchConflate::Slot::Detach( void ) {
+  boost::shared_ptr<void> p( pOwner.lock() );  // keeps the source while removing from it
+  if ( 0 != p.get() ) {
+    pSource->Remove( MakeDelegate( this, &Slot::HandleQuote ) );
+  }
+}
+
+bool WatchConflate::Slot::Released( void ) {
+  boost::shared_ptr<void> p( pOwner.lock() );
+  if ( 0 == p.get() ) return true;  // its dispatches ended with it
+  return !pSource->Dispatches( MakeDelegate( this, &Slot::HandleQuote ) );
+}
+
+WatchConflate::WatchConflate( void )
+: m_idNext( 1 ), m_nDelivered( 0 ), m_nPolls( 0 )
+{
+}
+
+WatchConflate::~WatchConflate( void ) {
+  std::set<Slot*> setSlot;  // those of a destroyed source may no longer be in m_mapSlot
+  for ( mapSubscriber_t::iterator iter = m_mapSubscriber.begin(); m_mapSubscriber.end() != iter; ++iter ) {
+    setSlot.insert( iter->second.pSlot );
+  }
+  m_mapSubscriber.clear();
+  m_mapSlot.clear();
+  for ( std::set<Slot*>::iterator iter = setSlot.begin(); setSlot.end() != iter; ++iter ) {
+    Retire( *iter );
+  }
+  while ( !m_vSlotRetired.empty() ) {
+    FreeReleased();
+    if ( !m_vSlotRetired.empty() ) boost::this_thread::yield();  // a dispatch is under way
+  }
+}
+
+void WatchConflate::Retire( Slot* pSlot ) {
+  pSlot->Detach();
+  m_vSlotRetired.push_back( pSlot );
+}
+
+void WatchConflate::FreeReleased( void ) {
+  std::vector<Slot*>::iterator iter = m_vSlotRetired.begin();
+  while ( m_vSlotRetired.end() != iter ) {
+    if ( ( *iter )->Released() ) {
+      delete *iter;
+      iter = m_vSlotRetired.erase( iter );
+    }
+    else {
+      ++iter;
+    }
+  }
+}
+
+WatchConflate::idSubscriber_t WatchConflate::Add(
+  source_t& source, const boost::weak_ptr<void>& pOwner, OnQuote_t handler, const boost::posix_time::time_duration& tdInterval
+) {
+
+  Slot* pSlot( 0 );
+  mapSlot_t::iterator iter = m_mapSlot.find( &source );
+  if ( m_mapSlot.end() != iter ) {
+    if ( iter->second->pOwner.expired() ) {  // a new source at the address of a destroyed one
+      m_mapSlot.erase( iter );  // the old slot stays with its subscribers until they are removed
+    }
+    else {
+      pSlot = iter->second;
+    }
+  }
+  if ( 0 == pSlot ) {
+    pSlot = new Slot( &source, pOwner );
+    m_mapSlot.insert( mapSlot_t::value_type( &source, pSlot ) );
+    source.Add( MakeDelegate( pSlot, &Slot::HandleQuote ) );
+  }
+  ++pSlot->cntSubscribers;
+
+  Subscriber subscriber;
+  subscriber.pSlot = pSlot;
+  subscriber.handler = handler;
+  subscriber.interval = std::chrono::microseconds( tdInterval.total_microseconds() );
+  subscriber.tpNext = clock_t::now();
+
+  const idSubscriber_t id( m_idNext++ );
+  m_mapSubscriber.insert( mapSubscriber_t::value_type( id, subscriber ) );
+  return id;
+}
+
+void WatchConflate::Remove( idSubscriber_t id ) {
+  mapSubscriber_t::iterator iter = m_mapSubscriber.find( id );
+  if ( m_mapSubscriber.end() == iter ) {
+    throw std::runtime_error( "WatchConflate::Remove: subscriber not found" );
+  }
+  Slot* pSlot( iter->second.pSlot );
+  m_mapSubscriber.erase( iter );
+  if ( 0 == --pSlot->cntSubscribers ) {
+    mapSlot_t::iterator iterSlot = m_mapSlot.find( pSlot->pSource );
+    if ( ( m_mapSlot.end() != iterSlot ) && ( pSlot == iterSlot->second ) ) {
+      m_mapSlot.erase( iterSlot );
+    }
+    Retire( pSlot );  // freed at a later Poll
+  }
+}
+
+size_t WatchConflate::Poll( void ) {
+
+  ++m_nPolls;
+
+  if ( !m_vSlotRetired.empty() ) FreeReleased();
+
+  size_t nDelivered( 0 );
+  const clock_t::time_point now( clock_t::now() );
+  Quote quote;
+
+  for ( mapSubscriber_t::iterator iter = m_mapSubscriber.begin(); m_mapSubscriber.end() != iter; ++iter ) {
+    Subscriber& subscriber( iter->second );
+    const boost::uint64_t n( subscriber.pSlot->nSequence.load( std::memory_order_acquire ) );
+    if ( n == subscriber.nSequence ) continue;  // nothing new, the common case for a quiet instrument
+    if ( now < subscriber.tpNext ) continue;  // the slot keeps the latest for a later poll
+    subscriber.nSequence = subscriber.pSlot->Read( quote );
+    subscriber.tpNext = now + subscriber.interval;
+    subscriber.handler( quote );
+    ++nDelivered;
+  }
+
+  m_nDelivered += nDelivered;
+  return nDelivered;
+}
+
+bool WatchConflate::Latest( source_t* pSource, Quote& quote ) const {
+  mapSlot_t::const_iterator iter = m_mapSlot.find( pSource );
+  if ( m_mapSlot.end() == iter ) return false;
+  if ( iter->second->pOwner.expired() ) return false;  // not this source, one destroyed at the same address
+  if ( 0 == iter->second->nSequence.load( std::memory_order_acquire ) ) return false;
+  iter->second->Read( quote );
+  return true;
+}
+
+WatchConflate::Stats WatchConflate::GetStats( void ) const {
+  Stats stats;
+  for ( mapSlot_t::const_iterator iter = m_mapSlot.begin(); m_mapSlot.end() != iter; ++iter ) {
+    stats.nReceived += iter->second->nSequence.load( std::memory_order_relaxed ) / 2;
+  }
+  stats.nDelivered = m_nDelivered;
+  stats.nPolls = m_nPolls;
+  stats.nRetired = m_vSlotRetired.size();
+  return stats;
+}
+
+} // namespace tf
+} // namespace ou
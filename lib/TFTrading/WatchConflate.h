@@ -0,0 +1,133 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// latest only quotes, for subscribers which redraw or decide on the current value rather than on every tick,
+//   such as gui panels and coarse strategies
+// each source, Watch::OnQuote or Position::OnQuote, gets one slot, shared by its subscribers here:
+//   the source's thread overwrites the slot under a sequence lock, a counter odd while written,
+//   so the writer never waits, and a reader retries a copy torn by a write
+// the consumer calls Poll from its own thread, a gui timer for example, each subscriber whose slot changed
+//   since its last delivery gets the latest quote once, and not again within its interval, zero for every poll,
+//   quotes in between are dropped, not queued
+// Add, Remove, Poll, Latest and destruction belong to the consumer's thread, one instance per consumer thread
+// a source is added through the shared_ptr of its Watch or Position, only a weak_ptr is kept:
+//   once the owner is destroyed, its subscribers get nothing further, and nothing is removed from the gone source
+// a slot no longer subscribed may still be written by a dispatch already running,
+//   it is freed at a later Poll, once the source no longer dispatches to it, or is gone
+
+#include <map>
+#include <vector>
+#include <atomic>
+#include <chrono>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <OUCommon/Delegate.h>
+
+#include <TFTimeSeries/DatedDatum.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class WatchConflate {
+public:
+
+  typedef ou::Delegate<const Quote&> source_t;
+  typedef FastDelegate1<const Quote&> OnQuote_t;
+  typedef size_t idSubscriber_t;
+
+  struct Stats {
+    boost::uint64_t nReceived;  // quotes written to the slots in use
+    boost::uint64_t nDelivered;  // handler calls
+    boost::uint64_t nPolls;
+    boost::uint64_t nRetired;  // slots waiting to be freed
+    Stats( void ): nReceived( 0 ), nDelivered( 0 ), nPolls( 0 ), nRetired( 0 ) {};
+  };
+
+  WatchConflate( void );
+  ~WatchConflate( void );  // removes its handlers from the sources still there, waits out their dispatches
+
+  template<typename Owner>  // Watch or Position, subscribes to its OnQuote
+  idSubscriber_t Add( const boost::shared_ptr<Owner>& pOwner, OnQuote_t handler, const boost::posix_time::time_duration& tdInterval = boost::posix_time::time_duration( 0, 0, 0 ) ) {
+    return Add( pOwner->OnQuote, boost::weak_ptr<void>( pOwner ), handler, tdInterval );
+  }
+  void Remove( idSubscriber_t );
+
+  size_t Poll( void );  // delivers what changed, returns the number of handler calls, frees the slots released
+
+  template<typename Owner>
+  bool Latest( const boost::shared_ptr<Owner>& pOwner, Quote& quote ) const {  // false when not subscribed, or no quote yet
+    return Latest( &pOwner->OnQuote, quote );
+  }
+
+  Stats GetStats( void ) const;
+
+protected:
+private:
+
+  typedef std::chrono::steady_clock clock_t;
+
+  struct Slot {
+    source_t* pSource;  // valid while pOwner is
+    boost::weak_ptr<void> pOwner;
+    std::atomic<boost::uint64_t> nSequence;  // twice the writes, odd while one is under way
+    Quote quote;
+    size_t cntSubscribers;
+    Slot( source_t* pSource_, const boost::weak_ptr<void>& pOwner_ )
+      : pSource( pSource_ ), pOwner( pOwner_ ), nSequence( 0 ), cntSubscribers( 0 ) {};
+    void HandleQuote( const Quote& );  // the source's thread, the only writer
+    boost::uint64_t Read( Quote& ) const;  // returns the sequence of the copy
+    void Detach( void );  // from the source, if still there
+    bool Released( void );  // the source no longer dispatches to it, or is gone
+  };
+
+  struct Subscriber {
+    Slot* pSlot;
+    OnQuote_t handler;
+    clock_t::duration interval;
+    clock_t::time_point tpNext;  // earliest next delivery
+    boost::uint64_t nSequence;  // of the last delivery
+    Subscriber( void ): pSlot( 0 ), nSequence( 0 ) {};
+  };
+
+  typedef std::map<source_t*, Slot*> mapSlot_t;
+  typedef std::map<idSubscriber_t, Subscriber> mapSubscriber_t;
+
+  mapSlot_t m_mapSlot;
+  mapSubscriber_t m_mapSubscriber;
+  std::vector<Slot*> m_vSlotRetired;  // detached, to be freed once released
+
+  idSubscriber_t m_idNext;
+
+  boost::uint64_t m_nDelivered;
+  boost::uint64_t m_nPolls;
+
+  idSubscriber_t Add( source_t&, const boost::weak_ptr<void>& pOwner, OnQuote_t, const boost::posix_time::time_duration& tdInterval );
+  bool Latest( source_t*, Quote& ) const;
+
+  void Retire( Slot* );
+  void FreeReleased( void );
+
+  WatchConflate( const WatchConflate& );  // not copyable
+  WatchConflate& operator=( const WatchConflate& );
+
+};
+
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,205 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#include "stdafx.h"
+
+#include <chrono>
+#include <functional>
+
+#include <boost/bind.hpp>
+
+#include "Watch.h"
+#include "WatchDispatch.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+WatchDispatch::Worker::Worker( size_t nQueueSize_ )
+: nQueueSize( nQueueSize_ ), queue( nQueueSize_ ),
+  nPosted( 0 ), nDelivered( 0 ), nStalls( 0 ), nDropped( 0 ), bWaiting( false )
+{
+  for ( unsigned ix = 0; ix < nBuckets; ++ix ) {
+    rnDepth[ ix ].store( 0 );
+    rnLatency[ ix ].store( 0 );
+  }
+}
+
+WatchDispatch::WatchDispatch( size_t nWorkers, size_t nQueueSize )
+: m_bStop( false )
+{
+  if ( 0 == nWorkers ) nWorkers = 1;
+  if ( 0 == nQueueSize ) nQueueSize = 1;
+  for ( size_t ix = 0; ix < nWorkers; ++ix ) {
+    m_vWorker.push_back( new Worker( nQueueSize ) );
+  }
+  for ( vWorker_t::iterator iter = m_vWorker.begin(); m_vWorker.end() != iter; ++iter ) {
+    ( *iter )->thread = boost::thread( boost::bind( &WatchDispatch::Run, this, boost::ref( **iter ) ) );
+  }
+}
+
+WatchDispatch::~WatchDispatch( void ) {
+  m_bStop.store( true );
+  for ( vWorker_t::iterator iter = m_vWorker.begin(); m_vWorker.end() != iter; ++iter ) {
+    {
+      boost::mutex::scoped_lock lock( ( *iter )->mutexWork );
+      ( *iter )->cvWork.notify_one();
+    }
+    ( *iter )->thread.join();  // a worker empties its queue before it exits
+    delete *iter;
+  }
+  m_vWorker.clear();
+}
+
+size_t WatchDispatch::Assign( const std::string& sInstrumentName ) const {
+  return std::hash<std::string>()( sInstrumentName ) % m_vWorker.size();
+}
+
+unsigned WatchDispatch::Bucket( boost::uint64_t n ) {
+  unsigned ix( 0 );
+  while ( ( 0 != n ) && ( ix < nBuckets - 1 ) ) {
+    n >>= 1;
+    ++ix;
+  }
+  return ix;
+}
+
+void WatchDispatch::Post( size_t ixWorker, Watch* pWatch, const Quote& quote ) {
+  Event event;
+  event.eType = Event::EQuote;
+  event.pWatch = pWatch;
+  event.quote = quote;
+  Post( *m_vWorker[ ixWorker ], event );
+}
+
+void WatchDispatch::Post( size_t ixWorker, Watch* pWatch, const Trade& trade ) {
+  Event event;
+  event.eType = Event::ETrade;
+  event.pWatch = pWatch;
+  event.trade = trade;
+  Post( *m_vWorker[ ixWorker ], event );
+}
+
+void WatchDispatch::Post( Worker& worker, const Event& event ) {
+
+  worker.lockPost.lock();
+  const size_t nDepth( worker.nQueueSize - worker.queue.write_available() );
+  worker.rnDepth[ Bucket( nDepth ) ].fetch_add( 1, std::memory_order_relaxed );
+  if ( !worker.queue.push( event ) ) {
+    worker.nStalls.fetch_add( 1, std::memory_order_relaxed );
+    while ( !worker.queue.push( event ) ) boost::this_thread::yield();
+  }
+  worker.nPosted.fetch_add( 1, std::memory_order_relaxed );  // under the lock, so the count matches the queue's order
+  worker.lockPost.unlock();
+
+  // pairs with the worker's store of bWaiting before it looks at the queue, one of the two sees the other
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+  if ( worker.bWaiting.load( std::memory_order_relaxed ) ) {
+    boost::mutex::scoped_lock lock( worker.mutexWork );
+    worker.cvWork.notify_one();
+  }
+}
+
+void WatchDispatch::Run( Worker& worker ) {
+  Event event;
+  boost::uint64_t nPopped( 0 );  // the event's number in the order posted
+  while ( true ) {
+    if ( worker.queue.pop( event ) ) {
+      ++nPopped;
+      bool bDropped( false );
+      for ( std::vector<Worker::dropped_t>::iterator iter = worker.vDropped.begin(); worker.vDropped.end() != iter; ) {
+        if ( nPopped > iter->second ) {  // everything queued for it has gone by
+          iter = worker.vDropped.erase( iter );
+        }
+        else {
+          if ( event.pWatch == iter->first ) bDropped = true;
+          ++iter;
+        }
+      }
+      if ( bDropped ) {
+        worker.nDropped.fetch_add( 1, std::memory_order_relaxed );
+      }
+      else {
+        const std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+        switch ( event.eType ) {
+        case Event::EQuote:
+          event.pWatch->DeliverQuote( event.quote );
+          break;
+        case Event::ETrade:
+          event.pWatch->DeliverTrade( event.trade );
+          break;
+        }
+        const boost::uint64_t ns( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count() );
+        worker.rnLatency[ Bucket( ns ) ].fetch_add( 1, std::memory_order_relaxed );
+      }
+      worker.nDelivered.fetch_add( 1, std::memory_order_release );
+    }
+    else {
+      boost::mutex::scoped_lock lock( worker.mutexWork );
+      worker.bWaiting.store( true, std::memory_order_relaxed );
+      std::atomic_thread_fence( std::memory_order_seq_cst );
+      if ( 0 == worker.queue.read_available() ) {
+        if ( m_bStop.load() ) break;
+        worker.cvDrained.notify_all();
+        worker.cvWork.timed_wait( lock, boost::posix_time::milliseconds( 100 ) );
+      }
+      worker.bWaiting.store( false, std::memory_order_relaxed );
+    }
+  }
+}
+
+void WatchDispatch::Drain( size_t ixWorker ) {
+  Worker& worker( *m_vWorker[ ixWorker ] );
+  if ( boost::this_thread::get_id() == worker.thread.get_id() ) return;  // a handler can't wait on itself
+  const boost::uint64_t nPosted( worker.nPosted.load( std::memory_order_relaxed ) );
+  boost::mutex::scoped_lock lock( worker.mutexWork );
+  while ( worker.nDelivered.load( std::memory_order_acquire ) < nPosted ) {
+    worker.cvDrained.timed_wait( lock, boost::posix_time::milliseconds( 1 ) );
+  }
+}
+
+void WatchDispatch::Detach( size_t ixWorker, Watch* pWatch ) {
+  Worker& worker( *m_vWorker[ ixWorker ] );
+  if ( boost::this_thread::get_id() == worker.thread.get_id() ) {
+    worker.lockPost.lock();
+    const boost::uint64_t nPosted( worker.nPosted.load( std::memory_order_relaxed ) );
+    worker.lockPost.unlock();
+    worker.vDropped.push_back( Worker::dropped_t( pWatch, nPosted ) );
+  }
+  else {
+    Drain( ixWorker );
+  }
+}
+
+void WatchDispatch::Drain( void ) {
+  for ( size_t ix = 0; ix < m_vWorker.size(); ++ix ) {
+    Drain( ix );
+  }
+}
+
+WatchDispatch::Stats WatchDispatch::GetStats( size_t ixWorker ) const {
+  const Worker& worker( *m_vWorker[ ixWorker ] );
+  Stats stats;
+  stats.nPosted = worker.nPosted.load( std::memory_order_relaxed );
+  stats.nDelivered = worker.nDelivered.load( std::memory_order_relaxed );
+  stats.nStalls = worker.nStalls.load( std::memory_order_relaxed );
+  stats.nDropped = worker.nDropped.load( std::memory_order_relaxed );
+  for ( unsigned ix = 0; ix < nBuckets; ++ix ) {
+    stats.rnDepth[ ix ] = worker.rnDepth[ ix ].load( std::memory_order_relaxed );
+    stats.rnLatency[ ix ] = worker.rnLatency[ ix ].load( std::memory_order_relaxed );
+  }
+  return stats;
+}
+
+} // namespace tf
+} // namespace ou
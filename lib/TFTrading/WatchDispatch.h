@@ -0,0 +1,135 @@
+/************************************************************************
+ * Copyright(c) 2018, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+#pragma once
+
+// moves a Watch's quotes and trades off the provider's thread, onto a pool of worker threads:
+//   each instrument is assigned to a worker by the hash of its name, so its quotes and trades stay in order,
+//   while a slow subscriber delays only the instruments sharing its worker
+// each worker has its own lock free queue, a provider's thread posts to it, the worker appends the
+//   Watch's series and fires OnQuote/OnTrade, so subscribers run on the worker, not the provider's thread
+// posting takes a spin lock per worker, uncontended with one data provider, so several providers can share the pool
+// a full queue makes the provider's thread wait, counted as a stall
+// OnQuote/OnTrade subscribers run on the workers, concurrently with anything on the provider's thread,
+//   such as order executions, so they need to be thread safe:  Position and Portfolio lock their state,
+//   other subscribers need to do the same, or only read what the Watch delivers
+// histograms, in powers of two, of the queue depth seen when posting, and of the time spent in the handlers
+// destroy after the Watches using it, or detach them first
+// a Watch detached from within a handler on its own worker can't wait for the worker to catch up,
+//   its events still queued are dropped instead, so a handler may destroy another Watch on the same worker
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <atomic>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <OUCommon/SpinLock.h>
+
+#include <TFTimeSeries/DatedDatum.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class Watch;
+
+class WatchDispatch {
+public:
+
+  enum { nBuckets = 32 };  // bucket 0 counts zero, bucket n counts [ 2^(n-1), 2^n )
+
+  struct Stats {
+    boost::uint64_t nPosted;
+    boost::uint64_t nDelivered;
+    boost::uint64_t nStalls;  // posts which waited on a full queue
+    boost::uint64_t nDropped;  // queued for a Watch detached from a handler, see Detach
+    boost::uint64_t rnDepth[ nBuckets ];  // events already queued, at each post
+    boost::uint64_t rnLatency[ nBuckets ];  // nanoseconds in the handlers, per event
+    Stats( void ): nPosted( 0 ), nDelivered( 0 ), nStalls( 0 ), nDropped( 0 ) {
+      for ( unsigned ix = 0; ix < nBuckets; ++ix ) { rnDepth[ ix ] = 0; rnLatency[ ix ] = 0; }
+    };
+  };
+
+  explicit WatchDispatch( size_t nWorkers = 2, size_t nQueueSize = 4096 );
+  ~WatchDispatch( void );
+
+  size_t Workers( void ) const { return m_vWorker.size(); };
+  size_t Assign( const std::string& sInstrumentName ) const;  // the worker for the instrument
+
+  void Post( size_t ixWorker, Watch*, const Quote& );
+  void Post( size_t ixWorker, Watch*, const Trade& );
+
+  void Drain( size_t ixWorker );  // returns once the worker has delivered what was posted before the call, immediately on the worker itself
+  void Drain( void );  // all workers
+
+  // nothing posted so far is delivered to the Watch once this returns:  waits for it to be delivered,
+  //   or, on the worker itself, drops it
+  void Detach( size_t ixWorker, Watch* );
+
+  Stats GetStats( size_t ixWorker ) const;
+
+protected:
+private:
+
+  struct Event {
+    enum EType { EQuote, ETrade } eType;
+    Watch* pWatch;
+    Quote quote;
+    Trade trade;
+  };
+
+  typedef boost::lockfree::spsc_queue<Event> queue_t;
+
+  struct Worker {
+    const size_t nQueueSize;
+    queue_t queue;
+    ou::SpinLock lockPost;  // producers take turns, the queue takes a single producer
+    std::atomic<boost::uint64_t> nPosted;
+    std::atomic<boost::uint64_t> nDelivered;
+    std::atomic<boost::uint64_t> nStalls;
+    std::atomic<boost::uint64_t> nDropped;
+    std::atomic<boost::uint64_t> rnDepth[ nBuckets ];
+    std::atomic<boost::uint64_t> rnLatency[ nBuckets ];
+    std::atomic<bool> bWaiting;  // asleep, or about to be, on cvWork
+    boost::mutex mutexWork;
+    boost::condition_variable cvWork;
+    boost::condition_variable cvDrained;
+    boost::thread thread;
+    typedef std::pair<Watch*,boost::uint64_t> dropped_t;  // the Watch, and the count posted when it was detached
+    std::vector<dropped_t> vDropped;  // used on the worker's thread only
+    explicit Worker( size_t nQueueSize );
+  };
+
+  typedef std::vector<Worker*> vWorker_t;
+  vWorker_t m_vWorker;
+
+  std::atomic<bool> m_bStop;
+
+  void Post( Worker&, const Event& );
+  void Run( Worker& );
+
+  static unsigned Bucket( boost::uint64_t );
+
+  WatchDispatch( const WatchDispatch& );  // not copyable
+  WatchDispatch& operator=( const WatchDispatch& );
+
+};
+
+} // namespace tf
+} // namespace ou
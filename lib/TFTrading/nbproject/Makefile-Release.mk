@@ -69,6 +69,8 @@ OBJECTFILES= \
 	${OBJECTDIR}/Symbol.o \
 	${OBJECTDIR}/TradingEnumerations.o \
 	${OBJECTDIR}/Watch.o \
+	${OBJECTDIR}/WatchConflate.o \
+	${OBJECTDIR}/WatchDispatch.o \
 	${OBJECTDIR}/stdafx.o
 
 
@@ -268,6 +270,16 @@ ${OBJECTDIR}/Watch.o: Watch.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Watch.o Watch.cpp
 
+${OBJECTDIR}/WatchConflate.o: WatchConflate.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/WatchConflate.o WatchConflate.cpp
+
+${OBJECTDIR}/WatchDispatch.o: WatchDispatch.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../ -std=c++11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/WatchDispatch.o WatchDispatch.cpp
+
 ${OBJECTDIR}/stdafx.o: stdafx.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"